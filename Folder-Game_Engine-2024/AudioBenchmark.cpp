@@ -0,0 +1,215 @@
+#include "AudioMixer.h"
+#include "AudioOutput.h"
+#include "Benchmark.h"
+
+#include <gtc/constants.hpp>
+#include <gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	unsigned const sampleRate = 48000;
+	std::size_t const blockFrames = 512;
+	std::size_t const voiceCount = 512;
+	std::size_t const realVoices = 64;
+	int const blockCount = 200;
+	float const worldExtent = 60.0f;
+
+	// One second of a sine with a whole number of periods, so it loops without a seam
+	engine::SoundBuffer sine(float frequency, unsigned rate)
+	{
+		std::vector<std::int16_t> pcm(rate);
+		for(std::size_t i = 0; i < pcm.size(); ++i)
+			pcm[i] = static_cast<std::int16_t>(16000.0f * glm::sin(glm::two_pi<float>() * frequency * i / rate));
+		return engine::SoundBuffer::fromPcm16(pcm.data(), pcm.size(), 1, rate);
+	}
+
+	std::vector<engine::VoiceId> playAll(engine::AudioMixer& mixer, const std::vector<engine::SoundBuffer>& sounds)
+	{
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::vector<engine::VoiceId> voices;
+		for(std::size_t i = 0; i < voiceCount; ++i)
+		{
+			engine::VoiceParams params;
+			params.loop = true;
+			params.pitch = 1.0f + 0.25f * unit(random);
+			params.position = glm::vec3(unit(random), 0.1f * unit(random), unit(random)) * worldExtent;
+			params.maxDistance = 100.0f;
+			voices.push_back(mixer.play(sounds[i % sounds.size()], params));
+		}
+		return voices;
+	}
+
+	// Average time to mix a block with every voice playing
+	double mixBlocks(engine::AudioMixer& mixer, std::vector<float>& out)
+	{
+		mixer.mix(out.data(), blockFrames);
+		engine::Stopwatch timer;
+		for(int i = 0; i < blockCount; ++i)
+			mixer.mix(out.data(), blockFrames);
+		return timer.elapsedMs() / blockCount;
+	}
+}
+
+ENGINE_BENCHMARK(Audio)
+{
+	std::vector<engine::SoundBuffer> sounds;
+	sounds.push_back(sine(441.0f, 44100));
+	sounds.push_back(sine(300.0f, 48000));
+	sounds.push_back(sine(250.0f, 22050));
+	std::vector<float> out(blockFrames * 2);
+	double const blockMs = 1000.0 * blockFrames / sampleRate;
+
+	engine::AudioMixer virtualized(sampleRate, voiceCount, realVoices);
+	std::vector<engine::VoiceId> const voices = playAll(virtualized, sounds);
+	double const virtualizedMs = mixBlocks(virtualized, out);
+	engine::AudioMixerStats const stats = virtualized.stats();
+	context.report("voices playing", static_cast<double>(stats.playingVoices), "");
+	context.report("real voices", static_cast<double>(stats.realVoices), "");
+	context.report("virtual voices", static_cast<double>(stats.virtualVoices), "");
+	context.report("mix block virtualized", virtualizedMs, "ms");
+
+	engine::AudioMixer allReal(sampleRate, voiceCount, voiceCount);
+	playAll(allReal, sounds);
+	double const allRealMs = mixBlocks(allReal, out);
+	unsigned const mixed = allReal.stats().realVoices;
+	context.report("mix block all real", allRealMs, "ms");
+	context.report("voices per ms", mixed / allRealMs, "voices/ms");
+	context.report("real-time voice capacity", mixed * blockMs / allRealMs, "voices");
+
+	// A centered voice at the output rate must come out untouched apart from the pan law, a resampled one
+	// must follow the sine it was sampled from
+	float exactError = 0.0f;
+	float resampledError = 0.0f;
+	{
+		engine::AudioMixer mixer(sampleRate, 4, 4);
+		engine::VoiceParams params;
+		params.positional = false;
+		params.loop = true;
+		mixer.play(sounds[1], params);
+		mixer.mix(out.data(), blockFrames);
+		float const gain = glm::cos(glm::quarter_pi<float>());
+		for(std::size_t i = 0; i < blockFrames; ++i)
+			exactError = std::max(exactError, glm::abs(out[i * 2] - sounds[1].samples[i] * gain));
+
+		engine::AudioMixer resampler(sampleRate, 4, 4);
+		resampler.play(sounds[0], params);
+		for(int block = 0; block < 100; ++block)
+		{
+			resampler.mix(out.data(), blockFrames);
+			for(std::size_t i = 0; i < blockFrames; ++i)
+			{
+				double const time = (block * blockFrames + i) / static_cast<double>(sampleRate);
+				float const expected = gain * 16000.0f / 32768.0f * static_cast<float>(glm::sin(glm::two_pi<double>() * 441.0 * time));
+				resampledError = std::max(resampledError, glm::abs(out[i * 2 + 1] - expected));
+			}
+		}
+	}
+	context.report("same rate error", exactError, "");
+	context.report("resampled error", resampledError, "");
+
+	// A voice losing its real slot to a louder one ramps down over a block instead of cutting off
+	bool fadedOut = false;
+	{
+		engine::SoundBuffer constant;
+		constant.sampleRate = sampleRate;
+		constant.samples.assign(sampleRate, 1.0f);
+		engine::SoundBuffer silence;
+		silence.sampleRate = sampleRate;
+		silence.samples.assign(sampleRate, 0.0f);
+		engine::AudioMixer mixer(sampleRate, 4, 1);
+		engine::VoiceParams params;
+		params.positional = false;
+		params.loop = true;
+		mixer.play(constant, params);
+		params.volume = 0.5f;
+		engine::VoiceId const louder = mixer.play(silence, params);
+		mixer.mix(out.data(), blockFrames);
+		float const gain = glm::cos(glm::quarter_pi<float>());
+		bool const steady = glm::abs(out[(blockFrames - 1) * 2] - gain) < 1e-5f;
+		mixer.setVolume(louder, 2.0f);
+		mixer.mix(out.data(), blockFrames);
+		float const step = gain / blockFrames;
+		bool ramp = glm::abs(out[0] - gain) <= step * 1.01f && out[(blockFrames - 1) * 2] <= step * 1.01f;
+		for(std::size_t i = 1; i < blockFrames; ++i)
+			ramp = ramp && out[i * 2] <= out[(i - 1) * 2];
+		mixer.mix(out.data(), blockFrames);
+		fadedOut = steady && ramp && *std::max_element(out.begin(), out.end()) == 0.0f;
+	}
+	context.report("demoted voice fades out", fadedOut ? 1.0 : 0.0, "ok");
+
+	// An id kept after its voice ended doesn't reach the voice that reuses its slot
+	bool staleIgnored = false;
+	{
+		engine::AudioMixer mixer(sampleRate, 1, 1);
+		engine::VoiceParams params;
+		params.positional = false;
+		params.loop = true;
+		engine::VoiceId const first = mixer.play(sounds[1], params);
+		mixer.stop(first);
+		mixer.mix(out.data(), blockFrames);
+		mixer.update();
+		engine::VoiceId const second = mixer.play(sounds[1], params);
+		mixer.stop(first);
+		mixer.setVolume(first, 0.0f);
+		mixer.mix(out.data(), blockFrames);
+		staleIgnored = second != engine::invalidVoice && second != first && mixer.stats().playingVoices == 1 && mixer.stats().realVoices == 1;
+	}
+	context.report("stale voice ids ignored", staleIgnored ? 1.0 : 0.0, "ok");
+
+	// The listener walks through the field while the device mixes on its own thread
+	engine::NullAudioOutput nullOutput;
+	std::uint64_t commands = 0;
+	{
+		engine::AudioDevice device(virtualized, nullOutput, blockFrames, false);
+		engine::Stopwatch timer;
+		for(int frame = 0; frame < 120; ++frame)
+		{
+			glm::vec3 const eye(frame * 0.5f - 30.0f, 1.8f, 0.0f);
+			commands += virtualized.setListener(glm::inverse(glm::lookAt(eye, eye + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)))) ? 1 : 0;
+			for(std::size_t i = 0; i < voices.size(); i += 8)
+				commands += virtualized.setPosition(voices[i], glm::vec3(glm::sin(frame * 0.05f + i), 0.0f, glm::cos(frame * 0.05f + i)) * worldExtent) ? 1 : 0;
+			virtualized.update();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		device.stop();
+		context.report("device blocks", static_cast<double>(device.blocksWritten()), "");
+		context.report("device realtime factor", device.blocksWritten() * blockMs / timer.elapsedMs(), "x");
+	}
+	context.report("commands sent", static_cast<double>(commands), "");
+	context.report("commands applied", static_cast<double>(virtualized.stats().commands - voiceCount), "");
+
+	for(engine::VoiceId voice : voices)
+		virtualized.stop(voice);
+	virtualized.mix(out.data(), blockFrames);
+	virtualized.update();
+	context.report("voices freed", virtualized.voicesInUse() == 0 ? 1.0 : 0.0, "ok");
+
+	// One second of the field to disk
+	char const* path = "audio_benchmark.wav";
+	engine::WavAudioOutput wav;
+	bool written = wav.open(path, sampleRate);
+	for(std::size_t frames = 0; frames < sampleRate; frames += blockFrames)
+	{
+		allReal.mix(out.data(), blockFrames);
+		written = wav.write(out.data(), blockFrames) && written;
+	}
+	written = wav.close() && written;
+	std::FILE* file = std::fopen(path, "rb");
+	long size = 0;
+	if(file)
+	{
+		std::fseek(file, 0, SEEK_END);
+		size = std::ftell(file);
+		std::fclose(file);
+	}
+	std::remove(path);
+	context.report("wav written", written && size == static_cast<long>(44 + wav.framesWritten() * 4) ? 1.0 : 0.0, "ok");
+}
@@ -0,0 +1,517 @@
+#include "AudioMixer.h"
+#include "AudioOutput.h"
+
+#include <gtc/constants.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace engine
+{
+	namespace
+	{
+		std::size_t const commandCapacity = 4096;
+		// About -72 dB, quieter voices are not worth a real slot
+		float const audibleThreshold = 1.0f / 4096.0f;
+		double const fixedOne = 4294967296.0;
+		std::size_t const maxSlots = 0xFFFF;
+
+		std::uint32_t voiceSlot(VoiceId voice)
+		{
+			return voice & 0xFFFFu;
+		}
+
+		// Resamples count frames with linear interpolation and adds them to left and right with gains ramping by a
+		// constant step per frame. The caller guarantees that every frame's sample and the one after it are in range.
+		void mixRun(const float* samples, std::uint64_t& cursor, std::uint64_t step, float* left, float* right, std::size_t count,
+			float& gainLeft, float& gainRight, float stepLeft, float stepRight)
+		{
+			std::size_t i = 0;
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			__m128 const fractionScale = _mm_set1_ps(static_cast<float>(2.0 / fixedOne));
+			__m128 gainL = _mm_setr_ps(gainLeft, gainLeft + stepLeft, gainLeft + 2.0f * stepLeft, gainLeft + 3.0f * stepLeft);
+			__m128 gainR = _mm_setr_ps(gainRight, gainRight + stepRight, gainRight + 2.0f * stepRight, gainRight + 3.0f * stepRight);
+			__m128 const gainStepL = _mm_set1_ps(4.0f * stepLeft);
+			__m128 const gainStepR = _mm_set1_ps(4.0f * stepRight);
+			if(step == (std::uint64_t(1) << 32) && (cursor & 0xFFFFFFFFu) == 0)
+			{
+				// Same rate and on a sample, nothing to interpolate
+				const float* source = samples + (cursor >> 32);
+				for(; i + 4 <= count; i += 4)
+				{
+					__m128 const s = _mm_loadu_ps(source + i);
+					_mm_storeu_ps(left + i, _mm_add_ps(_mm_loadu_ps(left + i), _mm_mul_ps(s, gainL)));
+					_mm_storeu_ps(right + i, _mm_add_ps(_mm_loadu_ps(right + i), _mm_mul_ps(s, gainR)));
+					gainL = _mm_add_ps(gainL, gainStepL);
+					gainR = _mm_add_ps(gainR, gainStepR);
+				}
+				cursor += i * step;
+			}
+			else
+			{
+				// The gather stays scalar, interpolation and the gains go four frames at a time
+				alignas(16) float a[4];
+				alignas(16) float b[4];
+				alignas(16) std::int32_t fraction[4];
+				for(; i + 4 <= count; i += 4)
+				{
+					for(int k = 0; k < 4; ++k)
+					{
+						std::size_t const index = static_cast<std::size_t>(cursor >> 32);
+						a[k] = samples[index];
+						b[k] = samples[index + 1];
+						// Top 31 bits of the fraction so the signed conversion works
+						fraction[k] = static_cast<std::int32_t>((cursor & 0xFFFFFFFFu) >> 1);
+						cursor += step;
+					}
+					__m128 const t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(fraction))), fractionScale);
+					__m128 const va = _mm_load_ps(a);
+					__m128 const s = _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(b), va), t));
+					_mm_storeu_ps(left + i, _mm_add_ps(_mm_loadu_ps(left + i), _mm_mul_ps(s, gainL)));
+					_mm_storeu_ps(right + i, _mm_add_ps(_mm_loadu_ps(right + i), _mm_mul_ps(s, gainR)));
+					gainL = _mm_add_ps(gainL, gainStepL);
+					gainR = _mm_add_ps(gainR, gainStepR);
+				}
+			}
+			gainLeft += static_cast<float>(i) * stepLeft;
+			gainRight += static_cast<float>(i) * stepRight;
+#endif
+			for(; i < count; ++i)
+			{
+				std::size_t const index = static_cast<std::size_t>(cursor >> 32);
+				float const t = static_cast<float>((cursor & 0xFFFFFFFFu) / fixedOne);
+				float const s = samples[index] + (samples[index + 1] - samples[index]) * t;
+				left[i] += s * gainLeft;
+				right[i] += s * gainRight;
+				gainLeft += stepLeft;
+				gainRight += stepRight;
+				cursor += step;
+			}
+		}
+	}
+
+	SoundBuffer SoundBuffer::fromPcm16(const std::int16_t* interleaved, std::size_t frameCount, unsigned channels, unsigned sampleRate)
+	{
+		SoundBuffer sound;
+		sound.sampleRate = sampleRate;
+		sound.samples.resize(frameCount);
+		float const scale = 1.0f / (32768.0f * static_cast<float>(std::max(channels, 1u)));
+		for(std::size_t i = 0; i < frameCount; ++i)
+		{
+			int sum = 0;
+			for(unsigned c = 0; c < channels; ++c)
+				sum += interleaved[i * channels + c];
+			sound.samples[i] = static_cast<float>(sum) * scale;
+		}
+		return sound;
+	}
+
+	AudioMixer::AudioMixer(unsigned sampleRate, std::size_t maxVoices, std::size_t maxRealVoices) :
+		m_sampleRate(sampleRate),
+		m_voiceCount(std::min(maxVoices, maxSlots)),
+		m_maxRealVoices(maxRealVoices),
+		m_generations(m_voiceCount, 0),
+		m_commands(commandCapacity),
+		m_ended(m_voiceCount),
+		m_voices(m_voiceCount),
+		m_listenerInverse(1.0f),
+		m_playingCount(0),
+		m_realCount(0),
+		m_virtualCount(0),
+		m_commandCount(0),
+		m_blockCount(0)
+	{
+		// Handed out from the back, lowest ids first
+		m_freeIds.reserve(m_voiceCount);
+		for(std::size_t i = m_voiceCount; i > 0; --i)
+			m_freeIds.push_back(static_cast<std::uint32_t>(i - 1));
+		m_playing.reserve(m_voiceCount);
+		m_ranked.reserve(m_voiceCount);
+		for(Voice& voice : m_voices)
+		{
+			voice.id = invalidVoice;
+			voice.sound = nullptr;
+			voice.playing = false;
+		}
+	}
+
+	bool AudioMixer::push(const Command& command)
+	{
+		return m_commands.push(command);
+	}
+
+	VoiceId AudioMixer::play(const SoundBuffer& sound, const VoiceParams& params)
+	{
+		if(m_freeIds.empty())
+			return invalidVoice;
+		std::uint32_t const slot = m_freeIds.back();
+		std::uint16_t const generation = static_cast<std::uint16_t>(m_generations[slot] + 1);
+		Command command;
+		command.type = Command::Play;
+		command.voice = static_cast<VoiceId>(generation) << 16 | slot;
+		command.sound = &sound;
+		command.params = params;
+		if(!push(command))
+			return invalidVoice;
+		m_generations[slot] = generation;
+		m_freeIds.pop_back();
+		return command.voice;
+	}
+
+	bool AudioMixer::stop(VoiceId voice)
+	{
+		Command command;
+		command.type = Command::Stop;
+		command.voice = voice;
+		return push(command);
+	}
+
+	bool AudioMixer::setPosition(VoiceId voice, const glm::vec3& position)
+	{
+		Command command;
+		command.type = Command::SetPosition;
+		command.voice = voice;
+		command.params.position = position;
+		return push(command);
+	}
+
+	bool AudioMixer::setVolume(VoiceId voice, float volume)
+	{
+		Command command;
+		command.type = Command::SetVolume;
+		command.voice = voice;
+		command.params.volume = volume;
+		return push(command);
+	}
+
+	bool AudioMixer::setPitch(VoiceId voice, float pitch)
+	{
+		Command command;
+		command.type = Command::SetPitch;
+		command.voice = voice;
+		command.params.pitch = pitch;
+		return push(command);
+	}
+
+	bool AudioMixer::setListener(const glm::mat4& transform)
+	{
+		Command command;
+		command.type = Command::SetListener;
+		command.voice = invalidVoice;
+		command.listener = transform;
+		return push(command);
+	}
+
+	void AudioMixer::update()
+	{
+		VoiceId voice;
+		while(m_ended.pop(voice))
+			m_freeIds.push_back(voiceSlot(voice));
+	}
+
+	void AudioMixer::apply(const Command& command)
+	{
+		if(command.type == Command::SetListener)
+		{
+			m_listenerInverse = glm::inverse(command.listener);
+			return;
+		}
+		std::uint32_t const slot = voiceSlot(command.voice);
+		if(slot >= m_voiceCount)
+			return;
+
+		Voice& voice = m_voices[slot];
+		if(command.type == Command::Play)
+		{
+			voice.id = command.voice;
+			voice.sound = command.sound;
+			voice.params = command.params;
+			voice.cursor = 0;
+			voice.gainLeft = voice.gainRight = 0.0f;
+			voice.playing = true;
+			voice.started = false;
+			voice.real = false;
+			voice.fading = false;
+			m_playing.push_back(slot);
+			return;
+		}
+		// Commands for a voice that ended, or for an earlier voice in the same slot
+		if(!voice.playing || voice.id != command.voice)
+			return;
+
+		switch(command.type)
+		{
+		case Command::Stop:
+			// Swept at the start of the next mix
+			voice.playing = false;
+			break;
+		case Command::SetPosition:
+			voice.params.position = command.params.position;
+			break;
+		case Command::SetVolume:
+			voice.params.volume = command.params.volume;
+			break;
+		case Command::SetPitch:
+			voice.params.pitch = command.params.pitch;
+			break;
+		default:
+			break;
+		}
+	}
+
+	void AudioMixer::computeGains(Voice& voice) const
+	{
+		const VoiceParams& params = voice.params;
+		float pan = 0.0f;
+		float attenuation = 1.0f;
+		if(params.positional)
+		{
+			glm::vec3 const local(m_listenerInverse * glm::vec4(params.position, 1.0f));
+			float const distance = glm::length(local);
+			if(distance > params.minDistance)
+				attenuation = params.minDistance / distance;
+			float const fadeStart = params.maxDistance * 0.9f;
+			if(distance > fadeStart)
+				attenuation *= glm::clamp((params.maxDistance - distance) / (params.maxDistance - fadeStart), 0.0f, 1.0f);
+			if(distance > 1e-4f)
+				pan = local.x / distance;
+		}
+
+		// Equal power, a centered voice gets cos(pi / 4) on both sides
+		float const angle = (pan + 1.0f) * glm::quarter_pi<float>();
+		float const gain = std::max(params.volume, 0.0f) * attenuation;
+		voice.targetLeft = gain * std::cos(angle);
+		voice.targetRight = gain * std::sin(angle);
+		voice.audibility = gain;
+	}
+
+	bool AudioMixer::render(Voice& voice, std::size_t frameCount, bool mixed)
+	{
+		const SoundBuffer& sound = *voice.sound;
+		std::size_t const frames = sound.frameCount();
+		if(frames == 0)
+			return false;
+		std::uint64_t const end = static_cast<std::uint64_t>(frames) << 32;
+		double const rate = static_cast<double>(sound.sampleRate) / m_sampleRate * std::max(voice.params.pitch, 0.0f);
+		std::uint64_t const step = std::max<std::uint64_t>(static_cast<std::uint64_t>(rate * fixedOne), 1);
+		bool const loop = voice.params.loop;
+
+		if(!mixed)
+		{
+			voice.cursor += step * frameCount;
+			if(voice.cursor < end)
+				return true;
+			if(!loop)
+				return false;
+			voice.cursor %= end;
+			return true;
+		}
+
+		// A voice that came back from virtual ramps up from silence
+		float gainLeft = voice.gainLeft;
+		float gainRight = voice.gainRight;
+		float const stepLeft = (voice.targetLeft - gainLeft) / frameCount;
+		float const stepRight = (voice.targetRight - gainRight) / frameCount;
+		// Frames before this cursor have their next sample inside the buffer
+		std::uint64_t const lastPair = static_cast<std::uint64_t>(frames - 1) << 32;
+		const float* samples = sound.samples.data();
+
+		std::size_t done = 0;
+		while(done < frameCount)
+		{
+			if(voice.cursor >= end)
+			{
+				if(!loop)
+					return false;
+				voice.cursor %= end;
+			}
+
+			std::size_t run = 0;
+			if(voice.cursor < lastPair)
+				run = static_cast<std::size_t>(std::min<std::uint64_t>(frameCount - done, (lastPair - voice.cursor + step - 1) / step));
+			mixRun(samples, voice.cursor, step, &m_left[done], &m_right[done], run, gainLeft, gainRight, stepLeft, stepRight);
+			done += run;
+			if(done == frameCount)
+				break;
+			// Steps longer than a sample can jump past the last one, the loop or the end is handled above
+			if(voice.cursor >= end)
+				continue;
+
+			// The frame between the last sample and the start when looping, or silence at the end
+			std::size_t const index = static_cast<std::size_t>(voice.cursor >> 32);
+			float const t = static_cast<float>((voice.cursor & 0xFFFFFFFFu) / fixedOne);
+			float const next = loop ? samples[0] : 0.0f;
+			float const s = samples[index] + (next - samples[index]) * t;
+			m_left[done] += s * gainLeft;
+			m_right[done] += s * gainRight;
+			gainLeft += stepLeft;
+			gainRight += stepRight;
+			voice.cursor += step;
+			++done;
+		}
+
+		voice.gainLeft = voice.targetLeft;
+		voice.gainRight = voice.targetRight;
+		return loop || voice.cursor < end;
+	}
+
+	void AudioMixer::mix(float* out, std::size_t frameCount)
+	{
+		std::uint64_t commands = 0;
+		Command command;
+		while(m_commands.pop(command))
+		{
+			apply(command);
+			++commands;
+		}
+
+		// Voices stopped by a command
+		std::size_t kept = 0;
+		for(std::uint32_t slot : m_playing)
+		{
+			if(m_voices[slot].playing)
+				m_playing[kept++] = slot;
+			else
+				m_ended.push(m_voices[slot].id);
+		}
+		m_playing.resize(kept);
+
+		// Rank the audible voices, the loudest get the real slots
+		m_ranked.clear();
+		for(std::uint32_t slot : m_playing)
+		{
+			Voice& voice = m_voices[slot];
+			computeGains(voice);
+			voice.fading = voice.real;
+			voice.real = false;
+			if(voice.audibility >= audibleThreshold)
+				m_ranked.push_back(slot);
+		}
+		if(m_ranked.size() > m_maxRealVoices)
+		{
+			std::nth_element(m_ranked.begin(), m_ranked.begin() + m_maxRealVoices, m_ranked.end(), [this](std::uint32_t a, std::uint32_t b)
+			{
+				return m_voices[a].audibility > m_voices[b].audibility;
+			});
+			m_ranked.resize(m_maxRealVoices);
+		}
+		for(std::uint32_t slot : m_ranked)
+		{
+			m_voices[slot].real = true;
+			m_voices[slot].fading = false;
+		}
+
+		m_left.assign(frameCount, 0.0f);
+		m_right.assign(frameCount, 0.0f);
+		unsigned real = 0;
+		unsigned virtualCount = 0;
+		kept = 0;
+		for(std::uint32_t slot : m_playing)
+		{
+			Voice& voice = m_voices[slot];
+			if(!voice.started)
+			{
+				// Starting audible at full gain, the attack is part of the sound
+				voice.gainLeft = voice.targetLeft;
+				voice.gainRight = voice.targetRight;
+				voice.started = true;
+			}
+			if(voice.fading)
+			{
+				// Lost its real slot or went quiet, ramps down over this block before it goes virtual
+				voice.targetLeft = voice.targetRight = 0.0f;
+			}
+			bool const mixed = voice.real || voice.fading;
+			bool const alive = render(voice, frameCount, mixed);
+			if(mixed)
+				++real;
+			else
+				++virtualCount;
+			if(!voice.real)
+				voice.gainLeft = voice.gainRight = 0.0f;
+			if(alive)
+			{
+				m_playing[kept++] = slot;
+				continue;
+			}
+			voice.playing = false;
+			m_ended.push(voice.id);
+		}
+		m_playing.resize(kept);
+
+		std::size_t i = 0;
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+		for(; i + 4 <= frameCount; i += 4)
+		{
+			__m128 const l = _mm_loadu_ps(&m_left[i]);
+			__m128 const r = _mm_loadu_ps(&m_right[i]);
+			_mm_storeu_ps(out + i * 2, _mm_unpacklo_ps(l, r));
+			_mm_storeu_ps(out + i * 2 + 4, _mm_unpackhi_ps(l, r));
+		}
+#endif
+		for(; i < frameCount; ++i)
+		{
+			out[i * 2] = m_left[i];
+			out[i * 2 + 1] = m_right[i];
+		}
+
+		m_playingCount.store(static_cast<unsigned>(m_playing.size()), std::memory_order_relaxed);
+		m_realCount.store(real, std::memory_order_relaxed);
+		m_virtualCount.store(virtualCount, std::memory_order_relaxed);
+		m_commandCount.fetch_add(commands, std::memory_order_relaxed);
+		m_blockCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	AudioMixerStats AudioMixer::stats() const
+	{
+		AudioMixerStats stats;
+		stats.playingVoices = m_playingCount.load(std::memory_order_relaxed);
+		stats.realVoices = m_realCount.load(std::memory_order_relaxed);
+		stats.virtualVoices = m_virtualCount.load(std::memory_order_relaxed);
+		stats.commands = m_commandCount.load(std::memory_order_relaxed);
+		stats.blocks = m_blockCount.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	AudioDevice::AudioDevice(AudioMixer& mixer, AudioOutput& output, std::size_t blockFrames, bool realTime) :
+		m_mixer(mixer),
+		m_output(output),
+		m_blockFrames(blockFrames),
+		m_realTime(realTime),
+		m_stopping(false),
+		m_blocks(0)
+	{
+		m_thread = std::thread(&AudioDevice::main, this);
+	}
+
+	AudioDevice::~AudioDevice()
+	{
+		stop();
+	}
+
+	void AudioDevice::stop()
+	{
+		m_stopping.store(true, std::memory_order_release);
+		if(m_thread.joinable())
+			m_thread.join();
+	}
+
+	void AudioDevice::main()
+	{
+		std::vector<float> block(m_blockFrames * 2);
+		std::chrono::duration<double> const blockDuration(static_cast<double>(m_blockFrames) / m_mixer.sampleRate());
+		std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+		while(!m_stopping.load(std::memory_order_acquire))
+		{
+			m_mixer.mix(block.data(), m_blockFrames);
+			m_output.write(block.data(), m_blockFrames);
+			m_blocks.fetch_add(1, std::memory_order_relaxed);
+			if(m_realTime)
+			{
+				next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(blockDuration);
+				std::this_thread::sleep_until(next);
+			}
+		}
+	}
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "SpscQueue.h"
+
+#include <glm.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace engine
+{
+	class AudioOutput;
+
+	// Decoded mono PCM. Stereo sources are mixed down, 3D sounds are panned from a point anyway.
+	struct SoundBuffer
+	{
+		std::vector<float> samples;
+		unsigned sampleRate;
+
+		SoundBuffer() : sampleRate(0) {}
+
+		std::size_t frameCount() const { return samples.size(); }
+
+		static SoundBuffer fromPcm16(const std::int16_t* interleaved, std::size_t frameCount, unsigned channels, unsigned sampleRate);
+	};
+
+	// Slot of the voice in the low 16 bits and how often the slot was handed out above, so a handle kept after its
+	// voice ended doesn't reach the voice that took over the slot
+	typedef std::uint32_t VoiceId;
+	VoiceId const invalidVoice = 0xFFFFFFFFu;
+
+	struct VoiceParams
+	{
+		float volume;
+		float pitch;          // Playback rate, 2 is an octave up
+		bool loop;
+		bool positional;      // 3D voices are panned and attenuated from position, others play centered
+		glm::vec3 position;
+		float minDistance;    // Full volume up to here, then inversely proportional to the distance
+		float maxDistance;    // Fades to silence over the last tenth
+
+		VoiceParams() : volume(1.0f), pitch(1.0f), loop(false), positional(true), position(0.0f), minDistance(1.0f), maxDistance(50.0f) {}
+	};
+
+	struct AudioMixerStats
+	{
+		unsigned playingVoices;
+		unsigned realVoices;     // Mixed in the last block, including voices fading out after losing their slot
+		unsigned virtualVoices;  // Only advanced, too quiet or beyond maxRealVoices
+		std::uint64_t commands;
+		std::uint64_t blocks;
+	};
+
+	// Software mixer. The game thread only talks to it through lock-free queues: commands go in one, the ids of
+	// voices that ended come back through another. mix runs on the audio thread, usually inside an AudioDevice.
+	//
+	// Every block the audible voices are ranked by volume after attenuation and only the loudest maxRealVoices are
+	// resampled and mixed, the others keep their playback position so they resume in place when they get louder.
+	// Gains ramp across a block so moving sources and volume changes don't click, a voice losing its slot is mixed
+	// one more block ramping down to silence.
+	class AudioMixer
+	{
+	public:
+		// At most 65535 voices
+		AudioMixer(unsigned sampleRate = 48000, std::size_t maxVoices = 1024, std::size_t maxRealVoices = 64);
+
+		AudioMixer(const AudioMixer&) = delete;
+		AudioMixer& operator=(const AudioMixer&) = delete;
+
+		unsigned sampleRate() const { return m_sampleRate; }
+
+		// Game thread. sound must stay alive until the voice ends. Returns invalidVoice when every voice is in use or
+		// the command queue is full.
+		VoiceId play(const SoundBuffer& sound, const VoiceParams& params = VoiceParams());
+		// These return false when the command queue is full. Commands for voices that already ended are ignored.
+		bool stop(VoiceId voice);
+		bool setPosition(VoiceId voice, const glm::vec3& position);
+		bool setVolume(VoiceId voice, float volume);
+		bool setPitch(VoiceId voice, float pitch);
+		// World transform of the listener, -z forward and +x to the right like a camera
+		bool setListener(const glm::mat4& transform);
+		// Takes back the ids of the voices that ended, which play may then hand out again
+		void update();
+		std::size_t voicesInUse() const { return m_voiceCount - m_freeIds.size(); }
+
+		// Audio thread: applies the queued commands and mixes frameCount interleaved stereo frames into out
+		void mix(float* out, std::size_t frameCount);
+		// Read from any thread
+		AudioMixerStats stats() const;
+
+	private:
+		struct Command
+		{
+			enum Type : std::uint8_t
+			{
+				Play,
+				Stop,
+				SetPosition,
+				SetVolume,
+				SetPitch,
+				SetListener
+			};
+
+			Type type;
+			VoiceId voice;
+			const SoundBuffer* sound;
+			VoiceParams params;
+			glm::mat4 listener;
+		};
+
+		struct Voice
+		{
+			VoiceId id;
+			const SoundBuffer* sound;
+			VoiceParams params;
+			// Source frame in 32.32 fixed point
+			std::uint64_t cursor;
+			float gainLeft;
+			float gainRight;
+			float targetLeft;
+			float targetRight;
+			float audibility;
+			bool playing;
+			bool started;
+			bool real;
+			bool fading;
+		};
+
+		bool push(const Command& command);
+		void apply(const Command& command);
+		void computeGains(Voice& voice) const;
+		// Mixes or only advances the voice, returns false once it reached the end
+		bool render(Voice& voice, std::size_t frameCount, bool mixed);
+
+		unsigned m_sampleRate;
+		std::size_t m_voiceCount;
+		std::size_t m_maxRealVoices;
+
+		// Game thread
+		std::vector<std::uint32_t> m_freeIds;
+		std::vector<std::uint16_t> m_generations;
+
+		SpscQueue<Command> m_commands;
+		SpscQueue<VoiceId> m_ended;
+
+		// Audio thread, voices by slot
+		std::vector<Voice> m_voices;
+		std::vector<std::uint32_t> m_playing;
+		std::vector<std::uint32_t> m_ranked;
+		glm::mat4 m_listenerInverse;
+		std::vector<float> m_left;
+		std::vector<float> m_right;
+
+		std::atomic<unsigned> m_playingCount;
+		std::atomic<unsigned> m_realCount;
+		std::atomic<unsigned> m_virtualCount;
+		std::atomic<std::uint64_t> m_commandCount;
+		std::atomic<std::uint64_t> m_blockCount;
+	};
+
+	// Runs a mixer on its own thread, one block at a time into an output. Real time paces the thread at the
+	// sample rate like a sound card would, otherwise it mixes as fast as it can.
+	class AudioDevice
+	{
+	public:
+		AudioDevice(AudioMixer& mixer, AudioOutput& output, std::size_t blockFrames = 512, bool realTime = true);
+		~AudioDevice();
+
+		AudioDevice(const AudioDevice&) = delete;
+		AudioDevice& operator=(const AudioDevice&) = delete;
+
+		void stop();
+
+		std::uint64_t blocksWritten() const { return m_blocks.load(std::memory_order_relaxed); }
+
+	private:
+		void main();
+
+		AudioMixer& m_mixer;
+		AudioOutput& m_output;
+		std::size_t m_blockFrames;
+		bool m_realTime;
+		std::atomic<bool> m_stopping;
+		std::atomic<std::uint64_t> m_blocks;
+		std::thread m_thread;
+	};
+}
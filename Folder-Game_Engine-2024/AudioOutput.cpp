@@ -0,0 +1,96 @@
+#include "AudioOutput.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace engine
+{
+	namespace
+	{
+		std::size_t const wavHeaderSize = 44;
+		std::uint16_t const wavChannels = 2;
+		std::uint16_t const wavBitsPerSample = 16;
+		std::size_t const conversionFrames = 1024;
+	}
+
+	bool NullAudioOutput::write(const float*, std::size_t frameCount)
+	{
+		m_frames += frameCount;
+		return true;
+	}
+
+	WavAudioOutput::~WavAudioOutput()
+	{
+		close();
+	}
+
+	bool WavAudioOutput::writeHeader(std::uint32_t dataBytes)
+	{
+		std::uint16_t const format = 1;
+		std::uint16_t const blockAlign = wavChannels * wavBitsPerSample / 8;
+		std::uint32_t const byteRate = m_sampleRate * blockAlign;
+		std::uint32_t const formatSize = 16;
+		std::uint32_t const riffSize = static_cast<std::uint32_t>(wavHeaderSize - 8) + dataBytes;
+		std::uint32_t const sampleRate = m_sampleRate;
+
+		bool ok = std::fseek(m_file, 0, SEEK_SET) == 0;
+		ok = ok && std::fwrite("RIFF", 4, 1, m_file) == 1;
+		ok = ok && std::fwrite(&riffSize, sizeof(riffSize), 1, m_file) == 1;
+		ok = ok && std::fwrite("WAVEfmt ", 8, 1, m_file) == 1;
+		ok = ok && std::fwrite(&formatSize, sizeof(formatSize), 1, m_file) == 1;
+		ok = ok && std::fwrite(&format, sizeof(format), 1, m_file) == 1;
+		ok = ok && std::fwrite(&wavChannels, sizeof(wavChannels), 1, m_file) == 1;
+		ok = ok && std::fwrite(&sampleRate, sizeof(sampleRate), 1, m_file) == 1;
+		ok = ok && std::fwrite(&byteRate, sizeof(byteRate), 1, m_file) == 1;
+		ok = ok && std::fwrite(&blockAlign, sizeof(blockAlign), 1, m_file) == 1;
+		ok = ok && std::fwrite(&wavBitsPerSample, sizeof(wavBitsPerSample), 1, m_file) == 1;
+		ok = ok && std::fwrite("data", 4, 1, m_file) == 1;
+		ok = ok && std::fwrite(&dataBytes, sizeof(dataBytes), 1, m_file) == 1;
+		return ok;
+	}
+
+	bool WavAudioOutput::open(const std::string& path, unsigned sampleRate)
+	{
+		close();
+		m_file = std::fopen(path.c_str(), "wb");
+		if(!m_file)
+			return false;
+		m_sampleRate = sampleRate;
+		m_frames = 0;
+		m_ok = writeHeader(0);
+		return m_ok;
+	}
+
+	bool WavAudioOutput::close()
+	{
+		if(!m_file)
+			return m_ok;
+		std::uint64_t const dataBytes = m_frames * wavChannels * (wavBitsPerSample / 8);
+		m_ok = m_ok && dataBytes <= 0xFFFFFFFFu - wavHeaderSize && writeHeader(static_cast<std::uint32_t>(dataBytes));
+		m_ok = std::fclose(m_file) == 0 && m_ok;
+		m_file = nullptr;
+		return m_ok;
+	}
+
+	bool WavAudioOutput::write(const float* frames, std::size_t frameCount)
+	{
+		if(!m_file)
+			return false;
+
+		// Clipped and rounded a chunk at a time
+		std::int16_t converted[conversionFrames * wavChannels];
+		for(std::size_t done = 0; done < frameCount;)
+		{
+			std::size_t const count = std::min(conversionFrames, frameCount - done);
+			for(std::size_t i = 0; i < count * wavChannels; ++i)
+			{
+				float const sample = std::min(std::max(frames[done * wavChannels + i], -1.0f), 1.0f);
+				converted[i] = static_cast<std::int16_t>(std::lround(sample * 32767.0f));
+			}
+			m_ok = m_ok && std::fwrite(converted, sizeof(std::int16_t) * wavChannels, count, m_file) == count;
+			done += count;
+		}
+		m_frames += frameCount;
+		return m_ok;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace engine
+{
+	// Where mixed audio goes: blocks of interleaved stereo float frames in [-1, 1]. A platform device would block
+	// in write until it can take the block, the outputs below never do.
+	class AudioOutput
+	{
+	public:
+		virtual ~AudioOutput() {}
+
+		virtual bool write(const float* frames, std::size_t frameCount) = 0;
+	};
+
+	// Discards everything, for headless runs and benchmarks
+	class NullAudioOutput : public AudioOutput
+	{
+	public:
+		NullAudioOutput() : m_frames(0) {}
+
+		bool write(const float* frames, std::size_t frameCount) override;
+
+		std::uint64_t framesWritten() const { return m_frames; }
+
+	private:
+		std::uint64_t m_frames;
+	};
+
+	// 16-bit stereo PCM WAV file. The header's sizes are written by close.
+	class WavAudioOutput : public AudioOutput
+	{
+	public:
+		WavAudioOutput() : m_file(nullptr), m_sampleRate(0), m_frames(0), m_ok(false) {}
+		~WavAudioOutput();
+
+		WavAudioOutput(const WavAudioOutput&) = delete;
+		WavAudioOutput& operator=(const WavAudioOutput&) = delete;
+
+		bool open(const std::string& path, unsigned sampleRate);
+		// False if any write failed
+		bool close();
+
+		bool write(const float* frames, std::size_t frameCount) override;
+
+		std::uint64_t framesWritten() const { return m_frames; }
+
+	private:
+		bool writeHeader(std::uint32_t dataBytes);
+
+		std::FILE* m_file;
+		unsigned m_sampleRate;
+		std::uint64_t m_frames;
+		bool m_ok;
+	};
+}
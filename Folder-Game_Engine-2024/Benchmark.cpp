@@ -0,0 +1,50 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+namespace engine
+{
+	namespace
+	{
+		std::vector<std::pair<const char*, BenchmarkFunction> >& registry()
+		{
+			static std::vector<std::pair<const char*, BenchmarkFunction> > benchmarks;
+			return benchmarks;
+		}
+	}
+
+	void BenchmarkContext::report(const char* label, double value, const char* unit) const
+	{
+		std::printf("%s/%s: %.3f %s\n", m_name, label, value, unit);
+	}
+
+	BenchmarkRegistrar::BenchmarkRegistrar(const char* name, BenchmarkFunction function)
+	{
+		registry().push_back(std::make_pair(name, function));
+	}
+
+	int runBenchmarks(const std::string& filter, JobSystem& jobs)
+	{
+		std::vector<std::pair<const char*, BenchmarkFunction> > benchmarks = registry();
+		std::sort(benchmarks.begin(), benchmarks.end(), [](const std::pair<const char*, BenchmarkFunction>& a, const std::pair<const char*, BenchmarkFunction>& b)
+		{
+			return std::string(a.first) < std::string(b.first);
+		});
+
+		int count = 0;
+		for(const std::pair<const char*, BenchmarkFunction>& benchmark : benchmarks)
+		{
+			if(std::string(benchmark.first).find(filter) == std::string::npos)
+				continue;
+
+			BenchmarkContext context(benchmark.first, jobs);
+			benchmark.second(context);
+			std::fflush(stdout);
+			++count;
+		}
+		return count;
+	}
+}
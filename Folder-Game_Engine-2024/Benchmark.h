@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	class Stopwatch
+	{
+	public:
+		Stopwatch() : m_start(std::chrono::steady_clock::now()) {}
+
+		void restart() { m_start = std::chrono::steady_clock::now(); }
+
+		double elapsedMs() const
+		{
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+		}
+
+	private:
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	// Handed to every benchmark. Results are printed as "benchmark/label: value unit".
+	class BenchmarkContext
+	{
+	public:
+		BenchmarkContext(const char* name, JobSystem& jobs) : m_name(name), m_jobs(jobs) {}
+
+		JobSystem& jobs() const { return m_jobs; }
+
+		void report(const char* label, double value, const char* unit) const;
+
+	private:
+		const char* m_name;
+		JobSystem& m_jobs;
+	};
+
+	typedef void (*BenchmarkFunction)(BenchmarkContext& context);
+
+	// Benchmarks register themselves at static initialization and are run headless with --bench.
+	class BenchmarkRegistrar
+	{
+	public:
+		BenchmarkRegistrar(const char* name, BenchmarkFunction function);
+	};
+
+	// Runs every benchmark whose name contains filter, an empty filter runs them all. Returns the number run.
+	int runBenchmarks(const std::string& filter, JobSystem& jobs);
+}
+
+#define ENGINE_BENCHMARK(name) \
+	static void name(engine::BenchmarkContext& context); \
+	static engine::BenchmarkRegistrar name##Registrar(#name, &name); \
+	static void name(engine::BenchmarkContext& context)
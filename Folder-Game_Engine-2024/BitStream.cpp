@@ -0,0 +1,137 @@
+#include "BitStream.h"
+
+#include <cmath>
+
+namespace engine
+{
+	namespace
+	{
+		float const smallestThreeRange = 0.70710678f;
+
+		std::uint32_t quantize(float value, float min, float max, int bits)
+		{
+			std::uint32_t const steps = (1u << bits) - 1;
+			float const unit = glm::clamp((value - min) / (max - min), 0.0f, 1.0f);
+			return static_cast<std::uint32_t>(unit * static_cast<float>(steps) + 0.5f);
+		}
+
+		float dequantize(std::uint32_t value, float min, float max, int bits)
+		{
+			std::uint32_t const steps = (1u << bits) - 1;
+			return min + (max - min) * (static_cast<float>(value) / static_cast<float>(steps));
+		}
+	}
+
+	void BitWriter::write(std::uint32_t value, int bits)
+	{
+		std::uint64_t const mask = (std::uint64_t(1) << bits) - 1;
+		m_scratch |= (value & mask) << m_scratchBits;
+		m_scratchBits += bits;
+		while(m_scratchBits >= 8)
+		{
+			m_bytes.push_back(static_cast<unsigned char>(m_scratch));
+			m_scratch >>= 8;
+			m_scratchBits -= 8;
+		}
+	}
+
+	void BitWriter::writeFloat(float value, float min, float max, int bits)
+	{
+		write(quantize(value, min, max, bits), bits);
+	}
+
+	void BitWriter::writeVec3(const glm::vec3& value, const glm::vec3& min, const glm::vec3& max, int bits)
+	{
+		for(int axis = 0; axis < 3; ++axis)
+			writeFloat(value[axis], min[axis], max[axis], bits);
+	}
+
+	void BitWriter::writeQuaternion(const glm::quat& value, int bits)
+	{
+		float const components[4] = { value.x, value.y, value.z, value.w };
+		int largest = 0;
+		for(int i = 1; i < 4; ++i)
+		{
+			if(std::fabs(components[i]) > std::fabs(components[largest]))
+				largest = i;
+		}
+		float const sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+		write(static_cast<std::uint32_t>(largest), 2);
+		for(int i = 0; i < 4; ++i)
+		{
+			if(i != largest)
+				writeFloat(components[i] * sign, -smallestThreeRange, smallestThreeRange, bits);
+		}
+	}
+
+	void BitWriter::flush()
+	{
+		if(m_scratchBits > 0)
+			m_bytes.push_back(static_cast<unsigned char>(m_scratch));
+		m_scratch = 0;
+		m_scratchBits = 0;
+	}
+
+	void BitWriter::clear()
+	{
+		m_bytes.clear();
+		m_scratch = 0;
+		m_scratchBits = 0;
+	}
+
+	std::uint32_t BitReader::read(int bits)
+	{
+		if(m_overflowed || m_size * 8 - m_bitOffset < static_cast<std::size_t>(bits))
+		{
+			m_overflowed = true;
+			return 0;
+		}
+
+		// At most 5 bytes hold 32 bits at any bit offset
+		std::uint64_t value = 0;
+		std::size_t const first = m_bitOffset >> 3;
+		std::size_t const last = (m_bitOffset + bits - 1) >> 3;
+		for(std::size_t i = first; i <= last; ++i)
+			value |= static_cast<std::uint64_t>(m_bytes[i]) << ((i - first) * 8);
+		value >>= m_bitOffset & 7;
+		m_bitOffset += bits;
+		return static_cast<std::uint32_t>(value & ((std::uint64_t(1) << bits) - 1));
+	}
+
+	float BitReader::readFloat(float min, float max, int bits)
+	{
+		return dequantize(read(bits), min, max, bits);
+	}
+
+	glm::vec3 BitReader::readVec3(const glm::vec3& min, const glm::vec3& max, int bits)
+	{
+		glm::vec3 value;
+		for(int axis = 0; axis < 3; ++axis)
+			value[axis] = readFloat(min[axis], max[axis], bits);
+		return value;
+	}
+
+	glm::quat BitReader::readQuaternion(int bits)
+	{
+		int const largest = static_cast<int>(read(2));
+		float components[4];
+		float sum = 0.0f;
+		for(int i = 0; i < 4; ++i)
+		{
+			if(i == largest)
+				continue;
+			components[i] = readFloat(-smallestThreeRange, smallestThreeRange, bits);
+			sum += components[i] * components[i];
+		}
+		components[largest] = std::sqrt(glm::max(0.0f, 1.0f - sum));
+		return glm::normalize(glm::quat(components[3], components[0], components[1], components[2]));
+	}
+
+	int bitsFor(std::uint32_t count)
+	{
+		int bits = 1;
+		while(bits < 32 && (std::uint64_t(1) << bits) < count)
+			++bits;
+		return bits;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm.hpp>
+#include <gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	// Packs values of any bit width back to back, least significant bit first, for network packets.
+	class BitWriter
+	{
+	public:
+		BitWriter() : m_scratch(0), m_scratchBits(0) {}
+
+		// Appends the low bits of value, bits in [1, 32]
+		void write(std::uint32_t value, int bits);
+		void writeBool(bool value) { write(value ? 1u : 0u, 1); }
+
+		// Quantized to steps of (max - min) / (2^bits - 1) with bits in [1, 24], values outside are clamped
+		void writeFloat(float value, float min, float max, int bits);
+		void writeVec3(const glm::vec3& value, const glm::vec3& min, const glm::vec3& max, int bits);
+
+		// Smallest three: the index of the largest component in 2 bits, then the three others in bits each. The
+		// largest is rebuilt from the unit length and made positive, since q and -q are the same rotation, so the
+		// others lie in [-1/sqrt(2), 1/sqrt(2)].
+		void writeQuaternion(const glm::quat& value, int bits);
+
+		// Writes the partial last byte, more bits may not be written after
+		void flush();
+		void clear();
+
+		std::size_t bitCount() const { return m_bytes.size() * 8 + m_scratchBits; }
+		// Complete once flush was called
+		const std::vector<unsigned char>& bytes() const { return m_bytes; }
+
+	private:
+		std::vector<unsigned char> m_bytes;
+		std::uint64_t m_scratch;
+		int m_scratchBits;
+	};
+
+	// Reads what BitWriter wrote. Reading past the end returns zeros and sets overflowed, so a packet can be parsed
+	// completely and rejected once.
+	class BitReader
+	{
+	public:
+		BitReader(const unsigned char* bytes, std::size_t size) : m_bytes(bytes), m_size(size), m_bitOffset(0), m_overflowed(false) {}
+
+		std::uint32_t read(int bits);
+		bool readBool() { return read(1) != 0; }
+		float readFloat(float min, float max, int bits);
+		glm::vec3 readVec3(const glm::vec3& min, const glm::vec3& max, int bits);
+		glm::quat readQuaternion(int bits);
+
+		bool overflowed() const { return m_overflowed; }
+		std::size_t bitsLeft() const { return m_overflowed ? 0 : m_size * 8 - m_bitOffset; }
+
+	private:
+		const unsigned char* m_bytes;
+		std::size_t m_size;
+		std::size_t m_bitOffset;
+		bool m_overflowed;
+	};
+
+	// Bits needed to store values in [0, count - 1]
+	int bitsFor(std::uint32_t count);
+}
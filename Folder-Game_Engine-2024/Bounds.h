@@ -0,0 +1,108 @@
+#pragma once
+
+#include <glm.hpp>
+
+namespace engine
+{
+	struct Aabb
+	{
+		glm::vec3 min;
+		glm::vec3 max;
+
+		Aabb() : min(0.0f), max(0.0f) {}
+		Aabb(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
+
+		static Aabb fromCenterExtent(const glm::vec3& center, const glm::vec3& extent) { return Aabb(center - extent, center + extent); }
+
+		glm::vec3 center() const { return (min + max) * 0.5f; }
+		glm::vec3 extent() const { return (max - min) * 0.5f; }
+	};
+
+	enum class Containment
+	{
+		Outside,
+		Intersecting,
+		Inside
+	};
+
+	// Six normalized planes pointing inwards, extracted from a projection * view matrix.
+	struct Frustum
+	{
+		enum Plane { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+		glm::vec4 planes[PlaneCount];
+
+		// Assumes the OpenGL clip volume, -w <= z <= w
+		static Frustum fromMatrix(const glm::mat4& viewProjection)
+		{
+			glm::vec4 const row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+			glm::vec4 const row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+			glm::vec4 const row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+			glm::vec4 const row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+			Frustum frustum;
+			frustum.planes[Left] = row3 + row0;
+			frustum.planes[Right] = row3 - row0;
+			frustum.planes[Bottom] = row3 + row1;
+			frustum.planes[Top] = row3 - row1;
+			frustum.planes[Near] = row3 + row2;
+			frustum.planes[Far] = row3 - row2;
+			for(glm::vec4& plane : frustum.planes)
+				plane /= glm::length(glm::vec3(plane));
+			return frustum;
+		}
+	};
+
+	inline bool intersects(const Aabb& a, const Aabb& b)
+	{
+		return glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::lessThanEqual(b.min, a.max));
+	}
+
+	inline bool contains(const Aabb& outer, const Aabb& inner)
+	{
+		return glm::all(glm::lessThanEqual(outer.min, inner.min)) && glm::all(glm::lessThanEqual(inner.max, outer.max));
+	}
+
+	inline float distance2(const Aabb& box, const glm::vec3& point)
+	{
+		glm::vec3 const delta = point - glm::clamp(point, box.min, box.max);
+		return glm::dot(delta, delta);
+	}
+
+	inline bool intersectsSphere(const Aabb& box, const glm::vec3& center, float radius)
+	{
+		return distance2(box, center) <= radius * radius;
+	}
+
+	// Slab test. inverseDirection is 1 / direction so the divisions are shared by all the boxes tested against one ray.
+	// On a hit, entry is the distance along the ray where it enters the box, 0 if the origin is inside.
+	inline bool intersectRay(const Aabb& box, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& entry)
+	{
+		glm::vec3 const t0 = (box.min - origin) * inverseDirection;
+		glm::vec3 const t1 = (box.max - origin) * inverseDirection;
+		glm::vec3 const tNear = glm::min(t0, t1);
+		glm::vec3 const tFar = glm::max(t0, t1);
+		float const enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+		float const exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+		entry = enter;
+		return enter <= exit;
+	}
+
+	inline Containment classify(const Frustum& frustum, const Aabb& box)
+	{
+		glm::vec3 const center = box.center();
+		glm::vec3 const extent = box.extent();
+		Containment result = Containment::Inside;
+		for(const glm::vec4& plane : frustum.planes)
+		{
+			glm::vec3 const normal(plane);
+			float const distance = glm::dot(normal, center) + plane.w;
+			float const radius = glm::dot(glm::abs(normal), extent);
+			if(distance + radius < 0.0f)
+				return Containment::Outside;
+			if(distance - radius < 0.0f)
+				result = Containment::Intersecting;
+		}
+		return result;
+	}
+}
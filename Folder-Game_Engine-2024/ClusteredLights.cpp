@@ -0,0 +1,216 @@
+#include "ClusteredLights.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace engine
+{
+	glm::vec4 boundingSphere(const SpotLight& light)
+	{
+		// Narrow cones are enclosed by the sphere through the apex and the rim of the cap, wide ones by the sphere
+		// centered on the rim's disk. Past a half angle of 90 degrees the light covers the sphere of its range.
+		float const halfPi = 1.57079632679f;
+		if(light.angle >= halfPi)
+			return glm::vec4(light.position, light.range);
+		float const cosAngle = std::cos(light.angle);
+		if(light.angle <= halfPi * 0.5f)
+		{
+			float const radius = light.range / (2.0f * cosAngle);
+			return glm::vec4(light.position + light.direction * radius, radius);
+		}
+		return glm::vec4(light.position + light.direction * (cosAngle * light.range), std::sin(light.angle) * light.range);
+	}
+
+	ClusteredLights::ClusteredLights(unsigned tilesX, unsigned tilesY, unsigned slices) :
+		m_tilesX(tilesX),
+		m_tilesY(tilesY),
+		m_slices(slices),
+		m_fovY(0.0f),
+		m_aspect(0.0f),
+		m_near(0.0f),
+		m_far(0.0f),
+		m_sliceScale(0.0f),
+		m_sliceBias(0.0f),
+		m_sliceLights(slices),
+		m_sliceIndices(slices),
+		m_sliceCounts(slices)
+	{
+	}
+
+	void ClusteredLights::setPerspective(float fovY, float aspect, float nearPlane, float farPlane)
+	{
+		if(fovY == m_fovY && aspect == m_aspect && nearPlane == m_near && farPlane == m_far)
+			return;
+
+		m_fovY = fovY;
+		m_aspect = aspect;
+		m_near = nearPlane;
+		m_far = farPlane;
+		m_sliceScale = static_cast<float>(m_slices) / std::log(farPlane / nearPlane);
+		m_sliceBias = -std::log(nearPlane) * m_sliceScale;
+		buildClusterBounds();
+	}
+
+	bool ClusteredLights::setProjection(const glm::mat4& projection)
+	{
+		// glm::perspective stores -1 in [2][3] and 0 in [3][3], with the depth range in [2][2] and [3][2]
+		if(projection[2][3] != -1.0f || projection[3][3] != 0.0f)
+			return false;
+
+		float const a = projection[2][2];
+		float const b = projection[3][2];
+#if GLM_CONFIG_CLIP_CONTROL & GLM_CLIP_CONTROL_ZO_BIT
+		float const nearPlane = b / a;
+		float const farPlane = b / (a + 1.0f);
+#else
+		float const nearPlane = b / (a - 1.0f);
+		float const farPlane = b / (a + 1.0f);
+#endif
+		float const fovY = 2.0f * std::atan(1.0f / projection[1][1]);
+		setPerspective(fovY, projection[1][1] / projection[0][0], nearPlane, farPlane);
+		return true;
+	}
+
+	unsigned ClusteredLights::sliceOf(float depth) const
+	{
+		float const slice = std::log(std::max(depth, m_near)) * m_sliceScale + m_sliceBias;
+		return std::min(static_cast<unsigned>(std::max(slice, 0.0f)), m_slices - 1);
+	}
+
+	void ClusteredLights::buildClusterBounds()
+	{
+		// A tile of the screen at view depth d spans ndc * d * tan(fovY / 2) * (aspect, 1), the cluster box encloses
+		// the tile's four edges between the near and far depth of its slice
+		float const tanY = std::tan(m_fovY * 0.5f);
+		glm::vec2 const scale(tanY * m_aspect, tanY);
+		m_clusterBounds.resize(static_cast<std::size_t>(m_tilesX) * m_tilesY * m_slices);
+		for(unsigned slice = 0; slice < m_slices; ++slice)
+		{
+			float const nearDepth = m_near * std::pow(m_far / m_near, static_cast<float>(slice) / m_slices);
+			float const farDepth = m_near * std::pow(m_far / m_near, static_cast<float>(slice + 1) / m_slices);
+			for(unsigned y = 0; y < m_tilesY; ++y)
+			for(unsigned x = 0; x < m_tilesX; ++x)
+			{
+				glm::vec2 const ndcMin(-1.0f + 2.0f * x / m_tilesX, -1.0f + 2.0f * y / m_tilesY);
+				glm::vec2 const ndcMax(-1.0f + 2.0f * (x + 1) / m_tilesX, -1.0f + 2.0f * (y + 1) / m_tilesY);
+				glm::vec2 const nearMin = ndcMin * scale * nearDepth;
+				glm::vec2 const nearMax = ndcMax * scale * nearDepth;
+				glm::vec2 const farMin = ndcMin * scale * farDepth;
+				glm::vec2 const farMax = ndcMax * scale * farDepth;
+				m_clusterBounds[clusterIndex(x, y, slice)] = Aabb(
+					glm::vec3(glm::min(nearMin, farMin), -farDepth),
+					glm::vec3(glm::max(nearMax, farMax), -nearDepth));
+			}
+		}
+	}
+
+	void ClusteredLights::assignSlice(unsigned slice, std::vector<std::uint32_t>& indices, std::vector<std::uint32_t>& counts) const
+	{
+		// Candidates as structure of arrays padded to a multiple of 4 with spheres that never pass
+		std::vector<std::uint32_t> const& lights = m_sliceLights[slice];
+		std::size_t const padded = (lights.size() + 3) & ~static_cast<std::size_t>(3);
+		std::vector<float> x(padded, 0.0f), y(padded, 0.0f), z(padded, 0.0f), radius2(padded, -1.0f);
+		for(std::size_t i = 0; i < lights.size(); ++i)
+		{
+			glm::vec4 const& sphere = m_viewSpheres[lights[i]];
+			x[i] = sphere.x;
+			y[i] = sphere.y;
+			z[i] = sphere.z;
+			radius2[i] = sphere.w * sphere.w;
+		}
+
+		std::size_t const tileCount = static_cast<std::size_t>(m_tilesX) * m_tilesY;
+		counts.assign(tileCount, 0);
+		indices.clear();
+		for(std::size_t tile = 0; tile < tileCount; ++tile)
+		{
+			Aabb const& box = m_clusterBounds[tile + tileCount * slice];
+			std::size_t const before = indices.size();
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			// Squared distance from each sphere center to the box, one of min - c and c - max is negative inside the slab
+			__m128 const zero = _mm_setzero_ps();
+			__m128 const minX = _mm_set1_ps(box.min.x), maxX = _mm_set1_ps(box.max.x);
+			__m128 const minY = _mm_set1_ps(box.min.y), maxY = _mm_set1_ps(box.max.y);
+			__m128 const minZ = _mm_set1_ps(box.min.z), maxZ = _mm_set1_ps(box.max.z);
+			for(std::size_t i = 0; i < padded; i += 4)
+			{
+				__m128 const cx = _mm_loadu_ps(&x[i]);
+				__m128 const cy = _mm_loadu_ps(&y[i]);
+				__m128 const cz = _mm_loadu_ps(&z[i]);
+				__m128 const dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minX, cx), _mm_sub_ps(cx, maxX)), zero);
+				__m128 const dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minY, cy), _mm_sub_ps(cy, maxY)), zero);
+				__m128 const dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minZ, cz), _mm_sub_ps(cz, maxZ)), zero);
+				__m128 const distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+				int mask = _mm_movemask_ps(_mm_cmple_ps(distance2, _mm_loadu_ps(&radius2[i])));
+				for(std::size_t lane = i; mask != 0; mask >>= 1, ++lane)
+				{
+					if(mask & 1)
+						indices.push_back(lights[lane]);
+				}
+			}
+#else
+			for(std::size_t i = 0; i < lights.size(); ++i)
+			{
+				glm::vec3 const center(x[i], y[i], z[i]);
+				glm::vec3 const delta = glm::max(glm::max(box.min - center, center - box.max), glm::vec3(0.0f));
+				if(glm::dot(delta, delta) <= radius2[i])
+					indices.push_back(lights[i]);
+			}
+#endif
+			counts[tile] = static_cast<std::uint32_t>(indices.size() - before);
+		}
+	}
+
+	void ClusteredLights::binSphere(std::uint32_t light, const glm::vec3& center, float radius, const glm::mat4& view)
+	{
+		glm::vec3 const viewCenter = glm::vec3(view * glm::vec4(center, 1.0f));
+		m_viewSpheres[light] = glm::vec4(viewCenter, radius);
+
+		// Bin the light by the slices its depth range overlaps, so each slice only tests its own candidates
+		float const nearDepth = -viewCenter.z - radius;
+		float const farDepth = -viewCenter.z + radius;
+		if(farDepth < m_near || nearDepth > m_far)
+			return;
+		unsigned const last = sliceOf(farDepth);
+		for(unsigned slice = sliceOf(nearDepth); slice <= last; ++slice)
+			m_sliceLights[slice].push_back(light);
+	}
+
+	void ClusteredLights::assign(const PointLight* pointLights, std::size_t pointCount, const SpotLight* spotLights, std::size_t spotCount,
+		const glm::mat4& view, JobSystem* jobs)
+	{
+		m_viewSpheres.resize(pointCount + spotCount);
+		for(std::vector<std::uint32_t>& sliceLights : m_sliceLights)
+			sliceLights.clear();
+
+		for(std::size_t i = 0; i < pointCount; ++i)
+			binSphere(static_cast<std::uint32_t>(i), pointLights[i].position, pointLights[i].radius, view);
+		for(std::size_t i = 0; i < spotCount; ++i)
+		{
+			glm::vec4 const sphere = boundingSphere(spotLights[i]);
+			binSphere(static_cast<std::uint32_t>(pointCount + i), glm::vec3(sphere), sphere.w, view);
+		}
+
+		parallelFor(jobs, m_slices, 1, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t slice = begin; slice < end; ++slice)
+				assignSlice(static_cast<unsigned>(slice), m_sliceIndices[slice], m_sliceCounts[slice]);
+		});
+
+		// Slices are stored one after the other, in the same order as the clusters
+		std::size_t const tileCount = static_cast<std::size_t>(m_tilesX) * m_tilesY;
+		m_clusterRanges.resize(m_clusterBounds.size());
+		m_lightIndices.clear();
+		for(unsigned slice = 0; slice < m_slices; ++slice)
+		{
+			std::uint32_t offset = static_cast<std::uint32_t>(m_lightIndices.size());
+			for(std::size_t tile = 0; tile < tileCount; ++tile)
+			{
+				m_clusterRanges[tile + tileCount * slice] = glm::uvec2(offset, m_sliceCounts[slice][tile]);
+				offset += m_sliceCounts[slice][tile];
+			}
+			m_lightIndices.insert(m_lightIndices.end(), m_sliceIndices[slice].begin(), m_sliceIndices[slice].end());
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Bounds.h"
+#include "FramePacket.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	// World space sphere (center, radius) enclosing a spot light's cone, capped by the sphere of its range
+	glm::vec4 boundingSphere(const SpotLight& light);
+
+	// Assigns lights to the froxels of a perspective camera: the screen is split in tiles and the view depth in slices
+	// spaced exponentially between the near and far planes. The result is a compact list of light indices per cluster,
+	// laid out to be uploaded as two texture buffers.
+	//
+	// Lights are tested as spheres: point lights as the sphere of their radius, spot lights as the smallest sphere
+	// enclosing their cone.
+	class ClusteredLights
+	{
+	public:
+		ClusteredLights(unsigned tilesX = 16, unsigned tilesY = 9, unsigned slices = 24);
+
+		// Same parameters as glm::perspective, the cluster bounds are only rebuilt when they change
+		void setPerspective(float fovY, float aspect, float nearPlane, float farPlane);
+
+		// Reads the parameters back from a glm::perspective matrix, returns false if it isn't one
+		bool setProjection(const glm::mat4& projection);
+
+		void assign(const PointLight* lights, std::size_t count, const glm::mat4& view, JobSystem* jobs = nullptr)
+		{
+			assign(lights, count, nullptr, 0, view, jobs);
+		}
+
+		// Spot lights are indexed after the point lights, spot light i as pointCount + i
+		void assign(const PointLight* pointLights, std::size_t pointCount, const SpotLight* spotLights, std::size_t spotCount,
+			const glm::mat4& view, JobSystem* jobs = nullptr);
+
+		unsigned tilesX() const { return m_tilesX; }
+		unsigned tilesY() const { return m_tilesY; }
+		unsigned slices() const { return m_slices; }
+		std::size_t clusterCount() const { return m_clusterBounds.size(); }
+		std::size_t clusterIndex(unsigned x, unsigned y, unsigned slice) const { return x + m_tilesX * (y + m_tilesY * slice); }
+
+		// Slice holding a point at distance depth in front of the camera, the shader does the same computation
+		unsigned sliceOf(float depth) const;
+
+		// View space bounds of a cluster
+		const Aabb& clusterBounds(std::size_t cluster) const { return m_clusterBounds[cluster]; }
+
+		// Per cluster, offset and count in lightIndices(). Indices refer to the lights given to assign().
+		const std::vector<glm::uvec2>& clusterRanges() const { return m_clusterRanges; }
+		const std::vector<std::uint32_t>& lightIndices() const { return m_lightIndices; }
+
+	private:
+		void buildClusterBounds();
+		void binSphere(std::uint32_t light, const glm::vec3& center, float radius, const glm::mat4& view);
+		void assignSlice(unsigned slice, std::vector<std::uint32_t>& indices, std::vector<std::uint32_t>& counts) const;
+
+		unsigned m_tilesX;
+		unsigned m_tilesY;
+		unsigned m_slices;
+		float m_fovY;
+		float m_aspect;
+		float m_near;
+		float m_far;
+		float m_sliceScale;
+		float m_sliceBias;
+
+		std::vector<Aabb> m_clusterBounds;
+		std::vector<glm::uvec2> m_clusterRanges;
+		std::vector<std::uint32_t> m_lightIndices;
+
+		// View space spheres, and the lights overlapping each slice
+		std::vector<glm::vec4> m_viewSpheres;
+		std::vector<std::vector<std::uint32_t> > m_sliceLights;
+		std::vector<std::vector<std::uint32_t> > m_sliceIndices;
+		std::vector<std::vector<std::uint32_t> > m_sliceCounts;
+	};
+}
@@ -0,0 +1,104 @@
+#include "Benchmark.h"
+#include "ClusteredLights.h"
+
+#include <gtc/matrix_transform.hpp>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	std::size_t const pointLightCount = 750;
+	std::size_t const spotLightCount = 250;
+	int const repeats = 50;
+
+	std::vector<engine::PointLight> randomLights(std::size_t count)
+	{
+		std::mt19937 random(23);
+		std::uniform_real_distribution<float> lateral(-150.0f, 150.0f);
+		std::uniform_real_distribution<float> height(0.0f, 20.0f);
+		std::uniform_real_distribution<float> depth(-300.0f, 0.0f);
+		std::uniform_real_distribution<float> radius(2.0f, 15.0f);
+		std::vector<engine::PointLight> lights(count);
+		for(engine::PointLight& light : lights)
+		{
+			light.position = glm::vec3(lateral(random), height(random), depth(random));
+			light.radius = radius(random);
+			light.color = glm::vec3(1.0f);
+			light.intensity = 1.0f;
+		}
+		return lights;
+	}
+
+	std::vector<engine::SpotLight> randomSpotLights(std::size_t count)
+	{
+		std::mt19937 random(29);
+		std::uniform_real_distribution<float> lateral(-150.0f, 150.0f);
+		std::uniform_real_distribution<float> height(0.0f, 20.0f);
+		std::uniform_real_distribution<float> depth(-300.0f, 0.0f);
+		std::uniform_real_distribution<float> range(5.0f, 25.0f);
+		std::uniform_real_distribution<float> angle(glm::radians(10.0f), glm::radians(70.0f));
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::vector<engine::SpotLight> lights(count);
+		for(engine::SpotLight& light : lights)
+		{
+			light.position = glm::vec3(lateral(random), height(random), depth(random));
+			light.range = range(random);
+			light.direction = glm::normalize(glm::vec3(unit(random), -1.0f, unit(random)));
+			light.angle = angle(random);
+			light.color = glm::vec3(1.0f);
+			light.intensity = 1.0f;
+		}
+		return lights;
+	}
+}
+
+ENGINE_BENCHMARK(ClusteredLights)
+{
+	std::vector<engine::PointLight> const lights = randomLights(pointLightCount);
+	std::vector<engine::SpotLight> const spotLights = randomSpotLights(spotLightCount);
+	glm::mat4 const projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+	glm::mat4 const view = glm::lookAt(glm::vec3(0.0f, 10.0f, 20.0f), glm::vec3(0.0f, 5.0f, -100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	engine::ClusteredLights clusters(16, 9, 24);
+	clusters.setProjection(projection);
+
+	// What clustering replaces on the CPU side: every light against every cluster
+	engine::Stopwatch timer;
+	std::size_t bruteForcePairs = 0;
+	for(std::size_t cluster = 0; cluster < clusters.clusterCount(); ++cluster)
+	{
+		for(const engine::PointLight& light : lights)
+		{
+			glm::vec3 const center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+			if(engine::intersectsSphere(clusters.clusterBounds(cluster), center, light.radius))
+				++bruteForcePairs;
+		}
+		for(const engine::SpotLight& light : spotLights)
+		{
+			glm::vec4 const sphere = engine::boundingSphere(light);
+			glm::vec3 const center = glm::vec3(view * glm::vec4(glm::vec3(sphere), 1.0f));
+			if(engine::intersectsSphere(clusters.clusterBounds(cluster), center, sphere.w))
+				++bruteForcePairs;
+		}
+	}
+	context.report("brute force", timer.elapsedMs(), "ms");
+
+	timer.restart();
+	for(int i = 0; i < repeats; ++i)
+		clusters.assign(lights.data(), lights.size(), spotLights.data(), spotLights.size(), view);
+	context.report("assign", timer.elapsedMs() / repeats, "ms");
+
+	timer.restart();
+	for(int i = 0; i < repeats; ++i)
+		clusters.assign(lights.data(), lights.size(), spotLights.data(), spotLights.size(), view, &context.jobs());
+	context.report("assign parallel", timer.elapsedMs() / repeats, "ms");
+
+	std::size_t occupied = 0;
+	for(const glm::uvec2& range : clusters.clusterRanges())
+		occupied += range.y > 0 ? 1 : 0;
+	context.report("light indices", static_cast<double>(clusters.lightIndices().size()), "");
+	context.report("occupied clusters", static_cast<double>(occupied), "");
+	if(bruteForcePairs != clusters.lightIndices().size())
+		context.report("MISMATCH brute force pairs", static_cast<double>(bruteForcePairs), "");
+}
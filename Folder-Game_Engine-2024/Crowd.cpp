@@ -0,0 +1,402 @@
+#include "Crowd.h"
+#include "Determinism.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace engine
+{
+	namespace
+	{
+		std::size_t const groupGrain = 32;
+		// Neighbor fields in a block: x, z relative to the agent, velocity x, z, combined radius. Each field holds four
+		// lanes, one per agent of the group.
+		int const fieldCount = 5;
+		// Padding neighbors sit far enough that any collision with them is beyond every time horizon
+		float const farAway = 1.0e4f;
+		float const minTime = 1.0e-3f;
+
+		// Candidate directions relative to the preferred one, at full and half speed
+		float const candidateAngles[] = { 0.0f, 20.0f, -20.0f, 40.0f, -40.0f, 65.0f, -65.0f, 90.0f, -90.0f, 130.0f, -130.0f, 180.0f };
+		float const candidateSpeeds[] = { 1.0f, 0.5f };
+		std::size_t const angleCount = sizeof(candidateAngles) / sizeof(candidateAngles[0]);
+		std::size_t const speedCount = sizeof(candidateSpeeds) / sizeof(candidateSpeeds[0]);
+		// The preferred and current velocity and standing still come first
+		std::size_t const fixedCandidates = 3;
+		std::size_t const candidateCount = fixedCandidates + angleCount * speedCount;
+
+		struct CandidateTable
+		{
+			float cosine[angleCount * speedCount];
+			float sine[angleCount * speedCount];
+
+			CandidateTable()
+			{
+				for(std::size_t s = 0; s < speedCount; ++s)
+				{
+					for(std::size_t a = 0; a < angleCount; ++a)
+					{
+						float const angle = glm::radians(candidateAngles[a]);
+						cosine[s * angleCount + a] = candidateSpeeds[s] * std::cos(angle);
+						sine[s * angleCount + a] = candidateSpeeds[s] * std::sin(angle);
+					}
+				}
+			}
+		};
+
+		CandidateTable const candidateTable;
+
+		// Everything a group of four agents needs besides its neighbors
+		struct Lanes
+		{
+			alignas(16) float vx[4];
+			alignas(16) float vz[4];
+			alignas(16) float preferredX[4];
+			alignas(16) float preferredZ[4];
+			alignas(16) float directionX[4];
+			alignas(16) float directionZ[4];
+			alignas(16) float maxSpeed[4];
+		};
+	}
+
+	Crowd::Crowd(const CrowdSettings& settings) :
+		m_settings(settings),
+		m_grid(std::max(settings.neighborRadius, 0.1f))
+	{
+	}
+
+	std::uint32_t Crowd::addAgent(const glm::vec3& position, const CrowdAgentParams& params)
+	{
+		m_x.push_back(position.x);
+		m_y.push_back(position.y);
+		m_z.push_back(position.z);
+		m_vx.push_back(0.0f);
+		m_vz.push_back(0.0f);
+		m_targetX.push_back(position.x);
+		m_targetZ.push_back(position.z);
+		m_radius.push_back(params.radius);
+		m_maxSpeed.push_back(params.maxSpeed);
+		m_slowingDistance.push_back(std::max(params.slowingDistance, 1e-3f));
+		return static_cast<std::uint32_t>(m_x.size() - 1);
+	}
+
+	void Crowd::setTarget(std::uint32_t agent, const glm::vec3& target)
+	{
+		m_targetX[agent] = target.x;
+		m_targetZ[agent] = target.z;
+	}
+
+	void Crowd::clear()
+	{
+		for(std::vector<float>* values : { &m_x, &m_y, &m_z, &m_vx, &m_vz, &m_targetX, &m_targetZ, &m_radius, &m_maxSpeed, &m_slowingDistance })
+			values->clear();
+	}
+
+	void Crowd::selectVelocities(std::size_t firstGroup, std::size_t lastGroup, std::vector<std::uint32_t>& found, std::vector<float>& block)
+	{
+		std::size_t const count = m_x.size();
+		std::size_t const slots = m_settings.maxNeighbors;
+		float const horizon = m_settings.timeHorizon;
+		float const weight = m_settings.collisionWeight;
+		std::vector<std::pair<float, std::uint32_t> > nearest(slots);
+		block.resize(std::max<std::size_t>(slots, 1) * fieldCount * 4);
+
+		for(std::size_t group = firstGroup; group < lastGroup; ++group)
+		{
+			// Gather the lanes and the closest neighbors of each agent, ties broken by index so the choice doesn't
+			// depend on the grid's internal order
+			Lanes lanes;
+			for(int l = 0; l < 4; ++l)
+			{
+				std::size_t const agent = group * 4 + l;
+				for(std::size_t s = 0; s < slots; ++s)
+				{
+					float* slot = &block[s * fieldCount * 4];
+					slot[l] = farAway;
+					slot[4 + l] = farAway;
+					slot[8 + l] = 0.0f;
+					slot[12 + l] = 0.0f;
+					slot[16 + l] = 0.0f;
+				}
+				if(agent >= count)
+				{
+					lanes.vx[l] = lanes.vz[l] = lanes.preferredX[l] = lanes.preferredZ[l] = lanes.maxSpeed[l] = 0.0f;
+					lanes.directionX[l] = 1.0f;
+					lanes.directionZ[l] = 0.0f;
+					continue;
+				}
+
+				lanes.vx[l] = m_vx[agent];
+				lanes.vz[l] = m_vz[agent];
+				lanes.preferredX[l] = m_preferredX[agent];
+				lanes.preferredZ[l] = m_preferredZ[agent];
+				lanes.maxSpeed[l] = m_maxSpeed[agent];
+				// Candidates fan out around where the agent wants to go, or where it is going once it arrived
+				float dx = m_preferredX[agent];
+				float dz = m_preferredZ[agent];
+				if(dx * dx + dz * dz < 1e-6f)
+				{
+					dx = m_vx[agent];
+					dz = m_vz[agent];
+				}
+				float const length = std::sqrt(dx * dx + dz * dz);
+				lanes.directionX[l] = length > 1e-3f ? dx / length : 1.0f;
+				lanes.directionZ[l] = length > 1e-3f ? dz / length : 0.0f;
+
+				found.clear();
+				m_grid.queryRadius(m_gridPositions[agent], m_settings.neighborRadius, found);
+				// Insertion into the sorted k closest, most of the candidates fail the first comparison
+				std::size_t kept = 0;
+				for(std::uint32_t other : found)
+				{
+					if(other == agent)
+						continue;
+					float const ox = m_x[other] - m_x[agent];
+					float const oz = m_z[other] - m_z[agent];
+					std::pair<float, std::uint32_t> const entry(ox * ox + oz * oz, other);
+					if(kept == slots && (slots == 0 || !(entry < nearest[kept - 1])))
+						continue;
+					std::size_t position = kept < slots ? kept++ : kept - 1;
+					while(position > 0 && entry < nearest[position - 1])
+					{
+						nearest[position] = nearest[position - 1];
+						--position;
+					}
+					nearest[position] = entry;
+				}
+				for(std::size_t s = 0; s < kept; ++s)
+				{
+					std::uint32_t const other = nearest[s].second;
+					float* slot = &block[s * fieldCount * 4];
+					slot[l] = m_x[other] - m_x[agent];
+					slot[4 + l] = m_z[other] - m_z[agent];
+					slot[8 + l] = m_vx[other];
+					slot[12 + l] = m_vz[other];
+					slot[16 + l] = m_radius[other] + m_radius[agent];
+				}
+			}
+
+			alignas(16) float bestX[4];
+			alignas(16) float bestZ[4];
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			bool const exact = m_settings.deterministic;
+			__m128 const zero = _mm_setzero_ps();
+			__m128 const infinity = _mm_set1_ps(std::numeric_limits<float>::infinity());
+			__m128 const two = _mm_set1_ps(2.0f);
+			__m128 const horizonV = _mm_set1_ps(horizon);
+			__m128 const weightV = _mm_set1_ps(weight);
+			__m128 const minTimeV = _mm_set1_ps(minTime);
+			__m128 const selfVx = _mm_load_ps(lanes.vx);
+			__m128 const selfVz = _mm_load_ps(lanes.vz);
+			__m128 const preferredX = _mm_load_ps(lanes.preferredX);
+			__m128 const preferredZ = _mm_load_ps(lanes.preferredZ);
+			__m128 bestPenalty = infinity;
+			__m128 bestVx = zero;
+			__m128 bestVz = zero;
+			__m128 const directionX = _mm_load_ps(lanes.directionX);
+			__m128 const directionZ = _mm_load_ps(lanes.directionZ);
+			__m128 const maxSpeed = _mm_load_ps(lanes.maxSpeed);
+			for(std::size_t c = 0; c < candidateCount; ++c)
+			{
+				// The preferred and current velocity, standing still, then the table rotating the preferred direction
+				__m128 candidateX = preferredX;
+				__m128 candidateZ = preferredZ;
+				if(c == 1)
+				{
+					candidateX = selfVx;
+					candidateZ = selfVz;
+				}
+				else if(c == 2)
+					candidateX = candidateZ = zero;
+				else if(c >= fixedCandidates)
+				{
+					__m128 const cosine = _mm_set1_ps(candidateTable.cosine[c - fixedCandidates]);
+					__m128 const sine = _mm_set1_ps(candidateTable.sine[c - fixedCandidates]);
+					candidateX = _mm_mul_ps(maxSpeed, _mm_sub_ps(_mm_mul_ps(directionX, cosine), _mm_mul_ps(directionZ, sine)));
+					candidateZ = _mm_mul_ps(maxSpeed, _mm_add_ps(_mm_mul_ps(directionX, sine), _mm_mul_ps(directionZ, cosine)));
+				}
+				// Reciprocal: each side of a pair takes half of the avoidance
+				__m128 const relativeX = _mm_sub_ps(_mm_mul_ps(two, candidateX), selfVx);
+				__m128 const relativeZ = _mm_sub_ps(_mm_mul_ps(two, candidateZ), selfVz);
+
+				__m128 earliest = infinity;
+				for(std::size_t s = 0; s < slots; ++s)
+				{
+					const float* slot = &block[s * fieldCount * 4];
+					__m128 const px = _mm_loadu_ps(slot);
+					__m128 const pz = _mm_loadu_ps(slot + 4);
+					__m128 const wx = _mm_sub_ps(relativeX, _mm_loadu_ps(slot + 8));
+					__m128 const wz = _mm_sub_ps(relativeZ, _mm_loadu_ps(slot + 12));
+					__m128 const r = _mm_loadu_ps(slot + 16);
+					// |p - w t| = r
+					__m128 const a = _mm_add_ps(_mm_mul_ps(wx, wx), _mm_mul_ps(wz, wz));
+					__m128 const b = _mm_add_ps(_mm_mul_ps(px, wx), _mm_mul_ps(pz, wz));
+					__m128 const c0 = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(pz, pz)), _mm_mul_ps(r, r));
+					__m128 const discriminant = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c0));
+					__m128 const approaching = _mm_cmpgt_ps(b, zero);
+					__m128 const overlapping = _mm_and_ps(_mm_cmplt_ps(c0, zero), approaching);
+					__m128 const hit = _mm_and_ps(approaching, _mm_cmpgt_ps(discriminant, zero));
+					__m128 root;
+					__m128 time;
+					if(exact)
+					{
+						root = _mm_sqrt_ps(_mm_max_ps(discriminant, zero));
+						time = _mm_div_ps(_mm_sub_ps(b, root), _mm_max_ps(a, minTimeV));
+					}
+					else
+					{
+						root = _mm_mul_ps(discriminant, _mm_rsqrt_ps(_mm_max_ps(discriminant, _mm_set1_ps(1e-12f))));
+						time = _mm_mul_ps(_mm_sub_ps(b, root), _mm_rcp_ps(_mm_max_ps(a, minTimeV)));
+					}
+					time = _mm_or_ps(_mm_and_ps(hit, time), _mm_andnot_ps(hit, infinity));
+					time = _mm_andnot_ps(overlapping, time);
+					earliest = _mm_min_ps(earliest, time);
+				}
+
+				__m128 const offX = _mm_sub_ps(candidateX, preferredX);
+				__m128 const offZ = _mm_sub_ps(candidateZ, preferredZ);
+				__m128 const off2 = _mm_add_ps(_mm_mul_ps(offX, offX), _mm_mul_ps(offZ, offZ));
+				__m128 const soon = _mm_cmplt_ps(earliest, horizonV);
+				__m128 collision;
+				__m128 offset;
+				if(exact)
+				{
+					offset = _mm_sqrt_ps(off2);
+					collision = _mm_div_ps(weightV, _mm_max_ps(earliest, minTimeV));
+				}
+				else
+				{
+					offset = _mm_mul_ps(off2, _mm_rsqrt_ps(_mm_max_ps(off2, _mm_set1_ps(1e-12f))));
+					collision = _mm_mul_ps(weightV, _mm_rcp_ps(_mm_max_ps(earliest, minTimeV)));
+				}
+				__m128 const penalty = _mm_add_ps(offset, _mm_and_ps(soon, collision));
+				__m128 const better = _mm_cmplt_ps(penalty, bestPenalty);
+				bestPenalty = _mm_or_ps(_mm_and_ps(better, penalty), _mm_andnot_ps(better, bestPenalty));
+				bestVx = _mm_or_ps(_mm_and_ps(better, candidateX), _mm_andnot_ps(better, bestVx));
+				bestVz = _mm_or_ps(_mm_and_ps(better, candidateZ), _mm_andnot_ps(better, bestVz));
+			}
+			_mm_store_ps(bestX, bestVx);
+			_mm_store_ps(bestZ, bestVz);
+#else
+			for(int l = 0; l < 4; ++l)
+			{
+				float bestPenalty = std::numeric_limits<float>::infinity();
+				bestX[l] = bestZ[l] = 0.0f;
+				for(std::size_t c = 0; c < candidateCount; ++c)
+				{
+					float cx = lanes.preferredX[l];
+					float cz = lanes.preferredZ[l];
+					if(c == 1)
+					{
+						cx = lanes.vx[l];
+						cz = lanes.vz[l];
+					}
+					else if(c == 2)
+						cx = cz = 0.0f;
+					else if(c >= fixedCandidates)
+					{
+						float const cosine = candidateTable.cosine[c - fixedCandidates];
+						float const sine = candidateTable.sine[c - fixedCandidates];
+						cx = lanes.maxSpeed[l] * (lanes.directionX[l] * cosine - lanes.directionZ[l] * sine);
+						cz = lanes.maxSpeed[l] * (lanes.directionX[l] * sine + lanes.directionZ[l] * cosine);
+					}
+					float const relativeX = 2.0f * cx - lanes.vx[l];
+					float const relativeZ = 2.0f * cz - lanes.vz[l];
+					float earliest = std::numeric_limits<float>::infinity();
+					for(std::size_t s = 0; s < slots; ++s)
+					{
+						const float* slot = &block[s * fieldCount * 4];
+						float const px = slot[l], pz = slot[4 + l];
+						float const wx = relativeX - slot[8 + l], wz = relativeZ - slot[12 + l];
+						float const r = slot[16 + l];
+						float const a = wx * wx + wz * wz;
+						float const b = px * wx + pz * wz;
+						float const c0 = px * px + pz * pz - r * r;
+						float const discriminant = b * b - a * c0;
+						if(b <= 0.0f)
+							continue;
+						if(c0 < 0.0f)
+							earliest = 0.0f;
+						else if(discriminant > 0.0f)
+							earliest = std::min(earliest, (b - std::sqrt(discriminant)) / std::max(a, minTime));
+					}
+					float const offX = cx - lanes.preferredX[l];
+					float const offZ = cz - lanes.preferredZ[l];
+					float penalty = std::sqrt(offX * offX + offZ * offZ);
+					if(earliest < horizon)
+						penalty += weight / std::max(earliest, minTime);
+					if(penalty < bestPenalty)
+					{
+						bestPenalty = penalty;
+						bestX[l] = cx;
+						bestZ[l] = cz;
+					}
+				}
+			}
+#endif
+			for(int l = 0; l < 4; ++l)
+			{
+				std::size_t const agent = group * 4 + l;
+				if(agent >= count)
+					break;
+				m_newVx[agent] = bestX[l];
+				m_newVz[agent] = bestZ[l];
+			}
+		}
+	}
+
+	void Crowd::update(float deltaTime, JobSystem* jobs)
+	{
+		std::size_t const count = m_x.size();
+		if(count == 0)
+			return;
+		m_preferredX.resize(count);
+		m_preferredZ.resize(count);
+		m_newVx.resize(count);
+		m_newVz.resize(count);
+		m_gridPositions.resize(count);
+
+		// Straight at the target, slowing down on the last stretch
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			float const dx = m_targetX[i] - m_x[i];
+			float const dz = m_targetZ[i] - m_z[i];
+			float const distance = std::sqrt(dx * dx + dz * dz);
+			float const speed = m_maxSpeed[i] * std::min(1.0f, distance / m_slowingDistance[i]);
+			float const scale = distance > 1e-4f ? speed / distance : 0.0f;
+			m_preferredX[i] = dx * scale;
+			m_preferredZ[i] = dz * scale;
+			m_gridPositions[i] = glm::vec3(m_x[i], 0.0f, m_z[i]);
+		}
+		m_grid.build(m_gridPositions.data(), count, jobs);
+
+		std::size_t const groups = (count + 3) / 4;
+		parallelFor(jobs, groups, groupGrain, [&](std::size_t begin, std::size_t end)
+		{
+			std::vector<std::uint32_t> found;
+			std::vector<float> block;
+			selectVelocities(begin, end, found, block);
+		});
+
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			m_vx[i] = m_newVx[i];
+			m_vz[i] = m_newVz[i];
+			m_x[i] += m_vx[i] * deltaTime;
+			m_z[i] += m_vz[i] * deltaTime;
+		}
+	}
+
+	std::uint64_t Crowd::stateHash() const
+	{
+		StateHash hash;
+		hash.add(m_x);
+		hash.add(m_z);
+		hash.add(m_vx);
+		hash.add(m_vz);
+		return hash.value();
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "SpatialHashGrid.h"
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	struct CrowdSettings
+	{
+		unsigned maxNeighbors;   // Closest agents considered when choosing a velocity
+		float neighborRadius;    // Agents farther than this are ignored
+		float timeHorizon;       // Collisions further in the future than this cost nothing, in seconds
+		float collisionWeight;   // Penalty of a collision in one second, traded against speed lost in m/s
+		// IEEE division and square root instead of the rcpps/rsqrtps estimates, whose results differ between CPU
+		// vendors. The update is independent of the thread count either way.
+		bool deterministic;
+
+		CrowdSettings() : maxNeighbors(8), neighborRadius(3.0f), timeHorizon(2.0f), collisionWeight(2.0f), deterministic(false) {}
+	};
+
+	struct CrowdAgentParams
+	{
+		float radius;
+		float maxSpeed;
+		float slowingDistance; // Speed drops linearly inside this distance to the target
+
+		CrowdAgentParams() : radius(0.4f), maxSpeed(1.5f), slowingDistance(1.0f) {}
+	};
+
+	// Local avoidance on the x, z plane. Each agent samples candidate velocities around its preferred one and keeps
+	// the one with the lowest penalty, distance from the preferred velocity plus collisionWeight over the time to the
+	// first collision with its neighbors under the reciprocal velocity obstacle assumption (RVO, van den Berg et al.).
+	// Candidates are scored four agents per SSE2 instruction.
+	//
+	// State is kept as structures of arrays. An update reads the previous state only, so it comes out the same in any
+	// order and with any number of threads. Targets are usually the next corner of a path from NavQuery.
+	class Crowd
+	{
+	public:
+		explicit Crowd(const CrowdSettings& settings = CrowdSettings());
+
+		const CrowdSettings& settings() const { return m_settings; }
+
+		std::uint32_t addAgent(const glm::vec3& position, const CrowdAgentParams& params = CrowdAgentParams());
+		void setTarget(std::uint32_t agent, const glm::vec3& target);
+		void clear();
+
+		std::size_t agentCount() const { return m_x.size(); }
+		glm::vec3 position(std::uint32_t agent) const { return glm::vec3(m_x[agent], m_y[agent], m_z[agent]); }
+		glm::vec3 velocity(std::uint32_t agent) const { return glm::vec3(m_vx[agent], 0.0f, m_vz[agent]); }
+		float radius(std::uint32_t agent) const { return m_radius[agent]; }
+
+		void update(float deltaTime, JobSystem* jobs = nullptr);
+
+		// Hash of the positions and velocities, for comparing runs
+		std::uint64_t stateHash() const;
+
+	private:
+		void selectVelocities(std::size_t firstGroup, std::size_t lastGroup, std::vector<std::uint32_t>& found, std::vector<float>& block);
+
+		CrowdSettings m_settings;
+
+		std::vector<float> m_x;
+		std::vector<float> m_y;
+		std::vector<float> m_z;
+		std::vector<float> m_vx;
+		std::vector<float> m_vz;
+		std::vector<float> m_targetX;
+		std::vector<float> m_targetZ;
+		std::vector<float> m_radius;
+		std::vector<float> m_maxSpeed;
+		std::vector<float> m_slowingDistance;
+
+		// Per update
+		std::vector<float> m_preferredX;
+		std::vector<float> m_preferredZ;
+		std::vector<float> m_newVx;
+		std::vector<float> m_newVz;
+		std::vector<glm::vec3> m_gridPositions;
+		SpatialHashGrid m_grid;
+	};
+}
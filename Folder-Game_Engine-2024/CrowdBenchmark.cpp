@@ -0,0 +1,113 @@
+#include "Benchmark.h"
+#include "Crowd.h"
+#include "SpatialHashGrid.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	int const blockSide = 50;
+	float const spacing = 1.2f;
+	float const blockOffset = 45.0f;
+	float const deltaTime = 1.0f / 60.0f;
+	int const frameCount = 300;
+	int const overlapInterval = 30;
+
+	// Four square blocks of agents swap corners through the middle
+	void populate(engine::Crowd& crowd, int side)
+	{
+		glm::vec2 const corners[4] = { glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f), glm::vec2(1.0f, 1.0f), glm::vec2(-1.0f, 1.0f) };
+		for(const glm::vec2& corner : corners)
+		{
+			for(int z = 0; z < side; ++z)
+			{
+				for(int x = 0; x < side; ++x)
+				{
+					glm::vec2 const local = (glm::vec2(x, z) - (side - 1) * 0.5f) * spacing;
+					glm::vec2 const start = corner * blockOffset + local;
+					glm::vec2 const target = -corner * blockOffset + local;
+					std::uint32_t const agent = crowd.addAgent(glm::vec3(start.x, 0.0f, start.y));
+					crowd.setTarget(agent, glm::vec3(target.x, 0.0f, target.y));
+				}
+			}
+		}
+	}
+
+	// Pairs closer than 90% of their combined radius
+	std::size_t countOverlaps(const engine::Crowd& crowd, engine::SpatialHashGrid& grid, std::vector<glm::vec3>& positions)
+	{
+		positions.resize(crowd.agentCount());
+		for(std::uint32_t i = 0; i < positions.size(); ++i)
+			positions[i] = crowd.position(i);
+		grid.build(positions.data(), positions.size());
+		std::vector<std::uint32_t> found;
+		std::size_t overlaps = 0;
+		for(std::uint32_t i = 0; i < positions.size(); ++i)
+		{
+			found.clear();
+			grid.queryRadius(positions[i], 1.0f, found);
+			for(std::uint32_t other : found)
+			{
+				if(other > i && glm::distance(positions[i], positions[other]) < 0.9f * (crowd.radius(i) + crowd.radius(other)))
+					++overlaps;
+			}
+		}
+		return overlaps;
+	}
+}
+
+ENGINE_BENCHMARK(Crowd)
+{
+	engine::Crowd crowd;
+	populate(crowd, blockSide);
+	context.report("agents", static_cast<double>(crowd.agentCount()), "");
+
+	engine::SpatialHashGrid grid(1.0f);
+	std::vector<glm::vec3> positions;
+	double totalMs = 0.0;
+	double maxMs = 0.0;
+	std::size_t overlaps = 0;
+	int overlapSamples = 0;
+	for(int frame = 0; frame < frameCount; ++frame)
+	{
+		engine::Stopwatch timer;
+		crowd.update(deltaTime, &context.jobs());
+		double const elapsed = timer.elapsedMs();
+		totalMs += elapsed;
+		maxMs = std::max(maxMs, elapsed);
+		if(frame % overlapInterval == overlapInterval - 1)
+		{
+			overlaps += countOverlaps(crowd, grid, positions);
+			++overlapSamples;
+		}
+	}
+
+	double speed = 0.0;
+	for(std::uint32_t i = 0; i < crowd.agentCount(); ++i)
+		speed += glm::length(crowd.velocity(i));
+	context.report("update", totalMs / frameCount, "ms");
+	context.report("update max", maxMs, "ms");
+	context.report("60 Hz frame used", totalMs / frameCount / (1000.0 * deltaTime) * 100.0, "%");
+	context.report("agents per ms", crowd.agentCount() / (totalMs / frameCount), "");
+	context.report("overlapping pairs", static_cast<double>(overlaps) / overlapSamples, "");
+	context.report("mean speed", speed / crowd.agentCount(), "m/s");
+
+	// Deterministic settings give the same state with and without worker threads
+	engine::CrowdSettings settings;
+	settings.deterministic = true;
+	engine::Crowd threaded(settings);
+	engine::Crowd serial(settings);
+	populate(threaded, 20);
+	populate(serial, 20);
+	double exactMs = 0.0;
+	for(int frame = 0; frame < 120; ++frame)
+	{
+		engine::Stopwatch timer;
+		threaded.update(deltaTime, &context.jobs());
+		exactMs += timer.elapsedMs();
+		serial.update(deltaTime, nullptr);
+	}
+	context.report("deterministic update 1600 agents", exactMs / 120, "ms");
+	context.report("same state any thread count", threaded.stateHash() == serial.stateHash() ? 1.0 : 0.0, "ok");
+}
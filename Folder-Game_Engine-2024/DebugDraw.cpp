@@ -0,0 +1,274 @@
+#include "DebugDraw.h"
+
+#if ENGINE_DEBUG_DRAW
+
+#include <gtc/constants.hpp>
+
+#include <atomic>
+#include <thread>
+
+namespace engine
+{
+	namespace
+	{
+		int const circleSegments = 32;
+
+		struct ThreadBuffer
+		{
+			std::atomic<std::uint64_t> writing; // Frame + 1 while the thread appends, 0 otherwise
+			std::atomic<bool> owned;
+			std::vector<DebugVertex> vertices[2][2]; // By frame parity, then depth mode
+			ThreadBuffer* next;
+		};
+
+		std::atomic<std::uint64_t> currentFrame(0);
+		// Never freed, threads may still draw while static objects are destroyed at exit
+		std::atomic<ThreadBuffer*> threadBuffers(nullptr);
+
+		// Gives the buffer back when its thread exits, a thread started later takes it over
+		struct ThreadOwner
+		{
+			ThreadBuffer* buffer;
+
+			ThreadOwner() : buffer(nullptr) {}
+			~ThreadOwner()
+			{
+				if(buffer)
+					buffer->owned.store(false, std::memory_order_release);
+			}
+		};
+
+		thread_local ThreadOwner owner;
+
+		ThreadBuffer& threadBuffer()
+		{
+			if(owner.buffer)
+				return *owner.buffer;
+			for(ThreadBuffer* buffer = threadBuffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+			{
+				bool expected = false;
+				if(!buffer->owned.load(std::memory_order_relaxed) && buffer->owned.compare_exchange_strong(expected, true, std::memory_order_acquire))
+					return *(owner.buffer = buffer);
+			}
+
+			ThreadBuffer* buffer = new ThreadBuffer;
+			buffer->writing.store(0, std::memory_order_relaxed);
+			buffer->owned.store(true, std::memory_order_relaxed);
+			buffer->next = threadBuffers.load(std::memory_order_relaxed);
+			while(!threadBuffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+			return *(owner.buffer = buffer);
+		}
+
+		// Marks the thread's buffer as written for the current frame while in scope. The frame is read again after
+		// the mark, so collect either waits for this append or the append goes to the next frame.
+		class Append
+		{
+		public:
+			explicit Append(DebugDepth depth) :
+				m_buffer(threadBuffer())
+			{
+				std::uint64_t frame = currentFrame.load();
+				for(;;)
+				{
+					m_buffer.writing.store(frame + 1);
+					std::uint64_t const check = currentFrame.load();
+					if(check == frame)
+						break;
+					frame = check;
+				}
+				m_vertices = &m_buffer.vertices[frame & 1][depth == DebugDepth::Overlay ? 1 : 0];
+			}
+
+			~Append() { m_buffer.writing.store(0, std::memory_order_release); }
+
+			Append(const Append&) = delete;
+			Append& operator=(const Append&) = delete;
+
+			void line(const glm::vec3& from, const glm::vec3& to, std::uint32_t color)
+			{
+				DebugVertex const vertices[2] = { { from, color }, { to, color } };
+				m_vertices->insert(m_vertices->end(), vertices, vertices + 2);
+			}
+
+			// Room for count vertices written with vertex, shapes grow the buffer once rather than per line
+			DebugVertex* extend(std::size_t count)
+			{
+				std::size_t const size = m_vertices->size();
+				m_vertices->resize(size + count);
+				return m_vertices->data() + size;
+			}
+
+			// The 12 edges between corners that differ along one axis, corner i at bit 0, 1 and 2 for x, y and z
+			void cube(const glm::vec3 (&corners)[8], std::uint32_t color)
+			{
+				DebugVertex* out = extend(24);
+				for(int corner = 0; corner < 8; ++corner)
+				{
+					for(int axis = 1; axis < 8; axis <<= 1)
+					{
+						if((corner & axis) != 0)
+							continue;
+						out[0].position = corners[corner];
+						out[0].color = color;
+						out[1].position = corners[corner | axis];
+						out[1].color = color;
+						out += 2;
+					}
+				}
+			}
+
+		private:
+			ThreadBuffer& m_buffer;
+			std::vector<DebugVertex>* m_vertices;
+		};
+
+		struct CircleTable
+		{
+			glm::vec2 points[circleSegments + 1];
+
+			CircleTable()
+			{
+				for(int i = 0; i <= circleSegments; ++i)
+				{
+					float const angle = glm::two_pi<float>() * static_cast<float>(i % circleSegments) / circleSegments;
+					points[i] = glm::vec2(glm::cos(angle), glm::sin(angle));
+				}
+			}
+		};
+
+		const glm::vec2* circlePoints()
+		{
+			static CircleTable const table;
+			return table.points;
+		}
+
+		// The first buffer is swapped in rather than copied, the thread keeps the storage lines had
+		void merge(std::vector<DebugVertex>& lines, std::vector<DebugVertex>& buffer)
+		{
+			if(lines.empty())
+				lines.swap(buffer);
+			else
+				lines.insert(lines.end(), buffer.begin(), buffer.end());
+			buffer.clear();
+		}
+
+		glm::vec3 cubeCorner(int corner)
+		{
+			return glm::vec3((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+		}
+	}
+
+	void DebugDraw::line(const glm::vec3& from, const glm::vec3& to, std::uint32_t color, DebugDepth depth)
+	{
+		Append append(depth);
+		append.line(from, to, color);
+	}
+
+	void DebugDraw::axes(const glm::mat4& transform, float length, DebugDepth depth)
+	{
+		glm::vec3 const origin(transform[3]);
+		Append append(depth);
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			glm::vec4 color(0.0f, 0.0f, 0.0f, 1.0f);
+			color[axis] = 1.0f;
+			append.line(origin, origin + glm::vec3(transform[axis]) * length, glm::packUnorm4x8(color));
+		}
+	}
+
+	void DebugDraw::cross(const glm::vec3& center, float size, std::uint32_t color, DebugDepth depth)
+	{
+		float const half = size * 0.5f;
+		Append append(depth);
+		append.line(center - glm::vec3(half, 0.0f, 0.0f), center + glm::vec3(half, 0.0f, 0.0f), color);
+		append.line(center - glm::vec3(0.0f, half, 0.0f), center + glm::vec3(0.0f, half, 0.0f), color);
+		append.line(center - glm::vec3(0.0f, 0.0f, half), center + glm::vec3(0.0f, 0.0f, half), color);
+	}
+
+	void DebugDraw::box(const glm::mat4& transform, std::uint32_t color, DebugDepth depth)
+	{
+		glm::vec3 corners[8];
+		for(int corner = 0; corner < 8; ++corner)
+			corners[corner] = glm::vec3(transform * glm::vec4(cubeCorner(corner), 1.0f));
+		Append append(depth);
+		append.cube(corners, color);
+	}
+
+	void DebugDraw::box(const Aabb& box, std::uint32_t color, DebugDepth depth)
+	{
+		glm::vec3 corners[8];
+		for(int corner = 0; corner < 8; ++corner)
+			corners[corner] = box.center() + box.extent() * cubeCorner(corner);
+		Append append(depth);
+		append.cube(corners, color);
+	}
+
+	void DebugDraw::circle(const glm::mat4& transform, std::uint32_t color, DebugDepth depth)
+	{
+		const glm::vec2* points = circlePoints();
+		Append append(depth);
+		DebugVertex* out = append.extend(circleSegments * 2);
+		glm::vec3 previous(transform * glm::vec4(points[0], 0.0f, 1.0f));
+		for(int i = 1; i <= circleSegments; ++i)
+		{
+			glm::vec3 const point(transform * glm::vec4(points[i], 0.0f, 1.0f));
+			out[0].position = previous;
+			out[0].color = color;
+			out[1].position = point;
+			out[1].color = color;
+			out += 2;
+			previous = point;
+		}
+	}
+
+	void DebugDraw::sphere(const glm::vec3& center, float radius, std::uint32_t color, DebugDepth depth)
+	{
+		const glm::vec2* points = circlePoints();
+		Append append(depth);
+		DebugVertex* out = append.extend(circleSegments * 6);
+		for(int i = 0; i < circleSegments; ++i)
+		{
+			glm::vec2 const from = points[i] * radius;
+			glm::vec2 const to = points[i + 1] * radius;
+			glm::vec3 const ends[6] = { glm::vec3(from, 0.0f), glm::vec3(to, 0.0f), glm::vec3(from.x, 0.0f, from.y), glm::vec3(to.x, 0.0f, to.y), glm::vec3(0.0f, from), glm::vec3(0.0f, to) };
+			for(const glm::vec3& end : ends)
+			{
+				out->position = center + end;
+				out->color = color;
+				++out;
+			}
+		}
+	}
+
+	void DebugDraw::frustum(const glm::mat4& viewProjection, std::uint32_t color, DebugDepth depth)
+	{
+		glm::mat4 const inverse = glm::inverse(viewProjection);
+		glm::vec3 corners[8];
+		for(int corner = 0; corner < 8; ++corner)
+		{
+			glm::vec4 const point = inverse * glm::vec4(cubeCorner(corner), 1.0f);
+			corners[corner] = glm::vec3(point) / point.w;
+		}
+		Append append(depth);
+		append.cube(corners, color);
+	}
+
+	void DebugDraw::collect(DebugLines& lines)
+	{
+		lines.clear();
+		std::uint64_t const ended = currentFrame.fetch_add(1);
+		for(ThreadBuffer* buffer = threadBuffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+		{
+			// An append that read the frame before it ended is a few stores from done
+			while(buffer->writing.load() == ended + 1)
+				std::this_thread::yield();
+			std::vector<DebugVertex>* vertices = buffer->vertices[ended & 1];
+			merge(lines.tested, vertices[0]);
+			merge(lines.overlay, vertices[1]);
+		}
+	}
+}
+
+#endif
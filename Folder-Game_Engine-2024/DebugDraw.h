@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Bounds.h"
+
+#include <glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Debug drawing is compiled in unless NDEBUG is defined, define ENGINE_DEBUG_DRAW to 0 or 1 to override it.
+// Compiled out, every call is an empty inline function and no buffers or GL objects exist.
+#ifndef ENGINE_DEBUG_DRAW
+#ifdef NDEBUG
+#define ENGINE_DEBUG_DRAW 0
+#else
+#define ENGINE_DEBUG_DRAW 1
+#endif
+#endif
+
+namespace engine
+{
+	enum class DebugDepth
+	{
+		Tested,  // Hidden behind the scene
+		Overlay  // Drawn over everything
+	};
+
+	struct DebugVertex
+	{
+		glm::vec3 position;
+		std::uint32_t color; // glm::packUnorm4x8 of the RGBA color
+	};
+
+	// Line vertex pairs of a frame, one list per depth mode
+	struct DebugLines
+	{
+		std::vector<DebugVertex> tested;
+		std::vector<DebugVertex> overlay;
+
+		void clear()
+		{
+			tested.clear();
+			overlay.clear();
+		}
+	};
+
+	// Lines and wireframe shapes callable from any thread without locking. Each thread appends to its own buffer,
+	// tagged with the frame it was started in. collect ends the frame: later calls go to the next frame, and the
+	// buffers of the frame that ended are merged once the appends still running on other threads finish.
+	// Shapes are drawn until the end of the frame they were added in.
+	class DebugDraw
+	{
+	public:
+#if ENGINE_DEBUG_DRAW
+		static void line(const glm::vec3& from, const glm::vec3& to, std::uint32_t color, DebugDepth depth = DebugDepth::Tested);
+		// Three lines of length along the transform's axes, red, green and blue
+		static void axes(const glm::mat4& transform, float length = 1.0f, DebugDepth depth = DebugDepth::Tested);
+		static void cross(const glm::vec3& center, float size, std::uint32_t color, DebugDepth depth = DebugDepth::Tested);
+		// Edges of the -1 to 1 cube through transform
+		static void box(const glm::mat4& transform, std::uint32_t color, DebugDepth depth = DebugDepth::Tested);
+		static void box(const Aabb& box, std::uint32_t color, DebugDepth depth = DebugDepth::Tested);
+		// Unit circle in the xy plane through transform
+		static void circle(const glm::mat4& transform, std::uint32_t color, DebugDepth depth = DebugDepth::Tested);
+		// Circles around the three axes
+		static void sphere(const glm::vec3& center, float radius, std::uint32_t color, DebugDepth depth = DebugDepth::Tested);
+		// Edges of the volume a view projection matrix maps to the clip cube
+		static void frustum(const glm::mat4& viewProjection, std::uint32_t color, DebugDepth depth = DebugDepth::Tested);
+
+		// Ends the frame and replaces lines with the frame's lines. Called by one thread at a time.
+		static void collect(DebugLines& lines);
+#else
+		static void line(const glm::vec3&, const glm::vec3&, std::uint32_t, DebugDepth = DebugDepth::Tested) {}
+		static void axes(const glm::mat4&, float = 1.0f, DebugDepth = DebugDepth::Tested) {}
+		static void cross(const glm::vec3&, float, std::uint32_t, DebugDepth = DebugDepth::Tested) {}
+		static void box(const glm::mat4&, std::uint32_t, DebugDepth = DebugDepth::Tested) {}
+		static void box(const Aabb&, std::uint32_t, DebugDepth = DebugDepth::Tested) {}
+		static void circle(const glm::mat4&, std::uint32_t, DebugDepth = DebugDepth::Tested) {}
+		static void sphere(const glm::vec3&, float, std::uint32_t, DebugDepth = DebugDepth::Tested) {}
+		static void frustum(const glm::mat4&, std::uint32_t, DebugDepth = DebugDepth::Tested) {}
+
+		static void collect(DebugLines& lines) { lines.clear(); }
+#endif
+	};
+}
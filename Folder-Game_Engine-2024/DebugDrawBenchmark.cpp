@@ -0,0 +1,140 @@
+#include "Benchmark.h"
+#include "DebugDraw.h"
+#include "JobSystem.h"
+
+#include <ext/matrix_clip_space.hpp>
+#include <ext/matrix_transform.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	std::size_t const shapeCount = 50000;
+	int const frameCount = 10;
+	int const warmupFrames = 3;
+	int const writerCount = 3;
+	std::size_t const linesPerWriter = 500000;
+
+	// Vertices of each shape in the mix drawn below, for checking what collect returns
+	std::size_t const boxVertices = 24;
+	std::size_t const sphereVertices = 3 * 32 * 2;
+	std::size_t const frustumVertices = 24;
+
+	// Mostly culling boxes, with the spheres, frusta and lines of the other debug views
+	void drawShape(std::size_t i, std::size_t& tested, std::size_t& overlay)
+	{
+		glm::vec3 const position(static_cast<float>(i % 100), static_cast<float>(i / 100 % 100), static_cast<float>(i / 10000));
+		std::uint32_t const color = glm::packUnorm4x8(glm::vec4(position / 100.0f, 1.0f));
+		if(i % 64 == 0)
+		{
+			glm::mat4 const view = glm::lookAt(position, position + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			engine::DebugDraw::frustum(glm::perspective(1.0f, 1.5f, 0.1f, 10.0f) * view, color, engine::DebugDepth::Overlay);
+			overlay += frustumVertices;
+		}
+		else if(i % 8 == 0)
+		{
+			engine::DebugDraw::sphere(position, 0.5f, color);
+			tested += sphereVertices;
+		}
+		else if(i % 8 == 1)
+		{
+			engine::DebugDraw::line(position, position + glm::vec3(0.0f, 1.0f, 0.0f), color);
+			tested += 2;
+		}
+		else
+		{
+			engine::DebugDraw::box(engine::Aabb::fromCenterExtent(position, glm::vec3(0.4f)), color);
+			tested += boxVertices;
+		}
+	}
+}
+
+ENGINE_BENCHMARK(DebugDraw)
+{
+	engine::DebugLines lines;
+	engine::DebugDraw::collect(lines);
+
+	std::size_t expectedTested = 0;
+	std::size_t expectedOverlay = 0;
+	for(std::size_t i = 0; i < shapeCount; ++i)
+	{
+		std::size_t tested = 0;
+		std::size_t overlay = 0;
+		drawShape(i, tested, overlay);
+		expectedTested += tested;
+		expectedOverlay += overlay;
+	}
+	engine::DebugDraw::collect(lines);
+#if ENGINE_DEBUG_DRAW
+	bool const complete = lines.tested.size() == expectedTested && lines.overlay.size() == expectedOverlay;
+#else
+	bool const complete = lines.tested.empty() && lines.overlay.empty();
+#endif
+
+	// The shapes drawn from every job, as culling or physics jobs would. The first frames grow the buffers that
+	// take turns holding a frame and aren't timed.
+	double drawMs = 0.0;
+	double collectMs = 0.0;
+	engine::Stopwatch timer;
+	for(int frame = -warmupFrames; frame < frameCount; ++frame)
+	{
+		if(frame == 0)
+			drawMs = collectMs = 0.0;
+		timer.restart();
+		engine::parallelFor(&context.jobs(), shapeCount, 1024, [](std::size_t begin, std::size_t end)
+		{
+			std::size_t tested = 0;
+			std::size_t overlay = 0;
+			for(std::size_t i = begin; i < end; ++i)
+				drawShape(i, tested, overlay);
+		});
+		drawMs += timer.elapsedMs();
+		timer.restart();
+		engine::DebugDraw::collect(lines);
+		collectMs += timer.elapsedMs();
+	}
+	context.report("shapes", static_cast<double>(shapeCount), "");
+	context.report("draw per shape", drawMs / frameCount / shapeCount * 1e6, "ns");
+	context.report("collect", collectMs / frameCount, "ms");
+	context.report("line vertices", static_cast<double>(lines.tested.size() + lines.overlay.size()), "");
+	context.report("vertex bytes", (lines.tested.size() + lines.overlay.size()) * sizeof(engine::DebugVertex) / (1024.0 * 1024.0), "MB");
+	context.report("all shapes collected", complete ? 1.0 : 0.0, "ok");
+
+	// Threads that keep drawing while frames end under them: every line lands in exactly one frame
+	std::atomic<int> finished(0);
+	std::vector<std::thread> writers;
+	for(int writer = 0; writer < writerCount; ++writer)
+	{
+		writers.push_back(std::thread([&finished, writer]()
+		{
+			for(std::size_t i = 0; i < linesPerWriter; ++i)
+			{
+				glm::vec3 const from(static_cast<float>(writer), static_cast<float>(i), 0.0f);
+				engine::DebugDraw::line(from, from + glm::vec3(1.0f), 0xFFFFFFFFu, i % 2 ? engine::DebugDepth::Overlay : engine::DebugDepth::Tested);
+			}
+			finished.fetch_add(1);
+		}));
+	}
+	std::size_t collected = 0;
+	int frames = 0;
+	while(finished.load() < writerCount)
+	{
+		engine::DebugDraw::collect(lines);
+		collected += (lines.tested.size() + lines.overlay.size()) / 2;
+		++frames;
+		std::this_thread::yield();
+	}
+	for(std::thread& writer : writers)
+		writer.join();
+	engine::DebugDraw::collect(lines);
+	collected += (lines.tested.size() + lines.overlay.size()) / 2;
+#if ENGINE_DEBUG_DRAW
+	bool const lossless = collected == writerCount * linesPerWriter;
+#else
+	bool const lossless = collected == 0;
+#endif
+	context.report("frames ended while drawing", static_cast<double>(frames), "");
+	context.report("no lines lost", lossless ? 1.0 : 0.0, "ok");
+}
@@ -0,0 +1,110 @@
+#include "Determinism.h"
+#include "FileIo.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace engine
+{
+	namespace
+	{
+		char const checksumMagic[4] = { 'C', 'S', 'U', 'M' };
+		std::uint32_t const checksumVersion = 1;
+
+		static_assert(sizeof(ChecksumLog::Entry) == 16, "ChecksumLog::Entry layout changed, bump checksumVersion");
+
+		std::uint64_t const hashPrime = 1099511628211ull;
+	}
+
+	void StateHash::add(const void* data, std::size_t size)
+	{
+		// FNV-1a on whole words, then on the bytes left
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		std::uint64_t hash = m_hash;
+		for(; size >= sizeof(std::uint64_t); size -= sizeof(std::uint64_t), bytes += sizeof(std::uint64_t))
+		{
+			std::uint64_t word;
+			std::memcpy(&word, bytes, sizeof(word));
+			hash = (hash ^ word) * hashPrime;
+		}
+		for(; size > 0; --size, ++bytes)
+			hash = (hash ^ *bytes) * hashPrime;
+		m_hash = hash;
+	}
+
+	const std::uint64_t ChecksumLog::noMismatch;
+
+	void ChecksumLog::record(std::uint64_t tick, std::uint64_t checksum)
+	{
+		Entry entry;
+		entry.tick = tick;
+		entry.checksum = checksum;
+		m_entries.push_back(entry);
+	}
+
+	std::uint64_t ChecksumLog::firstMismatch(const ChecksumLog& other) const
+	{
+		std::size_t i = 0;
+		std::size_t j = 0;
+		while(i < m_entries.size() && j < other.m_entries.size())
+		{
+			if(m_entries[i].tick < other.m_entries[j].tick)
+				++i;
+			else if(other.m_entries[j].tick < m_entries[i].tick)
+				++j;
+			else if(m_entries[i].checksum != other.m_entries[j].checksum)
+				return m_entries[i].tick;
+			else
+			{
+				++i;
+				++j;
+			}
+		}
+		return noMismatch;
+	}
+
+	bool ChecksumLog::save(const std::string& path) const
+	{
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+		if(!file)
+			return false;
+
+		std::uint64_t const count = m_entries.size();
+		bool ok = std::fwrite(checksumMagic, sizeof(checksumMagic), 1, file) == 1;
+		ok = ok && std::fwrite(&checksumVersion, sizeof(checksumVersion), 1, file) == 1;
+		ok = ok && std::fwrite(&count, sizeof(count), 1, file) == 1;
+		ok = ok && (count == 0 || std::fwrite(m_entries.data(), sizeof(Entry), m_entries.size(), file) == m_entries.size());
+		return std::fclose(file) == 0 && ok;
+	}
+
+	bool ChecksumLog::load(const std::string& path)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if(!file)
+			return false;
+
+		char magic[4] = {};
+		std::uint32_t version = 0;
+		std::uint64_t count = 0;
+		bool ok = std::fread(magic, sizeof(magic), 1, file) == 1
+			&& std::fread(&version, sizeof(version), 1, file) == 1
+			&& std::fread(&count, sizeof(count), 1, file) == 1
+			&& std::equal(magic, magic + 4, checksumMagic)
+			&& version == checksumVersion;
+		// A truncated or corrupt count fails here rather than sizing the entries
+		ok = ok && count <= bytesLeft(file) / sizeof(Entry);
+
+		std::vector<Entry> entries;
+		if(ok)
+		{
+			entries.resize(static_cast<std::size_t>(count));
+			ok = count == 0 || std::fread(entries.data(), sizeof(Entry), entries.size(), file) == entries.size();
+		}
+		std::fclose(file);
+
+		if(ok)
+			m_entries.swap(entries);
+		return ok;
+	}
+}
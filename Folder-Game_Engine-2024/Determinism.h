@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace engine
+{
+	// 64-bit hash of simulation state, fed with the raw bytes of trivially copyable values. Floats are hashed by
+	// their bits, so -0 and 0 or two NaNs with different payloads count as different states.
+	class StateHash
+	{
+	public:
+		StateHash() : m_hash(14695981039346656037ull) {}
+
+		void add(const void* data, std::size_t size);
+
+		template<typename T>
+		void add(const T& value) { add(&value, sizeof(T)); }
+
+		template<typename T>
+		void add(const std::vector<T>& values)
+		{
+			if(!values.empty())
+				add(values.data(), values.size() * sizeof(T));
+		}
+
+		std::uint64_t value() const { return m_hash; }
+
+	private:
+		std::uint64_t m_hash;
+	};
+
+	// Checksum of the simulation state after each tick. Recording it along with a session's inputs and comparing it
+	// with a replay finds the first tick where two runs diverge, whether they ran on other machines, builds or
+	// thread counts.
+	class ChecksumLog
+	{
+	public:
+		struct Entry
+		{
+			std::uint64_t tick;
+			std::uint64_t checksum;
+		};
+
+		static const std::uint64_t noMismatch = ~0ull;
+
+		void record(std::uint64_t tick, std::uint64_t checksum);
+		void clear() { m_entries.clear(); }
+
+		const std::vector<Entry>& entries() const { return m_entries; }
+
+		// First tick recorded by both logs with different checksums, or noMismatch. Ticks must be recorded in
+		// increasing order.
+		std::uint64_t firstMismatch(const ChecksumLog& other) const;
+
+		bool save(const std::string& path) const;
+		bool load(const std::string& path);
+
+	private:
+		std::vector<Entry> m_entries;
+	};
+}
@@ -0,0 +1,154 @@
+#include "Benchmark.h"
+#include "Determinism.h"
+#include "Fixed.h"
+#include "JobSystem.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	std::size_t const particleCount = 20000;
+	int const tickCount = 300;
+
+	// Particles pulled towards their center of mass under a turning wind, bouncing on the ground. The center is a
+	// reduction over every particle, the step a parallel loop where each particle only writes itself.
+	template<typename T>
+	class Swarm
+	{
+	public:
+		typedef glm::vec<3, T, glm::defaultp> Vec3;
+
+		// reduceChunks: 0 reduces in fixed chunks, otherwise in that many chunks like a per-worker split would
+		Swarm(engine::JobSystem* jobs, std::size_t reduceChunks) :
+			m_jobs(jobs),
+			m_reduceChunks(reduceChunks),
+			m_time(0)
+		{
+			std::mt19937 random(5);
+			std::uniform_real_distribution<float> coordinate(-50.0f, 50.0f);
+			for(std::size_t i = 0; i < particleCount; ++i)
+			{
+				m_positions.push_back(Vec3(T(coordinate(random)), T(coordinate(random) + 60.0f), T(coordinate(random))));
+				m_velocities.push_back(Vec3(T(0)));
+			}
+		}
+
+		void tick()
+		{
+			using engine::cos;
+			using engine::sin;
+			using std::cos;
+			using std::sin;
+
+			std::size_t const chunkSize = m_reduceChunks == 0 ? 1024 : (particleCount + m_reduceChunks - 1) / m_reduceChunks;
+			Vec3 const sum = engine::parallelReduce(m_jobs, particleCount, chunkSize, Vec3(T(0)), [&](std::size_t begin, std::size_t end)
+			{
+				Vec3 partial(T(0));
+				for(std::size_t i = begin; i < end; ++i)
+					partial += m_positions[i];
+				return partial;
+			}, [](const Vec3& a, const Vec3& b) { return a + b; });
+			Vec3 const center = sum / T(static_cast<int>(particleCount));
+
+			T const dt = T(1) / T(60);
+			T const angle = T(m_time) / T(100);
+			Vec3 const wind = Vec3(sin(angle), T(0), cos(angle)) * T(2);
+			engine::parallelFor(m_jobs, particleCount, 1024, [&](std::size_t begin, std::size_t end)
+			{
+				for(std::size_t i = begin; i < end; ++i)
+				{
+					Vec3 const toCenter = center - m_positions[i];
+					Vec3 const acceleration = toCenter / (length(toCenter) + T(1)) * T(8) + wind + Vec3(T(0), T(-10), T(0));
+					m_velocities[i] = m_velocities[i] * T(0.995) + acceleration * dt;
+					m_positions[i] += m_velocities[i] * dt;
+					if(m_positions[i].y < T(0))
+					{
+						m_positions[i].y = -m_positions[i].y;
+						m_velocities[i].y = -m_velocities[i].y * T(0.8);
+					}
+				}
+			});
+			++m_time;
+		}
+
+		std::uint64_t checksum() const
+		{
+			engine::StateHash hash;
+			hash.add(m_positions);
+			hash.add(m_velocities);
+			hash.add(m_time);
+			return hash.value();
+		}
+
+	private:
+		engine::JobSystem* m_jobs;
+		std::size_t m_reduceChunks;
+		int m_time;
+		std::vector<Vec3> m_positions;
+		std::vector<Vec3> m_velocities;
+	};
+
+	template<typename T>
+	engine::ChecksumLog run(engine::JobSystem* jobs, std::size_t reduceChunks, double& milliseconds)
+	{
+		Swarm<T> swarm(jobs, reduceChunks);
+		engine::ChecksumLog log;
+		engine::Stopwatch timer;
+		for(int tick = 0; tick < tickCount; ++tick)
+		{
+			swarm.tick();
+			log.record(static_cast<std::uint64_t>(tick), swarm.checksum());
+		}
+		milliseconds = timer.elapsedMs();
+		return log;
+	}
+
+	double mismatchTick(const engine::ChecksumLog& a, const engine::ChecksumLog& b)
+	{
+		std::uint64_t const tick = a.firstMismatch(b);
+		return tick == engine::ChecksumLog::noMismatch ? -1.0 : static_cast<double>(tick);
+	}
+}
+
+ENGINE_BENCHMARK(Determinism)
+{
+	unsigned const workers = context.jobs().workerCount();
+	double serialMs = 0.0;
+	double parallelMs = 0.0;
+
+	engine::ChecksumLog const fixedSerial = run<engine::Fixed>(nullptr, 0, serialMs);
+	engine::ChecksumLog const fixedParallel = run<engine::Fixed>(&context.jobs(), 0, parallelMs);
+	context.report("fixed serial per tick", serialMs / tickCount, "ms");
+	context.report("fixed on jobs per tick", parallelMs / tickCount, "ms");
+	context.report("fixed first mismatch tick (-1 none)", mismatchTick(fixedSerial, fixedParallel), "");
+
+	engine::ChecksumLog const floatSerial = run<float>(nullptr, 0, serialMs);
+	engine::ChecksumLog const floatParallel = run<float>(&context.jobs(), 0, parallelMs);
+	context.report("float serial per tick", serialMs / tickCount, "ms");
+	context.report("float on jobs per tick", parallelMs / tickCount, "ms");
+	context.report("float first mismatch tick (-1 none)", mismatchTick(floatSerial, floatParallel), "");
+
+	// What a reduction split by worker count does: the sums depend on the thread count
+	engine::ChecksumLog const floatPerWorker = run<float>(&context.jobs(), workers + 1, parallelMs);
+	context.report("float per-worker chunks first mismatch tick (-1 none)", mismatchTick(floatSerial, floatPerWorker), "");
+
+	// A saved log loads back, one whose entry count runs past the end of the file is refused
+	char const* const path = "determinism_benchmark.csum";
+	engine::ChecksumLog loaded;
+	bool const roundTrip = fixedSerial.save(path) && loaded.load(path) && loaded.entries().size() == fixedSerial.entries().size()
+		&& mismatchTick(fixedSerial, loaded) < 0.0;
+	std::uint64_t const corruptCount = 1ull << 40;
+	bool corrupted = false;
+	if(std::FILE* file = std::fopen(path, "r+b"))
+	{
+		// After the magic and the version
+		corrupted = std::fseek(file, 8, SEEK_SET) == 0 && std::fwrite(&corruptCount, sizeof(corruptCount), 1, file) == 1;
+		corrupted = std::fclose(file) == 0 && corrupted;
+	}
+	bool const refused = corrupted && !loaded.load(path) && loaded.entries().size() == fixedSerial.entries().size();
+	std::remove(path);
+	context.report("checksum log round trip", roundTrip ? 1.0 : 0.0, "ok");
+	context.report("corrupt checksum log refused", refused ? 1.0 : 0.0, "ok");
+}
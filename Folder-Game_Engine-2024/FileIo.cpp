@@ -0,0 +1,15 @@
+#include "FileIo.h"
+
+namespace engine
+{
+	std::uint64_t bytesLeft(std::FILE* file)
+	{
+		long const position = std::ftell(file);
+		if(position < 0 || std::fseek(file, 0, SEEK_END) != 0)
+			return 0;
+		long const end = std::ftell(file);
+		if(std::fseek(file, position, SEEK_SET) != 0)
+			return 0;
+		return end > position ? static_cast<std::uint64_t>(end - position) : 0;
+	}
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+namespace engine
+{
+	// Bytes from the read position to the end of the file, 0 when seeking fails. Loaders check the counts and
+	// sizes in a header against this before allocating anything for them.
+	std::uint64_t bytesLeft(std::FILE* file);
+}
@@ -0,0 +1,59 @@
+#include "Fixed.h"
+
+namespace engine
+{
+	namespace
+	{
+		// Raw values of pi and its multiples
+		std::int32_t const pi = 205887;
+		std::int32_t const halfPi = 102944;
+		std::int64_t const twoPi = 411775;
+	}
+
+	Fixed sqrt(Fixed a)
+	{
+		if(a.raw <= 0)
+			return Fixed();
+
+		// sqrt(raw / 2^16) * 2^16 == sqrt(raw * 2^16). IEEE 754 requires sqrt to be correctly rounded and the input
+		// is exact in a double, so the estimate is the same everywhere, the integer fix-up makes it the exact floor.
+		std::uint64_t const value = static_cast<std::uint64_t>(a.raw) << Fixed::fractionBits;
+		std::uint64_t result = static_cast<std::uint64_t>(std::sqrt(static_cast<double>(value)));
+		while(result * result > value)
+			--result;
+		while((result + 1) * (result + 1) <= value)
+			++result;
+		return Fixed::fromRaw(static_cast<std::int32_t>(result));
+	}
+
+	Fixed sin(Fixed angle)
+	{
+		// Into [-pi, pi], then [-pi/2, pi/2] by symmetry around +-pi/2
+		std::int32_t x = static_cast<std::int32_t>(angle.raw % twoPi);
+		if(x > pi)
+			x -= static_cast<std::int32_t>(twoPi);
+		else if(x < -pi)
+			x += static_cast<std::int32_t>(twoPi);
+		if(x > halfPi)
+			x = pi - x;
+		else if(x < -halfPi)
+			x = -pi - x;
+
+		// Taylor series to x^9 in Q2.30, whose last term is below the resolution of the result
+		std::int64_t const x30 = static_cast<std::int64_t>(x) << 14;
+		std::int64_t const x2 = (x30 * x30) >> 30;
+		std::int64_t const one30 = std::int64_t(1) << 30;
+		std::int64_t series = one30 - x2 / 72;
+		series = one30 - ((x2 * series) >> 30) / 42;
+		series = one30 - ((x2 * series) >> 30) / 20;
+		series = one30 - ((x2 * series) >> 30) / 6;
+		std::int64_t const result = (x30 * series) >> 30;
+		return Fixed::fromRaw(static_cast<std::int32_t>((result + (1 << 13)) >> 14));
+	}
+
+	Fixed cos(Fixed angle)
+	{
+		// Through int64 so angles near the top of the range don't wrap
+		return sin(Fixed::fromRaw(static_cast<std::int32_t>((static_cast<std::int64_t>(angle.raw) + halfPi) % twoPi)));
+	}
+}
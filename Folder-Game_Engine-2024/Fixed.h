@@ -0,0 +1,159 @@
+#pragma once
+
+#include <glm.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace engine
+{
+	// Q16.16 fixed point number: about +-32768 with a resolution of 1/65536. Everything is integer arithmetic, so
+	// results are bit identical on any compiler, CPU and floating point mode, which lockstep simulation and replays
+	// rely on. Products round to nearest, quotients truncate and overflow wraps. Dividing by zero saturates towards
+	// the sign of the dividend (0 / 0 is 0) rather than trapping.
+	//
+	// Float simulation is only reproducible between runs of the same binary, and only with reductions that don't
+	// depend on the thread count (parallelReduce). Other builds may contract a * b + c into an FMA or call another
+	// libm for sin and cos, the same is true of glm's fast* approximations.
+	//
+	// It can be the component type of glm::vec and glm::mat, whose arithmetic operators work on any type. glm's
+	// geometric and trigonometric functions only accept floating point types, the overloads below replace them.
+	struct Fixed
+	{
+		static const int fractionBits = 16;
+		static const std::int32_t one = 1 << fractionBits;
+
+		std::int32_t raw;
+
+		// Uninitialized like a float, glm::vec needs a trivial default constructor. Fixed() is zero.
+		Fixed() = default;
+		constexpr explicit Fixed(int value) : raw(static_cast<std::int32_t>(static_cast<std::uint32_t>(value) << fractionBits)) {}
+		// Conversions from floating point are exact up to the rounding to 1/65536, keep them to setup code. Values out
+		// of range saturate and NaN is zero.
+		explicit Fixed(double value) : raw(rawFromDouble(value)) {}
+		explicit Fixed(float value) : Fixed(static_cast<double>(value)) {}
+
+		static Fixed fromRaw(std::int32_t raw)
+		{
+			Fixed result;
+			result.raw = raw;
+			return result;
+		}
+
+		explicit operator float() const { return static_cast<float>(raw) / one; }
+		explicit operator double() const { return static_cast<double>(raw) / one; }
+		// Rounds towards negative infinity
+		explicit operator int() const { return raw >> fractionBits; }
+
+		Fixed& operator+=(Fixed b) { raw = static_cast<std::int32_t>(static_cast<std::uint32_t>(raw) + static_cast<std::uint32_t>(b.raw)); return *this; }
+		Fixed& operator-=(Fixed b) { raw = static_cast<std::int32_t>(static_cast<std::uint32_t>(raw) - static_cast<std::uint32_t>(b.raw)); return *this; }
+		Fixed& operator*=(Fixed b) { raw = static_cast<std::int32_t>((static_cast<std::int64_t>(raw) * b.raw + (one >> 1)) >> fractionBits); return *this; }
+		Fixed& operator/=(Fixed b)
+		{
+			if(b.raw != 0)
+				raw = static_cast<std::int32_t>(static_cast<std::int64_t>(raw) * one / b.raw);
+			else if(raw != 0)
+				raw = raw > 0 ? std::numeric_limits<std::int32_t>::max() : std::numeric_limits<std::int32_t>::min();
+			return *this;
+		}
+
+	private:
+		static std::int32_t rawFromDouble(double value)
+		{
+			double const scaled = std::floor(value * one + 0.5);
+			if(scaled >= static_cast<double>(std::numeric_limits<std::int32_t>::max()))
+				return std::numeric_limits<std::int32_t>::max();
+			if(scaled <= static_cast<double>(std::numeric_limits<std::int32_t>::min()))
+				return std::numeric_limits<std::int32_t>::min();
+			// NaN fails both comparisons above and this one
+			return scaled == scaled ? static_cast<std::int32_t>(scaled) : 0;
+		}
+	};
+
+	inline Fixed operator+(Fixed a, Fixed b) { return a += b; }
+	inline Fixed operator-(Fixed a, Fixed b) { return a -= b; }
+	inline Fixed operator*(Fixed a, Fixed b) { return a *= b; }
+	inline Fixed operator/(Fixed a, Fixed b) { return a /= b; }
+	inline Fixed operator-(Fixed a) { return Fixed() - a; }
+	inline Fixed operator+(Fixed a) { return a; }
+
+	inline bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+	inline bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+	inline bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+	inline bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+	inline bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+	inline bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+
+	inline Fixed abs(Fixed a) { return a.raw < 0 ? -a : a; }
+	inline Fixed min(Fixed a, Fixed b) { return b < a ? b : a; }
+	inline Fixed max(Fixed a, Fixed b) { return a < b ? b : a; }
+	inline Fixed clamp(Fixed a, Fixed low, Fixed high) { return min(max(a, low), high); }
+
+	// Rounded down, 0 for negative inputs
+	Fixed sqrt(Fixed a);
+	// Angles in radians. Within about 2/65536 of the exact value over the first turns, the rounded 2 pi that wraps
+	// the angle adds 1/65536 every dozen turns after that: keep angles wrapped.
+	Fixed sin(Fixed angle);
+	Fixed cos(Fixed angle);
+
+	// Products are summed at full precision and rounded once
+	template<glm::length_t L, glm::qualifier Q>
+	Fixed dot(const glm::vec<L, Fixed, Q>& a, const glm::vec<L, Fixed, Q>& b)
+	{
+		std::int64_t sum = 0;
+		for(glm::length_t i = 0; i < L; ++i)
+			sum += static_cast<std::int64_t>(a[i].raw) * b[i].raw;
+		return Fixed::fromRaw(static_cast<std::int32_t>((sum + (Fixed::one >> 1)) >> Fixed::fractionBits));
+	}
+
+	template<glm::length_t L, glm::qualifier Q>
+	Fixed length(const glm::vec<L, Fixed, Q>& v)
+	{
+		return sqrt(dot(v, v));
+	}
+
+	template<glm::length_t L, glm::qualifier Q>
+	Fixed distance(const glm::vec<L, Fixed, Q>& a, const glm::vec<L, Fixed, Q>& b)
+	{
+		return length(b - a);
+	}
+
+	// The zero vector stays zero
+	template<glm::length_t L, glm::qualifier Q>
+	glm::vec<L, Fixed, Q> normalize(const glm::vec<L, Fixed, Q>& v)
+	{
+		Fixed const vectorLength = length(v);
+		return vectorLength.raw == 0 ? v : v / vectorLength;
+	}
+
+	template<glm::qualifier Q>
+	glm::vec<3, Fixed, Q> cross(const glm::vec<3, Fixed, Q>& a, const glm::vec<3, Fixed, Q>& b)
+	{
+		return glm::vec<3, Fixed, Q>(a.y * b.z - b.y * a.z, a.z * b.x - b.z * a.x, a.x * b.y - b.x * a.y);
+	}
+
+	typedef glm::vec<2, Fixed, glm::defaultp> FixedVec2;
+	typedef glm::vec<3, Fixed, glm::defaultp> FixedVec3;
+	typedef glm::vec<4, Fixed, glm::defaultp> FixedVec4;
+	typedef glm::mat<3, 3, Fixed, glm::defaultp> FixedMat3;
+	typedef glm::mat<4, 4, Fixed, glm::defaultp> FixedMat4;
+
+	template<glm::length_t L, glm::qualifier Q>
+	glm::vec<L, Fixed, Q> toFixed(const glm::vec<L, float, Q>& v)
+	{
+		glm::vec<L, Fixed, Q> result;
+		for(glm::length_t i = 0; i < L; ++i)
+			result[i] = Fixed(v[i]);
+		return result;
+	}
+
+	template<glm::length_t L, glm::qualifier Q>
+	glm::vec<L, float, Q> toFloat(const glm::vec<L, Fixed, Q>& v)
+	{
+		glm::vec<L, float, Q> result;
+		for(glm::length_t i = 0; i < L; ++i)
+			result[i] = static_cast<float>(v[i]);
+		return result;
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Material.h"
+
+#include <glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	struct DrawItem
+	{
+		glm::mat4 world;
+		std::uint32_t mesh;
+		std::uint32_t material;
+	};
+
+	struct PointLight
+	{
+		glm::vec3 position;
+		float radius;
+		glm::vec3 color;
+		float intensity;
+	};
+
+	// Lights the cone of half angle angle (radians) around direction, which is normalized, up to range
+	struct SpotLight
+	{
+		glm::vec3 position;
+		float range;
+		glm::vec3 direction;
+		float angle;
+		glm::vec3 color;
+		float intensity;
+	};
+
+	// Materials are kept by the renderer, the simulation only sends the ones it changed
+	struct MaterialUpdate
+	{
+		std::uint32_t material;
+		MaterialParams params;
+	};
+
+	// Everything the renderer needs for one frame. The simulation fills a packet and publishes it, after which
+	// it is only read by the render thread until it's handed back for reuse.
+	struct FramePacket
+	{
+		std::uint64_t frame;
+		std::chrono::steady_clock::time_point publishTime;
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec3 cameraPosition;
+		std::vector<DrawItem> draws;
+		std::vector<PointLight> lights;
+		std::vector<SpotLight> spotLights;
+		std::vector<MaterialUpdate> materials;
+
+		FramePacket() : frame(0), view(1.0f), projection(1.0f), cameraPosition(0.0f) {}
+
+		// Keeps the capacity of the arrays, packets are recycled every frame
+		void clear()
+		{
+			draws.clear();
+			lights.clear();
+			spotLights.clear();
+			materials.clear();
+		}
+	};
+}
@@ -0,0 +1,109 @@
+#include "GlDebugDraw.h"
+
+#if ENGINE_DEBUG_DRAW
+
+#include <gtc/type_ptr.hpp>
+
+namespace engine
+{
+	namespace
+	{
+		char const* const debugVertexShader = R"(
+			#version 330 core
+			layout(location = 0) in vec3 position;
+			layout(location = 1) in vec4 color;
+			uniform mat4 viewProjection;
+			out vec4 vertexColor;
+			void main()
+			{
+				vertexColor = color;
+				gl_Position = viewProjection * vec4(position, 1.0);
+			}
+		)";
+
+		char const* const debugFragmentShader = R"(
+			#version 330 core
+			in vec4 vertexColor;
+			out vec4 fragmentColor;
+			void main()
+			{
+				fragmentColor = vertexColor;
+			}
+		)";
+	}
+
+	GlDebugDraw::GlDebugDraw(StatsRegistry* stats) :
+		m_program(debugVertexShader, debugFragmentShader),
+		m_viewProjection(m_program.uniform("viewProjection")),
+		m_vertexArray(0),
+		m_vertexBuffer(0),
+		m_capacity(0),
+		m_stats(stats)
+	{
+		glGenVertexArrays(1, &m_vertexArray);
+		glGenBuffers(1, &m_vertexBuffer);
+		glBindVertexArray(m_vertexArray);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), reinterpret_cast<void*>(offsetof(DebugVertex, position)));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DebugVertex), reinterpret_cast<void*>(offsetof(DebugVertex, color)));
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	GlDebugDraw::~GlDebugDraw()
+	{
+		glDeleteBuffers(1, &m_vertexBuffer);
+		glDeleteVertexArrays(1, &m_vertexArray);
+	}
+
+	std::size_t GlDebugDraw::draw(const DebugLines& lines, const glm::mat4& viewProjection)
+	{
+		std::size_t const tested = lines.tested.size();
+		std::size_t const overlay = lines.overlay.size();
+		if(tested + overlay == 0 || !m_program.valid())
+			return 0;
+
+		// Orphaned every frame so the upload doesn't wait for last frame's draws, overlay lines after the tested ones
+		std::size_t const bytes = (tested + overlay) * sizeof(DebugVertex);
+		if(bytes > m_capacity)
+			m_capacity = bytes + bytes / 2;
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+		m_stats.bufferBinds.add();
+		glBufferData(GL_ARRAY_BUFFER, m_capacity, nullptr, GL_STREAM_DRAW);
+		if(tested > 0)
+			glBufferSubData(GL_ARRAY_BUFFER, 0, tested * sizeof(DebugVertex), lines.tested.data());
+		if(overlay > 0)
+			glBufferSubData(GL_ARRAY_BUFFER, tested * sizeof(DebugVertex), overlay * sizeof(DebugVertex), lines.overlay.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		m_program.use();
+		glUniformMatrix4fv(m_viewProjection, 1, GL_FALSE, glm::value_ptr(viewProjection));
+		glBindVertexArray(m_vertexArray);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glDepthMask(GL_FALSE);
+
+		std::size_t draws = 0;
+		if(tested > 0)
+		{
+			glEnable(GL_DEPTH_TEST);
+			glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(tested));
+			++draws;
+		}
+		if(overlay > 0)
+		{
+			glDisable(GL_DEPTH_TEST);
+			glDrawArrays(GL_LINES, static_cast<GLint>(tested), static_cast<GLsizei>(overlay));
+			glEnable(GL_DEPTH_TEST);
+			++draws;
+		}
+		glDepthMask(GL_TRUE);
+		glBindVertexArray(0);
+		m_stats.drawCalls.add(static_cast<std::int64_t>(draws));
+		return draws;
+	}
+}
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "DebugDraw.h"
+#include "Stats.h"
+
+#if ENGINE_DEBUG_DRAW
+#include "GlProgram.h"
+
+#include <glad/glad.h>
+#endif
+
+#include <cstddef>
+
+namespace engine
+{
+	// Draws the lines collected by DebugDraw with one GL_LINES call per depth mode, from a buffer refilled every
+	// frame. Depth writes are off for both, the tested lines only test against the depth the scene left.
+	// Needs a current GL context for its whole lifetime. With debug drawing compiled out it draws nothing and
+	// holds no GL objects.
+	class GlDebugDraw
+	{
+	public:
+#if ENGINE_DEBUG_DRAW
+		explicit GlDebugDraw(StatsRegistry* stats = nullptr);
+		~GlDebugDraw();
+
+		GlDebugDraw(const GlDebugDraw&) = delete;
+		GlDebugDraw& operator=(const GlDebugDraw&) = delete;
+
+		bool valid() const { return m_program.valid(); }
+
+		// Returns the number of draw calls. Alpha blending and depth testing are on afterwards.
+		std::size_t draw(const DebugLines& lines, const glm::mat4& viewProjection);
+
+	private:
+		GlProgram m_program;
+		GLint m_viewProjection;
+		GLuint m_vertexArray;
+		GLuint m_vertexBuffer;
+		std::size_t m_capacity;
+		RenderStatHandles m_stats;
+#else
+		explicit GlDebugDraw(StatsRegistry* = nullptr) {}
+
+		bool valid() const { return true; }
+		std::size_t draw(const DebugLines&, const glm::mat4&) { return 0; }
+#endif
+	};
+}
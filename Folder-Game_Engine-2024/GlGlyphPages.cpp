@@ -0,0 +1,63 @@
+#include "GlGlyphPages.h"
+#include "GlyphCache.h"
+
+namespace engine
+{
+	GlGlyphPages::~GlGlyphPages()
+	{
+		if(!m_textures.empty())
+			glDeleteTextures(static_cast<GLsizei>(m_textures.size()), m_textures.data());
+	}
+
+	void GlGlyphPages::upload(GlyphCache& glyphs)
+	{
+		GLsizei const pageSize = static_cast<GLsizei>(glyphs.pageSize());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, pageSize);
+		for(std::uint32_t page = 0; page < glyphs.pageCount(); ++page)
+		{
+			glm::uvec4 const rect = glyphs.uploadRect(page, m_textures.size());
+			if(rect.z <= rect.x || rect.w <= rect.y)
+				continue;
+
+			if(page == m_textures.size())
+			{
+				GLuint texture = 0;
+				glGenTextures(1, &texture);
+				glBindTexture(GL_TEXTURE_2D, texture);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, pageSize, pageSize, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+				m_textures.push_back(texture);
+			}
+			else
+			{
+				glBindTexture(GL_TEXTURE_2D, m_textures[page]);
+			}
+
+			// The skips pick the rectangle out of the whole page, they are set for every upload so a new page
+			// never starts reading at the corner of the dirty rectangle before it
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, static_cast<GLint>(rect.x));
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, static_cast<GLint>(rect.y));
+			glTexSubImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(rect.x), static_cast<GLint>(rect.y),
+				static_cast<GLsizei>(rect.z - rect.x), static_cast<GLsizei>(rect.w - rect.y), GL_RED, GL_UNSIGNED_BYTE, glyphs.pagePixels(page));
+			glyphs.markClean(page);
+		}
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void GlGlyphPages::appendPages(std::vector<GlSpritePage>& pages) const
+	{
+		for(GLuint texture : m_textures)
+		{
+			GlSpritePage const page = { texture, true };
+			pages.push_back(page);
+		}
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "GlSpriteRenderer.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace engine
+{
+	class GlyphCache;
+
+	// GL_R8 textures mirroring the pages of a GlyphCache. Only the dirty rectangle of each page is uploaded, a
+	// frame of text that was already cached uploads nothing. Needs a current GL context for its whole lifetime.
+	class GlGlyphPages
+	{
+	public:
+		GlGlyphPages() {}
+		~GlGlyphPages();
+
+		GlGlyphPages(const GlGlyphPages&) = delete;
+		GlGlyphPages& operator=(const GlGlyphPages&) = delete;
+
+		// Creates textures for new pages and uploads what changed in the others, then marks the pages clean
+		void upload(GlyphCache& glyphs);
+
+		std::size_t pageCount() const { return m_textures.size(); }
+		// Distance field pages for GlSpriteRenderer, in the order drawText numbers them from its firstPage
+		void appendPages(std::vector<GlSpritePage>& pages) const;
+
+	private:
+		std::vector<GLuint> m_textures;
+	};
+}
@@ -0,0 +1,72 @@
+#include "GlMaterialBuffers.h"
+
+namespace engine
+{
+	GlMaterialBuffers::GlMaterialBuffers(GLuint binding, StatsRegistry* stats) :
+		m_binding(binding),
+		m_boundBuffer(0),
+		m_boundOffset(0),
+		m_stats(stats)
+	{
+	}
+
+	GlMaterialBuffers::~GlMaterialBuffers()
+	{
+		if(!m_buffers.empty())
+			glDeleteBuffers(static_cast<GLsizei>(m_buffers.size()), m_buffers.data());
+	}
+
+	std::size_t GlMaterialBuffers::offsetAlignment()
+	{
+		GLint alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		return alignment > 0 ? static_cast<std::size_t>(alignment) : 256;
+	}
+
+	void GlMaterialBuffers::upload(MaterialLibrary& library)
+	{
+		// New pages go up whole with their latest contents, the dirty ranges only matter for the older ones
+		std::size_t const uploadedPages = m_buffers.size();
+		for(std::size_t page = uploadedPages; page < library.pageCount(); ++page)
+		{
+			GLuint buffer = 0;
+			glGenBuffers(1, &buffer);
+			glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+			m_stats.bufferBinds.add();
+			glBufferData(GL_UNIFORM_BUFFER, library.pageBytes(), library.pageData(page), GL_DYNAMIC_DRAW);
+			m_buffers.push_back(buffer);
+		}
+
+		library.dirtyRanges(m_ranges);
+		for(const DirtyRange& range : m_ranges)
+		{
+			if(range.page >= uploadedPages)
+				continue;
+			glBindBuffer(GL_UNIFORM_BUFFER, m_buffers[range.page]);
+			m_stats.bufferBinds.add();
+			glBufferSubData(GL_UNIFORM_BUFFER, range.begin, range.end - range.begin, library.pageData(range.page) + range.begin);
+		}
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		library.clearDirty();
+
+		// glBindBuffer on the generic target leaves the indexed binding alone, but anything else may have
+		// rebound it between frames
+		m_boundBuffer = 0;
+	}
+
+	void GlMaterialBuffers::bind(const MaterialLibrary& library, std::uint32_t material)
+	{
+		std::size_t const page = library.pageOf(material);
+		if(material >= library.size() || page >= m_buffers.size())
+			return;
+
+		std::size_t const offset = library.offsetOf(material);
+		if(m_buffers[page] == m_boundBuffer && offset == m_boundOffset)
+			return;
+
+		glBindBufferRange(GL_UNIFORM_BUFFER, m_binding, m_buffers[page], offset, sizeof(MaterialParams));
+		m_stats.bufferBinds.add();
+		m_boundBuffer = m_buffers[page];
+		m_boundOffset = offset;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Material.h"
+#include "Stats.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	// One GL_UNIFORM_BUFFER per page of a MaterialLibrary. Only the bytes written since the last upload are sent,
+	// and a draw selects its material with glBindBufferRange on the block's binding point instead of glUniform calls.
+	// Needs a current GL context for its whole lifetime.
+	class GlMaterialBuffers
+	{
+	public:
+		explicit GlMaterialBuffers(GLuint binding, StatsRegistry* stats = nullptr);
+		~GlMaterialBuffers();
+
+		GlMaterialBuffers(const GlMaterialBuffers&) = delete;
+		GlMaterialBuffers& operator=(const GlMaterialBuffers&) = delete;
+
+		// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, what a MaterialLibrary for this context has to be created with
+		static std::size_t offsetAlignment();
+
+		// Creates buffers for new pages and sends the dirty ranges of the others
+		void upload(MaterialLibrary& library);
+		// Skipped when the material's range is already bound
+		void bind(const MaterialLibrary& library, std::uint32_t material);
+
+	private:
+		GLuint m_binding;
+		std::vector<GLuint> m_buffers;
+		std::vector<DirtyRange> m_ranges;
+		GLuint m_boundBuffer;
+		std::size_t m_boundOffset;
+		RenderStatHandles m_stats;
+	};
+}
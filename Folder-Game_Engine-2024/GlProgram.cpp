@@ -0,0 +1,53 @@
+#include "GlProgram.h"
+
+namespace engine
+{
+	GlProgram::GlProgram(const char* vertexSource, const char* fragmentSource) :
+		m_program(0)
+	{
+		GLuint const vertex = compile(GL_VERTEX_SHADER, vertexSource);
+		GLuint const fragment = compile(GL_FRAGMENT_SHADER, fragmentSource);
+		if(vertex != 0 && fragment != 0)
+		{
+			m_program = glCreateProgram();
+			glAttachShader(m_program, vertex);
+			glAttachShader(m_program, fragment);
+			glLinkProgram(m_program);
+			GLint linked = GL_FALSE;
+			glGetProgramiv(m_program, GL_LINK_STATUS, &linked);
+			if(linked != GL_TRUE)
+			{
+				char log[1024] = {};
+				glGetProgramInfoLog(m_program, sizeof(log), nullptr, log);
+				m_log += log;
+				glDeleteProgram(m_program);
+				m_program = 0;
+			}
+		}
+		// Flagged for deletion, they go with the program
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+	}
+
+	GlProgram::~GlProgram()
+	{
+		glDeleteProgram(m_program);
+	}
+
+	GLuint GlProgram::compile(GLenum stage, const char* source)
+	{
+		GLuint const shader = glCreateShader(stage);
+		glShaderSource(shader, 1, &source, nullptr);
+		glCompileShader(shader);
+		GLint compiled = GL_FALSE;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+		if(compiled == GL_TRUE)
+			return shader;
+
+		char log[1024] = {};
+		glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+		m_log += log;
+		glDeleteShader(shader);
+		return 0;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string>
+
+namespace engine
+{
+	// Vertex and fragment shader linked into a program. Compile and link errors are kept in log() and leave the
+	// program invalid, using an invalid program draws nothing. Needs a current GL context for its whole lifetime.
+	class GlProgram
+	{
+	public:
+		GlProgram(const char* vertexSource, const char* fragmentSource);
+		~GlProgram();
+
+		GlProgram(const GlProgram&) = delete;
+		GlProgram& operator=(const GlProgram&) = delete;
+
+		bool valid() const { return m_program != 0; }
+		const std::string& log() const { return m_log; }
+
+		void use() const { glUseProgram(m_program); }
+		GLint uniform(const char* name) const { return m_program != 0 ? glGetUniformLocation(m_program, name) : -1; }
+
+	private:
+		GLuint compile(GLenum stage, const char* source);
+
+		GLuint m_program;
+		std::string m_log;
+	};
+}
@@ -0,0 +1,103 @@
+#include "GlRenderBackend.h"
+#include "GlMaterialBuffers.h"
+#include "GlTextureBuffer.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <gtx/buffer_layout.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+namespace engine
+{
+	// Read back in shaders as two RGBA32F texels, laid out like a std430 struct of two vec4
+	typedef glm::buffer_layout<glm::std430_layout, glm::vec3, float, glm::vec3, float> PointLightTexels;
+	static_assert(PointLightTexels::matches(offsetof(PointLight, position), offsetof(PointLight, radius), offsetof(PointLight, color), offsetof(PointLight, intensity))
+		&& sizeof(PointLight) == PointLightTexels::size() && PointLightTexels::size() == 2 * sizeof(glm::vec4), "PointLight is uploaded as two RGBA32F texels");
+
+	typedef glm::buffer_layout<glm::std430_layout, glm::vec3, float, glm::vec3, float, glm::vec3, float> SpotLightTexels;
+	static_assert(SpotLightTexels::matches(offsetof(SpotLight, position), offsetof(SpotLight, range), offsetof(SpotLight, direction),
+		offsetof(SpotLight, angle), offsetof(SpotLight, color), offsetof(SpotLight, intensity))
+		&& sizeof(SpotLight) == SpotLightTexels::size() && SpotLightTexels::size() == 3 * sizeof(glm::vec4), "SpotLight is uploaded as three RGBA32F texels");
+
+	GlRenderBackend::GlRenderBackend(GLFWwindow* window, JobSystem* jobs, StatsRegistry* stats) :
+		m_window(window),
+		m_jobs(jobs),
+		m_stats(stats),
+		m_loaded(false)
+	{
+		if(stats)
+			m_renderMs = stats->gauge("render.cpu_ms");
+	}
+
+	GlRenderBackend::~GlRenderBackend()
+	{
+	}
+
+	void GlRenderBackend::initialize()
+	{
+		glfwMakeContextCurrent(m_window);
+		m_loaded = gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)) != 0;
+		glfwSwapInterval(1);
+		if(!m_loaded)
+			return;
+
+		m_clusterRanges.reset(new GlTextureBuffer(GL_RG32UI, m_stats));
+		m_lightIndices.reset(new GlTextureBuffer(GL_R32UI, m_stats));
+		m_lights.reset(new GlTextureBuffer(GL_RGBA32F, m_stats));
+		m_materials.reset(new MaterialLibrary(GlMaterialBuffers::offsetAlignment()));
+		m_materialBuffers.reset(new GlMaterialBuffers(materialBinding, m_stats));
+	}
+
+	void GlRenderBackend::render(const FramePacket& packet)
+	{
+		if(!m_loaded)
+			return;
+
+		std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+		if(m_lightClusters.setProjection(packet.projection))
+		{
+			m_lightClusters.assign(packet.lights.data(), packet.lights.size(), packet.spotLights.data(), packet.spotLights.size(), packet.view, m_jobs);
+			m_clusterRanges->upload(m_lightClusters.clusterRanges().data(), m_lightClusters.clusterRanges().size() * sizeof(glm::uvec2));
+			m_lightIndices->upload(m_lightClusters.lightIndices().data(), m_lightClusters.lightIndices().size() * sizeof(std::uint32_t));
+
+			std::size_t const pointBytes = packet.lights.size() * sizeof(PointLight);
+			std::size_t const spotBytes = packet.spotLights.size() * sizeof(SpotLight);
+			m_lightTexels.resize((pointBytes + spotBytes) / sizeof(glm::vec4));
+			if(pointBytes > 0)
+				std::memcpy(m_lightTexels.data(), packet.lights.data(), pointBytes);
+			if(spotBytes > 0)
+				std::memcpy(reinterpret_cast<unsigned char*>(m_lightTexels.data()) + pointBytes, packet.spotLights.data(), spotBytes);
+			m_lights->upload(m_lightTexels.data(), pointBytes + spotBytes);
+		}
+
+		for(const MaterialUpdate& update : packet.materials)
+			m_materials->set(update.material, update.params);
+		m_materialBuffers->upload(*m_materials);
+
+		int width = 0;
+		int height = 0;
+		glfwGetFramebufferSize(m_window, &width, &height);
+		glViewport(0, 0, width, height);
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		m_renderMs.set(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	void GlRenderBackend::present()
+	{
+		glfwSwapBuffers(m_window);
+	}
+
+	void GlRenderBackend::shutdown()
+	{
+		// GL objects go while the context is still current
+		m_clusterRanges.reset();
+		m_lightIndices.reset();
+		m_lights.reset();
+		m_materialBuffers.reset();
+		glfwMakeContextCurrent(nullptr);
+	}
+}
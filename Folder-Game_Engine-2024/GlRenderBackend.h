@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ClusteredLights.h"
+#include "Material.h"
+#include "RenderBackend.h"
+#include "Stats.h"
+
+#include <memory>
+#include <vector>
+
+struct GLFWwindow;
+
+namespace engine
+{
+	class GlMaterialBuffers;
+	class GlTextureBuffer;
+
+	// Takes the window's GL context on the render thread. The window itself stays owned by the main thread,
+	// which keeps polling its events.
+	//
+	// The packet's lights are assigned to clusters every frame and uploaded as three texture buffers: per cluster
+	// offset and count (RG32UI), light indices (R32UI) and the lights themselves as RGBA32F texels: the point lights
+	// first, two texels each, then the spot lights, three texels each. An index i below the point light count reads
+	// texel 2 * i, the others read texel 2 * pointCount + 3 * (i - pointCount).
+	//
+	// Material updates from the packet land in a MaterialLibrary whose changed bytes are uploaded once per frame.
+	// The backend doesn't hold meshes or programs yet, so the packet's draws aren't issued. When they are, they go
+	// in sortByMaterial order and select their material with GlMaterialBuffers::bind on the Material block at
+	// materialBinding, and the light buffers with GlTextureBuffer::bind.
+	//
+	// With a StatsRegistry its buffers publish their binds under render.*, and every frame's CPU time in render is
+	// published as render.cpu_ms.
+	class GlRenderBackend : public RenderBackend
+	{
+	public:
+		static const unsigned materialBinding = 0;
+
+		explicit GlRenderBackend(GLFWwindow* window, JobSystem* jobs = nullptr, StatsRegistry* stats = nullptr);
+		~GlRenderBackend();
+
+		void initialize() override;
+		void render(const FramePacket& packet) override;
+		void present() override;
+		void shutdown() override;
+
+		bool loaded() const { return m_loaded; }
+
+	private:
+		GLFWwindow* m_window;
+		JobSystem* m_jobs;
+		StatsRegistry* m_stats;
+		StatGauge m_renderMs;
+		bool m_loaded;
+
+		ClusteredLights m_lightClusters;
+		std::unique_ptr<GlTextureBuffer> m_clusterRanges;
+		std::unique_ptr<GlTextureBuffer> m_lightIndices;
+		std::unique_ptr<GlTextureBuffer> m_lights;
+		std::vector<glm::vec4> m_lightTexels;
+		std::unique_ptr<MaterialLibrary> m_materials;
+		std::unique_ptr<GlMaterialBuffers> m_materialBuffers;
+	};
+}
@@ -0,0 +1,193 @@
+#include "GlSpriteRenderer.h"
+
+#include <gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace engine
+{
+	namespace
+	{
+		char const* const spriteVertexShader = R"(
+			#version 330 core
+			layout(location = 0) in vec2 position;
+			layout(location = 1) in vec2 uv;
+			layout(location = 2) in vec4 color;
+			uniform mat4 projection;
+			out vec2 vertexUv;
+			out vec4 vertexColor;
+			void main()
+			{
+				vertexUv = uv;
+				vertexColor = color;
+				gl_Position = projection * vec4(position, 0.0, 1.0);
+			}
+		)";
+
+		char const* const spriteFragmentShader = R"(
+			#version 330 core
+			uniform sampler2D page;
+			in vec2 vertexUv;
+			in vec4 vertexColor;
+			out vec4 fragmentColor;
+			void main()
+			{
+				fragmentColor = texture(page, vertexUv) * vertexColor;
+			}
+		)";
+
+		// The edge is antialiased over about a pixel on screen whatever the scale the glyph is drawn at
+		char const* const distanceFieldFragmentShader = R"(
+			#version 330 core
+			uniform sampler2D page;
+			in vec2 vertexUv;
+			in vec4 vertexColor;
+			out vec4 fragmentColor;
+			void main()
+			{
+				float distance = texture(page, vertexUv).r;
+				float width = max(fwidth(distance) * 0.7, 1e-4);
+				fragmentColor = vec4(vertexColor.rgb, vertexColor.a * smoothstep(0.5 - width, 0.5 + width, distance));
+			}
+		)";
+
+		// Waiting this long means the GPU is hung, the segment is overwritten anyway
+		GLuint64 const fenceTimeout = 1000000000;
+	}
+
+	GlSpriteRenderer::GlSpriteRenderer(std::size_t maxSprites, unsigned framesInFlight, StatsRegistry* stats) :
+		m_program(spriteVertexShader, spriteFragmentShader),
+		m_distanceFieldProgram(spriteVertexShader, distanceFieldFragmentShader),
+		m_projection(m_program.uniform("projection")),
+		m_distanceFieldProjection(m_distanceFieldProgram.uniform("projection")),
+		m_vertexArray(0),
+		m_vertexBuffer(0),
+		m_indexBuffer(0),
+		m_maxSprites(maxSprites),
+		m_segment(0),
+		m_fences(glm::max(framesInFlight, 1u), nullptr),
+		m_stats(stats)
+	{
+		glGenVertexArrays(1, &m_vertexArray);
+		glGenBuffers(1, &m_vertexBuffer);
+		glGenBuffers(1, &m_indexBuffer);
+		glBindVertexArray(m_vertexArray);
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, m_fences.size() * m_maxSprites * 4 * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), reinterpret_cast<void*>(offsetof(SpriteVertex, position)));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(SpriteVertex), reinterpret_cast<void*>(offsetof(SpriteVertex, uv)));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteVertex), reinterpret_cast<void*>(offsetof(SpriteVertex, color)));
+
+		std::vector<std::uint32_t> indices(m_maxSprites * 6);
+		for(std::size_t quad = 0; quad < m_maxSprites; ++quad)
+		{
+			std::uint32_t const base = static_cast<std::uint32_t>(quad * 4);
+			std::uint32_t const pattern[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+			std::copy(pattern, pattern + 6, indices.begin() + quad * 6);
+		}
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(std::uint32_t), indices.data(), GL_STATIC_DRAW);
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		m_program.use();
+		glUniform1i(m_program.uniform("page"), 0);
+		m_distanceFieldProgram.use();
+		glUniform1i(m_distanceFieldProgram.uniform("page"), 0);
+		glUseProgram(0);
+	}
+
+	GlSpriteRenderer::~GlSpriteRenderer()
+	{
+		for(GLsync fence : m_fences)
+			glDeleteSync(fence);
+		glDeleteBuffers(1, &m_indexBuffer);
+		glDeleteBuffers(1, &m_vertexBuffer);
+		glDeleteVertexArrays(1, &m_vertexArray);
+	}
+
+	std::size_t GlSpriteRenderer::draw(const SpriteBatch& batch, const glm::mat4& projection, const GlSpritePage* pages, std::size_t pageCount, JobSystem* jobs)
+	{
+		std::size_t const count = glm::min(batch.spriteCount(), m_maxSprites);
+		if(count == 0 || !valid())
+			return 0;
+
+		// The segment was last drawn from framesInFlight frames ago, its fence has nearly always passed
+		GLsync& fence = m_fences[m_segment];
+		if(fence)
+		{
+			glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, fenceTimeout);
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+
+		std::size_t const segmentVertices = m_maxSprites * 4;
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+		m_stats.bufferBinds.add();
+		void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, m_segment * segmentVertices * sizeof(SpriteVertex), count * 4 * sizeof(SpriteVertex),
+			GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+		if(!mapped)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			return 0;
+		}
+		batch.writeVertices(static_cast<SpriteVertex*>(mapped), 0, count, jobs);
+		bool const intact = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		if(!intact)
+			return 0;
+
+		glDisable(GL_DEPTH_TEST);
+		glDisable(GL_CULL_FACE);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		m_distanceFieldProgram.use();
+		glUniformMatrix4fv(m_distanceFieldProjection, 1, GL_FALSE, glm::value_ptr(projection));
+		m_program.use();
+		glUniformMatrix4fv(m_projection, 1, GL_FALSE, glm::value_ptr(projection));
+		glBindVertexArray(m_vertexArray);
+		glActiveTexture(GL_TEXTURE0);
+
+		std::size_t draws = 0;
+		GLuint bound = 0;
+		bool distanceField = false;
+		GLint const baseVertex = static_cast<GLint>(m_segment * segmentVertices);
+		for(const SpriteRange& range : batch.ranges())
+		{
+			if(range.first >= count || range.page >= pageCount)
+				continue;
+			const GlSpritePage& page = pages[range.page];
+			if(page.distanceField != distanceField)
+			{
+				distanceField = page.distanceField;
+				if(distanceField)
+					m_distanceFieldProgram.use();
+				else
+					m_program.use();
+			}
+			if(page.texture != bound)
+			{
+				bound = page.texture;
+				glBindTexture(GL_TEXTURE_2D, bound);
+				m_stats.textureBinds.add();
+			}
+			std::size_t const sprites = glm::min<std::size_t>(range.count, count - range.first);
+			glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(sprites * 6), GL_UNSIGNED_INT, reinterpret_cast<void*>(range.first * 6 * sizeof(std::uint32_t)), baseVertex);
+			++draws;
+			m_stats.triangles.add(static_cast<std::int64_t>(sprites * 2));
+		}
+		glBindVertexArray(0);
+		m_stats.drawCalls.add(static_cast<std::int64_t>(draws));
+
+		fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_segment = (m_segment + 1) % m_fences.size();
+		return draws;
+	}
+}
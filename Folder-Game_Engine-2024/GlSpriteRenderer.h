@@ -0,0 +1,55 @@
+#pragma once
+
+#include "GlProgram.h"
+#include "SpriteBatch.h"
+#include "Stats.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	struct GlSpritePage
+	{
+		GLuint texture;
+		bool distanceField; // Single channel distance field, glyphs from a GlyphCache for instance
+	};
+
+	// Draws a SpriteBatch with one call per range. The vertices are written straight into a buffer mapped with
+	// GL_MAP_UNSYNCHRONIZED_BIT, split in one segment per frame in flight and each guarded by a fence, the GL 3.3
+	// stand-in for a persistently mapped buffer: no copy, and the driver never waits on draws still reading it.
+	// Quads share one static index buffer, the segment is selected with the base vertex.
+	// Needs a current GL context for its whole lifetime.
+	class GlSpriteRenderer
+	{
+	public:
+		explicit GlSpriteRenderer(std::size_t maxSprites = 262144, unsigned framesInFlight = 3, StatsRegistry* stats = nullptr);
+		~GlSpriteRenderer();
+
+		GlSpriteRenderer(const GlSpriteRenderer&) = delete;
+		GlSpriteRenderer& operator=(const GlSpriteRenderer&) = delete;
+
+		bool valid() const { return m_program.valid() && m_distanceFieldProgram.valid(); }
+
+		// The batch must be sorted. pages are indexed by the sprites' page, sprites past maxSprites are dropped.
+		// Alpha blending is on and depth testing off afterwards. Returns the number of draw calls.
+		std::size_t draw(const SpriteBatch& batch, const glm::mat4& projection, const GlSpritePage* pages, std::size_t pageCount, JobSystem* jobs = nullptr);
+
+	private:
+		GlProgram m_program;
+		GlProgram m_distanceFieldProgram;
+		GLint m_projection;
+		GLint m_distanceFieldProjection;
+		GLuint m_vertexArray;
+		GLuint m_vertexBuffer;
+		GLuint m_indexBuffer;
+		std::size_t m_maxSprites;
+		unsigned m_segment;
+		std::vector<GLsync> m_fences;
+		RenderStatHandles m_stats;
+	};
+}
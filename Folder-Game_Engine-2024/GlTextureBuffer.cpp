@@ -0,0 +1,50 @@
+#include "GlTextureBuffer.h"
+
+namespace engine
+{
+	GlTextureBuffer::GlTextureBuffer(GLenum internalFormat, StatsRegistry* stats) :
+		m_internalFormat(internalFormat),
+		m_buffer(0),
+		m_texture(0),
+		m_capacity(0),
+		m_stats(stats)
+	{
+		glGenBuffers(1, &m_buffer);
+		glGenTextures(1, &m_texture);
+
+		// The texture follows the buffer object when its storage is reallocated, it's attached once.
+		// Binding the buffer first is what creates the object behind the name.
+		glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+		glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+		glTexBuffer(GL_TEXTURE_BUFFER, m_internalFormat, m_buffer);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	}
+
+	GlTextureBuffer::~GlTextureBuffer()
+	{
+		glDeleteTextures(1, &m_texture);
+		glDeleteBuffers(1, &m_buffer);
+	}
+
+	void GlTextureBuffer::upload(const void* data, std::size_t bytes)
+	{
+		// An empty texture buffer is invalid to sample, always keep some storage
+		std::size_t const size = bytes > 0 ? bytes : 16;
+		if(size > m_capacity)
+			m_capacity = size + size / 2;
+		glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+		m_stats.bufferBinds.add();
+		glBufferData(GL_TEXTURE_BUFFER, m_capacity, nullptr, GL_STREAM_DRAW);
+		if(bytes > 0)
+			glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	}
+
+	void GlTextureBuffer::bind(GLuint textureUnit) const
+	{
+		glActiveTexture(GL_TEXTURE0 + textureUnit);
+		glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+		m_stats.textureBinds.add();
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Stats.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+namespace engine
+{
+	// Buffer object viewed through a GL_TEXTURE_BUFFER texture, read in shaders with texelFetch on a samplerBuffer.
+	// Needs a current GL context for its whole lifetime.
+	class GlTextureBuffer
+	{
+	public:
+		explicit GlTextureBuffer(GLenum internalFormat, StatsRegistry* stats = nullptr);
+		~GlTextureBuffer();
+
+		GlTextureBuffer(const GlTextureBuffer&) = delete;
+		GlTextureBuffer& operator=(const GlTextureBuffer&) = delete;
+
+		// Orphans the previous storage so uploading doesn't wait for draws still reading it
+		void upload(const void* data, std::size_t bytes);
+		void bind(GLuint textureUnit) const;
+
+	private:
+		GLenum m_internalFormat;
+		GLuint m_buffer;
+		GLuint m_texture;
+		std::size_t m_capacity;
+		RenderStatHandles m_stats;
+	};
+}
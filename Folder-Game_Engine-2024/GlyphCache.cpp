@@ -0,0 +1,305 @@
+#include "GlyphCache.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace engine
+{
+	namespace
+	{
+		float const far = 1e20f;
+
+		// Where the parabolas rooted at samples q and p cross
+		float intersection(const float* f, int q, int p)
+		{
+			return ((f[q] + static_cast<float>(q * q)) - (f[p] + static_cast<float>(p * p))) / static_cast<float>(2 * (q - p));
+		}
+
+		// Squared distance of each sample to the nearest sample, f holding 0 at the feature samples and far elsewhere.
+		// The lower envelope of the parabolas rooted at each sample, v their positions and z the boundaries.
+		void distanceTransform(const float* f, int count, float* d, int* v, float* z)
+		{
+			int k = 0;
+			v[0] = 0;
+			z[0] = -far;
+			z[1] = far;
+			for(int q = 1; q < count; ++q)
+			{
+				float s = intersection(f, q, v[k]);
+				// z[0] is lower than any intersection, k stays positive
+				while(s <= z[k])
+					s = intersection(f, q, v[--k]);
+				++k;
+				v[k] = q;
+				z[k] = s;
+				z[k + 1] = far;
+			}
+			k = 0;
+			for(int q = 0; q < count; ++q)
+			{
+				while(z[k + 1] < static_cast<float>(q))
+					++k;
+				float const offset = static_cast<float>(q - v[k]);
+				d[q] = offset * offset + f[v[k]];
+			}
+		}
+
+		// 2D transform in place over a width by height grid, columns then rows
+		void distanceTransform(std::vector<float>& grid, int width, int height, std::vector<float>& scratch, std::vector<int>& v, std::vector<float>& z)
+		{
+			int const longest = std::max(width, height);
+			scratch.resize(longest * 2);
+			v.resize(longest);
+			z.resize(longest + 1);
+			float* const line = scratch.data();
+			float* const result = scratch.data() + longest;
+			for(int x = 0; x < width; ++x)
+			{
+				for(int y = 0; y < height; ++y)
+					line[y] = grid[y * width + x];
+				distanceTransform(line, height, result, v.data(), z.data());
+				for(int y = 0; y < height; ++y)
+					grid[y * width + x] = result[y];
+			}
+			for(int y = 0; y < height; ++y)
+			{
+				std::copy(grid.begin() + y * width, grid.begin() + (y + 1) * width, line);
+				distanceTransform(line, width, result, v.data(), z.data());
+				std::copy(result, result + width, grid.begin() + y * width);
+			}
+		}
+	}
+
+	std::uint32_t nextCodepoint(const char*& text)
+	{
+		unsigned char const lead = static_cast<unsigned char>(*text);
+		if(lead == 0)
+			return 0;
+		++text;
+		if(lead < 0x80)
+			return lead;
+
+		int length = 0;
+		std::uint32_t codepoint = 0;
+		if((lead & 0xE0) == 0xC0)
+		{
+			length = 1;
+			codepoint = lead & 0x1F;
+		}
+		else if((lead & 0xF0) == 0xE0)
+		{
+			length = 2;
+			codepoint = lead & 0x0F;
+		}
+		else if((lead & 0xF8) == 0xF0)
+		{
+			length = 3;
+			codepoint = lead & 0x07;
+		}
+		else
+			return 0xFFFD;
+
+		for(int i = 0; i < length; ++i)
+		{
+			unsigned char const next = static_cast<unsigned char>(*text);
+			// A truncated sequence stops before the next lead byte or the terminator
+			if((next & 0xC0) != 0x80)
+				return 0xFFFD;
+			codepoint = codepoint << 6 | (next & 0x3F);
+			++text;
+		}
+		return codepoint <= 0x10FFFF ? codepoint : 0xFFFD;
+	}
+
+	void generateDistanceField(const std::uint8_t* coverage, unsigned width, unsigned height, unsigned spread, std::vector<std::uint8_t>& field)
+	{
+		int const fieldWidth = static_cast<int>(width + spread * 2);
+		int const fieldHeight = static_cast<int>(height + spread * 2);
+		std::size_t const size = static_cast<std::size_t>(fieldWidth) * fieldHeight;
+		std::vector<float> inside(size, 0.0f);
+		std::vector<float> outside(size, far);
+		for(unsigned y = 0; y < height; ++y)
+		{
+			for(unsigned x = 0; x < width; ++x)
+			{
+				if(coverage[y * width + x] < 128)
+					continue;
+				std::size_t const index = (y + spread) * fieldWidth + x + spread;
+				inside[index] = far;
+				outside[index] = 0.0f;
+			}
+		}
+
+		std::vector<float> scratch;
+		std::vector<int> v;
+		std::vector<float> z;
+		// Distance to the nearest pixel outside for pixels inside, and the other way around
+		distanceTransform(inside, fieldWidth, fieldHeight, scratch, v, z);
+		distanceTransform(outside, fieldWidth, fieldHeight, scratch, v, z);
+
+		field.resize(size);
+		float const scale = 127.0f / static_cast<float>(glm::max(spread, 1u));
+		for(std::size_t i = 0; i < size; ++i)
+		{
+			// Neighboring pixel centers are a pixel apart across an edge halfway between them
+			float const distance = inside[i] > 0.0f ? glm::sqrt(inside[i]) - 0.5f : 0.5f - glm::sqrt(outside[i]);
+			field[i] = static_cast<std::uint8_t>(glm::clamp(128.0f + distance * scale, 0.0f, 255.0f) + 0.5f);
+		}
+	}
+
+	GlyphCache::GlyphCache(const GlyphRasterizer& rasterizer, unsigned spread, unsigned pageSize, unsigned maxPages) :
+		m_rasterizer(rasterizer),
+		m_spread(spread),
+		m_atlas(pageSize, maxPages),
+		m_frame(0)
+	{
+		m_stats.generated = 0;
+		m_stats.evictedPages = 0;
+		m_stats.overflows = 0;
+	}
+
+	void GlyphCache::generate(Generated& glyph) const
+	{
+		GlyphBitmap bitmap;
+		bitmap.width = 0;
+		bitmap.height = 0;
+		bitmap.metrics.offset = glm::vec2(0.0f);
+		bitmap.metrics.size = glm::vec2(0.0f);
+		bitmap.metrics.advance = 0.0f;
+		glyph.found = m_rasterizer.rasterize(glyph.codepoint, bitmap);
+		glyph.width = 0;
+		glyph.height = 0;
+		glyph.metrics = bitmap.metrics;
+		if(!glyph.found || bitmap.width == 0 || bitmap.height == 0)
+			return;
+
+		generateDistanceField(bitmap.coverage.data(), bitmap.width, bitmap.height, m_spread, glyph.field);
+		glyph.width = bitmap.width + m_spread * 2;
+		glyph.height = bitmap.height + m_spread * 2;
+		glyph.metrics.offset -= glm::vec2(static_cast<float>(m_spread));
+		glyph.metrics.size = glm::vec2(static_cast<float>(glyph.width), static_cast<float>(glyph.height));
+	}
+
+	bool GlyphCache::evictPage()
+	{
+		std::size_t oldest = m_pages.size();
+		for(std::size_t page = 0; page < m_pages.size(); ++page)
+		{
+			if(m_pages[page].lastUsed < m_frame && (oldest == m_pages.size() || m_pages[page].lastUsed < m_pages[oldest].lastUsed))
+				oldest = page;
+		}
+		if(oldest == m_pages.size())
+			return false;
+
+		Page& page = m_pages[oldest];
+		for(std::uint32_t codepoint : page.glyphs)
+			m_glyphs.erase(codepoint);
+		page.glyphs.clear();
+		// Stale padding would bleed into the glyphs packed next to it
+		std::fill(page.pixels.begin(), page.pixels.end(), 0);
+		page.dirty = glm::uvec4(0, 0, m_atlas.pageSize(), m_atlas.pageSize());
+		m_atlas.clearPage(static_cast<std::uint32_t>(oldest));
+		++m_stats.evictedPages;
+		return true;
+	}
+
+	const CachedGlyph* GlyphCache::insert(Generated& glyph)
+	{
+		if(!glyph.found)
+		{
+			m_missing.insert(glyph.codepoint);
+			return nullptr;
+		}
+
+		CachedGlyph cached;
+		cached.region.page = 0;
+		cached.region.position = glm::uvec2(0);
+		cached.region.size = glm::uvec2(0);
+		cached.region.uv = glm::vec4(0.0f);
+		cached.metrics = glyph.metrics;
+		cached.lastUsed = m_frame;
+		if(glyph.width > 0)
+		{
+			bool const fits = glyph.width <= m_atlas.pageSize() && glyph.height <= m_atlas.pageSize();
+			if(!fits || (!m_atlas.allocate(glyph.width, glyph.height, cached.region) && (!evictPage() || !m_atlas.allocate(glyph.width, glyph.height, cached.region))))
+			{
+				// Not generated again before the next frame
+				m_overflowed.insert(glyph.codepoint);
+				++m_stats.overflows;
+				return nullptr;
+			}
+
+			unsigned const pageSize = m_atlas.pageSize();
+			while(m_pages.size() <= cached.region.page)
+			{
+				Page page;
+				page.pixels.assign(static_cast<std::size_t>(pageSize) * pageSize, 0);
+				page.lastUsed = m_frame;
+				page.dirty = glm::uvec4(0);
+				m_pages.push_back(page);
+			}
+			Page& page = m_pages[cached.region.page];
+			glm::uvec2 const low = cached.region.position;
+			glm::uvec2 const high = low + cached.region.size;
+			for(unsigned y = 0; y < glyph.height; ++y)
+				std::memcpy(&page.pixels[(low.y + y) * pageSize + low.x], &glyph.field[y * glyph.width], glyph.width);
+			page.glyphs.push_back(glyph.codepoint);
+			page.lastUsed = m_frame;
+			page.dirty = page.dirty.z > page.dirty.x ? glm::uvec4(glm::min(glm::uvec2(page.dirty), low), glm::max(glm::uvec2(page.dirty.z, page.dirty.w), high)) : glm::uvec4(low, high);
+		}
+		++m_stats.generated;
+		return &(m_glyphs[glyph.codepoint] = cached);
+	}
+
+	void GlyphCache::prepare(const char* text, JobSystem* jobs)
+	{
+		std::vector<Generated> pending;
+		std::unordered_set<std::uint32_t> seen;
+		while(std::uint32_t const codepoint = nextCodepoint(text))
+		{
+			// Glyphs already cached are marked used first, so making room for the new ones doesn't evict them
+			std::unordered_map<std::uint32_t, CachedGlyph>::iterator found = m_glyphs.find(codepoint);
+			if(found != m_glyphs.end())
+			{
+				touch(found->second);
+				continue;
+			}
+			if(m_missing.count(codepoint) != 0 || m_overflowed.count(codepoint) != 0 || !seen.insert(codepoint).second)
+				continue;
+			pending.push_back(Generated());
+			pending.back().codepoint = codepoint;
+		}
+
+		parallelFor(jobs, pending.size(), 4, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t i = begin; i < end; ++i)
+				generate(pending[i]);
+		});
+		for(Generated& glyph : pending)
+			insert(glyph);
+	}
+
+	const CachedGlyph* GlyphCache::glyph(std::uint32_t codepoint)
+	{
+		std::unordered_map<std::uint32_t, CachedGlyph>::iterator found = m_glyphs.find(codepoint);
+		if(found == m_glyphs.end())
+		{
+			if(m_missing.count(codepoint) != 0 || m_overflowed.count(codepoint) != 0)
+				return nullptr;
+			Generated glyph = Generated();
+			glyph.codepoint = codepoint;
+			generate(glyph);
+			return insert(glyph);
+		}
+		touch(found->second);
+		return &found->second;
+	}
+
+	void GlyphCache::touch(CachedGlyph& glyph)
+	{
+		glyph.lastUsed = m_frame;
+		if(glyph.region.size.x > 0)
+			m_pages[glyph.region.page].lastUsed = m_frame;
+	}
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "TextureAtlas.h"
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	// Pixels at the rasterizer's size, y down from the pen position on the baseline
+	struct GlyphMetrics
+	{
+		glm::vec2 offset;  // Top-left corner of the bitmap
+		glm::vec2 size;
+		float advance;
+	};
+
+	struct GlyphBitmap
+	{
+		unsigned width;
+		unsigned height;
+		std::vector<std::uint8_t> coverage; // Row by row, 255 fully inside the glyph
+		GlyphMetrics metrics;
+	};
+
+	// Source of glyph shapes for a GlyphCache, a font loaded with a TrueType rasterizer for instance. Glyphs are
+	// rasterized once at pixelSize and scaled from the distance field afterwards, 32 to 64 pixels keeps the
+	// corners sharp. rasterize is called from several jobs at once.
+	class GlyphRasterizer
+	{
+	public:
+		virtual ~GlyphRasterizer() {}
+
+		virtual unsigned pixelSize() const = 0;
+		virtual float ascent() const = 0;
+		virtual float lineHeight() const = 0;
+		// False if the font has no glyph for the codepoint. Glyphs without an outline, spaces, leave the bitmap empty.
+		virtual bool rasterize(std::uint32_t codepoint, GlyphBitmap& bitmap) const = 0;
+		virtual float kerning(std::uint32_t /*left*/, std::uint32_t /*right*/) const { return 0.0f; }
+	};
+
+	// Next codepoint of a UTF-8 string, 0 at its end. Malformed sequences give U+FFFD.
+	std::uint32_t nextCodepoint(const char*& text);
+
+	// Signed distance field of a coverage bitmap, grown by spread pixels on each side. Distances to the 50%
+	// coverage edge from -spread outside to spread inside map to 0 to 255, 128 on the edge. Exact euclidean
+	// distances from two separable transforms (Felzenszwalb and Huttenlocher 2012), linear in the pixel count.
+	void generateDistanceField(const std::uint8_t* coverage, unsigned width, unsigned height, unsigned spread, std::vector<std::uint8_t>& field);
+
+	struct CachedGlyph
+	{
+		AtlasRegion region;    // Empty for glyphs without an outline
+		GlyphMetrics metrics;  // Of the distance field, so including the spread
+		std::uint64_t lastUsed;
+	};
+
+	struct GlyphCacheStats
+	{
+		std::size_t generated;
+		std::size_t evictedPages;
+		std::size_t overflows; // Glyphs dropped because every page held glyphs used this frame
+	};
+
+	// Distance field glyphs generated on first use into single channel atlas pages kept on the CPU, uploaded by
+	// the renderer from each page's dirty rectangle. When every page is full the least recently used page is
+	// cleared and its glyphs generated again when next needed. Pages with glyphs used during the current frame
+	// are never cleared, sprites already batched still point into them, so the glyphs of a frame should fit in
+	// about half the pages or new ones start to overflow.
+	class GlyphCache
+	{
+	public:
+		GlyphCache(const GlyphRasterizer& rasterizer, unsigned spread = 6, unsigned pageSize = 1024, unsigned maxPages = 4);
+
+		GlyphCache(const GlyphCache&) = delete;
+		GlyphCache& operator=(const GlyphCache&) = delete;
+
+		const GlyphRasterizer& rasterizer() const { return m_rasterizer; }
+		unsigned spread() const { return m_spread; }
+
+		// Starts a new frame for the recency of glyphs, glyphs that overflowed are tried again
+		void nextFrame()
+		{
+			++m_frame;
+			m_overflowed.clear();
+		}
+
+		// Generates the glyphs of a UTF-8 string missing from the cache across jobs, so a screen of new text
+		// doesn't rasterize one glyph at a time on the calling thread
+		void prepare(const char* text, JobSystem* jobs = nullptr);
+		// Null if the font has no such glyph or the atlas overflowed. Generated on the calling thread if missing,
+		// invalid after the next call that generates glyphs.
+		const CachedGlyph* glyph(std::uint32_t codepoint);
+		// Whether a null glyph is only missing until the next frame
+		bool overflowed(std::uint32_t codepoint) const { return m_overflowed.count(codepoint) != 0; }
+
+		unsigned pageSize() const { return m_atlas.pageSize(); }
+		std::size_t pageCount() const { return m_pages.size(); }
+		const std::uint8_t* pagePixels(std::uint32_t page) const { return m_pages[page].pixels.data(); }
+		// Min and max corners of the pixels changed since the page was last marked clean, empty when max <= min
+		glm::uvec4 dirtyRect(std::uint32_t page) const { return m_pages[page].dirty; }
+		void markClean(std::uint32_t page) { m_pages[page].dirty = glm::uvec4(0); }
+		// What a renderer holding textures for the first uploadedPages pages sends for page: the whole page if it
+		// has no texture yet, else the dirty rectangle
+		glm::uvec4 uploadRect(std::uint32_t page, std::size_t uploadedPages) const
+		{
+			return page >= uploadedPages ? glm::uvec4(0, 0, pageSize(), pageSize()) : dirtyRect(page);
+		}
+
+		const GlyphCacheStats& stats() const { return m_stats; }
+
+	private:
+		struct Page
+		{
+			std::vector<std::uint8_t> pixels;
+			std::vector<std::uint32_t> glyphs;
+			std::uint64_t lastUsed;
+			glm::uvec4 dirty;
+		};
+
+		struct Generated
+		{
+			std::uint32_t codepoint;
+			bool found;
+			unsigned width;
+			unsigned height;
+			std::vector<std::uint8_t> field;
+			GlyphMetrics metrics;
+		};
+
+		void generate(Generated& glyph) const;
+		const CachedGlyph* insert(Generated& glyph);
+		bool evictPage();
+		void touch(CachedGlyph& glyph);
+
+		const GlyphRasterizer& m_rasterizer;
+		unsigned m_spread;
+		TextureAtlas m_atlas;
+		std::vector<Page> m_pages;
+		std::unordered_map<std::uint32_t, CachedGlyph> m_glyphs;
+		std::unordered_set<std::uint32_t> m_missing;
+		std::unordered_set<std::uint32_t> m_overflowed;
+		std::uint64_t m_frame;
+		GlyphCacheStats m_stats;
+	};
+}
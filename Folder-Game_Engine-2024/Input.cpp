@@ -0,0 +1,315 @@
+#include "Input.h"
+#include "FileIo.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace engine
+{
+	namespace
+	{
+		char const logMagic[4] = { 'I', 'L', 'O', 'G' };
+		std::uint32_t const logVersion = 1;
+
+		// Entries are written as they are in memory, the layout is part of the file format
+		static_assert(sizeof(InputLog::Entry) == 32, "InputLog::Entry layout changed, bump logVersion");
+
+		// Checks a loaded entry through its bytes, a bool holding anything but 0 or 1 can't be read
+		bool validEntry(const InputLog::Entry& entry)
+		{
+			const unsigned char* const bytes = reinterpret_cast<const unsigned char*>(&entry.event);
+			unsigned char const type = bytes[offsetof(InputEvent, type)];
+			unsigned char const down = bytes[offsetof(InputEvent, down)];
+			return type <= static_cast<unsigned char>(InputEvent::Type::Scroll) && down <= 1 && entry.event.button < inputButtonCount;
+		}
+
+		InputQueue& queueOf(GLFWwindow* window)
+		{
+			return *static_cast<InputQueue*>(glfwGetWindowUserPointer(window));
+		}
+
+		void postButton(GLFWwindow* window, InputButton button, int action)
+		{
+			// Repeats carry no new state
+			if(action == GLFW_REPEAT)
+				return;
+
+			InputQueue& queue = queueOf(window);
+			InputEvent event = {};
+			event.type = InputEvent::Type::Button;
+			event.down = action == GLFW_PRESS;
+			event.button = button;
+			event.value = glm::vec2(0.0f);
+			event.time = queue.now();
+			queue.post(event);
+		}
+
+		void keyCallback(GLFWwindow* window, int key, int, int action, int)
+		{
+			if(key >= 0 && key < mouseButtonBase)
+				postButton(window, static_cast<InputButton>(key), action);
+		}
+
+		void mouseButtonCallback(GLFWwindow* window, int button, int action, int)
+		{
+			if(button >= 0 && button < inputButtonCount - mouseButtonBase)
+				postButton(window, mouseButton(button), action);
+		}
+
+		void postValue(GLFWwindow* window, InputEvent::Type type, double x, double y)
+		{
+			InputQueue& queue = queueOf(window);
+			InputEvent event = {};
+			event.type = type;
+			event.down = false;
+			event.button = 0;
+			event.value = glm::vec2(static_cast<float>(x), static_cast<float>(y));
+			event.time = queue.now();
+			queue.post(event);
+		}
+
+		void cursorCallback(GLFWwindow* window, double x, double y)
+		{
+			postValue(window, InputEvent::Type::Cursor, x, y);
+		}
+
+		void scrollCallback(GLFWwindow* window, double x, double y)
+		{
+			postValue(window, InputEvent::Type::Scroll, x, y);
+		}
+	}
+
+	InputQueue::InputQueue(std::size_t capacity) :
+		m_events(capacity),
+		m_start(std::chrono::steady_clock::now()),
+		m_dropped(0)
+	{
+	}
+
+	void InputQueue::attach(GLFWwindow* window)
+	{
+		glfwSetWindowUserPointer(window, this);
+		glfwSetKeyCallback(window, keyCallback);
+		glfwSetMouseButtonCallback(window, mouseButtonCallback);
+		glfwSetCursorPosCallback(window, cursorCallback);
+		glfwSetScrollCallback(window, scrollCallback);
+	}
+
+	void InputQueue::post(const InputEvent& event)
+	{
+		if(!m_events.push(event))
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	std::uint64_t InputQueue::now() const
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+	}
+
+	ActionMap::ActionState& ActionMap::action(std::uint32_t action)
+	{
+		if(action >= m_actions.size())
+		{
+			ActionState const idle = { 0, false, false };
+			m_actions.resize(action + 1, idle);
+		}
+		return m_actions[action];
+	}
+
+	void ActionMap::press(std::uint32_t action)
+	{
+		ActionState& state = m_actions[action];
+		if(state.heldCount++ == 0)
+			state.pressed = true;
+	}
+
+	void ActionMap::release(std::uint32_t action)
+	{
+		ActionState& state = m_actions[action];
+		if(state.heldCount > 0 && --state.heldCount == 0)
+			state.released = true;
+	}
+
+	void ActionMap::bindButton(std::uint32_t action, InputButton button)
+	{
+		this->action(action);
+		Binding const binding = { button, action };
+		m_bindings.push_back(binding);
+	}
+
+	bool ActionMap::bindChord(std::uint32_t action, std::initializer_list<InputButton> buttons, std::uint64_t windowMicroseconds)
+	{
+		for(InputButton button : buttons)
+		{
+			if(button >= inputButtonCount)
+				return false;
+		}
+
+		this->action(action);
+		Chord chord;
+		chord.buttons.assign(buttons.begin(), buttons.end());
+		chord.action = action;
+		chord.window = windowMicroseconds;
+		chord.active = false;
+		m_chords.push_back(chord);
+		return true;
+	}
+
+	void ActionMap::beginTick()
+	{
+		for(ActionState& state : m_actions)
+		{
+			state.pressed = false;
+			state.released = false;
+		}
+		m_tickCursor = m_cursor;
+		m_scroll = glm::vec2(0.0f);
+	}
+
+	void ActionMap::apply(const InputEvent& event)
+	{
+		if(event.type == InputEvent::Type::Cursor)
+		{
+			m_cursor = event.value;
+			return;
+		}
+		if(event.type == InputEvent::Type::Scroll)
+		{
+			m_scroll += event.value;
+			return;
+		}
+
+		// Ignore events that don't change the state, such as a release whose press happened before the window had focus
+		if(event.button >= inputButtonCount || (m_buttonHeld[event.button] != 0) == event.down)
+			return;
+		m_buttonHeld[event.button] = event.down ? 1 : 0;
+		if(event.down)
+			m_buttonDownTime[event.button] = event.time;
+
+		for(const Binding& binding : m_bindings)
+		{
+			if(binding.button != event.button)
+				continue;
+			if(event.down)
+				press(binding.action);
+			else
+				release(binding.action);
+		}
+
+		for(Chord& chord : m_chords)
+		{
+			if(std::find(chord.buttons.begin(), chord.buttons.end(), event.button) == chord.buttons.end())
+				continue;
+
+			if(!event.down)
+			{
+				if(chord.active)
+					release(chord.action);
+				chord.active = false;
+				continue;
+			}
+
+			std::uint64_t first = event.time;
+			bool complete = true;
+			for(InputButton button : chord.buttons)
+			{
+				complete = complete && m_buttonHeld[button] != 0;
+				first = std::min(first, m_buttonDownTime[button]);
+			}
+			if(complete && !chord.active && event.time - first <= chord.window)
+			{
+				chord.active = true;
+				press(chord.action);
+			}
+		}
+	}
+
+	void InputLog::record(std::uint64_t tick, const InputEvent& event)
+	{
+		// Entries are saved as raw bytes, so the padding is zeroed rather than copied from the event
+		Entry entry;
+		std::memset(&entry, 0, sizeof(entry));
+		entry.tick = tick;
+		entry.event.type = event.type;
+		entry.event.down = event.down;
+		entry.event.button = event.button;
+		entry.event.value = event.value;
+		entry.event.time = event.time;
+		m_entries.push_back(entry);
+	}
+
+	void InputLog::clear()
+	{
+		m_entries.clear();
+		m_cursor = 0;
+	}
+
+	void InputLog::playTick(std::uint64_t tick, ActionMap& actions)
+	{
+		actions.beginTick();
+		while(m_cursor < m_entries.size() && m_entries[m_cursor].tick <= tick)
+			actions.apply(m_entries[m_cursor++].event);
+	}
+
+	bool InputLog::save(const std::string& path) const
+	{
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+		if(!file)
+			return false;
+
+		std::uint64_t const count = m_entries.size();
+		bool ok = std::fwrite(logMagic, sizeof(logMagic), 1, file) == 1;
+		ok = ok && std::fwrite(&logVersion, sizeof(logVersion), 1, file) == 1;
+		ok = ok && std::fwrite(&count, sizeof(count), 1, file) == 1;
+		ok = ok && (count == 0 || std::fwrite(m_entries.data(), sizeof(Entry), m_entries.size(), file) == m_entries.size());
+		return std::fclose(file) == 0 && ok;
+	}
+
+	bool InputLog::load(const std::string& path)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if(!file)
+			return false;
+
+		char magic[4] = {};
+		std::uint32_t version = 0;
+		std::uint64_t count = 0;
+		bool ok = std::fread(magic, sizeof(magic), 1, file) == 1
+			&& std::fread(&version, sizeof(version), 1, file) == 1
+			&& std::fread(&count, sizeof(count), 1, file) == 1
+			&& std::equal(magic, magic + 4, logMagic)
+			&& version == logVersion;
+		// Only as many entries as the file has bytes for, whatever the header says
+		ok = ok && count <= bytesLeft(file) / sizeof(Entry);
+
+		std::vector<Entry> entries;
+		if(ok)
+		{
+			entries.resize(static_cast<std::size_t>(count));
+			ok = count == 0 || std::fread(entries.data(), sizeof(Entry), entries.size(), file) == entries.size();
+			ok = ok && std::all_of(entries.begin(), entries.end(), validEntry);
+		}
+		std::fclose(file);
+		if(!ok)
+			return false;
+
+		m_entries.swap(entries);
+		m_cursor = 0;
+		return true;
+	}
+
+	void consumeInput(InputQueue& queue, ActionMap& actions, InputLog* log, std::uint64_t tick)
+	{
+		actions.beginTick();
+		InputEvent event;
+		while(queue.pop(event))
+		{
+			if(log)
+				log->record(tick, event);
+			actions.apply(event);
+		}
+	}
+}
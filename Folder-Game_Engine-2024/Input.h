@@ -0,0 +1,154 @@
+#pragma once
+
+#include "SpscQueue.h"
+
+#include <glm.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+struct GLFWwindow;
+
+namespace engine
+{
+	// Keys use their GLFW key code, mouse buttons are placed after the last key
+	typedef std::uint16_t InputButton;
+	InputButton const mouseButtonBase = 512;
+	InputButton const inputButtonCount = mouseButtonBase + 8;
+
+	inline InputButton mouseButton(int button) { return static_cast<InputButton>(mouseButtonBase + button); }
+
+	struct InputEvent
+	{
+		enum class Type : std::uint8_t
+		{
+			Button,
+			Cursor,
+			Scroll
+		};
+
+		Type type;
+		bool down;
+		InputButton button;
+		glm::vec2 value;     // Cursor position or scroll offset
+		std::uint64_t time;  // Microseconds since the queue was created
+	};
+
+	// Timestamps events in the GLFW callbacks, which run inside glfwPollEvents on the main thread, and hands them
+	// to the simulation thread through a lock-free ring. Nothing else happens in the callbacks.
+	class InputQueue
+	{
+	public:
+		explicit InputQueue(std::size_t capacity = 4096);
+
+		// Installs the key, mouse button, cursor and scroll callbacks and sets the window user pointer
+		void attach(GLFWwindow* window);
+
+		// Producer side, events are dropped and counted when the consumer falls behind
+		void post(const InputEvent& event);
+		std::uint64_t now() const;
+		std::size_t droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+		// Consumer side
+		bool pop(InputEvent& event) { return m_events.pop(event); }
+
+	private:
+		SpscQueue<InputEvent> m_events;
+		std::chrono::steady_clock::time_point m_start;
+		std::atomic<std::size_t> m_dropped;
+	};
+
+	// Maps buttons to game actions, which are small integers chosen by the game.
+	// A chord triggers when all its buttons are held and went down within its window of each other, in any order.
+	class ActionMap
+	{
+	public:
+		void bindButton(std::uint32_t action, InputButton button);
+		// Returns false and binds nothing if a button is out of range
+		bool bindChord(std::uint32_t action, std::initializer_list<InputButton> buttons, std::uint64_t windowMicroseconds);
+
+		// Clears the pressed and released flags and the scroll, call once per tick before applying the tick's events
+		void beginTick();
+		void apply(const InputEvent& event);
+
+		bool held(std::uint32_t action) const { return action < m_actions.size() && m_actions[action].heldCount > 0; }
+		bool pressed(std::uint32_t action) const { return action < m_actions.size() && m_actions[action].pressed; }
+		bool released(std::uint32_t action) const { return action < m_actions.size() && m_actions[action].released; }
+		bool buttonHeld(InputButton button) const { return button < inputButtonCount && m_buttonHeld[button] != 0; }
+
+		glm::vec2 cursor() const { return m_cursor; }
+		glm::vec2 cursorDelta() const { return m_cursor - m_tickCursor; }
+		glm::vec2 scroll() const { return m_scroll; }
+
+	private:
+		struct ActionState
+		{
+			int heldCount;
+			bool pressed;
+			bool released;
+		};
+
+		struct Binding
+		{
+			InputButton button;
+			std::uint32_t action;
+		};
+
+		struct Chord
+		{
+			std::vector<InputButton> buttons;
+			std::uint32_t action;
+			std::uint64_t window;
+			bool active;
+		};
+
+		ActionState& action(std::uint32_t action);
+		void press(std::uint32_t action);
+		void release(std::uint32_t action);
+
+		std::vector<ActionState> m_actions;
+		std::vector<Binding> m_bindings;
+		std::vector<Chord> m_chords;
+		std::uint8_t m_buttonHeld[inputButtonCount] = {};
+		std::uint64_t m_buttonDownTime[inputButtonCount] = {};
+		glm::vec2 m_cursor = glm::vec2(0.0f);
+		glm::vec2 m_tickCursor = glm::vec2(0.0f);
+		glm::vec2 m_scroll = glm::vec2(0.0f);
+	};
+
+	// Events tagged with the simulation tick that consumed them. Playing a log back feeds an ActionMap exactly
+	// what it saw live, so input can be replayed without a window.
+	class InputLog
+	{
+	public:
+		struct Entry
+		{
+			std::uint64_t tick;
+			InputEvent event;
+		};
+
+		void record(std::uint64_t tick, const InputEvent& event);
+		void clear();
+
+		const std::vector<Entry>& entries() const { return m_entries; }
+
+		// Applies the events recorded for tick, ticks must be played in increasing order
+		void playTick(std::uint64_t tick, ActionMap& actions);
+		void rewind() { m_cursor = 0; }
+		bool finished() const { return m_cursor == m_entries.size(); }
+
+		bool save(const std::string& path) const;
+		bool load(const std::string& path);
+
+	private:
+		std::vector<Entry> m_entries;
+		std::size_t m_cursor = 0;
+	};
+
+	// Drains the queue into actions for one simulation tick, recording the events when log is not null
+	void consumeInput(InputQueue& queue, ActionMap& actions, InputLog* log, std::uint64_t tick);
+}
@@ -0,0 +1,126 @@
+#include "Benchmark.h"
+#include "Input.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+namespace
+{
+	std::size_t const eventCount = 1000000;
+	std::uint32_t const actionCount = 32;
+
+	// Synthetic session: random key and mouse presses and releases mixed with cursor moves, about 1ms apart
+	std::vector<engine::InputEvent> randomEvents(std::size_t count)
+	{
+		std::mt19937 random(17);
+		std::uniform_int_distribution<int> kind(0, 9);
+		std::uniform_int_distribution<int> key(32, 96);
+		std::uniform_real_distribution<float> position(0.0f, 1280.0f);
+		std::vector<engine::InputEvent> events(count);
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			engine::InputEvent& event = events[i];
+			int const type = kind(random);
+			event.type = type < 6 ? engine::InputEvent::Type::Button : engine::InputEvent::Type::Cursor;
+			event.down = (type & 1) != 0;
+			event.button = type == 5 ? engine::mouseButton(0) : static_cast<engine::InputButton>(key(random));
+			event.value = glm::vec2(position(random), position(random));
+			event.time = i * 1000;
+		}
+		return events;
+	}
+
+	void bindActions(engine::ActionMap& actions)
+	{
+		for(std::uint32_t action = 0; action < actionCount; ++action)
+			actions.bindButton(action, static_cast<engine::InputButton>(32 + action * 2));
+		actions.bindChord(actionCount, { 65, 66 }, 50000);
+		actions.bindChord(actionCount + 1, { 70, 71, 72 }, 50000);
+	}
+
+	// Sum of the action states over all ticks, identical for a live run and its replay
+	std::uint64_t tickChecksum(const engine::ActionMap& actions, std::uint64_t tick)
+	{
+		std::uint64_t sum = 0;
+		for(std::uint32_t action = 0; action < actionCount + 2; ++action)
+			sum += (actions.held(action) ? 1 : 0) + (actions.pressed(action) ? 2 : 0) + (actions.released(action) ? 4 : 0);
+		return sum * (tick + 1);
+	}
+}
+
+ENGINE_BENCHMARK(Input)
+{
+	std::vector<engine::InputEvent> const events = randomEvents(eventCount);
+
+	// A producer thread stands in for the GLFW callbacks, the simulation drains the queue once per tick
+	engine::InputQueue queue(eventCount);
+	engine::ActionMap live;
+	bindActions(live);
+	engine::InputLog log;
+
+	engine::Stopwatch timer;
+	std::thread producer([&]()
+	{
+		for(const engine::InputEvent& event : events)
+			queue.post(event);
+	});
+	std::uint64_t liveChecksum = 0;
+	std::uint64_t tick = 0;
+	while(log.entries().size() + queue.droppedCount() < eventCount)
+	{
+		engine::consumeInput(queue, live, &log, tick);
+		liveChecksum += tickChecksum(live, tick);
+		++tick;
+	}
+	producer.join();
+	context.report("queue and map throughput", eventCount / timer.elapsedMs(), "events/ms");
+	context.report("dropped", static_cast<double>(queue.droppedCount()), "events");
+
+	char const* const path = "input_benchmark.log";
+	timer.restart();
+	bool const saved = log.save(path);
+	engine::InputLog loaded;
+	bool const read = saved && loaded.load(path);
+	context.report("save and load", timer.elapsedMs(), "ms");
+
+	// An entry count far past the end of the file, loading fails and leaves the loaded log alone
+	engine::InputLog corrupt;
+	std::uint64_t const entryCount = ~0ull >> 8;
+	std::FILE* file = std::fopen(path, "r+b");
+	bool const patched = file && std::fseek(file, 8, SEEK_SET) == 0 && std::fwrite(&entryCount, sizeof(entryCount), 1, file) == 1;
+	if(file)
+		std::fclose(file);
+	context.report("corrupt log refused", patched && !corrupt.load(path) ? 1.0 : 0.0, "ok");
+
+	// A down flag that isn't 0 or 1 in the first entry, which follows the 16 byte header
+	unsigned char const badFlag = 2;
+	long const downOffset = static_cast<long>(16 + offsetof(engine::InputLog::Entry, event) + offsetof(engine::InputEvent, down));
+	file = log.save(path) ? std::fopen(path, "r+b") : nullptr;
+	bool const flagPatched = file && std::fseek(file, downOffset, SEEK_SET) == 0 && std::fwrite(&badFlag, 1, 1, file) == 1;
+	if(file)
+		std::fclose(file);
+	context.report("invalid entry refused", flagPatched && !corrupt.load(path) ? 1.0 : 0.0, "ok");
+	std::remove(path);
+	if(!read)
+	{
+		context.report("FAILED to round trip the log", 0.0, "");
+		return;
+	}
+
+	// Replays the recorded ticks without a window, the checksums must match
+	engine::ActionMap replay;
+	bindActions(replay);
+	std::uint64_t replayChecksum = 0;
+	timer.restart();
+	for(std::uint64_t replayed = 0; replayed < tick; ++replayed)
+	{
+		loaded.playTick(replayed, replay);
+		replayChecksum += tickChecksum(replay, replayed);
+	}
+	context.report("replay throughput", eventCount / timer.elapsedMs(), "events/ms");
+	context.report("ticks", static_cast<double>(tick), "");
+	if(replayChecksum != liveChecksum)
+		context.report("MISMATCH replay checksum", static_cast<double>(replayChecksum), "");
+}
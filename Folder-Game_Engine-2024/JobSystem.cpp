@@ -0,0 +1,116 @@
+#include "JobSystem.h"
+
+namespace engine
+{
+	JobSystem::JobSystem(unsigned workerCount) :
+		m_queued(0),
+		m_quit(false)
+	{
+		m_workers.reserve(workerCount);
+		for(unsigned i = 0; i < workerCount; ++i)
+			m_workers.emplace_back(&JobSystem::workerMain, this);
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_wake.notify_all();
+		for(std::thread& worker : m_workers)
+			worker.join();
+	}
+
+	unsigned JobSystem::defaultWorkerCount()
+	{
+		unsigned const hardware = std::thread::hardware_concurrency();
+		return hardware > 1 ? hardware - 1 : 0;
+	}
+
+	void JobSystem::run(Job job, JobCounter& counter)
+	{
+		counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queue.emplace_back(std::move(job), &counter);
+			m_queued.store(m_queue.size(), std::memory_order_relaxed);
+		}
+		m_wake.notify_one();
+	}
+
+	void JobSystem::wait(JobCounter& counter)
+	{
+		while(!counter.done())
+		{
+			if(!runOne())
+				std::this_thread::yield();
+		}
+	}
+
+	void JobSystem::parallelFor(std::size_t count, std::size_t grain, const RangeJob& job)
+	{
+		if(count == 0)
+			return;
+
+		grain = std::max<std::size_t>(grain, 1);
+		std::size_t const rangeCount = (count + grain - 1) / grain;
+		if(rangeCount == 1 || m_workers.empty())
+		{
+			job(0, count);
+			return;
+		}
+
+		// Every participant pulls ranges from the same cursor so a slow thread doesn't hold back the others
+		std::atomic<std::size_t> cursor(0);
+		auto drain = [&]()
+		{
+			for(;;)
+			{
+				std::size_t const range = cursor.fetch_add(1, std::memory_order_relaxed);
+				if(range >= rangeCount)
+					return;
+				std::size_t const begin = range * grain;
+				job(begin, std::min(begin + grain, count));
+			}
+		};
+
+		JobCounter counter;
+		std::size_t const helpers = std::min<std::size_t>(m_workers.size(), rangeCount - 1);
+		for(std::size_t i = 0; i < helpers; ++i)
+			run(drain, counter);
+		drain();
+		wait(counter);
+	}
+
+	bool JobSystem::runOne()
+	{
+		std::pair<Job, JobCounter*> entry;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if(m_queue.empty())
+				return false;
+			entry = std::move(m_queue.front());
+			m_queue.pop_front();
+			m_queued.store(m_queue.size(), std::memory_order_relaxed);
+		}
+
+		entry.first();
+		entry.second->m_pending.fetch_sub(1, std::memory_order_release);
+		return true;
+	}
+
+	void JobSystem::workerMain()
+	{
+		for(;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait(lock, [this]() { return m_quit || !m_queue.empty(); });
+				if(m_quit && m_queue.empty())
+					return;
+			}
+			runOne();
+		}
+	}
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine
+{
+	// Counts the jobs that are still running. JobSystem::wait returns once it reaches zero.
+	class JobCounter
+	{
+	public:
+		JobCounter() : m_pending(0) {}
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+		std::atomic<int> m_pending;
+	};
+
+	// Fixed pool of worker threads fed from a single queue.
+	// A thread waiting on a counter runs queued jobs instead of blocking, so jobs may wait on other jobs.
+	class JobSystem
+	{
+	public:
+		typedef std::function<void()> Job;
+		typedef std::function<void(std::size_t begin, std::size_t end)> RangeJob;
+
+		// 0 creates a pool without workers: every job runs on the thread that waits for it.
+		explicit JobSystem(unsigned workerCount = defaultWorkerCount());
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		unsigned workerCount() const { return static_cast<unsigned>(m_workers.size()); }
+		// Jobs waiting for a thread, read without locking the queue
+		std::size_t queuedJobs() const { return m_queued.load(std::memory_order_relaxed); }
+
+		void run(Job job, JobCounter& counter);
+		void wait(JobCounter& counter);
+
+		// Calls job(begin, end) over [0, count) in ranges of at most grain elements and returns when all ranges are done.
+		void parallelFor(std::size_t count, std::size_t grain, const RangeJob& job);
+
+		// Hardware threads minus the calling thread.
+		static unsigned defaultWorkerCount();
+
+	private:
+		bool runOne();
+		void workerMain();
+
+		std::vector<std::thread> m_workers;
+		std::deque<std::pair<Job, JobCounter*> > m_queue;
+		std::atomic<std::size_t> m_queued;
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		bool m_quit;
+	};
+
+	// Runs serially when jobs is null.
+	inline void parallelFor(JobSystem* jobs, std::size_t count, std::size_t grain, const JobSystem::RangeJob& job)
+	{
+		if(jobs)
+			jobs->parallelFor(count, grain, job);
+		else if(count > 0)
+			job(0, count);
+	}
+
+	// Reduces fixed-size chunks in parallel and combines their results in index order. The chunks don't depend on
+	// the number of workers, so floating point sums come out the same with any JobSystem or none.
+	template<typename T, typename ReduceChunk, typename Combine>
+	T parallelReduce(JobSystem* jobs, std::size_t count, std::size_t chunkSize, const T& identity, const ReduceChunk& reduceChunk, const Combine& combine)
+	{
+		std::size_t const chunkCount = (count + chunkSize - 1) / chunkSize;
+		std::vector<T> partials(chunkCount, identity);
+		parallelFor(jobs, chunkCount, 1, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t chunk = begin; chunk < end; ++chunk)
+				partials[chunk] = reduceChunk(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+		});
+
+		T result = identity;
+		for(const T& partial : partials)
+			result = combine(result, partial);
+		return result;
+	}
+
+	// Sorts chunks in parallel then merges them pairwise, also in parallel. The chunks depend on the number of
+	// workers, so elements that compare equal may come out in a different order: use a total order when the result
+	// has to be deterministic.
+	template<typename T, typename Compare>
+	void parallelSort(JobSystem* jobs, std::vector<T>& values, Compare less)
+	{
+		std::size_t const minChunk = 4096;
+		std::size_t chunkCount = jobs ? jobs->workerCount() + 1 : 1;
+		chunkCount = std::max<std::size_t>(1, std::min(chunkCount, values.size() / minChunk));
+		if(chunkCount == 1)
+		{
+			std::sort(values.begin(), values.end(), less);
+			return;
+		}
+
+		std::vector<std::size_t> bounds(chunkCount + 1);
+		for(std::size_t i = 0; i <= chunkCount; ++i)
+			bounds[i] = values.size() * i / chunkCount;
+
+		jobs->parallelFor(chunkCount, 1, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t i = begin; i < end; ++i)
+				std::sort(values.begin() + bounds[i], values.begin() + bounds[i + 1], less);
+		});
+
+		std::vector<T> scratch(values.size());
+		std::vector<T>* source = &values;
+		std::vector<T>* target = &scratch;
+		for(std::size_t width = 1; width < chunkCount; width *= 2)
+		{
+			std::size_t const merges = (chunkCount + 2 * width - 1) / (2 * width);
+			jobs->parallelFor(merges, 1, [&](std::size_t begin, std::size_t end)
+			{
+				for(std::size_t m = begin; m < end; ++m)
+				{
+					std::size_t const first = bounds[m * 2 * width];
+					std::size_t const middle = bounds[std::min(m * 2 * width + width, chunkCount)];
+					std::size_t const last = bounds[std::min(m * 2 * width + 2 * width, chunkCount)];
+					std::merge(
+						source->begin() + first, source->begin() + middle,
+						source->begin() + middle, source->begin() + last,
+						target->begin() + first, less);
+				}
+			});
+			std::swap(source, target);
+		}
+
+		if(source != &values)
+			values.swap(*source);
+	}
+}
@@ -0,0 +1,300 @@
+#include "LooseOctree.h"
+
+#include <algorithm>
+
+namespace engine
+{
+	namespace
+	{
+		std::uint32_t const rootNode = 0;
+	}
+
+	const std::uint32_t LooseOctree::invalidIndex;
+
+	LooseOctree::LooseOctree(const glm::vec3& center, float halfSize, unsigned maxDepth) :
+		m_center(center),
+		m_halfSize(halfSize),
+		m_maxDepth(maxDepth),
+		m_freeNode(invalidIndex),
+		m_nodeCount(0),
+		m_freeObject(invalidIndex),
+		m_objectCount(0)
+	{
+		Node root;
+		root.center = center;
+		root.halfSize = halfSize;
+		root.parent = invalidIndex;
+		std::fill(root.children, root.children + 8, invalidIndex);
+		root.firstObject = invalidIndex;
+		root.depth = 0;
+		m_nodes.push_back(root);
+		m_nodeCount = 1;
+	}
+
+	Aabb LooseOctree::looseBounds(const Node& node) const
+	{
+		return Aabb::fromCenterExtent(node.center, glm::vec3(node.halfSize * 2.0f));
+	}
+
+	unsigned LooseOctree::depthFor(const Aabb& bounds) const
+	{
+		glm::vec3 const extent = bounds.extent();
+		float const size = glm::max(extent.x, glm::max(extent.y, extent.z));
+		unsigned depth = 0;
+		for(float half = m_halfSize * 0.5f; depth < m_maxDepth && size <= half; half *= 0.5f)
+			++depth;
+		return depth;
+	}
+
+	bool LooseOctree::fits(const Node& node, const Aabb& bounds) const
+	{
+		if(node.depth == 0 && glm::any(glm::greaterThan(glm::abs(bounds.center() - m_center), glm::vec3(m_halfSize))))
+			return true;
+
+		// Objects may sink one level below their node before it's worth moving them
+		if(depthFor(bounds) > node.depth + 1)
+			return false;
+		if(node.depth == 0)
+			return true;
+		return contains(looseBounds(node), bounds);
+	}
+
+	std::uint32_t LooseOctree::allocateNode(std::uint32_t parent, unsigned octant)
+	{
+		std::uint32_t index = m_freeNode;
+		if(index != invalidIndex)
+			m_freeNode = m_nodes[index].parent;
+		else
+		{
+			index = static_cast<std::uint32_t>(m_nodes.size());
+			m_nodes.push_back(Node());
+		}
+
+		Node& node = m_nodes[index];
+		Node const& parentNode = m_nodes[parent];
+		float const half = parentNode.halfSize * 0.5f;
+		node.center = parentNode.center + glm::vec3(
+			(octant & 1) ? half : -half,
+			(octant & 2) ? half : -half,
+			(octant & 4) ? half : -half);
+		node.halfSize = half;
+		node.parent = parent;
+		std::fill(node.children, node.children + 8, invalidIndex);
+		node.firstObject = invalidIndex;
+		node.depth = parentNode.depth + 1;
+		m_nodes[parent].children[octant] = index;
+		++m_nodeCount;
+		return index;
+	}
+
+	void LooseOctree::link(std::uint32_t object)
+	{
+		Aabb const& bounds = m_objects[object].bounds;
+		glm::vec3 const center = bounds.center();
+
+		std::uint32_t node = rootNode;
+		if(glm::all(glm::lessThanEqual(glm::abs(center - m_center), glm::vec3(m_halfSize))))
+		{
+			unsigned const depth = depthFor(bounds);
+			while(m_nodes[node].depth < depth)
+			{
+				glm::vec3 const nodeCenter = m_nodes[node].center;
+				unsigned const octant =
+					(center.x >= nodeCenter.x ? 1 : 0) |
+					(center.y >= nodeCenter.y ? 2 : 0) |
+					(center.z >= nodeCenter.z ? 4 : 0);
+				std::uint32_t child = m_nodes[node].children[octant];
+				if(child == invalidIndex)
+					child = allocateNode(node, octant);
+				node = child;
+			}
+		}
+
+		Object& entry = m_objects[object];
+		entry.node = node;
+		entry.previous = invalidIndex;
+		entry.next = m_nodes[node].firstObject;
+		if(entry.next != invalidIndex)
+			m_objects[entry.next].previous = object;
+		m_nodes[node].firstObject = object;
+	}
+
+	void LooseOctree::unlink(std::uint32_t object)
+	{
+		Object& entry = m_objects[object];
+		if(entry.previous != invalidIndex)
+			m_objects[entry.previous].next = entry.next;
+		else
+			m_nodes[entry.node].firstObject = entry.next;
+		if(entry.next != invalidIndex)
+			m_objects[entry.next].previous = entry.previous;
+	}
+
+	void LooseOctree::prune(std::uint32_t node)
+	{
+		while(node != rootNode)
+		{
+			Node& current = m_nodes[node];
+			if(current.firstObject != invalidIndex)
+				return;
+			for(std::uint32_t child : current.children)
+			{
+				if(child != invalidIndex)
+					return;
+			}
+
+			std::uint32_t const parent = current.parent;
+			std::replace(m_nodes[parent].children, m_nodes[parent].children + 8, node, invalidIndex);
+			current.parent = m_freeNode;
+			m_freeNode = node;
+			--m_nodeCount;
+			node = parent;
+		}
+	}
+
+	std::uint32_t LooseOctree::insert(const Aabb& bounds)
+	{
+		std::uint32_t object = m_freeObject;
+		if(object != invalidIndex)
+			m_freeObject = m_objects[object].next;
+		else
+		{
+			object = static_cast<std::uint32_t>(m_objects.size());
+			m_objects.push_back(Object());
+		}
+
+		m_objects[object].bounds = bounds;
+		m_objects[object].pending = false;
+		link(object);
+		++m_objectCount;
+		return object;
+	}
+
+	void LooseOctree::remove(std::uint32_t object)
+	{
+		std::uint32_t const node = m_objects[object].node;
+		unlink(object);
+		prune(node);
+
+		// A queued update of a removed object is skipped by flushUpdates
+		Object& entry = m_objects[object];
+		entry.node = invalidIndex;
+		entry.pending = false;
+		entry.next = m_freeObject;
+		m_freeObject = object;
+		--m_objectCount;
+	}
+
+	void LooseOctree::update(std::uint32_t object, const Aabb& bounds)
+	{
+		Object& entry = m_objects[object];
+		entry.bounds = bounds;
+		if(!entry.pending && !fits(m_nodes[entry.node], bounds))
+		{
+			entry.pending = true;
+			m_pending.push_back(object);
+		}
+	}
+
+	void LooseOctree::flushUpdates()
+	{
+		for(std::uint32_t object : m_pending)
+		{
+			if(!m_objects[object].pending)
+				continue;
+
+			// Link before pruning so a node the object comes back to isn't freed and allocated again
+			std::uint32_t const node = m_objects[object].node;
+			m_objects[object].pending = false;
+			unlink(object);
+			link(object);
+			prune(node);
+		}
+		m_pending.clear();
+	}
+
+	std::size_t LooseOctree::memoryUsage() const
+	{
+		return sizeof(*this)
+			+ m_nodes.capacity() * sizeof(Node)
+			+ m_objects.capacity() * sizeof(Object)
+			+ m_pending.capacity() * sizeof(std::uint32_t);
+	}
+
+	template<typename NodeTest, typename ObjectVisitor>
+	void LooseOctree::traverse(NodeTest nodeTest, ObjectVisitor visitor) const
+	{
+		// The low bit marks nodes known to be entirely inside the query, their subtree is taken without tests.
+		// The root is never tested since it also holds the objects outside the octree.
+		std::vector<std::uint32_t> stack;
+		stack.reserve(64);
+		stack.push_back(rootNode << 1);
+		while(!stack.empty())
+		{
+			std::uint32_t const node = stack.back() >> 1;
+			bool inside = (stack.back() & 1) != 0;
+			stack.pop_back();
+
+			Node const& current = m_nodes[node];
+			if(!inside && node != rootNode)
+			{
+				Containment const containment = nodeTest(looseBounds(current));
+				if(containment == Containment::Outside)
+					continue;
+				inside = containment == Containment::Inside;
+			}
+
+			for(std::uint32_t object = current.firstObject; object != invalidIndex; object = m_objects[object].next)
+				visitor(object, inside);
+			for(std::uint32_t child : current.children)
+			{
+				if(child != invalidIndex)
+					stack.push_back((child << 1) | (inside ? 1 : 0));
+			}
+		}
+	}
+
+	void LooseOctree::queryFrustum(const Frustum& frustum, std::vector<std::uint32_t>& out) const
+	{
+		traverse(
+			[&](const Aabb& bounds) { return classify(frustum, bounds); },
+			[&](std::uint32_t object, bool inside)
+			{
+				if(inside || classify(frustum, m_objects[object].bounds) != Containment::Outside)
+					out.push_back(object);
+			});
+	}
+
+	void LooseOctree::querySphere(const glm::vec3& center, float radius, std::vector<std::uint32_t>& out) const
+	{
+		traverse(
+			[&](const Aabb& bounds) { return intersectsSphere(bounds, center, radius) ? Containment::Intersecting : Containment::Outside; },
+			[&](std::uint32_t object, bool)
+			{
+				if(intersectsSphere(m_objects[object].bounds, center, radius))
+					out.push_back(object);
+			});
+	}
+
+	void LooseOctree::queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<RayHit>& out) const
+	{
+		std::size_t const first = out.size();
+		glm::vec3 const inverseDirection = 1.0f / direction;
+		float entry = 0.0f;
+		traverse(
+			[&](const Aabb& bounds) { return intersectRay(bounds, origin, inverseDirection, maxDistance, entry) ? Containment::Intersecting : Containment::Outside; },
+			[&](std::uint32_t object, bool)
+			{
+				if(intersectRay(m_objects[object].bounds, origin, inverseDirection, maxDistance, entry))
+				{
+					RayHit const hit = { object, entry };
+					out.push_back(hit);
+				}
+			});
+
+		std::sort(out.begin() + first, out.end(), [](const RayHit& a, const RayHit& b)
+		{
+			return a.distance < b.distance || (a.distance == b.distance && a.object < b.object);
+		});
+	}
+}
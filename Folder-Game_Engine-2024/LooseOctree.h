@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Bounds.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	struct RayHit
+	{
+		std::uint32_t object;
+		float distance;
+	};
+
+	// Loose octree over a fixed cube of the world. Each node's bounds are twice its cell so an object is stored in
+	// the deepest node whose cell contains its center and whose size matches its own, which never needs splitting.
+	// Objects outside the cube stay in the root.
+	//
+	// Moves are lazy: update() only queues an object when it leaves the loose bounds of its node or becomes much
+	// smaller than it, and flushUpdates() reinserts the queued objects. Queries expect the queue to be empty.
+	//
+	// Nodes and objects live in pooled arrays with free lists, object ids stay valid until the object is removed.
+	class LooseOctree
+	{
+	public:
+		static const std::uint32_t invalidIndex = 0xFFFFFFFFu;
+
+		LooseOctree(const glm::vec3& center, float halfSize, unsigned maxDepth = 6);
+
+		std::uint32_t insert(const Aabb& bounds);
+		void remove(std::uint32_t object);
+		void update(std::uint32_t object, const Aabb& bounds);
+		void flushUpdates();
+
+		const Aabb& bounds(std::uint32_t object) const { return m_objects[object].bounds; }
+
+		std::size_t objectCount() const { return m_objectCount; }
+		std::size_t nodeCount() const { return m_nodeCount; }
+		std::size_t pendingCount() const { return m_pending.size(); }
+		std::size_t memoryUsage() const;
+
+		// Append the ids of the matching objects. Ray hits are sorted by distance, direction doesn't need to be normalized
+		// but distances are measured in its length.
+		void queryFrustum(const Frustum& frustum, std::vector<std::uint32_t>& out) const;
+		void querySphere(const glm::vec3& center, float radius, std::vector<std::uint32_t>& out) const;
+		void queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<RayHit>& out) const;
+
+	private:
+		struct Node
+		{
+			glm::vec3 center;
+			float halfSize;
+			std::uint32_t parent;
+			std::uint32_t children[8];
+			std::uint32_t firstObject;
+			std::uint32_t depth;
+		};
+
+		struct Object
+		{
+			Aabb bounds;
+			std::uint32_t node;
+			std::uint32_t previous;
+			std::uint32_t next;
+			bool pending;
+		};
+
+		Aabb looseBounds(const Node& node) const;
+		unsigned depthFor(const Aabb& bounds) const;
+		bool fits(const Node& node, const Aabb& bounds) const;
+
+		std::uint32_t allocateNode(std::uint32_t parent, unsigned octant);
+		void link(std::uint32_t object);
+		void unlink(std::uint32_t object);
+		void prune(std::uint32_t node);
+
+		template<typename NodeTest, typename ObjectVisitor>
+		void traverse(NodeTest nodeTest, ObjectVisitor visitor) const;
+
+		glm::vec3 m_center;
+		float m_halfSize;
+		unsigned m_maxDepth;
+
+		std::vector<Node> m_nodes;
+		std::uint32_t m_freeNode;
+		std::size_t m_nodeCount;
+
+		std::vector<Object> m_objects;
+		std::uint32_t m_freeObject;
+		std::size_t m_objectCount;
+
+		std::vector<std::uint32_t> m_pending;
+	};
+}
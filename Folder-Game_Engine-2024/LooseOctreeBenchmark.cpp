@@ -0,0 +1,122 @@
+#include "Benchmark.h"
+#include "LooseOctree.h"
+
+#include <gtc/matrix_transform.hpp>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	std::size_t const objectCount = 100000;
+	float const worldHalfSize = 1000.0f;
+	unsigned const maxDepth = 6;
+	float const maxSpeed = 20.0f;
+	float const frameTime = 1.0f / 60.0f;
+	int const frameCount = 60;
+
+	struct Mover
+	{
+		glm::vec3 position;
+		glm::vec3 velocity;
+		glm::vec3 extent;
+		std::uint32_t object;
+	};
+
+	std::vector<Mover> randomMovers(std::size_t count)
+	{
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> coordinate(-worldHalfSize, worldHalfSize);
+		std::uniform_real_distribution<float> speed(-maxSpeed, maxSpeed);
+		std::uniform_real_distribution<float> size(0.25f, 4.0f);
+		std::vector<Mover> movers(count);
+		for(Mover& mover : movers)
+		{
+			mover.position = glm::vec3(coordinate(random), coordinate(random) * 0.05f, coordinate(random));
+			mover.velocity = glm::vec3(speed(random), 0.0f, speed(random));
+			mover.extent = glm::vec3(size(random));
+			mover.object = engine::LooseOctree::invalidIndex;
+		}
+		return movers;
+	}
+
+	void step(Mover& mover)
+	{
+		mover.position += mover.velocity * frameTime;
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			if(glm::abs(mover.position[axis]) > worldHalfSize)
+				mover.velocity[axis] = -mover.velocity[axis];
+		}
+	}
+}
+
+ENGINE_BENCHMARK(LooseOctree)
+{
+	std::vector<Mover> movers = randomMovers(objectCount);
+	engine::LooseOctree octree(glm::vec3(0.0f), worldHalfSize, maxDepth);
+
+	engine::Stopwatch timer;
+	for(Mover& mover : movers)
+		mover.object = octree.insert(engine::Aabb::fromCenterExtent(mover.position, mover.extent));
+	context.report("insert", timer.elapsedMs(), "ms");
+	context.report("nodes", static_cast<double>(octree.nodeCount()), "");
+	context.report("memory", octree.memoryUsage() / 1024.0, "KiB");
+
+	double updateMs = 0.0;
+	double flushMs = 0.0;
+	std::size_t reinserted = 0;
+	for(int frame = 0; frame < frameCount; ++frame)
+	{
+		timer.restart();
+		for(Mover& mover : movers)
+		{
+			step(mover);
+			octree.update(mover.object, engine::Aabb::fromCenterExtent(mover.position, mover.extent));
+		}
+		updateMs += timer.elapsedMs();
+		reinserted += octree.pendingCount();
+
+		timer.restart();
+		octree.flushUpdates();
+		flushMs += timer.elapsedMs();
+	}
+	context.report("update per frame", updateMs / frameCount, "ms");
+	context.report("flush per frame", flushMs / frameCount, "ms");
+	context.report("reinserted per frame", static_cast<double>(reinserted) / frameCount, "objects");
+
+	// What the octree replaces: rebuilding the whole tree every frame
+	timer.restart();
+	for(int frame = 0; frame < 5; ++frame)
+	{
+		engine::LooseOctree rebuilt(glm::vec3(0.0f), worldHalfSize, maxDepth);
+		for(const Mover& mover : movers)
+			rebuilt.insert(engine::Aabb::fromCenterExtent(mover.position, mover.extent));
+	}
+	context.report("full rebuild per frame", timer.elapsedMs() / 5, "ms");
+
+	glm::mat4 const projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 400.0f);
+	glm::mat4 const view = glm::lookAt(glm::vec3(0.0f, 50.0f, 0.0f), glm::vec3(100.0f, 0.0f, 100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	engine::Frustum const frustum = engine::Frustum::fromMatrix(projection * view);
+
+	std::vector<std::uint32_t> visible;
+	timer.restart();
+	octree.queryFrustum(frustum, visible);
+	context.report("frustum query", timer.elapsedMs(), "ms");
+	context.report("visible", static_cast<double>(visible.size()), "objects");
+
+	std::vector<engine::RayHit> hits;
+	timer.restart();
+	for(int i = 0; i < 1000; ++i)
+	{
+		float const angle = glm::radians(i * 0.36f);
+		octree.queryRay(glm::vec3(0.0f), glm::vec3(glm::cos(angle), 0.0f, glm::sin(angle)), worldHalfSize, hits);
+	}
+	context.report("1000 ray queries", timer.elapsedMs(), "ms");
+
+	std::vector<std::uint32_t> nearby;
+	timer.restart();
+	for(int i = 0; i < 1000; ++i)
+		octree.querySphere(movers[i].position, 25.0f, nearby);
+	context.report("1000 sphere queries", timer.elapsedMs(), "ms");
+}
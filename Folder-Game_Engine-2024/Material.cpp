@@ -0,0 +1,84 @@
+#include "Material.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace engine
+{
+	MaterialParams::MaterialParams() :
+		baseColor(1.0f),
+		emissive(0.0f),
+		emissiveStrength(0.0f),
+		uvScale(1.0f),
+		uvOffset(0.0f),
+		metallic(0.0f),
+		roughness(1.0f),
+		normalScale(1.0f),
+		alphaCutoff(0.5f)
+	{
+	}
+
+	MaterialLibrary::MaterialLibrary(std::size_t offsetAlignment, std::size_t pageBytes) :
+		m_stride((sizeof(MaterialParams) + offsetAlignment - 1) / offsetAlignment * offsetAlignment),
+		m_pageBytes(std::max(pageBytes / m_stride, std::size_t(1)) * m_stride),
+		m_count(0)
+	{
+	}
+
+	void MaterialLibrary::set(std::uint32_t material, const MaterialParams& params)
+	{
+		std::size_t const page = pageOf(material);
+		while(m_pages.size() <= page)
+		{
+			// New pages are uploaded whole, so unused slots hold defaults rather than garbage
+			m_pages.push_back(std::vector<unsigned char>(m_pageBytes));
+			MaterialParams const defaults;
+			for(std::size_t offset = 0; offset < m_pageBytes; offset += m_stride)
+				std::memcpy(&m_pages.back()[offset], &defaults, sizeof(MaterialParams));
+		}
+
+		std::memcpy(&m_pages[page][offsetOf(material)], &params, sizeof(MaterialParams));
+		m_count = std::max(m_count, static_cast<std::size_t>(material) + 1);
+		if(m_isDirty.size() < m_count)
+			m_isDirty.resize(m_count, false);
+		if(!m_isDirty[material])
+		{
+			m_isDirty[material] = true;
+			m_dirty.push_back(material);
+		}
+	}
+
+	MaterialParams MaterialLibrary::get(std::uint32_t material) const
+	{
+		MaterialParams params;
+		if(material < m_count)
+			std::memcpy(&params, &m_pages[pageOf(material)][offsetOf(material)], sizeof(MaterialParams));
+		return params;
+	}
+
+	void MaterialLibrary::dirtyRanges(std::vector<DirtyRange>& ranges)
+	{
+		ranges.clear();
+		std::sort(m_dirty.begin(), m_dirty.end());
+		for(std::size_t i = 0; i < m_dirty.size(); ++i)
+		{
+			std::uint32_t const material = m_dirty[i];
+			std::size_t const page = pageOf(material);
+			std::size_t const offset = offsetOf(material);
+			if(!ranges.empty() && ranges.back().page == page && m_dirty[i - 1] + 1 == material)
+			{
+				ranges.back().end = offset + sizeof(MaterialParams);
+				continue;
+			}
+			DirtyRange const range = { page, offset, offset + sizeof(MaterialParams) };
+			ranges.push_back(range);
+		}
+	}
+
+	void MaterialLibrary::clearDirty()
+	{
+		for(std::uint32_t material : m_dirty)
+			m_isDirty[material] = false;
+		m_dirty.clear();
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <glm.hpp>
+#include <gtc/type_aligned.hpp>
+#include <gtx/buffer_layout.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	// Mirrors the shaders' uniform block, so pages of materials are copied to the GPU as they are:
+	//
+	//	layout(std140) uniform Material
+	//	{
+	//		vec4 baseColor;
+	//		vec3 emissive;
+	//		float emissiveStrength;
+	//		vec2 uvScale;
+	//		vec2 uvOffset;
+	//		float metallic;
+	//		float roughness;
+	//		float normalScale;
+	//		float alphaCutoff;
+	//	};
+	//
+	// std140 puts a vec3 on a 16 byte boundary but lets the next float use its last 4 bytes. glm::aligned_vec3 is
+	// 16 bytes long, so emissive is a plain vec3 placed right after a 16 byte member instead.
+	struct MaterialParams
+	{
+		glm::aligned_vec4 baseColor;
+		glm::vec3 emissive;
+		float emissiveStrength;
+		glm::aligned_vec2 uvScale;
+		glm::aligned_vec2 uvOffset;
+		float metallic;
+		float roughness;
+		float normalScale;
+		float alphaCutoff;
+
+		MaterialParams();
+	};
+
+	typedef glm::buffer_layout<glm::std140_layout,
+		glm::vec4, glm::vec3, float, glm::vec2, glm::vec2, float, float, float, float> MaterialBlock;
+
+	static_assert(MaterialBlock::matches(
+		offsetof(MaterialParams, baseColor), offsetof(MaterialParams, emissive), offsetof(MaterialParams, emissiveStrength),
+		offsetof(MaterialParams, uvScale), offsetof(MaterialParams, uvOffset), offsetof(MaterialParams, metallic),
+		offsetof(MaterialParams, roughness), offsetof(MaterialParams, normalScale), offsetof(MaterialParams, alphaCutoff)),
+		"MaterialParams members must sit at their std140 offsets");
+	static_assert(sizeof(MaterialParams) == MaterialBlock::size(), "MaterialParams must be the size of the std140 Material block");
+
+	struct DirtyRange
+	{
+		std::size_t page;
+		std::size_t begin;
+		std::size_t end;
+	};
+
+	// CPU copy of every material, packed into fixed size pages that each back one uniform buffer. A material
+	// lives at a stride that respects GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, so switching material is binding another
+	// range of a page. Material ids are dense, setting one past the end grows the library.
+	class MaterialLibrary
+	{
+	public:
+		static const std::size_t defaultPageBytes = 64 * 1024;
+
+		explicit MaterialLibrary(std::size_t offsetAlignment = 256, std::size_t pageBytes = defaultPageBytes);
+
+		void set(std::uint32_t material, const MaterialParams& params);
+		MaterialParams get(std::uint32_t material) const;
+
+		std::size_t size() const { return m_count; }
+		std::size_t stride() const { return m_stride; }
+		std::size_t pageBytes() const { return m_pageBytes; }
+		std::size_t materialsPerPage() const { return m_pageBytes / m_stride; }
+		std::size_t pageCount() const { return m_pages.size(); }
+
+		std::size_t pageOf(std::uint32_t material) const { return material / materialsPerPage(); }
+		std::size_t offsetOf(std::uint32_t material) const { return material % materialsPerPage() * m_stride; }
+
+		const unsigned char* pageData(std::size_t page) const { return m_pages[page].data(); }
+
+		// Byte ranges written since the last clearDirty, neighbouring materials of a page merged into one range
+		void dirtyRanges(std::vector<DirtyRange>& ranges);
+		void clearDirty();
+
+	private:
+		std::size_t m_stride;
+		std::size_t m_pageBytes;
+		std::size_t m_count;
+		std::vector<std::vector<unsigned char>> m_pages;
+		std::vector<std::uint32_t> m_dirty;
+		std::vector<bool> m_isDirty;
+	};
+}
@@ -0,0 +1,64 @@
+#include "Mesh.h"
+
+#include <gtc/constants.hpp>
+
+#include <cmath>
+
+namespace engine
+{
+	Aabb computeBounds(const Mesh& mesh)
+	{
+		if(mesh.positions.empty())
+			return Aabb();
+
+		Aabb bounds(mesh.positions[0], mesh.positions[0]);
+		for(const glm::vec3& position : mesh.positions)
+		{
+			bounds.min = glm::min(bounds.min, position);
+			bounds.max = glm::max(bounds.max, position);
+		}
+		return bounds;
+	}
+
+	Mesh makeSphere(unsigned rings, unsigned segments, float radius)
+	{
+		Mesh mesh;
+		if(rings < 2 || segments < 3)
+			return mesh;
+
+		// Poles first, then the rings in between without repeating the first segment
+		mesh.positions.push_back(glm::vec3(0.0f, radius, 0.0f));
+		mesh.positions.push_back(glm::vec3(0.0f, -radius, 0.0f));
+		for(unsigned ring = 1; ring < rings; ++ring)
+		{
+			float const polar = glm::pi<float>() * ring / rings;
+			for(unsigned segment = 0; segment < segments; ++segment)
+			{
+				float const azimuth = glm::two_pi<float>() * segment / segments;
+				mesh.positions.push_back(radius * glm::vec3(std::sin(polar) * std::cos(azimuth), std::cos(polar), -std::sin(polar) * std::sin(azimuth)));
+			}
+		}
+
+		auto vertex = [segments](unsigned ring, unsigned segment)
+		{
+			return static_cast<std::uint32_t>(2 + (ring - 1) * segments + segment % segments);
+		};
+		for(unsigned segment = 0; segment < segments; ++segment)
+		{
+			mesh.indices.insert(mesh.indices.end(), { 0u, vertex(1, segment), vertex(1, segment + 1) });
+			mesh.indices.insert(mesh.indices.end(), { 1u, vertex(rings - 1, segment + 1), vertex(rings - 1, segment) });
+		}
+		for(unsigned ring = 1; ring + 1 < rings; ++ring)
+		{
+			for(unsigned segment = 0; segment < segments; ++segment)
+			{
+				std::uint32_t const a = vertex(ring, segment);
+				std::uint32_t const b = vertex(ring, segment + 1);
+				std::uint32_t const c = vertex(ring + 1, segment);
+				std::uint32_t const d = vertex(ring + 1, segment + 1);
+				mesh.indices.insert(mesh.indices.end(), { a, c, d, a, d, b });
+			}
+		}
+		return mesh;
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Bounds.h"
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	// Indexed triangle list, counter-clockwise front faces
+	struct Mesh
+	{
+		std::vector<glm::vec3> positions;
+		std::vector<std::uint32_t> indices;
+
+		std::size_t vertexCount() const { return positions.size(); }
+		std::size_t triangleCount() const { return indices.size() / 3; }
+	};
+
+	Aabb computeBounds(const Mesh& mesh);
+
+	// UV sphere of rings * segments quads with a fan at each pole, seams are welded
+	Mesh makeSphere(unsigned rings, unsigned segments, float radius = 1.0f);
+}
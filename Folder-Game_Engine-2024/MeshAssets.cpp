@@ -0,0 +1,238 @@
+#include "MeshAssets.h"
+#include "FileIo.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace engine
+{
+	namespace
+	{
+		char const meshMagic[4] = { 'M', 'E', 'S', 'H' };
+		std::uint32_t const meshVersion = 1;
+
+		// Positions are written as they are in memory, the layout is part of the file format
+		static_assert(sizeof(glm::vec3) == 12, "glm::vec3 layout changed, bump meshVersion");
+
+		bool readFile(const std::string& path, std::string& contents)
+		{
+			std::FILE* file = std::fopen(path.c_str(), "rb");
+			if(!file)
+				return false;
+
+			contents.clear();
+			char buffer[65536];
+			std::size_t read;
+			while((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+				contents.append(buffer, read);
+			bool const ok = std::ferror(file) == 0;
+			return std::fclose(file) == 0 && ok;
+		}
+
+		bool endsWith(const std::string& text, const std::string& suffix)
+		{
+			return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+		}
+	}
+
+	bool loadObj(const std::string& path, Mesh& mesh)
+	{
+		std::string contents;
+		if(!readFile(path, contents))
+			return false;
+
+		Mesh loaded;
+		std::vector<std::uint32_t> face;
+		char const* cursor = contents.c_str();
+		while(*cursor)
+		{
+			char const* const lineEnd = cursor + std::strcspn(cursor, "\r\n");
+			if(cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t'))
+			{
+				// strtof and strtol skip newlines, a number read past lineEnd belongs to the next line
+				char* end = const_cast<char*>(cursor + 1);
+				glm::vec3 position;
+				for(int axis = 0; axis < 3; ++axis)
+				{
+					char const* const start = end;
+					position[axis] = std::strtof(start, &end);
+					if(end == start || end > lineEnd)
+						return false;
+				}
+				loaded.positions.push_back(position);
+			}
+			else if(cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t'))
+			{
+				// Only the position of each v/vt/vn corner matters, negative indices count back from the last vertex
+				face.clear();
+				char const* corner = cursor + 1;
+				while(corner < lineEnd)
+				{
+					char* end;
+					long const index = std::strtol(corner, &end, 10);
+					if(end == corner || end > lineEnd)
+						break;
+					long const position = index < 0 ? static_cast<long>(loaded.positions.size()) + index : index - 1;
+					if(position < 0 || position >= static_cast<long>(loaded.positions.size()))
+						return false;
+					face.push_back(static_cast<std::uint32_t>(position));
+					corner = end + std::strcspn(end, " \t\r\n");
+				}
+				if(face.size() < 3)
+					return false;
+				for(std::size_t i = 2; i < face.size(); ++i)
+				{
+					loaded.indices.push_back(face[0]);
+					loaded.indices.push_back(face[i - 1]);
+					loaded.indices.push_back(face[i]);
+				}
+			}
+			cursor = lineEnd + std::strspn(lineEnd, "\r\n");
+		}
+
+		mesh.positions.swap(loaded.positions);
+		mesh.indices.swap(loaded.indices);
+		return true;
+	}
+
+	bool saveMesh(const std::string& path, const Mesh& mesh)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+		if(!file)
+			return false;
+
+		std::uint64_t const vertexCount = mesh.positions.size();
+		std::uint64_t const indexCount = mesh.indices.size();
+		bool ok = std::fwrite(meshMagic, sizeof(meshMagic), 1, file) == 1;
+		ok = ok && std::fwrite(&meshVersion, sizeof(meshVersion), 1, file) == 1;
+		ok = ok && std::fwrite(&vertexCount, sizeof(vertexCount), 1, file) == 1;
+		ok = ok && std::fwrite(&indexCount, sizeof(indexCount), 1, file) == 1;
+		ok = ok && (vertexCount == 0 || std::fwrite(mesh.positions.data(), sizeof(glm::vec3), mesh.positions.size(), file) == mesh.positions.size());
+		ok = ok && (indexCount == 0 || std::fwrite(mesh.indices.data(), sizeof(std::uint32_t), mesh.indices.size(), file) == mesh.indices.size());
+		return std::fclose(file) == 0 && ok;
+	}
+
+	bool loadMesh(const std::string& path, Mesh& mesh)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if(!file)
+			return false;
+
+		char magic[4] = {};
+		std::uint32_t version = 0;
+		std::uint64_t vertexCount = 0;
+		std::uint64_t indexCount = 0;
+		bool ok = std::fread(magic, sizeof(magic), 1, file) == 1
+			&& std::fread(&version, sizeof(version), 1, file) == 1
+			&& std::fread(&vertexCount, sizeof(vertexCount), 1, file) == 1
+			&& std::fread(&indexCount, sizeof(indexCount), 1, file) == 1
+			&& std::equal(magic, magic + 4, meshMagic)
+			&& version == meshVersion
+			&& indexCount % 3 == 0;
+		// Only as many positions and indices as the file has bytes for, checked one after the other so the
+		// products can't overflow
+		if(ok)
+		{
+			std::uint64_t const left = bytesLeft(file);
+			ok = vertexCount <= left / sizeof(glm::vec3)
+				&& indexCount <= (left - vertexCount * sizeof(glm::vec3)) / sizeof(std::uint32_t);
+		}
+
+		Mesh loaded;
+		if(ok)
+		{
+			loaded.positions.resize(static_cast<std::size_t>(vertexCount));
+			loaded.indices.resize(static_cast<std::size_t>(indexCount));
+			ok = (vertexCount == 0 || std::fread(loaded.positions.data(), sizeof(glm::vec3), loaded.positions.size(), file) == loaded.positions.size())
+				&& (indexCount == 0 || std::fread(loaded.indices.data(), sizeof(std::uint32_t), loaded.indices.size(), file) == loaded.indices.size());
+		}
+		std::fclose(file);
+
+		for(std::size_t i = 0; ok && i < loaded.indices.size(); ++i)
+			ok = loaded.indices[i] < vertexCount;
+		if(ok)
+		{
+			mesh.positions.swap(loaded.positions);
+			mesh.indices.swap(loaded.indices);
+		}
+		return ok;
+	}
+
+	std::vector<std::string> listFiles(const std::string& directory, const std::string& extension)
+	{
+		std::vector<std::string> files;
+#ifdef _WIN32
+		WIN32_FIND_DATAA data;
+		HANDLE const find = FindFirstFileA((directory + "\\*").c_str(), &data);
+		if(find == INVALID_HANDLE_VALUE)
+			return files;
+		do
+		{
+			std::string const name = data.cFileName;
+			if(!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && endsWith(name, extension))
+				files.push_back(directory + "\\" + name);
+		}
+		while(FindNextFileA(find, &data));
+		FindClose(find);
+#else
+		DIR* const dir = opendir(directory.c_str());
+		if(!dir)
+			return files;
+		while(dirent* const entry = readdir(dir))
+		{
+			std::string const path = directory + "/" + entry->d_name;
+			struct stat info;
+			if(endsWith(entry->d_name, extension) && stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+				files.push_back(path);
+		}
+		closedir(dir);
+#endif
+		std::sort(files.begin(), files.end());
+		return files;
+	}
+
+	std::vector<MeshOptimizeResult> optimizeMeshDirectory(const std::string& directory, JobSystem* jobs)
+	{
+		std::vector<std::string> const sources = listFiles(directory, ".obj");
+		std::vector<MeshOptimizeResult> results(sources.size());
+		parallelFor(jobs, sources.size(), 1, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t i = begin; i < end; ++i)
+			{
+				MeshOptimizeResult& result = results[i];
+				result.source = sources[i];
+				result.output = sources[i].substr(0, sources[i].size() - 4) + ".mesh";
+				result.ok = false;
+				result.vertices = 0;
+				result.triangles = 0;
+				result.before = result.after = VertexCacheStats{ 0.0f, 0.0f };
+				result.fetchBefore = result.fetchAfter = 0.0f;
+
+				Mesh mesh;
+				if(!loadObj(result.source, mesh))
+					continue;
+				result.triangles = mesh.triangleCount();
+				result.before = analyzeVertexCache(mesh.indices, mesh.vertexCount());
+				result.fetchBefore = analyzeVertexFetch(mesh.indices, mesh.vertexCount(), sizeof(glm::vec3));
+				optimizeMesh(mesh);
+				result.vertices = mesh.vertexCount();
+				result.after = analyzeVertexCache(mesh.indices, mesh.vertexCount());
+				result.fetchAfter = analyzeVertexFetch(mesh.indices, mesh.vertexCount(), sizeof(glm::vec3));
+				result.ok = saveMesh(result.output, mesh);
+			}
+		});
+		return results;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+
+#include <string>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	// Positions and faces of a Wavefront OBJ, polygons are triangulated as fans. Texture coordinates and normals are ignored.
+	bool loadObj(const std::string& path, Mesh& mesh);
+
+	// Engine mesh file: positions and indices as they are in memory
+	bool saveMesh(const std::string& path, const Mesh& mesh);
+	bool loadMesh(const std::string& path, Mesh& mesh);
+
+	// Paths of the regular files in directory whose name ends with extension, sorted
+	std::vector<std::string> listFiles(const std::string& directory, const std::string& extension);
+
+	struct MeshOptimizeResult
+	{
+		std::string source;
+		std::string output;
+		bool ok;
+		std::size_t vertices;
+		std::size_t triangles;
+		VertexCacheStats before;
+		VertexCacheStats after;
+		float fetchBefore;
+		float fetchAfter;
+	};
+
+	// Offline: optimizes every .obj in directory and writes it next to it as a .mesh, one file per job
+	std::vector<MeshOptimizeResult> optimizeMeshDirectory(const std::string& directory, JobSystem* jobs = nullptr);
+}
@@ -0,0 +1,90 @@
+#include "MeshLod.h"
+#include "JobSystem.h"
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace engine
+{
+	LodChain buildLodChain(const Mesh& mesh, unsigned maxLevels, float reduction, std::size_t minTriangles)
+	{
+		LodChain chain;
+		Aabb const bounds = computeBounds(mesh);
+		chain.center = bounds.center();
+		for(const glm::vec3& position : mesh.positions)
+			chain.radius = std::max(chain.radius, glm::distance(position, chain.center));
+
+		MeshLod source;
+		source.mesh = mesh;
+		source.error = 0.0f;
+		chain.levels.push_back(source);
+
+		// Simplifying the previous level rather than the source keeps every step small
+		while(chain.levels.size() < maxLevels && chain.levels.back().mesh.triangleCount() > minTriangles)
+		{
+			const MeshLod& previous = chain.levels.back();
+			std::size_t const triangles = previous.mesh.triangleCount();
+			std::size_t const target = std::max(static_cast<std::size_t>(triangles * reduction), minTriangles);
+
+			MeshLod level;
+			level.error = previous.error + simplifyMesh(previous.mesh, target, std::numeric_limits<float>::max(), level.mesh);
+			if(level.mesh.triangleCount() * 10 > triangles * 9)
+				break;
+			chain.levels.push_back(level);
+		}
+		return chain;
+	}
+
+	LodSelector::LodSelector(float pixelThreshold, float hysteresis) :
+		m_threshold(pixelThreshold),
+		m_hysteresis(hysteresis),
+		m_pixelsPerUnit(0.0f),
+		m_orthographic(false)
+	{
+	}
+
+	void LodSelector::setProjection(const glm::mat4& projection, float viewportHeight)
+	{
+		// [1][1] maps view space y to clip space: cot(fovY / 2) for a perspective, 2 / height for an orthographic projection
+		m_pixelsPerUnit = projection[1][1] * viewportHeight * 0.5f;
+		m_orthographic = projection[3][3] == 1.0f;
+	}
+
+	float LodSelector::projectedError(float error, float distance) const
+	{
+		if(m_orthographic)
+			return error * m_pixelsPerUnit;
+		return error * m_pixelsPerUnit / std::max(distance, std::numeric_limits<float>::epsilon());
+	}
+
+	unsigned LodSelector::select(const LodChain& chain, const glm::mat4& world, const glm::vec3& cameraPosition, unsigned current) const
+	{
+		if(chain.levels.empty())
+			return 0;
+
+		// Errors scale with the largest axis, and the closest point of the bounding sphere gives the largest projection
+		float const scale = std::sqrt(std::max(std::max(glm::dot(glm::vec3(world[0]), glm::vec3(world[0])),
+			glm::dot(glm::vec3(world[1]), glm::vec3(world[1]))), glm::dot(glm::vec3(world[2]), glm::vec3(world[2]))));
+		glm::vec3 const center = glm::vec3(world * glm::vec4(chain.center, 1.0f));
+		float const distance = glm::distance(center, cameraPosition) - chain.radius * scale;
+
+		unsigned const last = static_cast<unsigned>(chain.levels.size() - 1);
+		unsigned level = std::min(current, last);
+		while(level > 0 && projectedError(chain.levels[level].error * scale, distance) > m_threshold)
+			--level;
+		while(level < last && projectedError(chain.levels[level + 1].error * scale, distance) <= m_threshold * (1.0f - m_hysteresis))
+			++level;
+		return level;
+	}
+
+	void LodSelector::select(const LodChain& chain, const glm::mat4* worlds, std::size_t count, const glm::vec3& cameraPosition, unsigned* levels, JobSystem* jobs) const
+	{
+		parallelFor(jobs, count, 256, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t i = begin; i < end; ++i)
+				levels[i] = select(chain, worlds[i], cameraPosition, levels[i]);
+		});
+	}
+}
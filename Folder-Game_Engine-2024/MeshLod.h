@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	struct MeshLod
+	{
+		Mesh mesh;
+		// Distance in mesh units the level may be off the source, summed over the simplifications that made it
+		float error;
+	};
+
+	// Level 0 is the source mesh. The bounding sphere is shared by every level.
+	struct LodChain
+	{
+		std::vector<MeshLod> levels;
+		glm::vec3 center;
+		float radius;
+
+		LodChain() : center(0.0f), radius(0.0f) {}
+	};
+
+	// Offline: each level keeps about reduction of the triangles of the previous one. The chain ends after maxLevels,
+	// below minTriangles, or when the simplifier can't get rid of a tenth of the triangles anymore.
+	LodChain buildLodChain(const Mesh& mesh, unsigned maxLevels = 6, float reduction = 0.5f, std::size_t minTriangles = 64);
+
+	// Picks the coarsest level whose error, projected on screen, stays under pixelThreshold. Levels only get coarser
+	// once their error is below (1 - hysteresis) * pixelThreshold, so an object sitting at a switching distance
+	// doesn't pop back and forth.
+	class LodSelector
+	{
+	public:
+		explicit LodSelector(float pixelThreshold = 1.0f, float hysteresis = 0.25f);
+
+		// Perspective or orthographic, viewportHeight in pixels
+		void setProjection(const glm::mat4& projection, float viewportHeight);
+
+		// Size in pixels of a world space error at distance from the camera
+		float projectedError(float error, float distance) const;
+
+		unsigned select(const LodChain& chain, const glm::mat4& world, const glm::vec3& cameraPosition, unsigned current) const;
+		// levels holds the current level of each instance and receives the new one
+		void select(const LodChain& chain, const glm::mat4* worlds, std::size_t count, const glm::vec3& cameraPosition, unsigned* levels, JobSystem* jobs = nullptr) const;
+
+	private:
+		float m_threshold;
+		float m_hysteresis;
+		float m_pixelsPerUnit;
+		bool m_orthographic;
+	};
+}
@@ -0,0 +1,107 @@
+#include "Benchmark.h"
+#include "MeshLod.h"
+
+#include <gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+	int const gridSize = 40;
+	float const spacing = 12.0f;
+	int const frameCount = 600;
+	float const viewportHeight = 1080.0f;
+
+	// Lumpy rock, so the simplifier has curvature to preserve
+	engine::Mesh makeRock()
+	{
+		engine::Mesh mesh = engine::makeSphere(128, 256, 2.0f);
+		for(glm::vec3& position : mesh.positions)
+		{
+			glm::vec3 const n = glm::normalize(position);
+			float const bumps = 0.15f * std::sin(5.0f * n.x) * std::cos(4.0f * n.y) + 0.05f * std::sin(17.0f * n.z + 3.0f * n.x);
+			position = n * (2.0f + bumps);
+		}
+		return mesh;
+	}
+
+	// Camera sweeping low over the field and back up along its diagonal, with some shake so objects sit around their
+	// switching distances for a while
+	glm::vec3 cameraAt(int frame)
+	{
+		float const t = static_cast<float>(frame) / frameCount;
+		float const extent = gridSize * spacing;
+		float const shake = 0.5f * std::sin(frame * 1.3f);
+		return glm::vec3(t * extent + shake, 3.0f + 40.0f * std::abs(std::sin(t * 3.14159265f * 2.0f)), t * extent * 0.8f + 10.0f * std::sin(t * 20.0f) + shake);
+	}
+
+	struct FlyThrough
+	{
+		double triangles;
+		double switches;
+	};
+
+	FlyThrough flyThrough(const engine::LodChain& chain, const std::vector<glm::mat4>& worlds, const engine::LodSelector& selector, engine::JobSystem* jobs)
+	{
+		FlyThrough result = { 0.0, 0.0 };
+		std::vector<unsigned> levels(worlds.size(), 0);
+		std::vector<unsigned> previous(worlds.size(), 0);
+		for(int frame = 0; frame < frameCount; ++frame)
+		{
+			previous = levels;
+			selector.select(chain, worlds.data(), worlds.size(), cameraAt(frame), levels.data(), jobs);
+			for(std::size_t i = 0; i < worlds.size(); ++i)
+			{
+				result.triangles += static_cast<double>(chain.levels[levels[i]].mesh.triangleCount());
+				result.switches += levels[i] != previous[i] ? 1.0 : 0.0;
+			}
+		}
+		result.triangles /= frameCount;
+		result.switches /= frameCount;
+		return result;
+	}
+}
+
+ENGINE_BENCHMARK(MeshLod)
+{
+	engine::Mesh const rock = makeRock();
+	engine::Stopwatch timer;
+	engine::LodChain const chain = engine::buildLodChain(rock, 8);
+	context.report("build chain", timer.elapsedMs(), "ms");
+	for(std::size_t level = 0; level < chain.levels.size(); ++level)
+	{
+		std::string const label = "lod " + std::to_string(level);
+		context.report((label + " triangles").c_str(), static_cast<double>(chain.levels[level].mesh.triangleCount()), "");
+		context.report((label + " error").c_str(), chain.levels[level].error, "units");
+	}
+
+	std::vector<glm::mat4> worlds;
+	for(int z = 0; z < gridSize; ++z)
+	for(int x = 0; x < gridSize; ++x)
+	{
+		float const scale = 0.5f + 0.5f * static_cast<float>((x * 7 + z * 13) % 5) / 4.0f;
+		glm::mat4 world = glm::translate(glm::mat4(1.0f), glm::vec3(x * spacing, 0.0f, z * spacing));
+		worlds.push_back(glm::scale(world, glm::vec3(scale)));
+	}
+
+	glm::mat4 const projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 2000.0f);
+	engine::LodSelector selector(1.0f, 0.25f);
+	selector.setProjection(projection, viewportHeight);
+	engine::LodSelector noHysteresis(1.0f, 0.0f);
+	noHysteresis.setProjection(projection, viewportHeight);
+
+	double const fullTriangles = static_cast<double>(rock.triangleCount() * worlds.size());
+	timer.restart();
+	FlyThrough const withLod = flyThrough(chain, worlds, selector, &context.jobs());
+	context.report("select per frame", timer.elapsedMs() / frameCount, "ms");
+	FlyThrough const without = flyThrough(chain, worlds, noHysteresis, &context.jobs());
+
+	context.report("full detail triangles", fullTriangles, "");
+	context.report("drawn triangles per frame", withLod.triangles, "");
+	context.report("saved triangles per frame", fullTriangles - withLod.triangles, "");
+	context.report("saved", 100.0 * (1.0 - withLod.triangles / fullTriangles), "%");
+	context.report("switches per frame", withLod.switches, "");
+	context.report("switches per frame without hysteresis", without.switches, "");
+}
@@ -0,0 +1,422 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace engine
+{
+	namespace
+	{
+		std::uint32_t const unusedVertex = 0xFFFFFFFFu;
+
+		// Triangles of every vertex, as offsets into one array
+		struct TriangleAdjacency
+		{
+			std::vector<std::uint32_t> offsets;
+			std::vector<std::uint32_t> triangles;
+
+			TriangleAdjacency(const std::vector<std::uint32_t>& indices, std::size_t vertexCount) :
+				offsets(vertexCount + 1, 0),
+				triangles(indices.size())
+			{
+				for(std::uint32_t index : indices)
+					++offsets[index + 1];
+				for(std::size_t vertex = 0; vertex < vertexCount; ++vertex)
+					offsets[vertex + 1] += offsets[vertex];
+
+				std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+				for(std::size_t i = 0; i < indices.size(); ++i)
+					triangles[cursor[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+			}
+
+			std::uint32_t count(std::uint32_t vertex) const { return offsets[vertex + 1] - offsets[vertex]; }
+		};
+
+		// FIFO cache where a vertex is cached while fewer than cacheSize misses happened since it was loaded
+		class FifoCache
+		{
+		public:
+			FifoCache(std::size_t vertexCount, unsigned cacheSize) : m_loadTime(vertexCount, 0), m_time(cacheSize + 1), m_size(cacheSize) {}
+
+			bool contains(std::uint32_t vertex) const { return m_time - m_loadTime[vertex] <= m_size; }
+			// Misses since the vertex was loaded, more than cacheSize when it isn't cached
+			std::uint32_t age(std::uint32_t vertex) const { return m_time - m_loadTime[vertex]; }
+
+			// Returns true on a miss
+			bool access(std::uint32_t vertex)
+			{
+				if(contains(vertex))
+					return false;
+				m_loadTime[vertex] = m_time++;
+				return true;
+			}
+
+			void reset() { m_time += m_size + 1; }
+
+		private:
+			std::vector<std::uint32_t> m_loadTime;
+			std::uint32_t m_time;
+			std::uint32_t m_size;
+		};
+	}
+
+	VertexCacheStats analyzeVertexCache(const std::vector<std::uint32_t>& indices, std::size_t vertexCount, unsigned cacheSize)
+	{
+		VertexCacheStats stats = { 0.0f, 0.0f };
+		if(indices.empty())
+			return stats;
+
+		FifoCache cache(vertexCount, cacheSize);
+		std::vector<bool> referenced(vertexCount, false);
+		std::size_t misses = 0;
+		std::size_t unique = 0;
+		for(std::uint32_t index : indices)
+		{
+			misses += cache.access(index) ? 1 : 0;
+			if(!referenced[index])
+			{
+				referenced[index] = true;
+				++unique;
+			}
+		}
+		stats.acmr = static_cast<float>(misses) / (indices.size() / 3);
+		stats.atvr = static_cast<float>(misses) / unique;
+		return stats;
+	}
+
+	float analyzeVertexFetch(const std::vector<std::uint32_t>& indices, std::size_t vertexCount, std::size_t vertexSize)
+	{
+		std::size_t const lineSize = 64;
+		std::size_t const lineCount = 256;
+		std::vector<std::size_t> lines(lineCount, ~std::size_t(0));
+		std::vector<bool> referenced(vertexCount, false);
+		std::size_t fetched = 0;
+		std::size_t unique = 0;
+		for(std::uint32_t index : indices)
+		{
+			if(!referenced[index])
+			{
+				referenced[index] = true;
+				++unique;
+			}
+
+			// A vertex may straddle two lines
+			std::size_t const first = index * vertexSize / lineSize;
+			std::size_t const last = (index * vertexSize + vertexSize - 1) / lineSize;
+			for(std::size_t line = first; line <= last; ++line)
+			{
+				std::size_t& slot = lines[line % lineCount];
+				if(slot != line)
+				{
+					slot = line;
+					fetched += lineSize;
+				}
+			}
+		}
+		return unique > 0 ? static_cast<float>(fetched) / (unique * vertexSize) : 0.0f;
+	}
+
+	void optimizeVertexCacheTipsify(std::vector<std::uint32_t>& indices, std::size_t vertexCount, unsigned cacheSize)
+	{
+		std::size_t const triangleCount = indices.size() / 3;
+		if(triangleCount == 0)
+			return;
+
+		TriangleAdjacency const adjacency(indices, vertexCount);
+		std::vector<std::uint32_t> live(vertexCount);
+		for(std::uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+			live[vertex] = adjacency.count(vertex);
+
+		FifoCache cache(vertexCount, cacheSize);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<std::uint32_t> deadEnd;
+		std::vector<std::uint32_t> candidates;
+		std::vector<std::uint32_t> result;
+		result.reserve(indices.size());
+
+		std::uint32_t fan = indices[0];
+		std::uint32_t scan = 0;
+		while(fan != unusedVertex)
+		{
+			candidates.clear();
+			for(std::uint32_t i = adjacency.offsets[fan]; i < adjacency.offsets[fan + 1]; ++i)
+			{
+				std::uint32_t const triangle = adjacency.triangles[i];
+				if(emitted[triangle])
+					continue;
+				emitted[triangle] = true;
+				for(int corner = 0; corner < 3; ++corner)
+				{
+					std::uint32_t const vertex = indices[triangle * 3 + corner];
+					result.push_back(vertex);
+					deadEnd.push_back(vertex);
+					candidates.push_back(vertex);
+					--live[vertex];
+					cache.access(vertex);
+				}
+			}
+
+			// Next fan: the candidate that stays cached the longest while its remaining triangles are emitted
+			fan = unusedVertex;
+			int best = -1;
+			for(std::uint32_t vertex : candidates)
+			{
+				if(live[vertex] == 0)
+					continue;
+				int priority = 0;
+				if(cache.age(vertex) + 2 * live[vertex] <= cacheSize)
+					priority = static_cast<int>(cache.age(vertex));
+				if(priority > best)
+				{
+					best = priority;
+					fan = vertex;
+				}
+			}
+
+			// Dead end: back to the most recent vertex with triangles left, then to the input order
+			while(fan == unusedVertex && !deadEnd.empty())
+			{
+				std::uint32_t const vertex = deadEnd.back();
+				deadEnd.pop_back();
+				if(live[vertex] > 0)
+					fan = vertex;
+			}
+			while(fan == unusedVertex && scan < indices.size())
+			{
+				if(live[indices[scan]] > 0)
+					fan = indices[scan];
+				++scan;
+			}
+		}
+		indices.swap(result);
+	}
+
+	void optimizeVertexCacheForsyth(std::vector<std::uint32_t>& indices, std::size_t vertexCount)
+	{
+		int const cacheSize = 32;
+		std::size_t const triangleCount = indices.size() / 3;
+		if(triangleCount == 0)
+			return;
+
+		// Scores from Forsyth's article: the last triangle's vertices are scored flat so fans don't win over strips
+		float positionScores[cacheSize];
+		for(int position = 0; position < cacheSize; ++position)
+			positionScores[position] = position < 3 ? 0.75f : std::pow(1.0f - (position - 3) / static_cast<float>(cacheSize - 3), 1.5f);
+		float liveScores[64];
+		liveScores[0] = 0.0f;
+		for(int live = 1; live < 64; ++live)
+			liveScores[live] = 2.0f / std::sqrt(static_cast<float>(live));
+
+		TriangleAdjacency const adjacency(indices, vertexCount);
+		std::vector<std::uint32_t> live(vertexCount);
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		auto vertexScore = [&](std::uint32_t vertex)
+		{
+			std::uint32_t const remaining = live[vertex];
+			if(remaining == 0)
+				return -1.0f;
+			float const valence = liveScores[std::min(remaining, 63u)];
+			return cachePosition[vertex] < 0 ? valence : valence + positionScores[cachePosition[vertex]];
+		};
+		for(std::uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			live[vertex] = adjacency.count(vertex);
+			vertexScores[vertex] = vertexScore(vertex);
+		}
+
+		std::vector<float> triangleScores(triangleCount);
+		for(std::size_t triangle = 0; triangle < triangleCount; ++triangle)
+			triangleScores[triangle] = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<std::uint32_t> cache;
+		std::vector<std::uint32_t> nextCache;
+		std::vector<std::uint32_t> result;
+		result.reserve(indices.size());
+		std::size_t scan = 0;
+		std::uint32_t best = 0;
+		for(std::size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+		{
+			emitted[best] = true;
+			std::uint32_t const* corner = &indices[best * 3];
+			result.insert(result.end(), corner, corner + 3);
+
+			// The triangle's vertices move to the front of the LRU cache
+			nextCache.assign(corner, corner + 3);
+			for(std::uint32_t vertex : cache)
+			{
+				if(vertex != corner[0] && vertex != corner[1] && vertex != corner[2])
+					nextCache.push_back(vertex);
+			}
+			for(int i = 0; i < 3; ++i)
+				--live[corner[i]];
+
+			// Vertices pushed out of the cache and the ones inside get rescored, along with their triangles
+			for(std::size_t i = 0; i < nextCache.size(); ++i)
+			{
+				std::uint32_t const vertex = nextCache[i];
+				cachePosition[vertex] = i < static_cast<std::size_t>(cacheSize) ? static_cast<int>(i) : -1;
+				float const score = vertexScore(vertex);
+				float const delta = score - vertexScores[vertex];
+				vertexScores[vertex] = score;
+				for(std::uint32_t j = adjacency.offsets[vertex]; j < adjacency.offsets[vertex + 1]; ++j)
+					triangleScores[adjacency.triangles[j]] += delta;
+			}
+			if(nextCache.size() > static_cast<std::size_t>(cacheSize))
+				nextCache.resize(cacheSize);
+			cache.swap(nextCache);
+
+			// The best triangle touching the cache, else the next one left in input order
+			float bestScore = -1.0f;
+			for(std::uint32_t vertex : cache)
+			{
+				for(std::uint32_t j = adjacency.offsets[vertex]; j < adjacency.offsets[vertex + 1]; ++j)
+				{
+					std::uint32_t const triangle = adjacency.triangles[j];
+					if(!emitted[triangle] && triangleScores[triangle] > bestScore)
+					{
+						bestScore = triangleScores[triangle];
+						best = triangle;
+					}
+				}
+			}
+			if(bestScore < 0.0f)
+			{
+				while(scan < triangleCount && emitted[scan])
+					++scan;
+				best = static_cast<std::uint32_t>(scan);
+			}
+		}
+		indices.swap(result);
+	}
+
+	void optimizeOverdraw(std::vector<std::uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold, unsigned cacheSize)
+	{
+		std::size_t const triangleCount = indices.size() / 3;
+		if(triangleCount == 0)
+			return;
+
+		// Hard boundaries where a triangle misses the cache on all three vertices, the order starts over there anyway.
+		// The first triangle always starts a cluster, even one that repeats a vertex.
+		FifoCache cache(positions.size(), cacheSize);
+		std::vector<std::size_t> hard(1, 0);
+		for(std::size_t triangle = 0; triangle < triangleCount; ++triangle)
+		{
+			int misses = 0;
+			for(int corner = 0; corner < 3; ++corner)
+				misses += cache.access(indices[triangle * 3 + corner]) ? 1 : 0;
+			if(misses == 3 && triangle > 0)
+				hard.push_back(triangle);
+		}
+		hard.push_back(triangleCount);
+
+		// Soft boundaries inside each hard cluster, as soon as the cluster so far is cheap enough to restart the cache after
+		std::vector<std::size_t> clusters;
+		for(std::size_t i = 0; i + 1 < hard.size(); ++i)
+		{
+			std::size_t const begin = hard[i];
+			std::size_t const end = hard[i + 1];
+			cache.reset();
+			std::size_t clusterMisses = 0;
+			for(std::size_t index = begin * 3; index < end * 3; ++index)
+				clusterMisses += cache.access(indices[index]) ? 1 : 0;
+			float const limit = threshold * clusterMisses / (end - begin);
+
+			cache.reset();
+			std::size_t start = begin;
+			std::size_t misses = 0;
+			clusters.push_back(begin);
+			for(std::size_t triangle = begin; triangle < end; ++triangle)
+			{
+				for(int corner = 0; corner < 3; ++corner)
+					misses += cache.access(indices[triangle * 3 + corner]) ? 1 : 0;
+				if(triangle + 1 < end && static_cast<float>(misses) / (triangle + 1 - start) <= limit)
+				{
+					start = triangle + 1;
+					misses = 0;
+					cache.reset();
+					clusters.push_back(start);
+				}
+			}
+		}
+		clusters.push_back(triangleCount);
+
+		// Clusters facing away from the mesh's center are drawn first
+		glm::vec3 meshCenter(0.0f);
+		float meshArea = 0.0f;
+		std::vector<float> sortKeys(clusters.size() - 1);
+		std::vector<glm::vec3> centers(clusters.size() - 1, glm::vec3(0.0f));
+		std::vector<glm::vec3> normals(clusters.size() - 1, glm::vec3(0.0f));
+		for(std::size_t cluster = 0; cluster + 1 < clusters.size(); ++cluster)
+		{
+			float area = 0.0f;
+			for(std::size_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle)
+			{
+				glm::vec3 const& p0 = positions[indices[triangle * 3]];
+				glm::vec3 const& p1 = positions[indices[triangle * 3 + 1]];
+				glm::vec3 const& p2 = positions[indices[triangle * 3 + 2]];
+				glm::vec3 const normal = glm::cross(p1 - p0, p2 - p0);
+				float const triangleArea = glm::length(normal);
+				centers[cluster] += (p0 + p1 + p2) * (triangleArea / 3.0f);
+				normals[cluster] += normal;
+				area += triangleArea;
+			}
+			meshCenter += centers[cluster];
+			meshArea += area;
+			centers[cluster] = area > 0.0f ? centers[cluster] / area : positions[indices[clusters[cluster] * 3]];
+		}
+		if(meshArea > 0.0f)
+			meshCenter /= meshArea;
+		for(std::size_t cluster = 0; cluster < sortKeys.size(); ++cluster)
+		{
+			float const length = glm::length(normals[cluster]);
+			sortKeys[cluster] = length > 0.0f ? glm::dot(centers[cluster] - meshCenter, normals[cluster] / length) : 0.0f;
+		}
+
+		std::vector<std::uint32_t> order(sortKeys.size());
+		for(std::uint32_t cluster = 0; cluster < order.size(); ++cluster)
+			order[cluster] = cluster;
+		std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b)
+		{
+			return sortKeys[a] > sortKeys[b];
+		});
+
+		std::vector<std::uint32_t> result;
+		result.reserve(indices.size());
+		for(std::uint32_t cluster : order)
+			result.insert(result.end(), indices.begin() + clusters[cluster] * 3, indices.begin() + clusters[cluster + 1] * 3);
+		indices.swap(result);
+	}
+
+	std::size_t vertexFetchRemap(const std::vector<std::uint32_t>& indices, std::size_t vertexCount, std::vector<std::uint32_t>& remap)
+	{
+		remap.assign(vertexCount, unusedVertex);
+		std::uint32_t next = 0;
+		for(std::uint32_t index : indices)
+		{
+			if(remap[index] == unusedVertex)
+				remap[index] = next++;
+		}
+		return next;
+	}
+
+	void optimizeVertexFetch(Mesh& mesh)
+	{
+		std::vector<std::uint32_t> remap;
+		std::size_t const kept = vertexFetchRemap(mesh.indices, mesh.positions.size(), remap);
+		remapVertices(mesh.positions, remap, kept);
+		for(std::uint32_t& index : mesh.indices)
+			index = remap[index];
+	}
+
+	void optimizeMesh(Mesh& mesh, VertexCacheMethod method, float overdrawThreshold)
+	{
+		if(method == VertexCacheMethod::Tipsify)
+			optimizeVertexCacheTipsify(mesh.indices, mesh.positions.size());
+		else
+			optimizeVertexCacheForsyth(mesh.indices, mesh.positions.size());
+		optimizeOverdraw(mesh.indices, mesh.positions, overdrawThreshold);
+		optimizeVertexFetch(mesh);
+	}
+}
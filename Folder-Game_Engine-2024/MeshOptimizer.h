@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	// Post-transform cache efficiency of an index order, simulated with a FIFO cache of cacheSize vertices.
+	// acmr is the number of vertices transformed per triangle (0.5 at best, 3 at worst), atvr the number of times each
+	// referenced vertex is transformed (1 at best).
+	struct VertexCacheStats
+	{
+		float acmr;
+		float atvr;
+	};
+
+	VertexCacheStats analyzeVertexCache(const std::vector<std::uint32_t>& indices, std::size_t vertexCount, unsigned cacheSize = 16);
+
+	// Bytes read from vertex memory divided by the bytes of the vertices referenced, through a small direct-mapped
+	// cache of 64 byte lines. 1 when every vertex is read once and vertices sit next to each other.
+	float analyzeVertexFetch(const std::vector<std::uint32_t>& indices, std::size_t vertexCount, std::size_t vertexSize);
+
+	// Tipsify (Sander, Nehab and Barczak 2007): fans around the vertex that stays longest in a FIFO of cacheSize. Linear time.
+	void optimizeVertexCacheTipsify(std::vector<std::uint32_t>& indices, std::size_t vertexCount, unsigned cacheSize = 16);
+
+	// Forsyth's linear-speed vertex cache optimisation: greedily emits the triangle whose vertices score highest in a
+	// simulated LRU cache of 32. Several times slower than Tipsify, meant for hardware whose cache isn't a FIFO.
+	void optimizeVertexCacheForsyth(std::vector<std::uint32_t>& indices, std::size_t vertexCount);
+
+	// Splits the index order into clusters where the cache restarts anyway, or where restarting costs at most threshold
+	// times the cluster's ACMR, then sorts the clusters outermost first so they occlude the rest of the mesh. Run it
+	// after a vertex cache optimization.
+	void optimizeOverdraw(std::vector<std::uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold = 1.05f, unsigned cacheSize = 16);
+
+	// Remap table ordering vertices by their first use, unreferenced vertices map to 0xFFFFFFFF.
+	// Returns the number of vertices kept.
+	std::size_t vertexFetchRemap(const std::vector<std::uint32_t>& indices, std::size_t vertexCount, std::vector<std::uint32_t>& remap);
+
+	template<typename T>
+	void remapVertices(std::vector<T>& vertices, const std::vector<std::uint32_t>& remap, std::size_t keptCount)
+	{
+		std::vector<T> remapped(keptCount);
+		for(std::size_t i = 0; i < vertices.size(); ++i)
+		{
+			if(remap[i] != 0xFFFFFFFFu)
+				remapped[remap[i]] = vertices[i];
+		}
+		vertices.swap(remapped);
+	}
+
+	// Reorders the mesh's vertices by first use and drops unreferenced ones
+	void optimizeVertexFetch(Mesh& mesh);
+
+	enum class VertexCacheMethod
+	{
+		Tipsify,
+		Forsyth
+	};
+
+	// Vertex cache, then overdraw, then vertex fetch
+	void optimizeMesh(Mesh& mesh, VertexCacheMethod method = VertexCacheMethod::Tipsify, float overdrawThreshold = 1.05f);
+}
@@ -0,0 +1,152 @@
+#include "Benchmark.h"
+#include "MeshAssets.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	bool writeText(const char* path, const char* text)
+	{
+		std::FILE* file = std::fopen(path, "wb");
+		if(!file)
+			return false;
+		bool const ok = std::fputs(text, file) >= 0;
+		return std::fclose(file) == 0 && ok;
+	}
+
+	// Sphere with triangles and vertices in random order, the way many exporters leave them
+	engine::Mesh makeShuffledSphere()
+	{
+		engine::Mesh mesh = engine::makeSphere(256, 512, 1.0f);
+		std::mt19937 random(7);
+
+		std::vector<std::uint32_t> triangles(mesh.triangleCount());
+		for(std::uint32_t i = 0; i < triangles.size(); ++i)
+			triangles[i] = i;
+		std::shuffle(triangles.begin(), triangles.end(), random);
+		std::vector<std::uint32_t> remap(mesh.vertexCount());
+		for(std::uint32_t i = 0; i < remap.size(); ++i)
+			remap[i] = i;
+		std::shuffle(remap.begin(), remap.end(), random);
+
+		std::vector<std::uint32_t> indices;
+		indices.reserve(mesh.indices.size());
+		for(std::uint32_t triangle : triangles)
+		{
+			for(int corner = 0; corner < 3; ++corner)
+				indices.push_back(remap[mesh.indices[triangle * 3 + corner]]);
+		}
+		mesh.indices.swap(indices);
+		engine::remapVertices(mesh.positions, remap, remap.size());
+		return mesh;
+	}
+
+	// Triangles by their corner positions, each rotated to start at its smallest corner so winding is kept, sorted.
+	// Positions rather than indices so vertex fetch's renumbering compares equal.
+	std::vector<std::array<float, 9> > triangleSet(const engine::Mesh& mesh)
+	{
+		std::vector<std::array<float, 9> > triangles(mesh.triangleCount());
+		for(std::size_t triangle = 0; triangle < triangles.size(); ++triangle)
+		{
+			std::array<float, 9> corners;
+			for(int corner = 0; corner < 3; ++corner)
+			{
+				glm::vec3 const& position = mesh.positions[mesh.indices[triangle * 3 + corner]];
+				corners[corner * 3] = position.x;
+				corners[corner * 3 + 1] = position.y;
+				corners[corner * 3 + 2] = position.z;
+			}
+			std::array<float, 9> const second = { corners[3], corners[4], corners[5], corners[6], corners[7], corners[8], corners[0], corners[1], corners[2] };
+			std::array<float, 9> const third = { corners[6], corners[7], corners[8], corners[0], corners[1], corners[2], corners[3], corners[4], corners[5] };
+			triangles[triangle] = std::min(corners, std::min(second, third));
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	bool sameTriangles(const engine::Mesh& mesh, const std::vector<std::array<float, 9> >& expected)
+	{
+		return mesh.indices.size() == expected.size() * 3 && triangleSet(mesh) == expected;
+	}
+
+	// A strip that starts with a degenerate triangle, so no triangle misses the cache on all three vertices
+	engine::Mesh makeDegenerateStrip()
+	{
+		engine::Mesh mesh;
+		for(int i = 0; i < 5; ++i)
+			mesh.positions.push_back(glm::vec3(static_cast<float>(i / 2), static_cast<float>(i % 2), 0.0f));
+		std::uint32_t const indices[9] = { 0, 0, 1, 1, 2, 3, 1, 3, 4 };
+		mesh.indices.assign(indices, indices + 9);
+		return mesh;
+	}
+
+	void reportStats(engine::BenchmarkContext& context, const std::string& label, const engine::Mesh& mesh)
+	{
+		engine::VertexCacheStats const stats = engine::analyzeVertexCache(mesh.indices, mesh.vertexCount());
+		context.report((label + " ACMR").c_str(), stats.acmr, "");
+		context.report((label + " ATVR").c_str(), stats.atvr, "");
+		context.report((label + " overfetch").c_str(), engine::analyzeVertexFetch(mesh.indices, mesh.vertexCount(), sizeof(glm::vec3)), "");
+	}
+}
+
+ENGINE_BENCHMARK(MeshOptimizer)
+{
+	engine::Mesh const source = makeShuffledSphere();
+	std::vector<std::array<float, 9> > const sourceTriangles = triangleSet(source);
+	bool kept = true;
+	context.report("triangles", static_cast<double>(source.triangleCount()), "");
+	reportStats(context, "shuffled", source);
+
+	engine::Stopwatch timer;
+	engine::Mesh tipsify = source;
+	engine::optimizeVertexCacheTipsify(tipsify.indices, tipsify.vertexCount());
+	context.report("tipsify", timer.elapsedMs(), "ms");
+	kept = kept && sameTriangles(tipsify, sourceTriangles);
+	reportStats(context, "tipsify", tipsify);
+
+	timer.restart();
+	engine::Mesh forsyth = source;
+	engine::optimizeVertexCacheForsyth(forsyth.indices, forsyth.vertexCount());
+	context.report("forsyth", timer.elapsedMs(), "ms");
+	kept = kept && sameTriangles(forsyth, sourceTriangles);
+	reportStats(context, "forsyth", forsyth);
+
+	timer.restart();
+	engine::optimizeOverdraw(forsyth.indices, forsyth.positions);
+	context.report("overdraw", timer.elapsedMs(), "ms");
+	kept = kept && sameTriangles(forsyth, sourceTriangles);
+	reportStats(context, "forsyth + overdraw", forsyth);
+
+	timer.restart();
+	engine::optimizeVertexFetch(forsyth);
+	context.report("vertex fetch", timer.elapsedMs(), "ms");
+	kept = kept && sameTriangles(forsyth, sourceTriangles);
+	reportStats(context, "optimized", forsyth);
+
+	// Every pass keeps every triangle, of the sphere and of a mesh no cluster boundary falls in
+	engine::Mesh const strip = makeDegenerateStrip();
+	std::vector<std::array<float, 9> > const stripTriangles = triangleSet(strip);
+	engine::Mesh stripTipsify = strip;
+	engine::optimizeMesh(stripTipsify, engine::VertexCacheMethod::Tipsify);
+	engine::Mesh stripForsyth = strip;
+	engine::optimizeMesh(stripForsyth, engine::VertexCacheMethod::Forsyth);
+	engine::Mesh stripOverdraw = strip;
+	engine::optimizeOverdraw(stripOverdraw.indices, stripOverdraw.positions);
+	kept = kept && sameTriangles(stripTipsify, stripTriangles) && sameTriangles(stripForsyth, stripTriangles) && sameTriangles(stripOverdraw, stripTriangles);
+	context.report("triangles kept", kept ? 1.0 : 0.0, "ok");
+
+	// Numbers are never taken from the next line: a short vertex is refused, a face ending in spaces keeps its corners
+	char const* const objPath = "mesh_optimizer_benchmark.obj";
+	engine::Mesh obj;
+	bool const shortRefused = writeText(objPath, "v 1 2\nv 3 4 5\nv 6 7 8\n") && !engine::loadObj(objPath, obj);
+	bool const faceRead = writeText(objPath, "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nf 1 2 3 \n 4\nf 2 4 3\n") && engine::loadObj(objPath, obj)
+		&& obj.positions.size() == 4 && obj.indices == std::vector<std::uint32_t>({ 0, 1, 2, 1, 3, 2 });
+	std::remove(objPath);
+	context.report("obj lines kept apart", shortRefused && faceRead ? 1.0 : 0.0, "ok");
+}
@@ -0,0 +1,341 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace engine
+{
+	namespace
+	{
+		std::uint32_t const invalidVertex = 0xFFFFFFFFu;
+		float const borderWeight = 10.0f;
+		// A collapse may turn a face by up to ~78 degrees
+		float const minNormalDot = 0.2f;
+
+		// Symmetric 4x4 matrix of the summed squared distances to a set of planes, kept in double as the sums grow large
+		struct Quadric
+		{
+			double a00, a01, a02, a03;
+			double a11, a12, a13;
+			double a22, a23;
+			double a33;
+
+			Quadric() : a00(0), a01(0), a02(0), a03(0), a11(0), a12(0), a13(0), a22(0), a23(0), a33(0) {}
+
+			static Quadric fromPlane(const glm::vec3& normal, float distance, float weight)
+			{
+				double const x = normal.x, y = normal.y, z = normal.z, d = distance, w = weight;
+				Quadric q;
+				q.a00 = w * x * x; q.a01 = w * x * y; q.a02 = w * x * z; q.a03 = w * x * d;
+				q.a11 = w * y * y; q.a12 = w * y * z; q.a13 = w * y * d;
+				q.a22 = w * z * z; q.a23 = w * z * d;
+				q.a33 = w * d * d;
+				return q;
+			}
+
+			Quadric& operator+=(const Quadric& q)
+			{
+				a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+				a11 += q.a11; a12 += q.a12; a13 += q.a13;
+				a22 += q.a22; a23 += q.a23;
+				a33 += q.a33;
+				return *this;
+			}
+
+			double evaluate(const glm::vec3& p) const
+			{
+				double const x = p.x, y = p.y, z = p.z;
+				double const error = x * (a00 * x + 2.0 * (a01 * y + a02 * z + a03))
+					+ y * (a11 * y + 2.0 * (a12 * z + a13))
+					+ z * (a22 * z + 2.0 * a23)
+					+ a33;
+				return std::max(error, 0.0);
+			}
+
+			// Point minimizing the error, false when the planes don't pin one down
+			bool minimum(glm::vec3& p) const
+			{
+				glm::dmat3 const a(a00, a01, a02, a01, a11, a12, a02, a12, a22);
+				double const determinant = glm::determinant(a);
+				if(std::abs(determinant) < 1e-12)
+					return false;
+				p = glm::vec3(glm::inverse(a) * glm::dvec3(-a03, -a13, -a23));
+				return true;
+			}
+		};
+
+		struct Collapse
+		{
+			double cost;
+			std::uint32_t from;
+			std::uint32_t to;
+			std::uint32_t fromVersion;
+			std::uint32_t toVersion;
+			glm::vec3 position;
+
+			bool operator>(const Collapse& other) const { return cost > other.cost; }
+		};
+
+		class Simplifier
+		{
+		public:
+			explicit Simplifier(const Mesh& source);
+
+			double run(std::size_t targetTriangles, double maxCost);
+			void extract(Mesh& result) const;
+
+		private:
+			// With the corner moved, if any, placed at position
+			glm::vec3 faceNormal(std::uint32_t triangle, std::uint32_t moved = invalidVertex, const glm::vec3& position = glm::vec3(0.0f)) const;
+			void pushCollapse(std::uint32_t a, std::uint32_t b);
+			bool flips(std::uint32_t vertex, std::uint32_t other, const glm::vec3& position) const;
+			void collapse(const Collapse& edge);
+
+			std::vector<glm::vec3> m_positions;
+			std::vector<std::uint32_t> m_indices;
+			std::vector<Quadric> m_quadrics;
+			std::vector<std::vector<std::uint32_t>> m_vertexTriangles;
+			std::vector<std::uint32_t> m_versions;
+			std::vector<bool> m_vertexAlive;
+			std::vector<bool> m_triangleAlive;
+			std::size_t m_triangleCount;
+			std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_heap;
+		};
+
+		Simplifier::Simplifier(const Mesh& source) :
+			m_positions(source.positions),
+			m_indices(source.indices),
+			m_quadrics(source.positions.size()),
+			m_vertexTriangles(source.positions.size()),
+			m_versions(source.positions.size(), 0),
+			m_vertexAlive(source.positions.size(), true),
+			m_triangleAlive(source.triangleCount(), true),
+			m_triangleCount(source.triangleCount())
+		{
+			// Undirected edges with the number of faces using them, borders are used once
+			std::vector<std::pair<std::uint64_t, std::uint32_t>> edges;
+			edges.reserve(m_indices.size());
+			for(std::uint32_t triangle = 0; triangle < m_triangleCount; ++triangle)
+			{
+				std::uint32_t const* corner = &m_indices[triangle * 3];
+				glm::vec3 const normal = glm::cross(m_positions[corner[1]] - m_positions[corner[0]], m_positions[corner[2]] - m_positions[corner[0]]);
+				float const length = glm::length(normal);
+				for(int i = 0; i < 3; ++i)
+				{
+					m_vertexTriangles[corner[i]].push_back(triangle);
+					std::uint32_t const a = std::min(corner[i], corner[(i + 1) % 3]);
+					std::uint32_t const b = std::max(corner[i], corner[(i + 1) % 3]);
+					edges.push_back(std::make_pair((static_cast<std::uint64_t>(a) << 32) | b, triangle));
+				}
+				if(length <= 0.0f)
+					continue;
+				glm::vec3 const unit = normal / length;
+				Quadric const plane = Quadric::fromPlane(unit, -glm::dot(unit, m_positions[corner[0]]), 1.0f);
+				for(int i = 0; i < 3; ++i)
+					m_quadrics[corner[i]] += plane;
+			}
+
+			std::sort(edges.begin(), edges.end());
+			for(std::size_t i = 0; i < edges.size();)
+			{
+				std::size_t end = i + 1;
+				while(end < edges.size() && edges[end].first == edges[i].first)
+					++end;
+
+				std::uint32_t const a = static_cast<std::uint32_t>(edges[i].first >> 32);
+				std::uint32_t const b = static_cast<std::uint32_t>(edges[i].first);
+				if(end - i == 1)
+				{
+					// Border: a plane through the edge, perpendicular to its face
+					glm::vec3 const normal = glm::cross(m_positions[b] - m_positions[a], faceNormal(edges[i].second));
+					float const length = glm::length(normal);
+					if(length > 0.0f)
+					{
+						glm::vec3 const unit = normal / length;
+						Quadric const plane = Quadric::fromPlane(unit, -glm::dot(unit, m_positions[a]), borderWeight);
+						m_quadrics[a] += plane;
+						m_quadrics[b] += plane;
+					}
+				}
+				i = end;
+			}
+
+			for(std::size_t i = 0; i < edges.size(); ++i)
+			{
+				if(i == 0 || edges[i].first != edges[i - 1].first)
+					pushCollapse(static_cast<std::uint32_t>(edges[i].first >> 32), static_cast<std::uint32_t>(edges[i].first));
+			}
+		}
+
+		glm::vec3 Simplifier::faceNormal(std::uint32_t triangle, std::uint32_t moved, const glm::vec3& position) const
+		{
+			std::uint32_t const* corner = &m_indices[triangle * 3];
+			glm::vec3 const p0 = corner[0] == moved ? position : m_positions[corner[0]];
+			glm::vec3 const p1 = corner[1] == moved ? position : m_positions[corner[1]];
+			glm::vec3 const p2 = corner[2] == moved ? position : m_positions[corner[2]];
+			glm::vec3 const normal = glm::cross(p1 - p0, p2 - p0);
+			float const length = glm::length(normal);
+			return length > 0.0f ? normal / length : glm::vec3(0.0f);
+		}
+
+		void Simplifier::pushCollapse(std::uint32_t a, std::uint32_t b)
+		{
+			Quadric q = m_quadrics[a];
+			q += m_quadrics[b];
+
+			// The best of the ends, the middle and the optimal point. The latter is ignored when it's far from the edge,
+			// which happens on nearly flat patches where the quadric barely pins it down.
+			glm::vec3 const middle = (m_positions[a] + m_positions[b]) * 0.5f;
+			glm::vec3 candidates[4] = { m_positions[a], m_positions[b], middle, glm::vec3(0.0f) };
+			int candidateCount = 3;
+			if(q.minimum(candidates[3]) && glm::distance(candidates[3], middle) <= glm::distance(m_positions[a], m_positions[b]))
+				candidateCount = 4;
+
+			Collapse edge;
+			edge.cost = std::numeric_limits<double>::max();
+			for(int i = 0; i < candidateCount; ++i)
+			{
+				double const cost = q.evaluate(candidates[i]);
+				if(cost < edge.cost)
+				{
+					edge.cost = cost;
+					edge.position = candidates[i];
+				}
+			}
+			edge.from = a;
+			edge.to = b;
+			edge.fromVersion = m_versions[a];
+			edge.toVersion = m_versions[b];
+			m_heap.push(edge);
+		}
+
+		bool Simplifier::flips(std::uint32_t vertex, std::uint32_t other, const glm::vec3& position) const
+		{
+			for(std::uint32_t triangle : m_vertexTriangles[vertex])
+			{
+				if(!m_triangleAlive[triangle])
+					continue;
+				std::uint32_t const* corner = &m_indices[triangle * 3];
+				if(corner[0] == other || corner[1] == other || corner[2] == other)
+					continue;
+				glm::vec3 const before = faceNormal(triangle);
+				glm::vec3 const after = faceNormal(triangle, vertex, position);
+				if(glm::dot(before, after) < minNormalDot)
+					return true;
+			}
+			return false;
+		}
+
+		void Simplifier::collapse(const Collapse& edge)
+		{
+			std::uint32_t const from = edge.from;
+			std::uint32_t const to = edge.to;
+
+			m_positions[to] = edge.position;
+			m_quadrics[to] += m_quadrics[from];
+			for(std::uint32_t triangle : m_vertexTriangles[from])
+			{
+				if(!m_triangleAlive[triangle])
+					continue;
+				std::uint32_t* corner = &m_indices[triangle * 3];
+				if(corner[0] == to || corner[1] == to || corner[2] == to)
+				{
+					m_triangleAlive[triangle] = false;
+					--m_triangleCount;
+					continue;
+				}
+				std::replace(corner, corner + 3, from, to);
+				m_vertexTriangles[to].push_back(triangle);
+			}
+
+			std::vector<std::uint32_t>& triangles = m_vertexTriangles[to];
+			triangles.erase(std::remove_if(triangles.begin(), triangles.end(), [this](std::uint32_t triangle)
+			{
+				return !m_triangleAlive[triangle];
+			}), triangles.end());
+			m_vertexTriangles[from].clear();
+			m_vertexAlive[from] = false;
+			++m_versions[from];
+			++m_versions[to];
+
+			// Every edge around the merged vertex has a new quadric
+			std::vector<std::uint32_t> neighbours;
+			for(std::uint32_t triangle : triangles)
+			{
+				for(int i = 0; i < 3; ++i)
+				{
+					if(m_indices[triangle * 3 + i] != to)
+						neighbours.push_back(m_indices[triangle * 3 + i]);
+				}
+			}
+			std::sort(neighbours.begin(), neighbours.end());
+			neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+			for(std::uint32_t neighbour : neighbours)
+				pushCollapse(to, neighbour);
+		}
+
+		double Simplifier::run(std::size_t targetTriangles, double maxCost)
+		{
+			double largest = 0.0;
+			while(m_triangleCount > targetTriangles && !m_heap.empty())
+			{
+				Collapse edge = m_heap.top();
+				m_heap.pop();
+				if(!m_vertexAlive[edge.from] || !m_vertexAlive[edge.to]
+					|| edge.fromVersion != m_versions[edge.from] || edge.toVersion != m_versions[edge.to])
+					continue;
+				if(edge.cost > maxCost)
+					break;
+
+				if(flips(edge.from, edge.to, edge.position) || flips(edge.to, edge.from, edge.position))
+					continue;
+				collapse(edge);
+				largest = std::max(largest, edge.cost);
+			}
+			return largest;
+		}
+
+		void Simplifier::extract(Mesh& result) const
+		{
+			std::vector<std::uint32_t> remap(m_positions.size(), invalidVertex);
+			result.positions.clear();
+			result.indices.clear();
+			result.indices.reserve(m_triangleCount * 3);
+
+			// Vertices keep their relative order, which keeps whatever locality the source had
+			for(std::size_t triangle = 0; triangle < m_triangleAlive.size(); ++triangle)
+			{
+				if(!m_triangleAlive[triangle])
+					continue;
+				for(int i = 0; i < 3; ++i)
+					remap[m_indices[triangle * 3 + i]] = 0;
+			}
+			for(std::size_t vertex = 0; vertex < remap.size(); ++vertex)
+			{
+				if(remap[vertex] == invalidVertex)
+					continue;
+				remap[vertex] = static_cast<std::uint32_t>(result.positions.size());
+				result.positions.push_back(m_positions[vertex]);
+			}
+			for(std::size_t triangle = 0; triangle < m_triangleAlive.size(); ++triangle)
+			{
+				if(!m_triangleAlive[triangle])
+					continue;
+				for(int i = 0; i < 3; ++i)
+					result.indices.push_back(remap[m_indices[triangle * 3 + i]]);
+			}
+		}
+	}
+
+	float simplifyMesh(const Mesh& source, std::size_t targetTriangles, float maxError, Mesh& result)
+	{
+		Simplifier simplifier(source);
+		double const cost = simplifier.run(targetTriangles, static_cast<double>(maxError) * maxError);
+		simplifier.extract(result);
+		return static_cast<float>(std::sqrt(cost));
+	}
+}
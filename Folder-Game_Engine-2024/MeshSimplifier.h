@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+
+namespace engine
+{
+	// Quadric error metric edge collapse (Garland and Heckbert). Collapses the cheapest edges until the mesh has at most
+	// targetTriangles triangles or the next collapse would cost more than maxError, which is a distance in mesh units.
+	// Open borders are held in place by planes perpendicular to their faces, and collapses that flip a face are skipped.
+	//
+	// Returns the largest error of the collapses made. Unreferenced vertices are dropped from the result.
+	float simplifyMesh(const Mesh& source, std::size_t targetTriangles, float maxError, Mesh& result);
+}
@@ -0,0 +1,67 @@
+#include "MovingBounds.h"
+#include "JobSystem.h"
+
+#include <gtx/bounds_transform.hpp>
+
+#include <algorithm>
+
+namespace engine
+{
+	std::uint32_t MovingBounds::add(const Aabb& local)
+	{
+		std::uint32_t const index = static_cast<std::uint32_t>(size());
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			m_center[axis].push_back(0.0f);
+			m_extent[axis].push_back(0.0f);
+			m_min[axis].push_back(0.0f);
+			m_max[axis].push_back(0.0f);
+		}
+		setLocal(index, local);
+		return index;
+	}
+
+	void MovingBounds::setLocal(std::uint32_t index, const Aabb& local)
+	{
+		glm::vec3 const center = local.center();
+		glm::vec3 const extent = local.extent();
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			m_center[axis][index] = center[axis];
+			m_extent[axis][index] = extent[axis];
+		}
+	}
+
+	void MovingBounds::clear()
+	{
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			m_center[axis].clear();
+			m_extent[axis].clear();
+			m_min[axis].clear();
+			m_max[axis].clear();
+		}
+	}
+
+	void MovingBounds::update(const glm::mat4* worlds, JobSystem* jobs)
+	{
+		// Ranges are whole multiples of 8 boxes but the last one, so only the end of the array takes the scalar path
+		std::size_t const blockSize = 8;
+		std::size_t const blockCount = (size() + blockSize - 1) / blockSize;
+		parallelFor(jobs, blockCount, 512, [&](std::size_t begin, std::size_t end)
+		{
+			std::size_t const first = begin * blockSize;
+			std::size_t const last = std::min(end * blockSize, size());
+			float const* const center[3] = { m_center[0].data() + first, m_center[1].data() + first, m_center[2].data() + first };
+			float const* const extent[3] = { m_extent[0].data() + first, m_extent[1].data() + first, m_extent[2].data() + first };
+			float* const min[3] = { m_min[0].data() + first, m_min[1].data() + first, m_min[2].data() + first };
+			float* const max[3] = { m_max[0].data() + first, m_max[1].data() + first, m_max[2].data() + first };
+			glm::transformBoundsBulk(worlds + first, center, extent, min, max, last - first);
+		});
+	}
+
+	Aabb MovingBounds::world(std::uint32_t index) const
+	{
+		return Aabb(glm::vec3(m_min[0][index], m_min[1][index], m_min[2][index]), glm::vec3(m_max[0][index], m_max[1][index], m_max[2][index]));
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Bounds.h"
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	// Local boxes of moving objects and their world boxes, kept as structures of arrays so update() can transform
+	// eight of them per instruction with glm::transformBoundsBulk. Index i is whatever the owner makes it, usually the
+	// object's slot in its transform array.
+	class MovingBounds
+	{
+	public:
+		std::uint32_t add(const Aabb& local);
+		void setLocal(std::uint32_t index, const Aabb& local);
+		void clear();
+
+		// worlds holds one affine matrix per box
+		void update(const glm::mat4* worlds, JobSystem* jobs = nullptr);
+
+		std::size_t size() const { return m_center[0].size(); }
+		Aabb world(std::uint32_t index) const;
+
+		// Structure of arrays of the world boxes, valid after update()
+		const float* worldMin(int axis) const { return m_min[axis].data(); }
+		const float* worldMax(int axis) const { return m_max[axis].data(); }
+
+	private:
+		std::vector<float> m_center[3];
+		std::vector<float> m_extent[3];
+		std::vector<float> m_min[3];
+		std::vector<float> m_max[3];
+	};
+}
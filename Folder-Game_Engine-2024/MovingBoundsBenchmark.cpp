@@ -0,0 +1,93 @@
+#include "Benchmark.h"
+#include "MovingBounds.h"
+
+#include <gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+	std::size_t const moverCount = 100000;
+	int const frameCount = 100;
+
+	// Reference: the eight corners through mat4 * vec4
+	engine::Aabb transformCorners(const engine::Aabb& local, const glm::mat4& world)
+	{
+		glm::vec3 min(std::numeric_limits<float>::max());
+		glm::vec3 max(-std::numeric_limits<float>::max());
+		for(int corner = 0; corner < 8; ++corner)
+		{
+			glm::vec4 const point((corner & 1) ? local.max.x : local.min.x, (corner & 2) ? local.max.y : local.min.y, (corner & 4) ? local.max.z : local.min.z, 1.0f);
+			glm::vec3 const transformed(world * point);
+			min = glm::min(min, transformed);
+			max = glm::max(max, transformed);
+		}
+		return engine::Aabb(min, max);
+	}
+}
+
+ENGINE_BENCHMARK(MovingBounds)
+{
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<engine::Aabb> locals(moverCount);
+	std::vector<glm::mat4> worlds(moverCount);
+	engine::MovingBounds bounds;
+	for(std::size_t i = 0; i < moverCount; ++i)
+	{
+		glm::vec3 const center(unit(random), unit(random), unit(random));
+		glm::vec3 const extent = glm::abs(glm::vec3(unit(random), unit(random), unit(random))) + 0.1f;
+		locals[i] = engine::Aabb::fromCenterExtent(center, extent);
+		bounds.add(locals[i]);
+	}
+
+	// Every mover changes every frame, the worst case for keeping culling input fresh
+	auto animate = [&](int frame)
+	{
+		for(std::size_t i = 0; i < moverCount; ++i)
+		{
+			float const angle = 0.01f * static_cast<float>(frame) + static_cast<float>(i);
+			glm::mat4 const world = glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(i % 317), 0.0f, static_cast<float>(i / 317)));
+			worlds[i] = glm::rotate(world, angle, glm::vec3(0.0f, 1.0f, 0.0f));
+		}
+	};
+
+	std::vector<engine::Aabb> reference(moverCount);
+	double cornersMs = 0.0;
+	double serialMs = 0.0;
+	double parallelMs = 0.0;
+	for(int frame = 0; frame < frameCount; ++frame)
+	{
+		animate(frame);
+
+		engine::Stopwatch timer;
+		for(std::size_t i = 0; i < moverCount; ++i)
+			reference[i] = transformCorners(locals[i], worlds[i]);
+		cornersMs += timer.elapsedMs();
+
+		timer.restart();
+		bounds.update(worlds.data());
+		serialMs += timer.elapsedMs();
+
+		timer.restart();
+		bounds.update(worlds.data(), &context.jobs());
+		parallelMs += timer.elapsedMs();
+	}
+
+	double maxError = 0.0;
+	for(std::uint32_t i = 0; i < moverCount; ++i)
+	{
+		engine::Aabb const world = bounds.world(i);
+		glm::vec3 const error = glm::max(glm::abs(world.min - reference[i].min), glm::abs(world.max - reference[i].max));
+		maxError = std::max(maxError, static_cast<double>(glm::max(error.x, glm::max(error.y, error.z))));
+	}
+
+	context.report("movers", static_cast<double>(moverCount), "");
+	context.report("8 corners per frame", cornersMs / frameCount, "ms");
+	context.report("bulk per frame", serialMs / frameCount, "ms");
+	context.report("bulk on jobs per frame", parallelMs / frameCount, "ms");
+	context.report("max difference", maxError, "units");
+}
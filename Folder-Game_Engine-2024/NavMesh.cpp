@@ -0,0 +1,511 @@
+#include "NavMesh.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+namespace engine
+{
+	namespace
+	{
+		std::uint32_t const noCell = 0xFFFFFFFFu;
+		int const bandRows = 16;
+		// Spans whose tops are this close merge their walkable flags
+		int const flagMergeCells = 1;
+
+		// Directions -x, +z, +x, -z, the opposite of d is (d + 2) & 3
+		int const directionX[4] = { -1, 0, 1, 0 };
+		int const directionZ[4] = { 0, 1, 0, -1 };
+
+		struct Span
+		{
+			int bottom;
+			int top;
+			bool walkable;
+		};
+
+		// Solid spans per column in cellHeight units above the bounds, sorted and not overlapping
+		struct Heightfield
+		{
+			int width;
+			int depth;
+			glm::vec3 origin;
+			std::vector<std::vector<Span> > columns;
+		};
+
+		// Open space on top of a walkable span
+		struct Cell
+		{
+			int x;
+			int z;
+			int floor;
+			int ceiling;
+			std::uint32_t links[4];
+		};
+
+		void addSpan(std::vector<Span>& column, int bottom, int top, bool walkable)
+		{
+			Span span = { bottom, top, walkable };
+			std::vector<Span>::iterator it = column.begin();
+			while(it != column.end())
+			{
+				if(it->bottom > span.top)
+					break;
+				if(it->top < span.bottom)
+				{
+					++it;
+					continue;
+				}
+				// Overlapping: the higher top decides whether the merged span is walkable
+				if(std::abs(it->top - span.top) <= flagMergeCells)
+					span.walkable = span.walkable || it->walkable;
+				else if(it->top > span.top)
+					span.walkable = it->walkable;
+				span.bottom = std::min(span.bottom, it->bottom);
+				span.top = std::max(span.top, it->top);
+				it = column.erase(it);
+			}
+			column.insert(it, span);
+		}
+
+		// Keeps the part of the polygon where sign * (p[axis] - value) >= 0
+		int clip(const glm::vec3* in, int count, glm::vec3* out, int axis, float value, float sign)
+		{
+			int result = 0;
+			for(int i = 0; i < count; ++i)
+			{
+				const glm::vec3& a = in[i];
+				const glm::vec3& b = in[(i + 1) % count];
+				float const da = sign * (a[axis] - value);
+				float const db = sign * (b[axis] - value);
+				if(da >= 0.0f)
+					out[result++] = a;
+				if((da >= 0.0f) != (db >= 0.0f))
+					out[result++] = a + (b - a) * (da / (da - db));
+			}
+			return result;
+		}
+
+		// Clips the triangle to each cell it covers in rows [rowBegin, rowEnd) and adds the covered height range
+		void rasterizeTriangle(const glm::vec3* triangle, bool walkable, int rowBegin, int rowEnd, const NavMeshSettings& settings, Heightfield& field)
+		{
+			float const inverseCell = 1.0f / settings.cellSize;
+			float const inverseHeight = 1.0f / settings.cellHeight;
+			glm::vec3 const low = glm::min(glm::min(triangle[0], triangle[1]), triangle[2]) - field.origin;
+			glm::vec3 const high = glm::max(glm::max(triangle[0], triangle[1]), triangle[2]) - field.origin;
+			int const z0 = std::max(rowBegin, static_cast<int>(std::floor(low.z * inverseCell)));
+			int const z1 = std::min(rowEnd - 1, static_cast<int>(std::floor(high.z * inverseCell)));
+			int const x0 = std::max(0, static_cast<int>(std::floor(low.x * inverseCell)));
+			int const x1 = std::min(field.width - 1, static_cast<int>(std::floor(high.x * inverseCell)));
+
+			glm::vec3 input[3];
+			for(int i = 0; i < 3; ++i)
+				input[i] = triangle[i] - field.origin;
+			glm::vec3 row[8];
+			glm::vec3 cell[12];
+			glm::vec3 scratch[12];
+			for(int z = z0; z <= z1; ++z)
+			{
+				int count = clip(input, 3, scratch, 2, z * settings.cellSize, 1.0f);
+				count = clip(scratch, count, row, 2, (z + 1) * settings.cellSize, -1.0f);
+				if(count < 3)
+					continue;
+				for(int x = x0; x <= x1; ++x)
+				{
+					int n = clip(row, count, scratch, 0, x * settings.cellSize, 1.0f);
+					n = clip(scratch, n, cell, 0, (x + 1) * settings.cellSize, -1.0f);
+					if(n < 3)
+						continue;
+					float minY = cell[0].y;
+					float maxY = cell[0].y;
+					for(int i = 1; i < n; ++i)
+					{
+						minY = std::min(minY, cell[i].y);
+						maxY = std::max(maxY, cell[i].y);
+					}
+					int const bottom = static_cast<int>(std::floor(minY * inverseHeight));
+					int const top = std::max(bottom, static_cast<int>(std::ceil(maxY * inverseHeight)));
+					addSpan(field.columns[z * field.width + x], bottom, top, walkable);
+				}
+			}
+		}
+	}
+
+	glm::vec3 NavPolygon::closestPoint(const glm::vec3& point) const
+	{
+		glm::vec3 const& low = corners[0];
+		glm::vec3 const& high = corners[2];
+		float const x = glm::clamp(point.x, low.x, high.x);
+		float const z = glm::clamp(point.z, low.z, high.z);
+		float const u = high.x > low.x ? (x - low.x) / (high.x - low.x) : 0.0f;
+		float const v = high.z > low.z ? (z - low.z) / (high.z - low.z) : 0.0f;
+		float const y = glm::mix(glm::mix(corners[0].y, corners[1].y, v), glm::mix(corners[3].y, corners[2].y, v), u);
+		return glm::vec3(x, y, z);
+	}
+
+	std::uint32_t NavMesh::findPolygon(const glm::vec3& point, float searchRadius, glm::vec3* nearest) const
+	{
+		if(m_polygons.empty())
+			return invalidPolygon;
+		float const inverseBucket = 1.0f / m_bucketSize;
+		int const bx0 = std::max(0, static_cast<int>(std::floor((point.x - searchRadius - m_bounds.min.x) * inverseBucket)));
+		int const bx1 = std::min(m_bucketsX - 1, static_cast<int>(std::floor((point.x + searchRadius - m_bounds.min.x) * inverseBucket)));
+		int const bz0 = std::max(0, static_cast<int>(std::floor((point.z - searchRadius - m_bounds.min.z) * inverseBucket)));
+		int const bz1 = std::min(m_bucketsZ - 1, static_cast<int>(std::floor((point.z + searchRadius - m_bounds.min.z) * inverseBucket)));
+
+		std::uint32_t best = invalidPolygon;
+		float bestDistance = std::numeric_limits<float>::max();
+		glm::vec3 bestPoint(0.0f);
+		for(int bz = bz0; bz <= bz1; ++bz)
+		{
+			for(int bx = bx0; bx <= bx1; ++bx)
+			{
+				std::size_t const bucket = static_cast<std::size_t>(bz) * m_bucketsX + bx;
+				for(std::uint32_t i = m_bucketStart[bucket]; i < m_bucketStart[bucket + 1]; ++i)
+				{
+					std::uint32_t const index = m_bucketPolygons[i];
+					glm::vec3 const closest = m_polygons[index].closestPoint(point);
+					glm::vec3 const offset = closest - point;
+					if(offset.x * offset.x + offset.z * offset.z > searchRadius * searchRadius)
+						continue;
+					float const distance = glm::dot(offset, offset);
+					if(distance < bestDistance)
+					{
+						bestDistance = distance;
+						best = index;
+						bestPoint = closest;
+					}
+				}
+			}
+		}
+		if(nearest && best != invalidPolygon)
+			*nearest = bestPoint;
+		return best;
+	}
+
+	void NavMesh::buildBuckets(float bucketSize)
+	{
+		m_bucketSize = bucketSize;
+		glm::vec3 const size = m_bounds.max - m_bounds.min;
+		m_bucketsX = std::max(1, static_cast<int>(std::ceil(size.x / bucketSize)));
+		m_bucketsZ = std::max(1, static_cast<int>(std::ceil(size.z / bucketSize)));
+
+		// Counted then filled, polygons are inserted into every bucket they overlap
+		std::size_t const bucketCount = static_cast<std::size_t>(m_bucketsX) * m_bucketsZ;
+		m_bucketStart.assign(bucketCount + 1, 0);
+		for(int pass = 0; pass < 2; ++pass)
+		{
+			std::vector<std::uint32_t> cursor;
+			if(pass == 1)
+			{
+				for(std::size_t i = 0; i < bucketCount; ++i)
+					m_bucketStart[i + 1] += m_bucketStart[i];
+				m_bucketPolygons.resize(m_bucketStart[bucketCount]);
+				cursor.assign(m_bucketStart.begin(), m_bucketStart.end() - 1);
+			}
+			for(std::uint32_t p = 0; p < m_polygons.size(); ++p)
+			{
+				const NavPolygon& polygon = m_polygons[p];
+				int const x0 = glm::clamp(static_cast<int>((polygon.corners[0].x - m_bounds.min.x) / bucketSize), 0, m_bucketsX - 1);
+				int const x1 = glm::clamp(static_cast<int>((polygon.corners[2].x - m_bounds.min.x) / bucketSize), 0, m_bucketsX - 1);
+				int const z0 = glm::clamp(static_cast<int>((polygon.corners[0].z - m_bounds.min.z) / bucketSize), 0, m_bucketsZ - 1);
+				int const z1 = glm::clamp(static_cast<int>((polygon.corners[2].z - m_bounds.min.z) / bucketSize), 0, m_bucketsZ - 1);
+				for(int z = z0; z <= z1; ++z)
+				{
+					for(int x = x0; x <= x1; ++x)
+					{
+						std::size_t const bucket = static_cast<std::size_t>(z) * m_bucketsX + x;
+						if(pass == 0)
+							++m_bucketStart[bucket + 1];
+						else
+							m_bucketPolygons[cursor[bucket]++] = p;
+					}
+				}
+			}
+		}
+	}
+
+	void buildNavMesh(const Mesh& level, const NavMeshSettings& settings, NavMesh& result, JobSystem* jobs)
+	{
+		result.m_polygons.clear();
+		result.m_links.clear();
+		Aabb const bounds = computeBounds(level);
+		result.m_bounds = bounds;
+
+		int const heightCells = static_cast<int>(std::ceil(settings.agentHeight / settings.cellHeight));
+		int const climbCells = static_cast<int>(std::floor(settings.agentClimb / settings.cellHeight));
+		// A cell d steps from the edge keeps (d + 0.5) cells between its center and the edge
+		int const radiusCells = std::max(0, static_cast<int>(std::ceil(settings.agentRadius / settings.cellSize - 0.5f)));
+		float const minNormalY = std::cos(glm::radians(settings.maxSlope));
+
+		// Voxelization, triangles are binned into bands of rows that rasterize independently
+		Heightfield field;
+		field.origin = bounds.min;
+		field.width = std::max(1, static_cast<int>(std::ceil((bounds.max.x - bounds.min.x) / settings.cellSize)));
+		field.depth = std::max(1, static_cast<int>(std::ceil((bounds.max.z - bounds.min.z) / settings.cellSize)));
+		field.columns.resize(static_cast<std::size_t>(field.width) * field.depth);
+
+		std::size_t const triangleCount = level.triangleCount();
+		int const bandCount = (field.depth + bandRows - 1) / bandRows;
+		std::vector<std::vector<std::uint32_t> > bands(bandCount);
+		std::vector<unsigned char> walkable(triangleCount);
+		for(std::size_t t = 0; t < triangleCount; ++t)
+		{
+			glm::vec3 const& a = level.positions[level.indices[t * 3]];
+			glm::vec3 const& b = level.positions[level.indices[t * 3 + 1]];
+			glm::vec3 const& c = level.positions[level.indices[t * 3 + 2]];
+			glm::vec3 const normal = glm::cross(b - a, c - a);
+			float const length = glm::length(normal);
+			walkable[t] = length > 0.0f && normal.y / length >= minNormalY;
+			float const minZ = std::min(std::min(a.z, b.z), c.z) - bounds.min.z;
+			float const maxZ = std::max(std::max(a.z, b.z), c.z) - bounds.min.z;
+			int const first = glm::clamp(static_cast<int>(minZ / settings.cellSize) / bandRows, 0, bandCount - 1);
+			int const last = glm::clamp(static_cast<int>(maxZ / settings.cellSize) / bandRows, 0, bandCount - 1);
+			for(int band = first; band <= last; ++band)
+				bands[band].push_back(static_cast<std::uint32_t>(t));
+		}
+		parallelFor(jobs, bands.size(), 1, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t band = begin; band < end; ++band)
+			{
+				int const rowBegin = static_cast<int>(band) * bandRows;
+				int const rowEnd = std::min(field.depth, rowBegin + bandRows);
+				for(std::uint32_t t : bands[band])
+				{
+					glm::vec3 const triangle[3] =
+					{
+						level.positions[level.indices[t * 3]],
+						level.positions[level.indices[t * 3 + 1]],
+						level.positions[level.indices[t * 3 + 2]]
+					};
+					rasterizeTriangle(triangle, walkable[t] != 0, rowBegin, rowEnd, settings, field);
+				}
+			}
+		});
+
+		// Open cells on top of walkable spans with room for the agent
+		std::size_t const columnCount = field.columns.size();
+		std::vector<std::uint32_t> columnStart(columnCount + 1, 0);
+		std::vector<Cell> cells;
+		for(std::size_t c = 0; c < columnCount; ++c)
+		{
+			const std::vector<Span>& column = field.columns[c];
+			for(std::size_t s = 0; s < column.size(); ++s)
+			{
+				int const ceiling = s + 1 < column.size() ? column[s + 1].bottom : std::numeric_limits<int>::max();
+				if(!column[s].walkable || ceiling - column[s].top < heightCells)
+					continue;
+				Cell cell;
+				cell.x = static_cast<int>(c % field.width);
+				cell.z = static_cast<int>(c / field.width);
+				cell.floor = column[s].top;
+				cell.ceiling = ceiling;
+				std::fill(cell.links, cell.links + 4, noCell);
+				cells.push_back(cell);
+			}
+			columnStart[c + 1] = static_cast<std::uint32_t>(cells.size());
+		}
+		field.columns.clear();
+		field.columns.shrink_to_fit();
+
+		// Neighbors the agent can step to and still stand up in
+		parallelFor(jobs, cells.size(), 4096, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t i = begin; i < end; ++i)
+			{
+				Cell& cell = cells[i];
+				for(int d = 0; d < 4; ++d)
+				{
+					int const nx = cell.x + directionX[d];
+					int const nz = cell.z + directionZ[d];
+					if(nx < 0 || nz < 0 || nx >= field.width || nz >= field.depth)
+						continue;
+					std::size_t const column = static_cast<std::size_t>(nz) * field.width + nx;
+					int bestStep = climbCells + 1;
+					for(std::uint32_t n = columnStart[column]; n < columnStart[column + 1]; ++n)
+					{
+						const Cell& neighbor = cells[n];
+						int const step = std::abs(neighbor.floor - cell.floor);
+						int const clearance = std::min(neighbor.ceiling, cell.ceiling) - std::max(neighbor.floor, cell.floor);
+						if(step < bestStep && clearance >= heightCells)
+						{
+							bestStep = step;
+							cell.links[d] = n;
+						}
+					}
+				}
+			}
+		});
+
+		// Erosion: steps from the nearest cell with a missing neighbor, found breadth first
+		std::vector<int> distance(cells.size(), std::numeric_limits<int>::max());
+		std::deque<std::uint32_t> frontier;
+		for(std::uint32_t i = 0; i < cells.size(); ++i)
+		{
+			const Cell& cell = cells[i];
+			if(cell.links[0] == noCell || cell.links[1] == noCell || cell.links[2] == noCell || cell.links[3] == noCell)
+			{
+				distance[i] = 0;
+				frontier.push_back(i);
+			}
+		}
+		while(!frontier.empty())
+		{
+			std::uint32_t const i = frontier.front();
+			frontier.pop_front();
+			if(distance[i] + 1 >= radiusCells)
+				continue;
+			for(std::uint32_t n : cells[i].links)
+			{
+				if(n != noCell && distance[n] > distance[i] + 1)
+				{
+					distance[n] = distance[i] + 1;
+					frontier.push_back(n);
+				}
+			}
+		}
+		for(Cell& cell : cells)
+		{
+			for(std::uint32_t& n : cell.links)
+			{
+				if(n != noCell && distance[n] < radiusCells)
+					n = noCell;
+			}
+		}
+
+		// Greedy rectangles: grow along +x as far as possible, then add rows along +z while the whole row is free
+		// and connected
+		std::uint32_t const maxCells = std::max(1u, settings.maxRegionCells);
+		std::vector<std::uint32_t> polygonOf(cells.size(), invalidPolygon);
+		std::vector<std::uint32_t> regionStart(1, 0);
+		std::vector<std::uint32_t> regionCells;
+		std::vector<glm::ivec2> regionSize;
+		std::vector<std::uint32_t> row;
+		std::vector<std::uint32_t> next;
+		for(std::uint32_t i = 0; i < cells.size(); ++i)
+		{
+			if(polygonOf[i] != invalidPolygon || distance[i] < radiusCells)
+				continue;
+			std::uint32_t const polygon = static_cast<std::uint32_t>(regionSize.size());
+			std::size_t const first = regionCells.size();
+
+			row.assign(1, i);
+			while(row.size() < maxCells)
+			{
+				std::uint32_t const n = cells[row.back()].links[2];
+				if(n == noCell || polygonOf[n] != invalidPolygon)
+					break;
+				row.push_back(n);
+			}
+			regionCells.insert(regionCells.end(), row.begin(), row.end());
+			std::uint32_t rows = 1;
+			while(rows < maxCells)
+			{
+				next.clear();
+				for(std::size_t k = 0; k < row.size(); ++k)
+				{
+					std::uint32_t const n = cells[row[k]].links[1];
+					if(n == noCell || polygonOf[n] != invalidPolygon || (k > 0 && cells[next.back()].links[2] != n))
+						break;
+					next.push_back(n);
+				}
+				if(next.size() != row.size())
+					break;
+				regionCells.insert(regionCells.end(), next.begin(), next.end());
+				row.swap(next);
+				++rows;
+			}
+			for(std::size_t k = first; k < regionCells.size(); ++k)
+				polygonOf[regionCells[k]] = polygon;
+			regionStart.push_back(static_cast<std::uint32_t>(regionCells.size()));
+			regionSize.push_back(glm::ivec2(static_cast<int>(row.size()), static_cast<int>(rows)));
+		}
+
+		// Polygons from the rectangles, links from runs of edge cells that face the same neighbor
+		std::vector<NavPolygon>& polygons = result.m_polygons;
+		std::vector<NavLink>& links = result.m_links;
+		polygons.resize(regionSize.size());
+		auto floorY = [&](std::uint32_t cell)
+		{
+			return bounds.min.y + cells[cell].floor * settings.cellHeight;
+		};
+		for(std::uint32_t p = 0; p < polygons.size(); ++p)
+		{
+			const std::uint32_t* region = regionCells.data() + regionStart[p];
+			int const width = regionSize[p].x;
+			int const height = regionSize[p].y;
+			const Cell& origin = cells[region[0]];
+			float const x0 = bounds.min.x + origin.x * settings.cellSize;
+			float const z0 = bounds.min.z + origin.z * settings.cellSize;
+			float const x1 = x0 + width * settings.cellSize;
+			float const z1 = z0 + height * settings.cellSize;
+			NavPolygon& polygon = polygons[p];
+			polygon.corners[0] = glm::vec3(x0, floorY(region[0]), z0);
+			polygon.corners[1] = glm::vec3(x0, floorY(region[(height - 1) * width]), z1);
+			polygon.corners[2] = glm::vec3(x1, floorY(region[height * width - 1]), z1);
+			polygon.corners[3] = glm::vec3(x1, floorY(region[width - 1]), z0);
+			polygon.firstLink = static_cast<std::uint32_t>(links.size());
+
+			for(int d = 0; d < 4; ++d)
+			{
+				// Cells along the edge facing d, in increasing x or z
+				bool const alongX = directionZ[d] != 0;
+				int const length = alongX ? width : height;
+				std::uint32_t runPolygon = invalidPolygon;
+				int runStart = 0;
+				glm::vec3 runLow(0.0f);
+				glm::vec3 runHigh(0.0f);
+				for(int k = 0; k <= length; ++k)
+				{
+					std::uint32_t cell = noCell;
+					std::uint32_t neighbor = invalidPolygon;
+					if(k < length)
+					{
+						int const column = d == 2 ? width - 1 : 0;
+						int const line = d == 1 ? height - 1 : 0;
+						cell = alongX ? region[line * width + k] : region[k * width + column];
+						std::uint32_t const n = cells[cell].links[d];
+						neighbor = n == noCell ? invalidPolygon : polygonOf[n];
+					}
+					if(neighbor == runPolygon && k < length)
+					{
+						if(neighbor == invalidPolygon)
+							continue;
+						// Extend the run to the far side of this cell
+						std::uint32_t const n = cells[cell].links[d];
+						float const y = (floorY(cell) + floorY(n)) * 0.5f;
+						runHigh = alongX ? glm::vec3(x0 + (k + 1) * settings.cellSize, y, d == 1 ? z1 : z0)
+							: glm::vec3(d == 2 ? x1 : x0, y, z0 + (k + 1) * settings.cellSize);
+						continue;
+					}
+					if(runPolygon != invalidPolygon)
+					{
+						// Walking out through -x or +z the right hand side is at higher coordinates
+						bool const rightHigh = d == 0 || d == 1;
+						NavLink link;
+						link.polygon = runPolygon;
+						link.left = rightHigh ? runLow : runHigh;
+						link.right = rightHigh ? runHigh : runLow;
+						links.push_back(link);
+					}
+					runPolygon = neighbor;
+					runStart = k;
+					if(neighbor != invalidPolygon)
+					{
+						std::uint32_t const n = cells[cell].links[d];
+						float const y = (floorY(cell) + floorY(n)) * 0.5f;
+						runLow = alongX ? glm::vec3(x0 + runStart * settings.cellSize, y, d == 1 ? z1 : z0)
+							: glm::vec3(d == 2 ? x1 : x0, y, z0 + runStart * settings.cellSize);
+						runHigh = alongX ? glm::vec3(x0 + (k + 1) * settings.cellSize, y, d == 1 ? z1 : z0)
+							: glm::vec3(d == 2 ? x1 : x0, y, z0 + (k + 1) * settings.cellSize);
+					}
+				}
+			}
+			polygon.linkCount = static_cast<std::uint32_t>(links.size()) - polygon.firstLink;
+		}
+
+		result.buildBuckets(maxCells * settings.cellSize);
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Bounds.h"
+#include "Mesh.h"
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	std::uint32_t const invalidPolygon = 0xFFFFFFFFu;
+
+	struct NavMeshSettings
+	{
+		float cellSize;          // Voxel size on x and z
+		float cellHeight;        // Voxel size on y
+		float agentHeight;       // Clearance needed above a floor
+		float agentRadius;       // Floors closer than this to a wall or ledge are removed
+		float agentClimb;        // Largest step between neighboring floors
+		float maxSlope;          // Steepest walkable triangle, in degrees
+		unsigned maxRegionCells; // Largest side of a polygon in cells, keeps paths through open areas from zigzagging
+
+		NavMeshSettings() : cellSize(0.3f), cellHeight(0.2f), agentHeight(2.0f), agentRadius(0.6f), agentClimb(0.9f), maxSlope(45.0f), maxRegionCells(32) {}
+	};
+
+	// Edge shared with a neighbor. left and right are the sides of the funnel walking out of the polygon that owns the
+	// link, with x and z taken as a 2D x, y frame.
+	struct NavLink
+	{
+		std::uint32_t polygon;
+		glm::vec3 left;
+		glm::vec3 right;
+	};
+
+	// The builder partitions the walkable cells into rectangles, so every polygon is a quad aligned with x and z whose
+	// corners follow the floor: (min x, min z), (min x, max z), (max x, max z), (max x, min z), counter-clockwise
+	// seen from above. Neighbors can share part of an edge, the links hold the shared part.
+	struct NavPolygon
+	{
+		glm::vec3 corners[4];
+		std::uint32_t firstLink;
+		std::uint32_t linkCount;
+
+		glm::vec3 center() const { return (corners[0] + corners[1] + corners[2] + corners[3]) * 0.25f; }
+		// Floor under (x, z) interpolated from the corners, x and z are clamped to the polygon
+		glm::vec3 closestPoint(const glm::vec3& point) const;
+	};
+
+	class NavMesh
+	{
+	public:
+		NavMesh() : m_bucketSize(1.0f), m_bucketsX(0), m_bucketsZ(0) {}
+
+		std::size_t polygonCount() const { return m_polygons.size(); }
+		const NavPolygon& polygon(std::uint32_t index) const { return m_polygons[index]; }
+		const NavLink* links(const NavPolygon& polygon) const { return m_links.data() + polygon.firstLink; }
+		const NavLink& link(std::uint32_t index) const { return m_links[index]; }
+		std::size_t linkCount() const { return m_links.size(); }
+		const Aabb& bounds() const { return m_bounds; }
+
+		// Polygon whose floor is closest to point within searchRadius on x and z, invalidPolygon if there is none.
+		// nearest receives the closest point on it. Safe to call from any number of threads.
+		std::uint32_t findPolygon(const glm::vec3& point, float searchRadius, glm::vec3* nearest = nullptr) const;
+
+	private:
+		friend void buildNavMesh(const Mesh&, const NavMeshSettings&, NavMesh&, JobSystem*);
+
+		void buildBuckets(float bucketSize);
+
+		std::vector<NavPolygon> m_polygons;
+		std::vector<NavLink> m_links;
+		Aabb m_bounds;
+
+		// Polygons overlapping bucket i on x and z are m_bucketPolygons[m_bucketStart[i]] to [m_bucketStart[i + 1]]
+		float m_bucketSize;
+		int m_bucketsX;
+		int m_bucketsZ;
+		std::vector<std::uint32_t> m_bucketStart;
+		std::vector<std::uint32_t> m_bucketPolygons;
+	};
+
+	// Voxelizes the level triangles into a heightfield, keeps the floors with enough clearance, links neighboring
+	// floors an agent can step between and erodes them by the agent radius. The walkable cells are then partitioned
+	// greedily into rectangles of connected cells, which become the polygons. Rasterization runs in bands of rows
+	// across the job system.
+	void buildNavMesh(const Mesh& level, const NavMeshSettings& settings, NavMesh& result, JobSystem* jobs = nullptr);
+}
@@ -0,0 +1,196 @@
+#include "Benchmark.h"
+#include "NavMesh.h"
+#include "NavQuery.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	float const levelSize = 256.0f;
+	float const groundTile = 16.0f;
+	float const lotSize = 32.0f;
+	std::size_t const requestCount = 20000;
+	std::size_t const serialRequests = 2000;
+
+	// Counter-clockwise seen from the side the normal points to
+	void addQuad(engine::Mesh& mesh, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& d)
+	{
+		std::uint32_t const base = static_cast<std::uint32_t>(mesh.positions.size());
+		mesh.positions.push_back(a);
+		mesh.positions.push_back(b);
+		mesh.positions.push_back(c);
+		mesh.positions.push_back(d);
+		std::uint32_t const indices[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+		mesh.indices.insert(mesh.indices.end(), indices, indices + 6);
+	}
+
+	void addBox(engine::Mesh& mesh, const glm::vec3& low, const glm::vec3& high)
+	{
+		glm::vec3 const p[8] =
+		{
+			glm::vec3(low.x, low.y, low.z), glm::vec3(high.x, low.y, low.z), glm::vec3(high.x, low.y, high.z), glm::vec3(low.x, low.y, high.z),
+			glm::vec3(low.x, high.y, low.z), glm::vec3(high.x, high.y, low.z), glm::vec3(high.x, high.y, high.z), glm::vec3(low.x, high.y, high.z)
+		};
+		addQuad(mesh, p[4], p[7], p[6], p[5]); // top
+		addQuad(mesh, p[0], p[4], p[5], p[1]); // -z
+		addQuad(mesh, p[2], p[6], p[7], p[3]); // +z
+		addQuad(mesh, p[3], p[7], p[4], p[0]); // -x
+		addQuad(mesh, p[1], p[5], p[6], p[2]); // +x
+	}
+
+	// Tiled ground with a block of buildings on every lot, some with a ramp up to the roof along their -x side
+	engine::Mesh makeLevel()
+	{
+		engine::Mesh level;
+		for(float z = 0.0f; z < levelSize; z += groundTile)
+		{
+			for(float x = 0.0f; x < levelSize; x += groundTile)
+				addQuad(level, glm::vec3(x, 0.0f, z), glm::vec3(x, 0.0f, z + groundTile), glm::vec3(x + groundTile, 0.0f, z + groundTile), glm::vec3(x + groundTile, 0.0f, z));
+		}
+
+		std::mt19937 random(43);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		for(float z = 0.0f; z < levelSize; z += lotSize)
+		{
+			for(float x = 0.0f; x < levelSize; x += lotSize)
+			{
+				glm::vec3 const size(6.0f + 14.0f * unit(random), 2.0f + 6.0f * unit(random), 6.0f + 14.0f * unit(random));
+				glm::vec3 const low(x + 8.0f + (lotSize - 8.0f - size.x) * unit(random), 0.0f, z + 4.0f + (lotSize - 8.0f - size.z) * unit(random));
+				addBox(level, low, low + size);
+				if(unit(random) < 0.3f)
+				{
+					// 30 degrees, ends flush with the roof
+					float const run = size.y * 1.732f;
+					float const z0 = low.z + 1.0f;
+					float const z1 = std::min(low.z + size.z - 1.0f, z0 + 3.0f);
+					addQuad(level, glm::vec3(low.x - run, 0.0f, z0), glm::vec3(low.x - run, 0.0f, z1), glm::vec3(low.x, size.y, z1), glm::vec3(low.x, size.y, z0));
+				}
+			}
+		}
+		return level;
+	}
+
+	// Fraction of points sampled along the paths that are off the mesh
+	double offMeshFraction(const engine::NavMesh& mesh, const std::vector<engine::PathResult>& results)
+	{
+		std::size_t samples = 0;
+		std::size_t off = 0;
+		for(const engine::PathResult& result : results)
+		{
+			for(std::size_t i = 1; i < result.points.size(); ++i)
+			{
+				glm::vec3 const a = result.points[i - 1];
+				glm::vec3 const b = result.points[i];
+				int const steps = std::max(1, static_cast<int>(glm::distance(a, b) / 0.5f));
+				for(int s = 0; s <= steps; ++s)
+				{
+					glm::vec3 const point = glm::mix(a, b, static_cast<float>(s) / steps);
+					glm::vec3 nearest;
+					std::uint32_t const polygon = mesh.findPolygon(point, 0.05f, &nearest);
+					++samples;
+					off += polygon == engine::invalidPolygon || glm::abs(nearest.y - point.y) > 1.0f ? 1 : 0;
+				}
+			}
+		}
+		return samples > 0 ? static_cast<double>(off) / samples : 0.0;
+	}
+}
+
+ENGINE_BENCHMARK(NavMesh)
+{
+	engine::Mesh const level = makeLevel();
+	context.report("level triangles", static_cast<double>(level.triangleCount()), "");
+
+	engine::NavMeshSettings settings;
+	engine::NavMesh mesh;
+	engine::Stopwatch timer;
+	engine::buildNavMesh(level, settings, mesh, &context.jobs());
+	context.report("build", timer.elapsedMs(), "ms");
+	context.report("polygons", static_cast<double>(mesh.polygonCount()), "");
+	context.report("links", static_cast<double>(mesh.linkCount()), "");
+
+	// Endpoints on the streets: the ground inside the closed buildings is walkable too but can't be reached
+	std::vector<bool> street(mesh.polygonCount(), false);
+	std::vector<std::uint32_t> stack(1, mesh.findPolygon(glm::vec3(0.0f), 2.0f));
+	street[stack.back()] = true;
+	while(!stack.empty())
+	{
+		const engine::NavPolygon& polygon = mesh.polygon(stack.back());
+		stack.pop_back();
+		for(std::uint32_t l = 0; l < polygon.linkCount; ++l)
+		{
+			std::uint32_t const neighbor = mesh.links(polygon)[l].polygon;
+			if(!street[neighbor])
+			{
+				street[neighbor] = true;
+				stack.push_back(neighbor);
+			}
+		}
+	}
+	std::mt19937 random(44);
+	std::uniform_real_distribution<float> coordinate(1.0f, levelSize - 1.0f);
+	std::vector<glm::vec3> streets;
+	while(streets.size() < requestCount * 2)
+	{
+		glm::vec3 const point(coordinate(random), 0.0f, coordinate(random));
+		glm::vec3 nearest;
+		std::uint32_t const polygon = mesh.findPolygon(point, 0.01f, &nearest);
+		if(polygon != engine::invalidPolygon && street[polygon] && nearest.y < 0.5f)
+			streets.push_back(nearest);
+	}
+	std::vector<glm::vec3> const starts(streets.begin(), streets.begin() + requestCount);
+	std::vector<glm::vec3> const ends(streets.begin() + requestCount, streets.end());
+
+	engine::NavQuery query(mesh);
+	std::vector<glm::vec3> points;
+	std::size_t nodes = 0;
+	timer.restart();
+	for(std::size_t i = 0; i < serialRequests; ++i)
+	{
+		query.findPath(starts[i], ends[i], points);
+		nodes += query.nodesVisited();
+	}
+	double const serialMs = timer.elapsedMs();
+	context.report("paths per second single thread", serialRequests / serialMs * 1000.0, "/s");
+	context.report("nodes per path", static_cast<double>(nodes) / serialRequests, "");
+
+	engine::PathQueue queue(mesh, context.jobs());
+	for(std::size_t i = 0; i < requestCount; ++i)
+		queue.request(starts[i], ends[i]);
+	std::vector<engine::PathResult> results;
+	timer.restart();
+	queue.dispatch();
+	queue.wait();
+	queue.collect(results);
+	double const batchMs = timer.elapsedMs();
+	context.report("paths per second batched", requestCount / batchMs * 1000.0, "/s");
+
+	std::size_t found = 0;
+	std::size_t partial = 0;
+	std::size_t pointCount = 0;
+	double lengthRatio = 0.0;
+	bool ordered = results.size() == requestCount;
+	for(std::size_t i = 0; i < results.size(); ++i)
+	{
+		const engine::PathResult& result = results[i];
+		ordered = ordered && result.ticket == i;
+		found += result.status == engine::PathStatus::Found ? 1 : 0;
+		partial += result.status == engine::PathStatus::Partial ? 1 : 0;
+		if(result.status != engine::PathStatus::Found)
+			continue;
+		pointCount += result.points.size();
+		float length = 0.0f;
+		for(std::size_t p = 1; p < result.points.size(); ++p)
+			length += glm::distance(result.points[p - 1], result.points[p]);
+		float const straight = glm::distance(result.points.front(), result.points.back());
+		lengthRatio += straight > 1.0f ? length / straight : 1.0;
+	}
+	context.report("results in request order", ordered ? 1.0 : 0.0, "ok");
+	context.report("found", 100.0 * found / requestCount, "%");
+	context.report("partial", 100.0 * partial / requestCount, "%");
+	context.report("points per path", found > 0 ? static_cast<double>(pointCount) / found : 0.0, "");
+	context.report("length over straight line", found > 0 ? lengthRatio / found : 0.0, "x");
+	context.report("samples off mesh", offMeshFraction(mesh, results) * 100.0, "%");
+}
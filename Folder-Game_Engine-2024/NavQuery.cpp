@@ -0,0 +1,361 @@
+#include "NavQuery.h"
+
+#include <algorithm>
+
+namespace engine
+{
+	namespace
+	{
+		std::uint32_t const noIndex = 0xFFFFFFFFu;
+
+		// Twice the signed area of abc with x and z taken as a 2D x, y frame, positive when c is right of ab
+		float triangleArea2(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+		{
+			return (c.x - a.x) * (b.z - a.z) - (b.x - a.x) * (c.z - a.z);
+		}
+
+		bool samePoint(const glm::vec3& a, const glm::vec3& b)
+		{
+			glm::vec3 const d = a - b;
+			return glm::dot(d, d) < 1e-6f;
+		}
+	}
+
+	NavQuery::NavQuery(const NavMesh& mesh) :
+		m_mesh(mesh),
+		m_nodes(mesh.polygonCount()),
+		m_generation(0),
+		m_nodesVisited(0)
+	{
+		for(Node& node : m_nodes)
+			node.generation = 0;
+		m_open.reserve(256);
+	}
+
+	void NavQuery::siftUp(std::size_t index)
+	{
+		std::uint32_t const polygon = m_open[index];
+		float const total = m_nodes[polygon].total;
+		while(index > 0)
+		{
+			std::size_t const parent = (index - 1) / 2;
+			if(m_nodes[m_open[parent]].total <= total)
+				break;
+			m_open[index] = m_open[parent];
+			m_nodes[m_open[index]].heapIndex = static_cast<std::uint32_t>(index);
+			index = parent;
+		}
+		m_open[index] = polygon;
+		m_nodes[polygon].heapIndex = static_cast<std::uint32_t>(index);
+	}
+
+	void NavQuery::siftDown(std::size_t index)
+	{
+		std::uint32_t const polygon = m_open[index];
+		float const total = m_nodes[polygon].total;
+		std::size_t const count = m_open.size();
+		for(;;)
+		{
+			std::size_t child = index * 2 + 1;
+			if(child >= count)
+				break;
+			if(child + 1 < count && m_nodes[m_open[child + 1]].total < m_nodes[m_open[child]].total)
+				++child;
+			if(total <= m_nodes[m_open[child]].total)
+				break;
+			m_open[index] = m_open[child];
+			m_nodes[m_open[index]].heapIndex = static_cast<std::uint32_t>(index);
+			index = child;
+		}
+		m_open[index] = polygon;
+		m_nodes[polygon].heapIndex = static_cast<std::uint32_t>(index);
+	}
+
+	void NavQuery::heapPush(std::uint32_t polygon)
+	{
+		m_open.push_back(polygon);
+		siftUp(m_open.size() - 1);
+	}
+
+	void NavQuery::heapUpdate(std::uint32_t polygon)
+	{
+		// Costs only go down
+		siftUp(m_nodes[polygon].heapIndex);
+	}
+
+	std::uint32_t NavQuery::heapPop()
+	{
+		std::uint32_t const top = m_open.front();
+		m_open.front() = m_open.back();
+		m_open.pop_back();
+		if(!m_open.empty())
+			siftDown(0);
+		m_nodes[top].heapIndex = noIndex;
+		return top;
+	}
+
+	bool NavQuery::searchCorridor(std::uint32_t startPolygon, const glm::vec3& start, std::uint32_t endPolygon, const glm::vec3& end)
+	{
+		// Bumping the generation invalidates every node without touching them
+		if(++m_generation == 0)
+		{
+			for(Node& node : m_nodes)
+				node.generation = 0;
+			m_generation = 1;
+		}
+		m_open.clear();
+		m_nodesVisited = 0;
+
+		Node& first = m_nodes[startPolygon];
+		first.position = start;
+		first.cost = 0.0f;
+		first.total = glm::distance(start, end);
+		first.parent = noIndex;
+		first.parentLink = noIndex;
+		first.generation = m_generation;
+		first.closed = false;
+		heapPush(startPolygon);
+
+		std::uint32_t best = startPolygon;
+		float bestHeuristic = first.total;
+		bool reached = false;
+		while(!m_open.empty())
+		{
+			std::uint32_t const current = heapPop();
+			Node& node = m_nodes[current];
+			node.closed = true;
+			++m_nodesVisited;
+			if(current == endPolygon)
+			{
+				best = current;
+				reached = true;
+				break;
+			}
+			float const heuristic = node.total - node.cost;
+			if(heuristic < bestHeuristic)
+			{
+				bestHeuristic = heuristic;
+				best = current;
+			}
+
+			const NavPolygon& polygon = m_mesh.polygon(current);
+			const NavLink* links = m_mesh.links(polygon);
+			for(std::uint32_t l = 0; l < polygon.linkCount; ++l)
+			{
+				std::uint32_t const neighbor = links[l].polygon;
+				if(neighbor == node.parent)
+					continue;
+				glm::vec3 const entry = (links[l].left + links[l].right) * 0.5f;
+				float const cost = node.cost + glm::distance(node.position, entry);
+				float const remaining = glm::distance(entry, end);
+
+				Node& next = m_nodes[neighbor];
+				bool const fresh = next.generation != m_generation;
+				if(!fresh && cost >= next.cost)
+					continue;
+				next.position = entry;
+				next.cost = cost;
+				next.total = cost + remaining;
+				next.parent = current;
+				next.parentLink = polygon.firstLink + l;
+				if(fresh || next.closed)
+				{
+					next.generation = m_generation;
+					next.closed = false;
+					heapPush(neighbor);
+				}
+				else
+					heapUpdate(neighbor);
+			}
+		}
+
+		m_corridor.clear();
+		m_corridorLinks.clear();
+		for(std::uint32_t polygon = best; polygon != noIndex; polygon = m_nodes[polygon].parent)
+		{
+			m_corridor.push_back(polygon);
+			if(m_nodes[polygon].parentLink != noIndex)
+				m_corridorLinks.push_back(m_nodes[polygon].parentLink);
+		}
+		std::reverse(m_corridor.begin(), m_corridor.end());
+		std::reverse(m_corridorLinks.begin(), m_corridorLinks.end());
+		return reached;
+	}
+
+	void NavQuery::stringPull(const glm::vec3& start, const glm::vec3& end, std::vector<glm::vec3>& points)
+	{
+		// Portals as left, right pairs, the start and end are portals of zero width
+		m_portals.clear();
+		m_portals.push_back(start);
+		m_portals.push_back(start);
+		for(std::uint32_t link : m_corridorLinks)
+		{
+			const NavLink& portal = m_mesh.link(link);
+			m_portals.push_back(portal.left);
+			m_portals.push_back(portal.right);
+		}
+		m_portals.push_back(end);
+		m_portals.push_back(end);
+
+		// Simple stupid funnel: tighten the left and right sides through each portal, when one crosses the other
+		// the apex moves to that corner and the scan restarts from there
+		points.clear();
+		points.push_back(start);
+		std::size_t const portalCount = m_portals.size() / 2;
+		glm::vec3 apex = start;
+		glm::vec3 left = start;
+		glm::vec3 right = start;
+		std::size_t apexIndex = 0;
+		std::size_t leftIndex = 0;
+		std::size_t rightIndex = 0;
+		for(std::size_t i = 1; i < portalCount; ++i)
+		{
+			glm::vec3 const& portalLeft = m_portals[i * 2];
+			glm::vec3 const& portalRight = m_portals[i * 2 + 1];
+
+			if(triangleArea2(apex, right, portalRight) <= 0.0f)
+			{
+				if(samePoint(apex, right) || triangleArea2(apex, left, portalRight) > 0.0f)
+				{
+					right = portalRight;
+					rightIndex = i;
+				}
+				else
+				{
+					points.push_back(left);
+					apex = left;
+					apexIndex = leftIndex;
+					right = left = apex;
+					rightIndex = leftIndex = apexIndex;
+					i = apexIndex;
+					continue;
+				}
+			}
+
+			if(triangleArea2(apex, left, portalLeft) >= 0.0f)
+			{
+				if(samePoint(apex, left) || triangleArea2(apex, right, portalLeft) < 0.0f)
+				{
+					left = portalLeft;
+					leftIndex = i;
+				}
+				else
+				{
+					points.push_back(right);
+					apex = right;
+					apexIndex = rightIndex;
+					right = left = apex;
+					rightIndex = leftIndex = apexIndex;
+					i = apexIndex;
+					continue;
+				}
+			}
+		}
+		if(!samePoint(points.back(), end))
+			points.push_back(end);
+	}
+
+	PathStatus NavQuery::findPath(const glm::vec3& start, const glm::vec3& end, std::vector<glm::vec3>& points, float searchRadius)
+	{
+		points.clear();
+		m_corridor.clear();
+		m_corridorLinks.clear();
+		glm::vec3 from(0.0f);
+		glm::vec3 to(0.0f);
+		std::uint32_t const startPolygon = m_mesh.findPolygon(start, searchRadius, &from);
+		std::uint32_t const endPolygon = m_mesh.findPolygon(end, searchRadius, &to);
+		if(startPolygon == invalidPolygon || endPolygon == invalidPolygon)
+			return PathStatus::NoPolygon;
+
+		bool const reached = searchCorridor(startPolygon, from, endPolygon, to);
+		if(!reached)
+			to = m_mesh.polygon(m_corridor.back()).closestPoint(to);
+		stringPull(from, to, points);
+		return reached ? PathStatus::Found : PathStatus::Partial;
+	}
+
+	PathQueue::PathQueue(const NavMesh& mesh, JobSystem& jobs, std::size_t requestsPerJob) :
+		m_mesh(mesh),
+		m_jobs(jobs),
+		m_requestsPerJob(std::max<std::size_t>(requestsPerJob, 1)),
+		m_nextTicket(0)
+	{
+	}
+
+	PathQueue::~PathQueue()
+	{
+		wait();
+	}
+
+	std::uint32_t PathQueue::request(const glm::vec3& start, const glm::vec3& end)
+	{
+		Request request;
+		request.ticket = m_nextTicket++;
+		request.start = start;
+		request.end = end;
+		m_requests.push_back(request);
+		return request.ticket;
+	}
+
+	NavQuery* PathQueue::acquire()
+	{
+		std::lock_guard<std::mutex> lock(m_poolMutex);
+		if(m_idle.empty())
+		{
+			m_queries.emplace_back(new NavQuery(m_mesh));
+			return m_queries.back().get();
+		}
+		NavQuery* query = m_idle.back();
+		m_idle.pop_back();
+		return query;
+	}
+
+	void PathQueue::release(NavQuery* query)
+	{
+		std::lock_guard<std::mutex> lock(m_poolMutex);
+		m_idle.push_back(query);
+	}
+
+	bool PathQueue::dispatch()
+	{
+		if(busy() || !m_results.empty())
+			return false;
+
+		m_running.swap(m_requests);
+		m_requests.clear();
+		m_results.resize(m_running.size());
+		for(std::size_t begin = 0; begin < m_running.size(); begin += m_requestsPerJob)
+		{
+			std::size_t const end = std::min(begin + m_requestsPerJob, m_running.size());
+			m_jobs.run([this, begin, end]()
+			{
+				NavQuery* query = acquire();
+				for(std::size_t i = begin; i < end; ++i)
+				{
+					const Request& request = m_running[i];
+					PathResult& result = m_results[i];
+					result.ticket = request.ticket;
+					result.status = query->findPath(request.start, request.end, result.points);
+				}
+				release(query);
+			}, m_counter);
+		}
+		return true;
+	}
+
+	void PathQueue::wait()
+	{
+		m_jobs.wait(m_counter);
+	}
+
+	bool PathQueue::collect(std::vector<PathResult>& results)
+	{
+		if(busy())
+			return false;
+		for(PathResult& result : m_results)
+			results.push_back(std::move(result));
+		m_results.clear();
+		m_running.clear();
+		return true;
+	}
+}
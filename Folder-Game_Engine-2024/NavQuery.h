@@ -0,0 +1,129 @@
+#pragma once
+
+#include "JobSystem.h"
+#include "NavMesh.h"
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace engine
+{
+	enum class PathStatus : std::uint8_t
+	{
+		Pending,
+		Found,
+		Partial,  // The goal is unreachable, the path ends at the closest reachable point
+		NoPolygon // Start or goal is off the mesh
+	};
+
+	// A* over the polygons of one navmesh followed by string pulling. The node pool and open list are sized for the
+	// whole mesh once and reused by every search, a search only touches the nodes it reaches. One query per thread.
+	class NavQuery
+	{
+	public:
+		explicit NavQuery(const NavMesh& mesh);
+
+		// Straight path from start to end including both, corners where it turns around obstacles in between.
+		// start and end are snapped to the mesh within searchRadius on x and z.
+		PathStatus findPath(const glm::vec3& start, const glm::vec3& end, std::vector<glm::vec3>& points, float searchRadius = 2.0f);
+
+		// Polygons crossed by the last path, start first
+		const std::vector<std::uint32_t>& corridor() const { return m_corridor; }
+		std::size_t nodesVisited() const { return m_nodesVisited; }
+
+	private:
+		struct Node
+		{
+			glm::vec3 position; // Where the path enters the polygon
+			float cost;
+			float total;
+			std::uint32_t parent;
+			std::uint32_t parentLink;
+			std::uint32_t heapIndex;
+			std::uint32_t generation;
+			bool closed;
+		};
+
+		bool searchCorridor(std::uint32_t startPolygon, const glm::vec3& start, std::uint32_t endPolygon, const glm::vec3& end);
+		void stringPull(const glm::vec3& start, const glm::vec3& end, std::vector<glm::vec3>& points);
+
+		void heapPush(std::uint32_t polygon);
+		void heapUpdate(std::uint32_t polygon);
+		std::uint32_t heapPop();
+		void siftUp(std::size_t index);
+		void siftDown(std::size_t index);
+
+		const NavMesh& m_mesh;
+		std::vector<Node> m_nodes;
+		std::vector<std::uint32_t> m_open;
+		std::uint32_t m_generation;
+		std::vector<std::uint32_t> m_corridor;
+		std::vector<std::uint32_t> m_corridorLinks;
+		std::vector<glm::vec3> m_portals;
+		std::size_t m_nodesVisited;
+	};
+
+	struct PathResult
+	{
+		std::uint32_t ticket;
+		PathStatus status;
+		std::vector<glm::vec3> points;
+	};
+
+	// Collects path requests during a frame and solves them as a batch of jobs that runs while the game goes on.
+	// Each job borrows a NavQuery from a pool, so there are never more queries than jobs running at once.
+	class PathQueue
+	{
+	public:
+		PathQueue(const NavMesh& mesh, JobSystem& jobs, std::size_t requestsPerJob = 32);
+		// Waits for the batch in flight
+		~PathQueue();
+
+		PathQueue(const PathQueue&) = delete;
+		PathQueue& operator=(const PathQueue&) = delete;
+
+		// Returns the ticket the result will carry
+		std::uint32_t request(const glm::vec3& start, const glm::vec3& end);
+
+		// Starts the requests made since the last dispatch, false while the previous batch is running or its results
+		// were not collected yet
+		bool dispatch();
+		bool busy() const { return !m_counter.done(); }
+		void wait();
+
+		// Moves the results of the finished batch to results in request order, false while it is still running
+		bool collect(std::vector<PathResult>& results);
+
+		std::size_t pending() const { return m_requests.size(); }
+
+	private:
+		struct Request
+		{
+			std::uint32_t ticket;
+			glm::vec3 start;
+			glm::vec3 end;
+		};
+
+		NavQuery* acquire();
+		void release(NavQuery* query);
+
+		const NavMesh& m_mesh;
+		JobSystem& m_jobs;
+		std::size_t m_requestsPerJob;
+		std::uint32_t m_nextTicket;
+
+		std::vector<Request> m_requests;
+		std::vector<Request> m_running;
+		std::vector<PathResult> m_results;
+		JobCounter m_counter;
+
+		std::mutex m_poolMutex;
+		std::vector<std::unique_ptr<NavQuery> > m_queries;
+		std::vector<NavQuery*> m_idle;
+	};
+}
@@ -0,0 +1,247 @@
+#include "NetConnection.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace engine
+{
+	namespace
+	{
+		std::size_t const historySize = 256;
+		// Sequence, ack, ack bits and message count
+		std::size_t const headerSize = 9;
+		// Id and size
+		std::size_t const messageHeaderSize = 4;
+		std::size_t const maxMessagesPerPacket = 255;
+		double const minimumResendDelay = 0.05;
+
+		// a is newer than b, with wrap around
+		bool newer(std::uint16_t a, std::uint16_t b)
+		{
+			return a != b && static_cast<std::uint16_t>(a - b) < 0x8000;
+		}
+
+		template<typename T>
+		void append(std::vector<unsigned char>& packet, const T& value)
+		{
+			unsigned char bytes[sizeof(T)];
+			std::memcpy(bytes, &value, sizeof(T));
+			packet.insert(packet.end(), bytes, bytes + sizeof(T));
+		}
+
+		template<typename T>
+		T fetch(const unsigned char* source)
+		{
+			T value;
+			std::memcpy(&value, source, sizeof(T));
+			return value;
+		}
+	}
+
+	const std::uint16_t NetConnection::reliableWindow;
+	const std::size_t NetConnection::maxMessageSize;
+
+	NetConnection::NetConnection()
+	{
+		reset();
+	}
+
+	void NetConnection::reset()
+	{
+		m_sequence = 0;
+		m_sent.assign(historySize, SentPacket());
+		for(SentPacket& sent : m_sent)
+			sent.valid = false;
+		m_pending.clear();
+		m_oldestPending = 0;
+
+		m_remoteSequence = 0;
+		m_receivedAny = false;
+		m_receivedSequences.assign(historySize, 0);
+		m_receivedValid.assign(historySize, 0);
+		m_received.assign(reliableWindow, ReceivedMessage());
+		for(ReceivedMessage& received : m_received)
+			received.valid = false;
+		m_nextReceive = 0;
+		m_delivered.clear();
+
+		m_roundTripTime = 0.1;
+		m_lastReceiveTime = 0.0;
+		m_packetsAcked = 0;
+		m_messagesResent = 0;
+	}
+
+	bool NetConnection::sendReliable(const void* data, std::size_t size)
+	{
+		if(size > maxMessageSize || m_pending.size() >= reliableWindow)
+			return false;
+		PendingMessage message;
+		message.data.assign(static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + size);
+		message.lastSent = 0.0;
+		message.sent = false;
+		message.acked = false;
+		m_pending.push_back(std::move(message));
+		return true;
+	}
+
+	bool NetConnection::receiveReliable(std::vector<unsigned char>& message)
+	{
+		if(m_delivered.empty())
+			return false;
+		message.swap(m_delivered.front());
+		m_delivered.pop_front();
+		return true;
+	}
+
+	void NetConnection::writePacket(double now, std::vector<unsigned char>& packet, std::size_t reliableBudget)
+	{
+		std::uint16_t const sequence = m_sequence++;
+		SentPacket& sent = m_sent[sequence % historySize];
+		sent.sequence = sequence;
+		sent.valid = true;
+		sent.acked = false;
+		sent.time = now;
+		sent.messages.clear();
+
+		// Bit i of the ack bits is sequence ack - i, none are set before the first packet arrives
+		std::uint32_t ackBits = 0;
+		for(std::uint16_t i = 0; i < 32; ++i)
+		{
+			std::uint16_t const previous = static_cast<std::uint16_t>(m_remoteSequence - i);
+			if(m_receivedValid[previous % historySize] && m_receivedSequences[previous % historySize] == previous)
+				ackBits |= 1u << i;
+		}
+
+		packet.clear();
+		append(packet, sequence);
+		append(packet, m_remoteSequence);
+		append(packet, ackBits);
+		packet.push_back(0);
+
+		// Unsent messages first go out in order, then the ones not acknowledged within a round trip
+		double const resendDelay = std::max(minimumResendDelay, m_roundTripTime * 1.25);
+		std::size_t size = headerSize;
+		std::size_t count = 0;
+		for(std::size_t i = 0; i < m_pending.size() && count < maxMessagesPerPacket; ++i)
+		{
+			PendingMessage& message = m_pending[i];
+			if(message.acked || (message.sent && now - message.lastSent < resendDelay))
+				continue;
+			if(size + messageHeaderSize + message.data.size() > reliableBudget)
+				break;
+			if(message.sent)
+				++m_messagesResent;
+			std::uint16_t const id = static_cast<std::uint16_t>(m_oldestPending + i);
+			append(packet, id);
+			append(packet, static_cast<std::uint16_t>(message.data.size()));
+			packet.insert(packet.end(), message.data.begin(), message.data.end());
+			message.sent = true;
+			message.lastSent = now;
+			sent.messages.push_back(id);
+			size += messageHeaderSize + message.data.size();
+			++count;
+		}
+		packet[headerSize - 1] = static_cast<unsigned char>(count);
+	}
+
+	void NetConnection::acknowledge(std::uint16_t sequence, double now)
+	{
+		SentPacket& sent = m_sent[sequence % historySize];
+		if(!sent.valid || sent.acked || sent.sequence != sequence)
+			return;
+		sent.acked = true;
+		++m_packetsAcked;
+		m_roundTripTime += (now - sent.time - m_roundTripTime) * 0.1;
+
+		for(std::uint16_t id : sent.messages)
+		{
+			std::uint16_t const index = static_cast<std::uint16_t>(id - m_oldestPending);
+			if(index < m_pending.size())
+				m_pending[index].acked = true;
+		}
+		while(!m_pending.empty() && m_pending.front().acked)
+		{
+			m_pending.pop_front();
+			++m_oldestPending;
+		}
+	}
+
+	bool NetConnection::readPacket(double now, const unsigned char* data, std::size_t size, std::size_t& payloadOffset)
+	{
+		if(size < headerSize)
+			return false;
+		std::uint16_t const sequence = fetch<std::uint16_t>(data);
+		std::uint16_t const ack = fetch<std::uint16_t>(data + 2);
+		std::uint32_t const ackBits = fetch<std::uint32_t>(data + 4);
+		std::size_t const count = data[8];
+
+		// Validate the messages before touching any state
+		std::size_t offset = headerSize;
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			if(size - offset < messageHeaderSize)
+				return false;
+			std::size_t const messageSize = fetch<std::uint16_t>(data + offset + 2);
+			if(size - offset - messageHeaderSize < messageSize)
+				return false;
+			offset += messageHeaderSize + messageSize;
+		}
+		std::size_t const slot = sequence % historySize;
+		if(m_receivedValid[slot] && m_receivedSequences[slot] == sequence)
+			return false;
+		// Too old to be told apart from a duplicate
+		if(m_receivedAny && newer(m_remoteSequence, sequence) && static_cast<std::uint16_t>(m_remoteSequence - sequence) >= historySize)
+			return false;
+
+		if(!m_receivedAny || newer(sequence, m_remoteSequence))
+		{
+			// Sequences skipped over are forgotten so a stale slot isn't acknowledged
+			std::uint16_t const skipped = m_receivedAny ? static_cast<std::uint16_t>(sequence - m_remoteSequence - 1) : 0;
+			for(std::uint16_t i = 0; i < std::min<std::size_t>(skipped, historySize); ++i)
+				m_receivedValid[static_cast<std::uint16_t>(m_remoteSequence + 1 + i) % historySize] = 0;
+			m_remoteSequence = sequence;
+			m_receivedAny = true;
+		}
+		m_receivedSequences[slot] = sequence;
+		m_receivedValid[slot] = 1;
+		m_lastReceiveTime = now;
+
+		for(std::uint16_t i = 0; i < 32; ++i)
+		{
+			if(ackBits & (1u << i))
+				acknowledge(static_cast<std::uint16_t>(ack - i), now);
+		}
+
+		offset = headerSize;
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			std::uint16_t const id = fetch<std::uint16_t>(data + offset);
+			std::size_t const messageSize = fetch<std::uint16_t>(data + offset + 2);
+			const unsigned char* message = data + offset + messageHeaderSize;
+			offset += messageHeaderSize + messageSize;
+
+			// Inside the window ahead of the next expected message, older ones were delivered already
+			if(static_cast<std::uint16_t>(id - m_nextReceive) >= reliableWindow)
+				continue;
+			ReceivedMessage& received = m_received[id % reliableWindow];
+			if(received.valid && received.id == id)
+				continue;
+			received.id = id;
+			received.valid = true;
+			received.data.assign(message, message + messageSize);
+		}
+		for(;;)
+		{
+			ReceivedMessage& next = m_received[m_nextReceive % reliableWindow];
+			if(!next.valid || next.id != m_nextReceive)
+				break;
+			next.valid = false;
+			m_delivered.push_back(std::move(next.data));
+			next.data.clear();
+			++m_nextReceive;
+		}
+
+		payloadOffset = offset;
+		return true;
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace engine
+{
+	// One end of a connection over an unreliable transport, with two channels in every packet:
+	//
+	// Reliable: messages are delivered once and in order. Each is sent in the next packet and resent every round
+	// trip until a packet carrying it is acknowledged.
+	// Unreliable: whatever the caller appends after the header, typically the latest state, which is worthless once
+	// newer state has been sent.
+	//
+	// Every packet has a 16-bit sequence number and acknowledges the newest sequence received and the 31 before it
+	// in a bit field, so one lost ack is covered by the next packets.
+	class NetConnection
+	{
+	public:
+		// Messages in flight, the receiver keeps this many out of order
+		static const std::uint16_t reliableWindow = 256;
+		static const std::size_t maxMessageSize = 512;
+
+		NetConnection();
+
+		void reset();
+
+		// False when the message is too large or the window is full, the connection is then too far behind
+		bool sendReliable(const void* data, std::size_t size);
+		// Pops the next message in order
+		bool receiveReliable(std::vector<unsigned char>& message);
+
+		// Replaces packet with the header and the reliable messages due for sending, up to reliableBudget bytes. The
+		// unreliable payload is appended by the caller. Messages go out in order, so the budget must leave room for
+		// one of maxMessageSize.
+		void writePacket(double now, std::vector<unsigned char>& packet, std::size_t reliableBudget);
+		// Reads the header and reliable messages, the unreliable payload starts at payloadOffset. False for
+		// malformed packets and duplicates.
+		bool readPacket(double now, const unsigned char* data, std::size_t size, std::size_t& payloadOffset);
+
+		// Smoothed over acknowledged packets, in seconds
+		double roundTripTime() const { return m_roundTripTime; }
+		double lastReceiveTime() const { return m_lastReceiveTime; }
+		std::size_t pendingReliable() const { return m_pending.size(); }
+		std::uint64_t packetsAcked() const { return m_packetsAcked; }
+		std::uint64_t messagesResent() const { return m_messagesResent; }
+
+	private:
+		struct SentPacket
+		{
+			std::uint16_t sequence;
+			bool valid;
+			bool acked;
+			double time;
+			std::vector<std::uint16_t> messages;
+		};
+
+		struct PendingMessage
+		{
+			std::vector<unsigned char> data;
+			double lastSent;
+			bool sent;
+			bool acked;
+		};
+
+		struct ReceivedMessage
+		{
+			std::uint16_t id;
+			bool valid;
+			std::vector<unsigned char> data;
+		};
+
+		void acknowledge(std::uint16_t sequence, double now);
+
+		// Sending
+		std::uint16_t m_sequence;
+		std::vector<SentPacket> m_sent;
+		std::deque<PendingMessage> m_pending;
+		std::uint16_t m_oldestPending;
+
+		// Receiving
+		std::uint16_t m_remoteSequence;
+		bool m_receivedAny;
+		std::vector<std::uint16_t> m_receivedSequences;
+		std::vector<std::uint8_t> m_receivedValid;
+		std::vector<ReceivedMessage> m_received;
+		std::uint16_t m_nextReceive;
+		std::deque<std::vector<unsigned char> > m_delivered;
+
+		double m_roundTripTime;
+		double m_lastReceiveTime;
+		std::uint64_t m_packetsAcked;
+		std::uint64_t m_messagesResent;
+	};
+}
@@ -0,0 +1,46 @@
+#include "RenderBackend.h"
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace engine
+{
+	void sortByMaterial(const std::vector<DrawItem>& draws, std::vector<std::uint32_t>& order)
+	{
+		order.resize(draws.size());
+		for(std::size_t i = 0; i < draws.size(); ++i)
+			order[i] = static_cast<std::uint32_t>(i);
+		std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b)
+		{
+			return draws[a].material < draws[b].material || (draws[a].material == draws[b].material && a < b);
+		});
+	}
+
+	NullRenderBackend::NullRenderBackend(double presentMilliseconds) :
+		m_presentMilliseconds(presentMilliseconds),
+		m_frameCount(0),
+		m_drawCount(0),
+		m_checksum(0.0f)
+	{
+	}
+
+	void NullRenderBackend::render(const FramePacket& packet)
+	{
+		// Read every draw like a real backend would when building its command stream
+		for(const DrawItem& draw : packet.draws)
+			m_checksum += draw.world[3].x + static_cast<float>(draw.mesh);
+		m_drawCount += packet.draws.size();
+	}
+
+	void NullRenderBackend::present()
+	{
+		if(m_presentMilliseconds > 0.0)
+		{
+			Stopwatch const wait;
+			while(wait.elapsedMs() < m_presentMilliseconds)
+				std::this_thread::yield();
+		}
+		++m_frameCount;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "FramePacket.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	// Indices of draws sorted by material, so consecutive draws of a material share one binding
+	void sortByMaterial(const std::vector<DrawItem>& draws, std::vector<std::uint32_t>& order);
+
+	// Called only from the render thread, which owns the graphics context
+	class RenderBackend
+	{
+	public:
+		virtual ~RenderBackend() {}
+
+		virtual void initialize() {}
+		virtual void render(const FramePacket& packet) = 0;
+		virtual void present() = 0;
+		virtual void shutdown() {}
+	};
+
+	// Reads the packets without touching the GPU, for headless runs and benchmarks.
+	// A present time can be set to stand in for the vsync wait.
+	class NullRenderBackend : public RenderBackend
+	{
+	public:
+		explicit NullRenderBackend(double presentMilliseconds = 0.0);
+
+		void render(const FramePacket& packet) override;
+		void present() override;
+
+		std::uint64_t frameCount() const { return m_frameCount; }
+		std::uint64_t drawCount() const { return m_drawCount; }
+
+	private:
+		double m_presentMilliseconds;
+		std::uint64_t m_frameCount;
+		std::uint64_t m_drawCount;
+		float m_checksum;
+	};
+}
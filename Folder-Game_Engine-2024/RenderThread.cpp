@@ -0,0 +1,130 @@
+#include "RenderThread.h"
+#include "RenderBackend.h"
+
+#include <algorithm>
+
+namespace engine
+{
+	namespace
+	{
+		std::size_t const noPacket = static_cast<std::size_t>(-1);
+	}
+
+	RenderThread::RenderThread(RenderBackend& backend, std::size_t packetCount, Mode mode) :
+		m_backend(backend),
+		m_mode(mode),
+		m_packets(std::max<std::size_t>(packetCount, 2)),
+		m_writing(noPacket),
+		m_nextFrame(0),
+		m_stopping(false),
+		m_stats(),
+		m_totalLatencyMs(0.0)
+	{
+		for(std::size_t i = 0; i < m_packets.size(); ++i)
+			m_free.push_back(i);
+		m_thread = std::thread(&RenderThread::main, this);
+	}
+
+	RenderThread::~RenderThread()
+	{
+		stop();
+	}
+
+	FramePacket& RenderThread::acquire()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		std::vector<MaterialUpdate> carried;
+		if(m_mode == Mode::Mailbox && m_free.empty() && !m_ready.empty())
+		{
+			// Material updates are deltas, the ones of a dropped packet go to the next packet to be rendered,
+			// ahead of its own so the newer values still win
+			std::size_t const dropped = m_ready.front();
+			m_ready.pop_front();
+			std::vector<MaterialUpdate>& materials = m_packets[dropped].materials;
+			if(!m_ready.empty())
+			{
+				std::vector<MaterialUpdate>& next = m_packets[m_ready.front()].materials;
+				next.insert(next.begin(), materials.begin(), materials.end());
+			}
+			else
+			{
+				carried.swap(materials);
+			}
+			m_free.push_back(dropped);
+			++m_stats.droppedFrames;
+		}
+		m_freeChanged.wait(lock, [this]() { return !m_free.empty(); });
+
+		m_writing = m_free.front();
+		m_free.pop_front();
+		FramePacket& packet = m_packets[m_writing];
+		packet.clear();
+		packet.materials.insert(packet.materials.end(), carried.begin(), carried.end());
+		packet.frame = m_nextFrame++;
+		return packet;
+	}
+
+	void RenderThread::publish()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_packets[m_writing].publishTime = std::chrono::steady_clock::now();
+			m_ready.push_back(m_writing);
+			m_writing = noPacket;
+			++m_stats.publishedFrames;
+		}
+		m_readyChanged.notify_one();
+	}
+
+	void RenderThread::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_readyChanged.notify_one();
+		if(m_thread.joinable())
+			m_thread.join();
+	}
+
+	RenderThreadStats RenderThread::stats() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		RenderThreadStats stats = m_stats;
+		stats.averageLatencyMs = stats.renderedFrames > 0 ? m_totalLatencyMs / stats.renderedFrames : 0.0;
+		return stats;
+	}
+
+	void RenderThread::main()
+	{
+		m_backend.initialize();
+		for(;;)
+		{
+			std::size_t index;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_readyChanged.wait(lock, [this]() { return m_stopping || !m_ready.empty(); });
+				if(m_ready.empty())
+					break;
+				index = m_ready.front();
+				m_ready.pop_front();
+			}
+
+			// The packet is neither free nor ready while it's rendered, the simulation can't touch it
+			FramePacket const& packet = m_packets[index];
+			m_backend.render(packet);
+			m_backend.present();
+			double const latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - packet.publishTime).count();
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_free.push_back(index);
+				++m_stats.renderedFrames;
+				m_totalLatencyMs += latency;
+				m_stats.maxLatencyMs = std::max(m_stats.maxLatencyMs, latency);
+			}
+			m_freeChanged.notify_one();
+		}
+		m_backend.shutdown();
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "FramePacket.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine
+{
+	class RenderBackend;
+
+	struct RenderThreadStats
+	{
+		std::uint64_t publishedFrames;
+		std::uint64_t renderedFrames;
+		std::uint64_t droppedFrames;
+		double averageLatencyMs;  // From publish to the end of present
+		double maxLatencyMs;
+	};
+
+	// Runs a RenderBackend on its own thread, fed by frame packets from the simulation thread.
+	//
+	// With two packets the simulation fills one while the other is rendered. With three it can run a frame further
+	// ahead, which smooths out uneven frames at the cost of a frame of latency. Queue mode renders every packet and
+	// blocks the simulation when all packets are in use. Mailbox mode never blocks the simulation: when no packet is
+	// free, the oldest one waiting to be rendered is dropped and reused, so the renderer always shows the newest frame.
+	// The material updates of a dropped packet are carried over to the next one, they are never lost.
+	class RenderThread
+	{
+	public:
+		enum class Mode
+		{
+			Queue,
+			Mailbox
+		};
+
+		RenderThread(RenderBackend& backend, std::size_t packetCount = 2, Mode mode = Mode::Queue);
+		~RenderThread();
+
+		RenderThread(const RenderThread&) = delete;
+		RenderThread& operator=(const RenderThread&) = delete;
+
+		// Simulation thread, one packet at a time. The packet is cleared but keeps its capacity.
+		FramePacket& acquire();
+		void publish();
+
+		// Renders the packets already published then stops the thread. Called by the destructor.
+		void stop();
+
+		RenderThreadStats stats() const;
+
+	private:
+		void main();
+
+		RenderBackend& m_backend;
+		Mode m_mode;
+		std::vector<FramePacket> m_packets;
+		std::deque<std::size_t> m_free;
+		std::deque<std::size_t> m_ready;
+		std::size_t m_writing;
+		std::uint64_t m_nextFrame;
+		bool m_stopping;
+
+		RenderThreadStats m_stats;
+		double m_totalLatencyMs;
+
+		mutable std::mutex m_mutex;
+		std::condition_variable m_freeChanged;
+		std::condition_variable m_readyChanged;
+		std::thread m_thread;
+	};
+}
@@ -0,0 +1,83 @@
+#include "Benchmark.h"
+#include "RenderBackend.h"
+#include "RenderThread.h"
+
+#include <string>
+#include <thread>
+
+namespace
+{
+	int const frameCount = 300;
+	std::size_t const drawCount = 10000;
+	double const simulationMs = 2.0;
+	double const presentMs = 3.0;
+
+	void spin(double milliseconds)
+	{
+		engine::Stopwatch const timer;
+		while(timer.elapsedMs() < milliseconds)
+			std::this_thread::yield();
+	}
+
+	void fillPacket(engine::FramePacket& packet)
+	{
+		packet.draws.resize(drawCount);
+		for(std::size_t i = 0; i < drawCount; ++i)
+		{
+			packet.draws[i].world = glm::mat4(1.0f);
+			packet.draws[i].world[3] = glm::vec4(static_cast<float>(i), 0.0f, 0.0f, 1.0f);
+			packet.draws[i].mesh = static_cast<std::uint32_t>(i % 64);
+			packet.draws[i].material = static_cast<std::uint32_t>(i % 16);
+		}
+	}
+
+	void runPipelined(engine::BenchmarkContext& context, std::size_t packetCount, engine::RenderThread::Mode mode, const char* name)
+	{
+		engine::NullRenderBackend backend(presentMs);
+		engine::RenderThreadStats stats;
+		engine::Stopwatch const timer;
+		{
+			engine::RenderThread renderThread(backend, packetCount, mode);
+			for(int frame = 0; frame < frameCount; ++frame)
+			{
+				spin(simulationMs);
+				fillPacket(renderThread.acquire());
+				renderThread.publish();
+			}
+			renderThread.stop();
+			stats = renderThread.stats();
+		}
+		double const elapsed = timer.elapsedMs();
+
+		std::string const prefix(name);
+		context.report((prefix + " simulated frames").c_str(), frameCount * 1000.0 / elapsed, "fps");
+		context.report((prefix + " presented frames").c_str(), stats.renderedFrames * 1000.0 / elapsed, "fps");
+		context.report((prefix + " average latency").c_str(), stats.averageLatencyMs, "ms");
+		context.report((prefix + " max latency").c_str(), stats.maxLatencyMs, "ms");
+		if(stats.droppedFrames > 0)
+			context.report((prefix + " dropped").c_str(), static_cast<double>(stats.droppedFrames), "frames");
+	}
+}
+
+ENGINE_BENCHMARK(RenderThread)
+{
+	// Simulation, packet building and present one after the other on the same thread
+	{
+		engine::NullRenderBackend backend(presentMs);
+		engine::FramePacket packet;
+		engine::Stopwatch const timer;
+		for(int frame = 0; frame < frameCount; ++frame)
+		{
+			spin(simulationMs);
+			packet.clear();
+			fillPacket(packet);
+			backend.render(packet);
+			backend.present();
+		}
+		context.report("single thread frames", frameCount * 1000.0 / timer.elapsedMs(), "fps");
+	}
+
+	runPipelined(context, 2, engine::RenderThread::Mode::Queue, "double buffered");
+	runPipelined(context, 3, engine::RenderThread::Mode::Queue, "triple buffered");
+	runPipelined(context, 3, engine::RenderThread::Mode::Mailbox, "triple buffered mailbox");
+}
@@ -0,0 +1,323 @@
+#include "Replay.h"
+#include "FileIo.h"
+#include "Serialization.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace engine
+{
+	namespace
+	{
+		char const replayMagic[4] = { 'R', 'P', 'L', 'Y' };
+		std::uint32_t const replayVersion = 1;
+
+		// Record kinds in a tick, a tick ends at EndTick or at the end of the stream
+		enum Record : unsigned char
+		{
+			EndTick,
+			ButtonUp,
+			ButtonDown,
+			CursorMove,
+			ScrollMove,
+			RandomSeed
+		};
+
+		std::uint32_t floatBits(float value)
+		{
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+
+		float bitsFloat(std::uint32_t bits)
+		{
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+	}
+
+	Replay::Replay()
+	{
+		clear();
+	}
+
+	void Replay::clear()
+	{
+		m_stream.clear();
+		m_snapshots.clear();
+		std::memset(&m_writer, 0, sizeof(m_writer));
+		m_tickStart = m_writer;
+	}
+
+	void Replay::beginTick(std::uint64_t time)
+	{
+		if(m_writer.tick > 0)
+			m_stream.push_back(EndTick);
+		m_tickStart = m_writer;
+		m_tickStart.offset = m_stream.size();
+
+		// Steady tick rates make the change of step close to zero
+		std::int64_t const step = static_cast<std::int64_t>(time - m_writer.time);
+		writeSigned(m_stream, step - m_writer.timeStep);
+		m_writer.timeStep = step;
+		m_writer.time = time;
+		++m_writer.tick;
+	}
+
+	void Replay::writeValue(std::uint32_t* previousBits, const glm::vec2& value)
+	{
+		for(int axis = 0; axis < 2; ++axis)
+		{
+			std::uint32_t const bits = floatBits(value[axis]);
+			writeSigned(m_stream, static_cast<std::int32_t>(bits - previousBits[axis]));
+			previousBits[axis] = bits;
+		}
+	}
+
+	void Replay::recordEvent(const InputEvent& event)
+	{
+		switch(event.type)
+		{
+		case InputEvent::Type::Button:
+			m_stream.push_back(event.down ? ButtonDown : ButtonUp);
+			break;
+		case InputEvent::Type::Cursor:
+			m_stream.push_back(CursorMove);
+			break;
+		case InputEvent::Type::Scroll:
+			m_stream.push_back(ScrollMove);
+			break;
+		}
+		writeSigned(m_stream, static_cast<std::int64_t>(event.time - m_writer.eventTime));
+		m_writer.eventTime = event.time;
+
+		if(event.type == InputEvent::Type::Button)
+			writeVarint(m_stream, event.button);
+		else
+			writeValue(event.type == InputEvent::Type::Cursor ? m_writer.cursorBits : m_writer.scrollBits, event.value);
+	}
+
+	void Replay::seedRandom(std::uint32_t seed)
+	{
+		m_stream.push_back(RandomSeed);
+		writeVarint(m_stream, seed);
+		std::srand(seed);
+	}
+
+	void Replay::recordSnapshot(const void* state, std::size_t size)
+	{
+		Snapshot snapshot;
+		snapshot.cursor = m_tickStart;
+		snapshot.state.assign(static_cast<const unsigned char*>(state), static_cast<const unsigned char*>(state) + size);
+		m_snapshots.push_back(snapshot);
+	}
+
+	bool Replay::save(const std::string& path) const
+	{
+		// Cursors are written as they are in memory, the layout is part of the file format
+		static_assert(sizeof(Cursor) == 56, "Replay::Cursor layout changed, bump replayVersion");
+
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+		if(!file)
+			return false;
+
+		// The writer only tracks the offset of the tick it's in, the one saved is the end of the stream
+		Cursor writer = m_writer;
+		writer.offset = m_stream.size();
+		std::uint64_t const streamSize = m_stream.size();
+		std::uint64_t const snapshotCount = m_snapshots.size();
+		bool ok = std::fwrite(replayMagic, sizeof(replayMagic), 1, file) == 1;
+		ok = ok && std::fwrite(&replayVersion, sizeof(replayVersion), 1, file) == 1;
+		ok = ok && std::fwrite(&writer, sizeof(writer), 1, file) == 1;
+		ok = ok && std::fwrite(&streamSize, sizeof(streamSize), 1, file) == 1;
+		ok = ok && (streamSize == 0 || std::fwrite(m_stream.data(), 1, m_stream.size(), file) == m_stream.size());
+		ok = ok && std::fwrite(&snapshotCount, sizeof(snapshotCount), 1, file) == 1;
+		for(const Snapshot& snapshot : m_snapshots)
+		{
+			std::uint64_t const stateSize = snapshot.state.size();
+			ok = ok && std::fwrite(&snapshot.cursor, sizeof(snapshot.cursor), 1, file) == 1;
+			ok = ok && std::fwrite(&stateSize, sizeof(stateSize), 1, file) == 1;
+			ok = ok && (stateSize == 0 || std::fwrite(snapshot.state.data(), 1, snapshot.state.size(), file) == snapshot.state.size());
+		}
+		return std::fclose(file) == 0 && ok;
+	}
+
+	bool Replay::load(const std::string& path)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if(!file)
+			return false;
+
+		char magic[4] = {};
+		std::uint32_t version = 0;
+		Cursor writer;
+		std::uint64_t streamSize = 0;
+		bool ok = std::fread(magic, sizeof(magic), 1, file) == 1
+			&& std::fread(&version, sizeof(version), 1, file) == 1
+			&& std::fread(&writer, sizeof(writer), 1, file) == 1
+			&& std::fread(&streamSize, sizeof(streamSize), 1, file) == 1
+			&& std::equal(magic, magic + 4, replayMagic)
+			&& version == replayVersion;
+		// Every tick takes at least a byte of the stream, which must end where the writer stopped
+		ok = ok && streamSize <= bytesLeft(file)
+			&& writer.offset == streamSize
+			&& writer.tick <= streamSize;
+
+		std::vector<unsigned char> stream;
+		std::vector<Snapshot> snapshots;
+		std::uint64_t snapshotCount = 0;
+		if(ok)
+		{
+			stream.resize(static_cast<std::size_t>(streamSize));
+			ok = (streamSize == 0 || std::fread(stream.data(), 1, stream.size(), file) == stream.size())
+				&& std::fread(&snapshotCount, sizeof(snapshotCount), 1, file) == 1;
+		}
+		for(std::uint64_t i = 0; ok && i < snapshotCount; ++i)
+		{
+			Snapshot snapshot;
+			std::uint64_t stateSize = 0;
+			// seek binary searches the snapshots by tick
+			ok = std::fread(&snapshot.cursor, sizeof(snapshot.cursor), 1, file) == 1
+				&& std::fread(&stateSize, sizeof(stateSize), 1, file) == 1
+				&& snapshot.cursor.offset <= streamSize
+				&& snapshot.cursor.tick <= writer.tick
+				&& (snapshots.empty() || snapshot.cursor.tick >= snapshots.back().cursor.tick)
+				&& stateSize <= bytesLeft(file);
+			if(ok)
+			{
+				snapshot.state.resize(static_cast<std::size_t>(stateSize));
+				ok = stateSize == 0 || std::fread(snapshot.state.data(), 1, snapshot.state.size(), file) == snapshot.state.size();
+				snapshots.push_back(snapshot);
+			}
+		}
+		std::fclose(file);
+		if(!ok)
+			return false;
+
+		m_stream.swap(stream);
+		m_snapshots.swap(snapshots);
+		m_writer = writer;
+		m_tickStart = m_writer;
+		return true;
+	}
+
+	ReplayPlayer::ReplayPlayer(const Replay& replay) :
+		m_replay(replay),
+		m_corrupt(false)
+	{
+		rewind();
+	}
+
+	void ReplayPlayer::rewind()
+	{
+		std::memset(&m_cursor, 0, sizeof(m_cursor));
+		m_events.clear();
+		m_corrupt = false;
+	}
+
+	void ReplayPlayer::stopCorrupt()
+	{
+		m_events.clear();
+		m_cursor.offset = m_replay.m_stream.size();
+		m_corrupt = true;
+	}
+
+	bool ReplayPlayer::nextTick()
+	{
+		const std::vector<unsigned char>& stream = m_replay.m_stream;
+		m_events.clear();
+		if(m_cursor.tick >= m_replay.m_writer.tick || m_cursor.offset >= stream.size())
+			return false;
+
+		std::uint64_t& offset = m_cursor.offset;
+		m_cursor.timeStep += readSigned(stream, offset);
+		m_cursor.time += static_cast<std::uint64_t>(m_cursor.timeStep);
+		++m_cursor.tick;
+
+		while(offset < stream.size())
+		{
+			unsigned char const record = stream[static_cast<std::size_t>(offset++)];
+			if(record == EndTick)
+				break;
+			if(record > RandomSeed)
+			{
+				stopCorrupt();
+				return false;
+			}
+			if(record == RandomSeed)
+			{
+				std::srand(static_cast<unsigned>(readVarint(stream, offset)));
+				continue;
+			}
+
+			InputEvent event;
+			event.down = record == ButtonDown;
+			event.button = 0;
+			event.value = glm::vec2(0.0f);
+			m_cursor.eventTime += static_cast<std::uint64_t>(readSigned(stream, offset));
+			event.time = m_cursor.eventTime;
+			if(record == ButtonUp || record == ButtonDown)
+			{
+				event.type = InputEvent::Type::Button;
+				std::uint64_t const button = readVarint(stream, offset);
+				if(button >= inputButtonCount)
+				{
+					stopCorrupt();
+					return false;
+				}
+				event.button = static_cast<InputButton>(button);
+			}
+			else
+			{
+				event.type = record == CursorMove ? InputEvent::Type::Cursor : InputEvent::Type::Scroll;
+				std::uint32_t* bits = record == CursorMove ? m_cursor.cursorBits : m_cursor.scrollBits;
+				for(int axis = 0; axis < 2; ++axis)
+				{
+					bits[axis] += static_cast<std::uint32_t>(readSigned(stream, offset));
+					event.value[axis] = bitsFloat(bits[axis]);
+				}
+			}
+			m_events.push_back(event);
+		}
+		return true;
+	}
+
+	bool ReplayPlayer::playTick(ActionMap& actions)
+	{
+		if(!nextTick())
+			return false;
+		actions.beginTick();
+		for(const InputEvent& event : m_events)
+			actions.apply(event);
+		return true;
+	}
+
+	const std::vector<unsigned char>* ReplayPlayer::seek(std::uint64_t tick)
+	{
+		const std::vector<Replay::Snapshot>& snapshots = m_replay.m_snapshots;
+		auto const after = std::upper_bound(snapshots.begin(), snapshots.end(), tick, [](std::uint64_t value, const Replay::Snapshot& snapshot)
+		{
+			return value < snapshot.cursor.tick;
+		});
+		rewind();
+		if(after == snapshots.begin())
+			return nullptr;
+		m_cursor = (after - 1)->cursor;
+		return &(after - 1)->state;
+	}
+
+	void consumeInput(InputQueue& queue, ActionMap& actions, Replay& replay)
+	{
+		actions.beginTick();
+		InputEvent event;
+		while(queue.pop(event))
+		{
+			replay.recordEvent(event);
+			actions.apply(event);
+		}
+	}
+}
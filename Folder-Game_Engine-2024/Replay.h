@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Input.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace engine
+{
+	// A recorded session: the time of every simulation tick, the input events each tick consumed and the seeds given
+	// to std::srand, which drives glm's gtc/random. Snapshots of the game state taken along the way let playback
+	// seek without simulating from the start.
+	//
+	// Ticks are delta encoded into one byte stream. Times and event fields are stored as differences from the
+	// previous ones in variable length integers, cursor and scroll values as differences of their float bits, so an
+	// idle tick at a steady rate takes two bytes.
+	class Replay
+	{
+	public:
+		Replay();
+
+		// Recording, ticks are numbered from 0 in the order they begin. time is in microseconds and must not decrease.
+		void beginTick(std::uint64_t time);
+		void recordEvent(const InputEvent& event);
+		// Seeds std::srand and records the seed, playback seeds it again at the same point of the tick
+		void seedRandom(std::uint32_t seed);
+		// State the current tick starts from, call right after beginTick. std::rand's state can't be saved: a session
+		// that uses it should call seedRandom right after each snapshot so playback can seek there.
+		void recordSnapshot(const void* state, std::size_t size);
+		void clear();
+
+		std::uint64_t tickCount() const { return m_writer.tick; }
+		std::size_t encodedBytes() const { return m_stream.size(); }
+		std::size_t snapshotCount() const { return m_snapshots.size(); }
+
+		bool save(const std::string& path) const;
+		bool load(const std::string& path);
+
+	private:
+		friend class ReplayPlayer;
+
+		// Everything needed to decode the stream from offset on
+		struct Cursor
+		{
+			std::uint64_t offset;
+			std::uint64_t tick;
+			std::uint64_t time;
+			std::int64_t timeStep;
+			std::uint64_t eventTime;
+			std::uint32_t cursorBits[2];
+			std::uint32_t scrollBits[2];
+		};
+
+		struct Snapshot
+		{
+			Cursor cursor;
+			std::vector<unsigned char> state;
+		};
+
+		void writeValue(std::uint32_t* previousBits, const glm::vec2& value);
+
+		std::vector<unsigned char> m_stream;
+		std::vector<Snapshot> m_snapshots;
+		Cursor m_writer;
+		Cursor m_tickStart;
+	};
+
+	// Headless playback of a Replay, one tick per call, as fast as the simulation goes
+	class ReplayPlayer
+	{
+	public:
+		explicit ReplayPlayer(const Replay& replay);
+
+		// Decodes the next tick and reseeds std::srand if the recording did, false once every tick was played.
+		// A record this version doesn't know ends playback there and marks the stream corrupt.
+		bool nextTick();
+		// nextTick, then applies the tick's events to actions like consumeInput did while recording
+		bool playTick(ActionMap& actions);
+
+		// Tick returned by the last nextTick, its time and its events
+		std::uint64_t tick() const { return m_cursor.tick - 1; }
+		std::uint64_t time() const { return m_cursor.time; }
+		const std::vector<InputEvent>& events() const { return m_events; }
+		bool corrupt() const { return m_corrupt; }
+
+		// Moves playback to the latest snapshot at or before tick and returns the state to restore, the next
+		// nextTick plays the snapshot's tick. Returns nullptr and rewinds to the start when there is none.
+		const std::vector<unsigned char>* seek(std::uint64_t tick);
+		void rewind();
+
+	private:
+		void stopCorrupt();
+
+		const Replay& m_replay;
+		Replay::Cursor m_cursor;
+		std::vector<InputEvent> m_events;
+		bool m_corrupt;
+	};
+
+	// consumeInput for a recording session, replay.beginTick must have been called for the tick
+	void consumeInput(InputQueue& queue, ActionMap& actions, Replay& replay);
+}
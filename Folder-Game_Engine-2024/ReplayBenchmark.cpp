@@ -0,0 +1,176 @@
+#include "Benchmark.h"
+#include "Determinism.h"
+#include "Replay.h"
+
+#include <gtc/random.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	std::uint64_t const tickCount = 60 * 60 * 10;
+	std::uint64_t const snapshotInterval = 600;
+	std::size_t const bodyCount = 256;
+
+	// Game state fed only by the tick's events and std::rand, so snapshots are plain bytes
+	struct World
+	{
+		glm::vec2 bodies[bodyCount];
+		glm::vec2 cursor;
+		std::uint32_t buttonsDown;
+
+		void tick(const std::vector<engine::InputEvent>& events)
+		{
+			for(const engine::InputEvent& event : events)
+			{
+				if(event.type == engine::InputEvent::Type::Cursor)
+					cursor = event.value;
+				else if(event.type == engine::InputEvent::Type::Button)
+					buttonsDown += event.down ? 1 : 0;
+			}
+			for(glm::vec2& body : bodies)
+				body += (cursor - body) * 0.01f + glm::linearRand(glm::vec2(-1.0f), glm::vec2(1.0f));
+		}
+
+		std::uint64_t checksum() const
+		{
+			engine::StateHash hash;
+			hash.add(*this);
+			return hash.value();
+		}
+	};
+
+	// About one event per tick, mostly cursor moves, and a tick step jittering around 16.7 ms
+	struct Session
+	{
+		std::mt19937 random;
+		std::uint64_t time;
+
+		Session() : random(23), time(0) {}
+
+		std::uint64_t nextTickTime()
+		{
+			time += 16666 + std::uniform_int_distribution<int>(-200, 200)(random);
+			return time;
+		}
+
+		std::vector<engine::InputEvent> events()
+		{
+			std::vector<engine::InputEvent> events;
+			int const count = std::uniform_int_distribution<int>(0, 9)(random) < 5 ? 0 : std::uniform_int_distribution<int>(1, 3)(random);
+			for(int i = 0; i < count; ++i)
+			{
+				engine::InputEvent event;
+				bool const button = std::uniform_int_distribution<int>(0, 3)(random) == 0;
+				event.type = button ? engine::InputEvent::Type::Button : engine::InputEvent::Type::Cursor;
+				event.down = button && (random() & 1) != 0;
+				event.button = button ? static_cast<engine::InputButton>(std::uniform_int_distribution<int>(32, 96)(random)) : 0;
+				event.value = button ? glm::vec2(0.0f) : glm::vec2(std::uniform_real_distribution<float>(0.0f, 1280.0f)(random), std::uniform_real_distribution<float>(0.0f, 720.0f)(random));
+				event.time = time - 1000 + static_cast<std::uint64_t>(i) * 100;
+				events.push_back(event);
+			}
+			return events;
+		}
+	};
+
+	void restore(World& world, const std::vector<unsigned char>& state)
+	{
+		std::memcpy(&world, state.data(), sizeof(World));
+	}
+}
+
+ENGINE_BENCHMARK(Replay)
+{
+	World world = World();
+	Session session;
+	engine::Replay replay;
+	engine::ChecksumLog recorded;
+	std::uint64_t eventCount = 0;
+
+	engine::Stopwatch timer;
+	for(std::uint64_t tick = 0; tick < tickCount; ++tick)
+	{
+		replay.beginTick(session.nextTickTime());
+		if(tick % snapshotInterval == 0)
+		{
+			replay.recordSnapshot(&world, sizeof(world));
+			replay.seedRandom(static_cast<std::uint32_t>(tick * 2654435761u));
+		}
+		std::vector<engine::InputEvent> const events = session.events();
+		for(const engine::InputEvent& event : events)
+			replay.recordEvent(event);
+		eventCount += events.size();
+		world.tick(events);
+		recorded.record(tick, world.checksum());
+	}
+	context.report("record", timer.elapsedMs(), "ms");
+	context.report("ticks", static_cast<double>(replay.tickCount()), "");
+	context.report("events", static_cast<double>(eventCount), "");
+	context.report("encoded", replay.encodedBytes() / 1024.0, "KiB");
+	context.report("bytes per tick", static_cast<double>(replay.encodedBytes()) / replay.tickCount(), "");
+	context.report("InputLog size", eventCount * sizeof(engine::InputLog::Entry) / 1024.0, "KiB");
+
+	std::string const path = "replay_benchmark.replay";
+	engine::Replay loaded;
+	bool const roundTrip = replay.save(path) && loaded.load(path);
+	std::remove(path.c_str());
+	context.report("save and load", roundTrip ? 1.0 : 0.0, "ok");
+
+	// Headless playback from the start
+	world = World();
+	engine::ReplayPlayer player(loaded);
+	engine::ChecksumLog played;
+	timer.restart();
+	while(player.nextTick())
+	{
+		world.tick(player.events());
+		played.record(player.tick(), world.checksum());
+	}
+	double const playMs = timer.elapsedMs();
+	context.report("playback", playMs, "ms");
+	context.report("playback speed", tickCount * 1000.0 / playMs / 60.0, "x realtime");
+	std::uint64_t const mismatch = recorded.firstMismatch(played);
+	context.report("first mismatch tick (-1 none)", mismatch == engine::ChecksumLog::noMismatch ? -1.0 : static_cast<double>(mismatch), "");
+
+	// Seeking to a late tick restores the snapshot before it and plays the rest
+	std::uint64_t const target = tickCount - 123;
+	timer.restart();
+	const std::vector<unsigned char>* state = player.seek(target);
+	if(state)
+		restore(world, *state);
+	while(player.nextTick() && player.tick() < target)
+		world.tick(player.events());
+	world.tick(player.events());
+	context.report("seek", timer.elapsedMs(), "ms");
+	context.report("seek matches", state && world.checksum() == recorded.entries()[target].checksum ? 1.0 : 0.0, "ok");
+
+	// Two empty ticks and a snapshot: the stream is { step 0, EndTick, step 1 }, after the 72 byte header
+	engine::Replay small;
+	small.beginTick(0);
+	small.beginTick(1);
+	small.recordSnapshot(&bodyCount, sizeof(bodyCount));
+	long const recordOffset = 72 + 1;
+	long const snapshotTickOffset = 72 + 3 + 8 + 8;
+
+	// An unknown record ends playback instead of being decoded as an event
+	unsigned char const unknownRecord = 0x7F;
+	std::FILE* file = small.save(path) ? std::fopen(path.c_str(), "r+b") : nullptr;
+	bool patched = file && std::fseek(file, recordOffset, SEEK_SET) == 0 && std::fwrite(&unknownRecord, 1, 1, file) == 1;
+	patched = file && std::fclose(file) == 0 && patched;
+	engine::Replay corrupt;
+	bool stopped = patched && corrupt.load(path);
+	engine::ReplayPlayer corruptPlayer(corrupt);
+	stopped = stopped && !corruptPlayer.nextTick() && corruptPlayer.corrupt() && !corruptPlayer.nextTick();
+	context.report("unknown record stops playback", stopped ? 1.0 : 0.0, "ok");
+
+	// A snapshot past the last tick can't be seeked to
+	std::uint64_t const lateTick = 5;
+	file = small.save(path) ? std::fopen(path.c_str(), "r+b") : nullptr;
+	patched = file && std::fseek(file, snapshotTickOffset, SEEK_SET) == 0 && std::fwrite(&lateTick, sizeof(lateTick), 1, file) == 1;
+	patched = file && std::fclose(file) == 0 && patched;
+	context.report("late snapshot refused", patched && !corrupt.load(path) ? 1.0 : 0.0, "ok");
+	std::remove(path.c_str());
+}
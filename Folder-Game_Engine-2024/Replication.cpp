@@ -0,0 +1,532 @@
+#include "Replication.h"
+#include "JobSystem.h"
+
+#include <gtx/compatibility.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace engine
+{
+	namespace
+	{
+		// Every packet starts with the protocol id and a packet type, data packets continue with a NetConnection packet
+		std::uint32_t const protocolId = 0x52474E45u;
+		std::size_t const framingSize = 5;
+
+		enum PacketType : std::uint8_t
+		{
+			ConnectRequest,
+			ConnectAccept,
+			Data
+		};
+
+		// First byte of every reliable message
+		enum MessageType : std::uint8_t
+		{
+			DespawnMessage,
+			GameMessage
+		};
+
+		// Snapshot payload: the server tick, the entity count, then each entity's id, position and rotation
+		int const tickBits = 32;
+		int const countBits = 10;
+		std::size_t const maxEntitiesPerPacket = (1u << countBits) - 1;
+
+		// Entities entering a client's range jump the queue so they show up at once
+		float const newEntityPriority = 8.0f;
+
+		// Type, tick and count
+		std::size_t const despawnHeaderSize = 7;
+		std::size_t const despawnsPerMessage = (NetConnection::maxMessageSize - despawnHeaderSize) / sizeof(std::uint32_t);
+
+		void writeFraming(std::vector<unsigned char>& packet, PacketType type)
+		{
+			unsigned char framing[framingSize];
+			std::memcpy(framing, &protocolId, sizeof(protocolId));
+			framing[4] = type;
+			packet.insert(packet.begin(), framing, framing + framingSize);
+		}
+
+		bool readFraming(const std::vector<unsigned char>& packet, PacketType& type)
+		{
+			std::uint32_t id;
+			if(packet.size() < framingSize)
+				return false;
+			std::memcpy(&id, packet.data(), sizeof(id));
+			type = static_cast<PacketType>(packet[4]);
+			return id == protocolId && type <= Data;
+		}
+	}
+
+	ReplicationSettings::ReplicationSettings() :
+		maxEntities(65536),
+		maxClients(64),
+		tickRate(30.0f),
+		worldMin(-2048.0f, -256.0f, -2048.0f),
+		worldMax(2048.0f, 256.0f, 2048.0f),
+		positionBits(18),
+		rotationBits(10),
+		interestRadius(150.0f),
+		packetSize(1200),
+		interpolationDelay(0.1),
+		timeout(5.0)
+	{
+	}
+
+	ReplicationServer::ReplicationServer(const ReplicationSettings& settings) :
+		m_settings(settings),
+		m_idBits(bitsFor(settings.maxEntities)),
+		m_clients(settings.maxClients),
+		m_grid(settings.interestRadius),
+		m_tick(0),
+		m_entitiesSent(0)
+	{
+		for(Client& client : m_clients)
+			client.active = false;
+	}
+
+	bool ReplicationServer::open(std::uint16_t port)
+	{
+		return m_socket.open(port);
+	}
+
+	std::size_t ReplicationServer::clientCount() const
+	{
+		return static_cast<std::size_t>(std::count_if(m_clients.begin(), m_clients.end(), [](const Client& client) { return client.active; }));
+	}
+
+	ReplicationServer::Client* ReplicationServer::findClient(const NetAddress& address)
+	{
+		for(Client& client : m_clients)
+		{
+			if(client.active && client.address == address)
+				return &client;
+		}
+		return nullptr;
+	}
+
+	void ReplicationServer::sendControl(const NetAddress& to, std::uint8_t type, double now)
+	{
+		std::vector<unsigned char> packet;
+		writeFraming(packet, static_cast<PacketType>(type));
+		m_socket.send(to, packet.data(), packet.size(), now);
+	}
+
+	void ReplicationServer::receive(double now)
+	{
+		NetAddress from;
+		PacketType type;
+		while(m_socket.receive(from, m_receiveBuffer))
+		{
+			if(!readFraming(m_receiveBuffer, type))
+				continue;
+			Client* client = findClient(from);
+			if(type == ConnectRequest)
+			{
+				// Accepts are unreliable, the client asks again until one arrives
+				if(!client)
+				{
+					auto const free = std::find_if(m_clients.begin(), m_clients.end(), [](const Client& slot) { return !slot.active; });
+					if(free == m_clients.end())
+						continue;
+					client = &*free;
+					client->active = true;
+					client->address = from;
+					client->connection.reset();
+					client->view = glm::vec3(0.0f);
+					client->priority.assign(m_settings.maxEntities, 0.0f);
+					client->inRangeTick.assign(m_settings.maxEntities, 0);
+					client->known.assign(m_settings.maxEntities, 0);
+					client->knownList.clear();
+				}
+				client->lastReceive = now;
+				sendControl(from, ConnectAccept, now);
+			}
+			else if(type == Data && client)
+			{
+				std::size_t payload = 0;
+				if(!client->connection.readPacket(now, m_receiveBuffer.data() + framingSize, m_receiveBuffer.size() - framingSize, payload))
+					continue;
+				client->lastReceive = now;
+				payload += framingSize;
+				// The view comes from the network: anything not finite is dropped, the rest kept inside the world
+				glm::vec3 view;
+				if(m_receiveBuffer.size() - payload >= sizeof(glm::vec3))
+				{
+					std::memcpy(&view, m_receiveBuffer.data() + payload, sizeof(glm::vec3));
+					if(glm::all(glm::isfinite(view)))
+						client->view = glm::clamp(view, m_settings.worldMin, m_settings.worldMax);
+				}
+
+				// Clients send no reliable messages yet
+				std::vector<unsigned char> message;
+				while(client->connection.receiveReliable(message))
+				{
+				}
+			}
+		}
+	}
+
+	bool ReplicationServer::sendMessage(std::size_t client, const void* data, std::size_t size)
+	{
+		if(client >= m_clients.size() || !m_clients[client].active || size + 1 > NetConnection::maxMessageSize)
+			return false;
+		std::vector<unsigned char> message(size + 1);
+		message[0] = GameMessage;
+		if(size > 0)
+			std::memcpy(message.data() + 1, data, size);
+		return m_clients[client].connection.sendReliable(message.data(), message.size());
+	}
+
+	void ReplicationServer::broadcastMessage(const void* data, std::size_t size)
+	{
+		for(std::size_t client = 0; client < m_clients.size(); ++client)
+			sendMessage(client, data, size);
+	}
+
+	void ReplicationServer::updateClient(Client& client, const std::uint32_t* hits, std::size_t hitCount, const glm::vec3* positions, const glm::quat* rotations, double now)
+	{
+		// Priorities grow from 1 at the edge of the range to 3 next to the view
+		float const inverseRadius = 1.0f / m_settings.interestRadius;
+		client.candidates.clear();
+		for(std::size_t i = 0; i < hitCount; ++i)
+		{
+			std::uint32_t const entity = hits[i];
+			client.inRangeTick[entity] = m_tick;
+			float const closeness = 1.0f - glm::min(1.0f, glm::distance(client.view, positions[entity]) * inverseRadius);
+			client.priority[entity] += client.known[entity] ? 1.0f + 2.0f * closeness : newEntityPriority;
+			client.candidates.push_back(entity);
+		}
+
+		client.leaving.clear();
+		for(std::uint32_t entity : client.knownList)
+		{
+			if(client.inRangeTick[entity] != m_tick)
+				client.leaving.push_back(entity);
+		}
+
+		// Entities are only forgotten once their despawn is queued. With the reliable window full the rest stay
+		// known and out of range, and are despawned on a later tick.
+		std::vector<unsigned char> despawn;
+		bool forgotten = false;
+		for(std::size_t first = 0; first < client.leaving.size(); first += despawnsPerMessage)
+		{
+			std::size_t const entities = std::min(client.leaving.size() - first, despawnsPerMessage);
+			std::uint16_t const count = static_cast<std::uint16_t>(entities);
+			despawn.resize(despawnHeaderSize + entities * sizeof(std::uint32_t));
+			despawn[0] = DespawnMessage;
+			std::memcpy(despawn.data() + 1, &m_tick, sizeof(m_tick));
+			std::memcpy(despawn.data() + 5, &count, sizeof(count));
+			std::memcpy(despawn.data() + despawnHeaderSize, client.leaving.data() + first, entities * sizeof(std::uint32_t));
+			if(!client.connection.sendReliable(despawn.data(), despawn.size()))
+				break;
+			for(std::size_t i = first; i < first + entities; ++i)
+			{
+				client.known[client.leaving[i]] = 0;
+				client.priority[client.leaving[i]] = 0.0f;
+			}
+			forgotten = true;
+		}
+		if(forgotten)
+		{
+			std::size_t kept = 0;
+			for(std::uint32_t entity : client.knownList)
+			{
+				if(client.known[entity])
+					client.knownList[kept++] = entity;
+			}
+			client.knownList.resize(kept);
+		}
+
+		client.connection.writePacket(now, client.packet, m_settings.packetSize / 2 - framingSize);
+		writeFraming(client.packet, Data);
+
+		// The highest priorities that fit in the rest of the packet
+		std::size_t const entityBits = static_cast<std::size_t>(m_idBits + 3 * m_settings.positionBits + 2 + 3 * m_settings.rotationBits);
+		std::size_t const freeBits = (m_settings.packetSize - client.packet.size()) * 8 - tickBits - countBits;
+		std::size_t const sendCount = std::min(std::min(client.candidates.size(), freeBits / entityBits), maxEntitiesPerPacket);
+		const std::vector<float>& priority = client.priority;
+		std::nth_element(client.candidates.begin(), client.candidates.begin() + sendCount, client.candidates.end(), [&](std::uint32_t a, std::uint32_t b)
+		{
+			return priority[a] > priority[b];
+		});
+
+		client.bits.clear();
+		client.bits.write(m_tick, tickBits);
+		client.bits.write(static_cast<std::uint32_t>(sendCount), countBits);
+		for(std::size_t i = 0; i < sendCount; ++i)
+		{
+			std::uint32_t const entity = client.candidates[i];
+			client.bits.write(entity, m_idBits);
+			client.bits.writeVec3(positions[entity], m_settings.worldMin, m_settings.worldMax, m_settings.positionBits);
+			client.bits.writeQuaternion(rotations[entity], m_settings.rotationBits);
+			client.priority[entity] = 0.0f;
+			if(!client.known[entity])
+			{
+				client.known[entity] = 1;
+				client.knownList.push_back(entity);
+			}
+		}
+		client.bits.flush();
+		client.packet.insert(client.packet.end(), client.bits.bytes().begin(), client.bits.bytes().end());
+		client.sentCount = static_cast<std::uint32_t>(sendCount);
+	}
+
+	void ReplicationServer::tick(double now, const glm::vec3* positions, const glm::quat* rotations, std::size_t count, JobSystem* jobs)
+	{
+		++m_tick;
+		receive(now);
+
+		m_activeClients.clear();
+		m_views.clear();
+		for(std::size_t i = 0; i < m_clients.size(); ++i)
+		{
+			Client& client = m_clients[i];
+			if(client.active && now - client.lastReceive > m_settings.timeout)
+				client.active = false;
+			if(!client.active)
+				continue;
+			m_activeClients.push_back(static_cast<std::uint32_t>(i));
+			m_views.push_back(client.view);
+		}
+		m_radii.assign(m_views.size(), m_settings.interestRadius);
+
+		count = std::min<std::size_t>(count, m_settings.maxEntities);
+		m_grid.build(positions, count, jobs);
+		m_grid.queryRadiusBatch(m_views.data(), m_radii.data(), m_views.size(), m_interest, jobs);
+
+		// Clients only touch their own state, packets are sent afterwards from this thread
+		parallelFor(jobs, m_activeClients.size(), 1, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t i = begin; i < end; ++i)
+				updateClient(m_clients[m_activeClients[i]], m_interest.hits(i), m_interest.hitCount(i), positions, rotations, now);
+		});
+		for(std::uint32_t index : m_activeClients)
+		{
+			Client& client = m_clients[index];
+			m_socket.send(client.address, client.packet.data(), client.packet.size(), now);
+			m_entitiesSent += client.sentCount;
+		}
+		m_socket.update(now);
+	}
+
+	const int ReplicationClient::historySize;
+
+	ReplicationClient::ReplicationClient(const ReplicationSettings& settings) :
+		m_settings(settings),
+		m_idBits(bitsFor(settings.maxEntities)),
+		m_connected(false),
+		m_view(0.0f),
+		m_history(settings.maxEntities),
+		m_knownIndex(settings.maxEntities, 0),
+		m_despawnTick(settings.maxEntities, 0),
+		m_latestTick(0),
+		m_hasSnapshot(false),
+		m_renderTick(0.0),
+		m_lastUpdate(0.0),
+		m_bytesReceived(0),
+		m_entityUpdates(0)
+	{
+		for(History& history : m_history)
+			history.count = 0;
+	}
+
+	bool ReplicationClient::open(const NetAddress& server, std::uint16_t port)
+	{
+		m_server = server;
+		m_connected = false;
+		m_connection.reset();
+		return m_socket.open(port);
+	}
+
+	void ReplicationClient::forget(std::uint32_t entity)
+	{
+		std::uint32_t const index = m_knownIndex[entity];
+		std::uint32_t const last = m_knownList.back();
+		m_knownList[index] = last;
+		m_knownIndex[last] = index;
+		m_knownList.pop_back();
+		m_history[entity].count = 0;
+	}
+
+	void ReplicationClient::addSample(std::uint32_t entity, const Sample& sample)
+	{
+		if(sample.tick <= m_despawnTick[entity])
+			return;
+		History& history = m_history[entity];
+		if(history.count == 0)
+		{
+			m_knownIndex[entity] = static_cast<std::uint32_t>(m_knownList.size());
+			m_knownList.push_back(entity);
+		}
+
+		// Insert in tick order, dropping the oldest sample when full
+		int position = history.count;
+		while(position > 0 && history.samples[position - 1].tick > sample.tick)
+			--position;
+		if(position > 0 && history.samples[position - 1].tick == sample.tick)
+			return;
+		if(history.count == historySize)
+		{
+			if(position == 0)
+				return;
+			std::copy(history.samples + 1, history.samples + position, history.samples);
+			--position;
+			--history.count;
+		}
+		std::copy_backward(history.samples + position, history.samples + history.count, history.samples + history.count + 1);
+		history.samples[position] = sample;
+		++history.count;
+	}
+
+	void ReplicationClient::readSnapshot(const unsigned char* data, std::size_t size)
+	{
+		BitReader bits(data, size);
+		std::uint32_t const tick = bits.read(tickBits);
+		std::uint32_t const count = bits.read(countBits);
+		if(bits.overflowed())
+			return;
+		if(!m_hasSnapshot || tick > m_latestTick)
+			m_latestTick = tick;
+		m_hasSnapshot = true;
+
+		Sample sample;
+		sample.tick = tick;
+		for(std::uint32_t i = 0; i < count; ++i)
+		{
+			std::uint32_t const entity = bits.read(m_idBits);
+			sample.position = bits.readVec3(m_settings.worldMin, m_settings.worldMax, m_settings.positionBits);
+			sample.rotation = bits.readQuaternion(m_settings.rotationBits);
+			if(bits.overflowed())
+				break;
+			if(entity >= m_settings.maxEntities)
+				continue;
+			addSample(entity, sample);
+			++m_entityUpdates;
+		}
+	}
+
+	void ReplicationClient::readReliable()
+	{
+		std::vector<unsigned char> message;
+		while(m_connection.receiveReliable(message))
+		{
+			if(message.empty())
+				continue;
+			if(message[0] == GameMessage)
+			{
+				m_messages.push_back(std::vector<unsigned char>(message.begin() + 1, message.end()));
+				continue;
+			}
+			if(message[0] != DespawnMessage || message.size() < despawnHeaderSize)
+				continue;
+
+			// Later updates, which may have overtaken the despawn, keep the entity
+			std::uint32_t tick;
+			std::uint16_t count;
+			std::memcpy(&tick, message.data() + 1, sizeof(tick));
+			std::memcpy(&count, message.data() + 5, sizeof(count));
+			count = static_cast<std::uint16_t>(std::min<std::size_t>(count, (message.size() - despawnHeaderSize) / sizeof(std::uint32_t)));
+			for(std::uint16_t i = 0; i < count; ++i)
+			{
+				std::uint32_t entity;
+				std::memcpy(&entity, message.data() + despawnHeaderSize + i * sizeof(entity), sizeof(entity));
+				if(entity >= m_settings.maxEntities)
+					continue;
+				m_despawnTick[entity] = std::max(m_despawnTick[entity], tick);
+				const History& history = m_history[entity];
+				if(history.count > 0 && history.samples[history.count - 1].tick <= tick)
+					forget(entity);
+			}
+		}
+	}
+
+	bool ReplicationClient::receiveMessage(std::vector<unsigned char>& message)
+	{
+		if(m_messages.empty())
+			return false;
+		message.swap(m_messages.front());
+		m_messages.pop_front();
+		return true;
+	}
+
+	void ReplicationClient::update(double now)
+	{
+		NetAddress from;
+		PacketType type;
+		while(m_socket.receive(from, m_packet))
+		{
+			if(from != m_server || !readFraming(m_packet, type))
+				continue;
+			m_bytesReceived += m_packet.size();
+			if(type == ConnectAccept)
+				m_connected = true;
+			else if(type == Data && m_connected)
+			{
+				std::size_t payload = 0;
+				if(!m_connection.readPacket(now, m_packet.data() + framingSize, m_packet.size() - framingSize, payload))
+					continue;
+				readReliable();
+				payload += framingSize;
+				readSnapshot(m_packet.data() + payload, m_packet.size() - payload);
+			}
+		}
+
+		// The render clock runs at the tick rate and is pulled towards interpolationDelay behind the newest
+		// snapshot, jumping there when it is too far off
+		if(m_hasSnapshot)
+		{
+			double const target = static_cast<double>(m_latestTick) - m_settings.interpolationDelay * m_settings.tickRate;
+			m_renderTick += (now - m_lastUpdate) * m_settings.tickRate;
+			double const error = target - m_renderTick;
+			if(std::abs(error) > 4.0)
+				m_renderTick = target;
+			else
+				m_renderTick += error * 0.05;
+		}
+		m_lastUpdate = now;
+
+		if(!m_connected)
+		{
+			m_packet.clear();
+			writeFraming(m_packet, ConnectRequest);
+		}
+		else
+		{
+			m_connection.writePacket(now, m_packet, m_settings.packetSize / 2);
+			writeFraming(m_packet, Data);
+			m_packet.insert(m_packet.end(), reinterpret_cast<const unsigned char*>(&m_view), reinterpret_cast<const unsigned char*>(&m_view) + sizeof(m_view));
+		}
+		m_socket.send(m_server, m_packet.data(), m_packet.size(), now);
+		m_socket.update(now);
+	}
+
+	void ReplicationClient::interpolate()
+	{
+		m_positions.resize(m_knownList.size());
+		m_rotations.resize(m_knownList.size());
+		for(std::size_t i = 0; i < m_knownList.size(); ++i)
+		{
+			const History& history = m_history[m_knownList[i]];
+			int next = 0;
+			while(next < history.count && history.samples[next].tick <= m_renderTick)
+				++next;
+
+			// Before the first sample or after the last one the nearest is held
+			if(next == 0 || next == history.count)
+			{
+				const Sample& held = history.samples[next == 0 ? 0 : history.count - 1];
+				m_positions[i] = held.position;
+				m_rotations[i] = held.rotation;
+				continue;
+			}
+			const Sample& a = history.samples[next - 1];
+			const Sample& b = history.samples[next];
+			float const t = static_cast<float>((m_renderTick - a.tick) / static_cast<double>(b.tick - a.tick));
+			m_positions[i] = glm::mix(a.position, b.position, t);
+			m_rotations[i] = glm::slerp(a.rotation, b.rotation, t);
+		}
+	}
+}
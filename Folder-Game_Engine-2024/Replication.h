@@ -0,0 +1,184 @@
+#pragma once
+
+#include "BitStream.h"
+#include "NetConnection.h"
+#include "SpatialHashGrid.h"
+#include "UdpSocket.h"
+
+#include <glm.hpp>
+#include <gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	// Shared by the server and its clients, both ends must use the same values
+	struct ReplicationSettings
+	{
+		std::uint32_t maxEntities;
+		std::uint32_t maxClients;
+		float tickRate;               // Server ticks and client packets per second
+		glm::vec3 worldMin;           // Positions are quantized over this box
+		glm::vec3 worldMax;
+		int positionBits;             // Per axis
+		int rotationBits;             // Per smallest three component
+		float interestRadius;         // Clients only receive entities this close to their view
+		std::size_t packetSize;       // Bytes per packet, reliable messages take up to half. At least 1100.
+		double interpolationDelay;    // Seconds clients render behind the newest snapshot
+		double timeout;               // Seconds without a packet before a client is dropped
+
+		ReplicationSettings();
+	};
+
+	// Authoritative server: every tick each client gets one packet with the entities around its view that matter
+	// most. An entity's priority grows every tick it is in range and not sent, faster when it is close, and drops to
+	// zero once sent, so far entities still update at a lower rate and the packet size stays fixed whatever the
+	// density. Entities leaving a client's range are despawned on the reliable channel, they stay known to the
+	// client until the despawn fits in its reliable window.
+	class ReplicationServer
+	{
+	public:
+		explicit ReplicationServer(const ReplicationSettings& settings);
+
+		bool open(std::uint16_t port = 0);
+		UdpSocket& socket() { return m_socket; }
+		const ReplicationSettings& settings() const { return m_settings; }
+
+		// Reads client packets, culls and prioritizes entities for every client and sends each one packet. Entity ids
+		// are indices into positions and rotations, count at most maxEntities.
+		void tick(double now, const glm::vec3* positions, const glm::quat* rotations, std::size_t count, JobSystem* jobs = nullptr);
+
+		// Game messages on the reliable channel, the client pops them with receiveMessage
+		bool sendMessage(std::size_t client, const void* data, std::size_t size);
+		void broadcastMessage(const void* data, std::size_t size);
+
+		std::size_t clientCount() const;
+		std::uint32_t serverTick() const { return m_tick; }
+		// Entity states written into packets over all clients
+		std::uint64_t entitiesSent() const { return m_entitiesSent; }
+
+	private:
+		struct Client
+		{
+			bool active;
+			NetAddress address;
+			double lastReceive;
+			NetConnection connection;
+			glm::vec3 view;
+			std::vector<float> priority;
+			std::vector<std::uint32_t> inRangeTick;
+			std::vector<std::uint8_t> known;
+			std::vector<std::uint32_t> knownList;
+			std::vector<std::uint32_t> candidates;
+			std::vector<std::uint32_t> leaving;
+			std::vector<unsigned char> packet;
+			BitWriter bits;
+			std::uint32_t sentCount;
+		};
+
+		void receive(double now);
+		Client* findClient(const NetAddress& address);
+		void sendControl(const NetAddress& to, std::uint8_t type, double now);
+		void updateClient(Client& client, const std::uint32_t* hits, std::size_t hitCount, const glm::vec3* positions, const glm::quat* rotations, double now);
+
+		ReplicationSettings m_settings;
+		int m_idBits;
+		UdpSocket m_socket;
+		std::vector<Client> m_clients;
+		SpatialHashGrid m_grid;
+		SpatialQueryResults m_interest;
+		std::vector<glm::vec3> m_views;
+		std::vector<float> m_radii;
+		std::vector<std::uint32_t> m_activeClients;
+		std::vector<unsigned char> m_receiveBuffer;
+		std::uint32_t m_tick;
+		std::uint64_t m_entitiesSent;
+	};
+
+	// Client of a ReplicationServer. Entities are rendered interpolationDelay behind the newest snapshot, between
+	// the two states received around the render tick, so updates arriving late, out of order or at a lower rate
+	// for far entities still move smoothly.
+	class ReplicationClient
+	{
+	public:
+		explicit ReplicationClient(const ReplicationSettings& settings);
+
+		bool open(const NetAddress& server, std::uint16_t port = 0);
+		UdpSocket& socket() { return m_socket; }
+
+		void setView(const glm::vec3& view) { m_view = view; }
+
+		// Reads server packets, advances the render clock and sends one packet, asking to connect until accepted
+		void update(double now);
+
+		// Samples every known entity at the render tick
+		void interpolate();
+
+		bool connected() const { return m_connected; }
+		// Server tick being rendered, fractional between ticks
+		double renderTick() const { return m_renderTick; }
+		std::uint32_t latestTick() const { return m_latestTick; }
+
+		// Filled by interpolate, in the same order
+		const std::vector<std::uint32_t>& entities() const { return m_knownList; }
+		const std::vector<glm::vec3>& positions() const { return m_positions; }
+		const std::vector<glm::quat>& rotations() const { return m_rotations; }
+
+		bool receiveMessage(std::vector<unsigned char>& message);
+
+		std::uint64_t bytesReceived() const { return m_bytesReceived; }
+		std::uint64_t entityUpdates() const { return m_entityUpdates; }
+
+	private:
+		static const int historySize = 4;
+
+		struct Sample
+		{
+			std::uint32_t tick;
+			glm::vec3 position;
+			glm::quat rotation;
+		};
+
+		// Samples sorted by tick, oldest first
+		struct History
+		{
+			Sample samples[historySize];
+			int count;
+		};
+
+		void readSnapshot(const unsigned char* data, std::size_t size);
+		void readReliable();
+		void addSample(std::uint32_t entity, const Sample& sample);
+		void forget(std::uint32_t entity);
+
+		ReplicationSettings m_settings;
+		int m_idBits;
+		UdpSocket m_socket;
+		NetAddress m_server;
+		NetConnection m_connection;
+		bool m_connected;
+		glm::vec3 m_view;
+
+		std::vector<History> m_history;
+		std::vector<std::uint32_t> m_knownIndex;
+		// Updates older than an entity's despawn are dropped
+		std::vector<std::uint32_t> m_despawnTick;
+		std::vector<std::uint32_t> m_knownList;
+		std::vector<glm::vec3> m_positions;
+		std::vector<glm::quat> m_rotations;
+		std::deque<std::vector<unsigned char> > m_messages;
+
+		std::uint32_t m_latestTick;
+		bool m_hasSnapshot;
+		double m_renderTick;
+		double m_lastUpdate;
+		std::vector<unsigned char> m_packet;
+		std::uint64_t m_bytesReceived;
+		std::uint64_t m_entityUpdates;
+	};
+}
@@ -0,0 +1,217 @@
+#include "Benchmark.h"
+#include "Replication.h"
+
+#include <gtc/constants.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+	std::size_t const entityCount = 20000;
+	std::size_t const clientCount = 64;
+	int const tickCount = 300;
+	int const warmupTicks = 30;
+	int const messageInterval = 10;
+	float const worldExtent = 1000.0f;
+
+	// Entities circle around fixed centers so their state at any time is known exactly
+	struct Mover
+	{
+		glm::vec3 center;
+		float radius;
+		float speed;
+		float phase;
+
+		glm::vec3 position(double time) const
+		{
+			float const angle = phase + speed * static_cast<float>(time);
+			return center + radius * glm::vec3(glm::cos(angle), 0.0f, glm::sin(angle));
+		}
+
+		glm::quat rotation(double time) const
+		{
+			return glm::angleAxis(-(phase + speed * static_cast<float>(time)), glm::vec3(0.0f, 1.0f, 0.0f));
+		}
+	};
+}
+
+ENGINE_BENCHMARK(Replication)
+{
+	engine::ReplicationSettings settings;
+	settings.maxEntities = static_cast<std::uint32_t>(entityCount);
+	settings.maxClients = static_cast<std::uint32_t>(clientCount);
+	engine::LinkConditions const conditions(0.05, 0.01, 0.05f);
+
+	std::mt19937 random(41);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<Mover> movers(entityCount);
+	for(Mover& mover : movers)
+	{
+		mover.center = glm::vec3(unit(random) * worldExtent, 0.0f, unit(random) * worldExtent);
+		mover.radius = 5.0f + 20.0f * glm::abs(unit(random));
+		mover.speed = 0.2f + glm::abs(unit(random));
+		mover.phase = unit(random) * glm::pi<float>();
+	}
+	std::vector<Mover> viewers(clientCount);
+	for(Mover& viewer : viewers)
+	{
+		viewer.center = glm::vec3(unit(random), 0.0f, unit(random)) * (worldExtent - 200.0f);
+		viewer.radius = 50.0f;
+		viewer.speed = 0.3f;
+		viewer.phase = unit(random) * glm::pi<float>();
+	}
+
+	engine::ReplicationServer server(settings);
+	bool opened = server.open();
+	server.socket().setConditions(conditions, 1);
+	std::vector<std::unique_ptr<engine::ReplicationClient> > clients;
+	for(std::size_t i = 0; i < clientCount; ++i)
+	{
+		clients.emplace_back(new engine::ReplicationClient(settings));
+		opened = opened && clients.back()->open(server.socket().address());
+		clients.back()->socket().setConditions(conditions, static_cast<std::uint32_t>(i + 2));
+	}
+	context.report("sockets opened", opened ? 1.0 : 0.0, "ok");
+	if(!opened)
+		return;
+
+	std::vector<glm::vec3> positions(entityCount);
+	std::vector<glm::quat> rotations(entityCount);
+	std::vector<std::uint32_t> nextMessage(clientCount, 0);
+	// Sent once every client is connected
+	std::uint32_t messagesSent = 0;
+	bool messagesInOrder = true;
+	double tickMs = 0.0;
+	double maxTickMs = 0.0;
+	double errorSum = 0.0;
+	std::uint64_t errorCount = 0;
+	std::uint64_t bytesAtWarmup = 0;
+	std::uint64_t clientBytesAtWarmup = 0;
+	std::uint64_t updatesAtWarmup = 0;
+	std::vector<unsigned char> message;
+
+	for(int tick = 0; tick < tickCount; ++tick)
+	{
+		double const now = tick / static_cast<double>(settings.tickRate);
+		for(std::size_t i = 0; i < entityCount; ++i)
+		{
+			positions[i] = movers[i].position(now);
+			rotations[i] = movers[i].rotation(now);
+		}
+		if(tick >= warmupTicks && tick % messageInterval == 0)
+		{
+			server.broadcastMessage(&messagesSent, sizeof(messagesSent));
+			++messagesSent;
+		}
+
+		engine::Stopwatch timer;
+		server.tick(now, positions.data(), rotations.data(), entityCount, &context.jobs());
+		double const elapsed = timer.elapsedMs();
+
+		for(std::size_t i = 0; i < clientCount; ++i)
+		{
+			engine::ReplicationClient& client = *clients[i];
+			client.setView(viewers[i].position(now));
+			client.update(now);
+			while(client.receiveMessage(message))
+			{
+				std::uint32_t value = 0;
+				std::memcpy(&value, message.data(), std::min(message.size(), sizeof(value)));
+				messagesInOrder = messagesInOrder && message.size() == sizeof(value) && value == nextMessage[i];
+				nextMessage[i] = value + 1;
+			}
+		}
+
+		if(tick == warmupTicks)
+		{
+			bytesAtWarmup = server.socket().bytesSent();
+			updatesAtWarmup = server.entitiesSent();
+			clientBytesAtWarmup = 0;
+			for(const auto& client : clients)
+				clientBytesAtWarmup += client->socket().bytesSent();
+		}
+		if(tick <= warmupTicks)
+			continue;
+		tickMs += elapsed;
+		maxTickMs = std::max(maxTickMs, elapsed);
+
+		// Server tick n simulated time (n - 1) / tickRate, compare with the truth well inside the client's range
+		for(std::size_t i = 0; i < clientCount; ++i)
+		{
+			engine::ReplicationClient& client = *clients[i];
+			client.interpolate();
+			double const renderTime = (client.renderTick() - 1.0) / settings.tickRate;
+			glm::vec3 const view = viewers[i].position(now);
+			for(std::size_t k = 0; k < client.entities().size(); ++k)
+			{
+				std::uint32_t const entity = client.entities()[k];
+				glm::vec3 const truth = movers[entity].position(renderTime);
+				if(glm::distance(truth, view) > settings.interestRadius * 0.8f)
+					continue;
+				errorSum += glm::distance(client.positions()[k], truth);
+				++errorCount;
+			}
+		}
+	}
+
+	double const seconds = (tickCount - warmupTicks - 1) / static_cast<double>(settings.tickRate);
+	std::uint64_t clientBytes = 0;
+	std::uint32_t messagesReceived = 0;
+	for(std::size_t i = 0; i < clientCount; ++i)
+	{
+		clientBytes += clients[i]->socket().bytesSent();
+		messagesReceived += nextMessage[i];
+	}
+	context.report("clients connected", static_cast<double>(server.clientCount()), "");
+	context.report("server tick", tickMs / (tickCount - warmupTicks - 1), "ms");
+	context.report("server tick max", maxTickMs, "ms");
+	context.report("down per client", (server.socket().bytesSent() - bytesAtWarmup) * 8.0 / 1000.0 / seconds / clientCount, "kbit/s");
+	context.report("up per client", (clientBytes - clientBytesAtWarmup) * 8.0 / 1000.0 / seconds / clientCount, "kbit/s");
+	context.report("entity updates per client", (server.entitiesSent() - updatesAtWarmup) / seconds / clientCount, "/s");
+	context.report("interpolation error", errorCount > 0 ? errorSum / errorCount * 100.0 : 0.0, "cm");
+	context.report("packets dropped", static_cast<double>(server.socket().packetsDropped()), "");
+	context.report("reliable messages in order", messagesInOrder ? 1.0 : 0.0, "ok");
+	context.report("reliable messages delivered", 100.0 * messagesReceived / (static_cast<double>(messagesSent) * clientCount), "%");
+
+	// Entities that leave while the client's reliable window is full are still despawned once it drains
+	engine::ReplicationSettings small;
+	small.maxEntities = 64;
+	small.maxClients = 1;
+	engine::ReplicationServer blockedServer(small);
+	engine::ReplicationClient blockedClient(small);
+	bool despawned = blockedServer.open() && blockedClient.open(blockedServer.socket().address());
+	std::vector<glm::vec3> nearby(small.maxEntities, glm::vec3(0.0f));
+	std::vector<glm::quat> still(small.maxEntities, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+	int tick = 0;
+	for(; tick < 30; ++tick)
+	{
+		double const now = tick / static_cast<double>(small.tickRate);
+		blockedServer.tick(now, nearby.data(), still.data(), nearby.size());
+		blockedClient.update(now);
+	}
+	blockedClient.interpolate();
+	despawned = despawned && blockedClient.entities().size() == nearby.size();
+
+	// No acks come back while the window is full, the entities leave meanwhile
+	std::uint32_t filler = 0;
+	while(blockedServer.sendMessage(0, &filler, sizeof(filler)) && filler < 1000)
+		++filler;
+	std::vector<glm::vec3> const away(small.maxEntities, glm::vec3(1000.0f, 0.0f, 0.0f));
+	blockedServer.tick(tick / static_cast<double>(small.tickRate), away.data(), still.data(), away.size());
+	for(++tick; tick < 120; ++tick)
+	{
+		double const now = tick / static_cast<double>(small.tickRate);
+		blockedServer.tick(now, away.data(), still.data(), away.size());
+		blockedClient.update(now);
+		while(blockedClient.receiveMessage(message))
+		{
+		}
+	}
+	blockedClient.interpolate();
+	despawned = despawned && blockedClient.entities().empty();
+	context.report("despawned after full reliable window", despawned ? 1.0 : 0.0, "ok");
+}
@@ -0,0 +1,298 @@
+#include "SceneGraph.h"
+#include "JobSystem.h"
+
+#include <simd/matrix.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace engine
+{
+	namespace
+	{
+		std::size_t const levelGrain = 1024;
+
+		glm::mat3x4 affineRows(const glm::mat4& matrix)
+		{
+			return glm::mat3x4(
+				glm::vec4(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]),
+				glm::vec4(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]),
+				glm::vec4(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]));
+		}
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+		void multiply(const glm::mat4& parent, const glm::mat4& local, glm::mat4& world)
+		{
+			glm_vec4 a[4], b[4], result[4];
+			for(glm::length_t i = 0; i < 4; ++i)
+			{
+				a[i] = _mm_loadu_ps(&parent[i][0]);
+				b[i] = _mm_loadu_ps(&local[i][0]);
+			}
+			glm_mat4_mul(a, b, result);
+			for(glm::length_t i = 0; i < 4; ++i)
+				_mm_storeu_ps(&world[i][0], result[i]);
+		}
+
+		// Row i of the product is the sum of the rows of local weighted by row i of parent, plus the parent translation
+		void multiply(const glm::mat3x4& parent, const glm::mat3x4& local, glm::mat3x4& world)
+		{
+			glm_vec4 const translation = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+			glm_vec4 const b0 = _mm_loadu_ps(&local[0][0]);
+			glm_vec4 const b1 = _mm_loadu_ps(&local[1][0]);
+			glm_vec4 const b2 = _mm_loadu_ps(&local[2][0]);
+			for(glm::length_t i = 0; i < 3; ++i)
+			{
+				glm_vec4 const a = _mm_loadu_ps(&parent[i][0]);
+				glm_vec4 const x = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+				glm_vec4 const y = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), b1);
+				glm_vec4 const z = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), b2);
+				glm_vec4 const w = _mm_and_ps(a, translation);
+				_mm_storeu_ps(&world[i][0], _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, w)));
+			}
+		}
+#else
+		void multiply(const glm::mat4& parent, const glm::mat4& local, glm::mat4& world)
+		{
+			world = parent * local;
+		}
+
+		void multiply(const glm::mat3x4& parent, const glm::mat3x4& local, glm::mat3x4& world)
+		{
+			for(glm::length_t i = 0; i < 3; ++i)
+				world[i] = parent[i].x * local[0] + parent[i].y * local[1] + parent[i].z * local[2] + glm::vec4(0.0f, 0.0f, 0.0f, parent[i].w);
+		}
+#endif
+	}
+
+	const std::uint32_t SceneGraph::invalidNode;
+
+	glm::mat4 Transform::matrix() const
+	{
+		glm::mat3 const basis = glm::mat3_cast(rotation);
+		return glm::mat4(
+			glm::vec4(basis[0] * scale.x, 0.0f),
+			glm::vec4(basis[1] * scale.y, 0.0f),
+			glm::vec4(basis[2] * scale.z, 0.0f),
+			glm::vec4(position, 1.0f));
+	}
+
+	SceneGraph::SceneGraph(Storage storage) :
+		m_storage(storage),
+		m_freeNode(invalidNode),
+		m_orderDirty(false),
+		m_anyDirty(false),
+		m_anyChanged(false)
+	{
+	}
+
+	std::uint32_t SceneGraph::create(std::uint32_t parent)
+	{
+		std::uint32_t node = m_freeNode;
+		if(node != invalidNode)
+			m_freeNode = m_parentOf[node];
+		else
+		{
+			node = static_cast<std::uint32_t>(m_parentOf.size());
+			m_parentOf.push_back(invalidNode);
+			m_slotOf.push_back(0);
+			m_alive.push_back(0);
+		}
+
+		// The new node goes to the end until the next update sorts it into its level
+		m_parentOf[node] = parent;
+		m_slotOf[node] = static_cast<std::uint32_t>(m_nodeOfSlot.size());
+		m_alive[node] = 1;
+		m_nodeOfSlot.push_back(node);
+		m_parentSlot.push_back(invalidNode);
+		m_local.push_back(Transform());
+		m_dirty.push_back(1);
+		m_changed.push_back(0);
+		m_orderDirty = true;
+		m_anyDirty = true;
+		return node;
+	}
+
+	void SceneGraph::destroy(std::uint32_t node)
+	{
+		m_alive[node] = 0;
+		m_orderDirty = true;
+	}
+
+	void SceneGraph::setParent(std::uint32_t node, std::uint32_t parent)
+	{
+#ifndef NDEBUG
+		for(std::uint32_t ancestor = parent; ancestor != invalidNode; ancestor = m_parentOf[ancestor])
+			assert(ancestor != node && "setParent would create a cycle");
+#endif
+		m_parentOf[node] = parent;
+		m_dirty[m_slotOf[node]] = 1;
+		m_orderDirty = true;
+		m_anyDirty = true;
+	}
+
+	void SceneGraph::setLocal(std::uint32_t node, const Transform& local)
+	{
+		std::uint32_t const slot = m_slotOf[node];
+		m_local[slot] = local;
+		m_dirty[slot] = 1;
+		m_anyDirty = true;
+	}
+
+	void SceneGraph::rebuildOrder()
+	{
+		// Depth of every node, -1 for destroyed nodes and their descendants
+		std::size_t const slotCount = m_nodeOfSlot.size();
+		std::vector<int> depth(m_parentOf.size(), -2);
+		std::vector<std::uint32_t> chain;
+		int maxDepth = -1;
+		for(std::size_t slot = 0; slot < slotCount; ++slot)
+		{
+			std::uint32_t node = m_nodeOfSlot[slot];
+			while(node != invalidNode && depth[node] == -2)
+			{
+				chain.push_back(node);
+				node = m_parentOf[node];
+			}
+
+			int current = node == invalidNode ? -1 : depth[node];
+			bool dead = node != invalidNode && current < 0;
+			while(!chain.empty())
+			{
+				std::uint32_t const link = chain.back();
+				chain.pop_back();
+				dead = dead || !m_alive[link];
+				current = dead ? -1 : current + 1;
+				depth[link] = current;
+			}
+			maxDepth = std::max(maxDepth, depth[m_nodeOfSlot[slot]]);
+		}
+
+		// Counting sort by depth, keeping the previous order within a level
+		m_levelStart.assign(maxDepth + 2, 0);
+		for(std::size_t slot = 0; slot < slotCount; ++slot)
+		{
+			int const nodeDepth = depth[m_nodeOfSlot[slot]];
+			if(nodeDepth >= 0)
+				++m_levelStart[nodeDepth + 1];
+		}
+		for(std::size_t level = 1; level < m_levelStart.size(); ++level)
+			m_levelStart[level] += m_levelStart[level - 1];
+
+		std::size_t const liveCount = m_levelStart.back();
+		std::vector<std::size_t> cursor(m_levelStart.begin(), m_levelStart.end() - 1);
+		std::vector<std::uint32_t> nodeOfSlot(liveCount);
+		std::vector<Transform> local(liveCount);
+		for(std::size_t slot = 0; slot < slotCount; ++slot)
+		{
+			std::uint32_t const node = m_nodeOfSlot[slot];
+			if(depth[node] < 0)
+			{
+				m_alive[node] = 0;
+				m_parentOf[node] = m_freeNode;
+				m_freeNode = node;
+				continue;
+			}
+
+			std::size_t const target = cursor[depth[node]]++;
+			nodeOfSlot[target] = node;
+			local[target] = m_local[slot];
+		}
+
+		m_nodeOfSlot.swap(nodeOfSlot);
+		m_local.swap(local);
+		for(std::size_t slot = 0; slot < liveCount; ++slot)
+			m_slotOf[m_nodeOfSlot[slot]] = static_cast<std::uint32_t>(slot);
+
+		m_parentSlot.resize(liveCount);
+		for(std::size_t slot = 0; slot < liveCount; ++slot)
+		{
+			std::uint32_t const parent = m_parentOf[m_nodeOfSlot[slot]];
+			m_parentSlot[slot] = parent == invalidNode ? invalidNode : m_slotOf[parent];
+		}
+
+		// Everything is recomputed after a reorder, it's rare enough not to track which nodes moved
+		m_dirty.assign(liveCount, 1);
+		m_changed.assign(liveCount, 0);
+		if(m_storage == Storage::Matrix4)
+			m_worldMatrix.resize(liveCount);
+		else
+			m_worldAffine.resize(liveCount);
+		m_orderDirty = false;
+		m_anyDirty = true;
+	}
+
+	void SceneGraph::updateLevel(std::size_t begin, std::size_t end)
+	{
+		for(std::size_t slot = begin; slot < end; ++slot)
+		{
+			std::uint32_t const parent = m_parentSlot[slot];
+			bool const changed = m_dirty[slot] || (parent != invalidNode && m_changed[parent]);
+			m_changed[slot] = changed ? 1 : 0;
+			m_dirty[slot] = 0;
+			if(!changed)
+				continue;
+
+			glm::mat4 const local = m_local[slot].matrix();
+			if(m_storage == Storage::Matrix4)
+			{
+				if(parent == invalidNode)
+					m_worldMatrix[slot] = local;
+				else
+					multiply(m_worldMatrix[parent], local, m_worldMatrix[slot]);
+			}
+			else
+			{
+				if(parent == invalidNode)
+					m_worldAffine[slot] = affineRows(local);
+				else
+					multiply(m_worldAffine[parent], affineRows(local), m_worldAffine[slot]);
+			}
+		}
+	}
+
+	void SceneGraph::update(JobSystem* jobs)
+	{
+		if(m_orderDirty)
+			rebuildOrder();
+
+		if(!m_anyDirty)
+		{
+			if(m_anyChanged)
+				std::fill(m_changed.begin(), m_changed.end(), 0);
+			m_anyChanged = false;
+			return;
+		}
+
+		// A level only reads the level above it, so the nodes of one level are independent
+		for(std::size_t level = 0; level + 1 < m_levelStart.size(); ++level)
+		{
+			std::size_t const first = m_levelStart[level];
+			parallelFor(jobs, m_levelStart[level + 1] - first, levelGrain, [&](std::size_t begin, std::size_t end)
+			{
+				updateLevel(first + begin, first + end);
+			});
+		}
+		m_anyDirty = false;
+		m_anyChanged = true;
+	}
+
+	glm::mat4 SceneGraph::world(std::uint32_t node) const
+	{
+		std::uint32_t const slot = m_slotOf[node];
+		if(m_storage == Storage::Matrix4)
+			return m_worldMatrix[slot];
+
+		glm::mat3x4 const& rows = m_worldAffine[slot];
+		return glm::mat4(
+			glm::vec4(rows[0][0], rows[1][0], rows[2][0], 0.0f),
+			glm::vec4(rows[0][1], rows[1][1], rows[2][1], 0.0f),
+			glm::vec4(rows[0][2], rows[1][2], rows[2][2], 0.0f),
+			glm::vec4(rows[0][3], rows[1][3], rows[2][3], 1.0f));
+	}
+
+	std::size_t SceneGraph::worldMatrixBytes() const
+	{
+		return m_storage == Storage::Matrix4 ? m_worldMatrix.size() * sizeof(glm::mat4) : m_worldAffine.size() * sizeof(glm::mat3x4);
+	}
+}
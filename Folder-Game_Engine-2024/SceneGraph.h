@@ -0,0 +1,95 @@
+#pragma once
+
+#include <glm.hpp>
+#include <gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	struct Transform
+	{
+		glm::vec3 position;
+		glm::quat rotation;
+		glm::vec3 scale;
+
+		Transform() : position(0.0f), rotation(1.0f, 0.0f, 0.0f, 0.0f), scale(1.0f) {}
+
+		glm::mat4 matrix() const;
+	};
+
+	// Transform hierarchy kept in flat arrays sorted by depth, so every parent is computed before its children and
+	// each level can be processed in parallel. Only nodes whose local transform changed, and their descendants,
+	// recompute their world matrix.
+	//
+	// World matrices are stored either as glm::mat4 or, for affine transforms, as the three first rows in a
+	// glm::mat3x4 which takes 48 bytes instead of 64.
+	//
+	// Node ids are stable. Creating, destroying or reparenting nodes only flags the order, which is rebuilt by the
+	// next update().
+	class SceneGraph
+	{
+	public:
+		enum class Storage
+		{
+			Matrix4,
+			Affine3x4
+		};
+
+		static const std::uint32_t invalidNode = 0xFFFFFFFFu;
+
+		explicit SceneGraph(Storage storage = Storage::Matrix4);
+
+		std::uint32_t create(std::uint32_t parent = invalidNode);
+
+		// Also destroys the descendants of node
+		void destroy(std::uint32_t node);
+
+		// parent may not be node or one of its descendants
+		void setParent(std::uint32_t node, std::uint32_t parent);
+		std::uint32_t parent(std::uint32_t node) const { return m_parentOf[node]; }
+
+		void setLocal(std::uint32_t node, const Transform& local);
+		const Transform& local(std::uint32_t node) const { return m_local[m_slotOf[node]]; }
+
+		void update(JobSystem* jobs = nullptr);
+
+		// Valid after update()
+		glm::mat4 world(std::uint32_t node) const;
+		bool worldChanged(std::uint32_t node) const { return m_changed[m_slotOf[node]] != 0; }
+
+		Storage storage() const { return m_storage; }
+		std::size_t nodeCount() const { return m_nodeOfSlot.size(); }
+		std::size_t levelCount() const { return m_levelStart.empty() ? 0 : m_levelStart.size() - 1; }
+		std::size_t worldMatrixBytes() const;
+
+	private:
+		void rebuildOrder();
+		void updateLevel(std::size_t begin, std::size_t end);
+
+		Storage m_storage;
+
+		// Indexed by node id
+		std::vector<std::uint32_t> m_parentOf;
+		std::vector<std::uint32_t> m_slotOf;
+		std::vector<std::uint8_t> m_alive;
+		std::uint32_t m_freeNode;
+		bool m_orderDirty;
+
+		// Indexed by slot, sorted by depth. Level i is [m_levelStart[i], m_levelStart[i + 1])
+		std::vector<std::uint32_t> m_nodeOfSlot;
+		std::vector<std::uint32_t> m_parentSlot;
+		std::vector<std::size_t> m_levelStart;
+		std::vector<Transform> m_local;
+		std::vector<std::uint8_t> m_dirty;
+		std::vector<std::uint8_t> m_changed;
+		std::vector<glm::mat4> m_worldMatrix;
+		std::vector<glm::mat3x4> m_worldAffine;
+		bool m_anyDirty;
+		bool m_anyChanged;
+	};
+}
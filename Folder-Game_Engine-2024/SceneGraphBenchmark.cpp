@@ -0,0 +1,104 @@
+#include "Benchmark.h"
+#include "SceneGraph.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	std::size_t const nodeCount = 100000;
+	std::size_t const childrenPerNode = 4;
+	int const frameCount = 20;
+
+	// Random transforms on a tree where node i is the child of node (i - 1) / childrenPerNode
+	void buildTree(engine::SceneGraph& graph, std::vector<std::uint32_t>& nodes, std::vector<engine::Transform>& locals)
+	{
+		std::mt19937 random(11);
+		std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+		std::uniform_real_distribution<float> angle(-0.5f, 0.5f);
+		nodes.resize(nodeCount);
+		locals.resize(nodeCount);
+		for(std::size_t i = 0; i < nodeCount; ++i)
+		{
+			nodes[i] = graph.create(i == 0 ? engine::SceneGraph::invalidNode : nodes[(i - 1) / childrenPerNode]);
+			locals[i].position = glm::vec3(offset(random), offset(random), offset(random));
+			locals[i].rotation = glm::quat(glm::vec3(angle(random), angle(random), angle(random)));
+			graph.setLocal(nodes[i], locals[i]);
+		}
+	}
+
+	void benchmarkStorage(engine::BenchmarkContext& context, engine::SceneGraph::Storage storage, const char* name)
+	{
+		engine::SceneGraph graph(storage);
+		std::vector<std::uint32_t> nodes;
+		std::vector<engine::Transform> locals;
+		buildTree(graph, nodes, locals);
+		graph.update();
+
+		std::string const prefix(name);
+		context.report((prefix + " world matrix memory").c_str(), graph.worldMatrixBytes() / 1024.0, "KiB");
+
+		engine::Stopwatch timer;
+		for(int frame = 0; frame < frameCount; ++frame)
+		{
+			graph.setLocal(nodes[0], locals[0]);
+			graph.update();
+		}
+		context.report((prefix + " full update").c_str(), timer.elapsedMs() / frameCount, "ms");
+
+		timer.restart();
+		for(int frame = 0; frame < frameCount; ++frame)
+		{
+			graph.setLocal(nodes[0], locals[0]);
+			graph.update(&context.jobs());
+		}
+		context.report((prefix + " full update parallel").c_str(), timer.elapsedMs() / frameCount, "ms");
+
+		// About 1% of the leaves move every frame
+		std::mt19937 random(13);
+		std::uniform_int_distribution<std::size_t> leaf(nodeCount - nodeCount * 3 / 4, nodeCount - 1);
+		timer.restart();
+		for(int frame = 0; frame < frameCount; ++frame)
+		{
+			for(std::size_t i = 0; i < nodeCount / 100; ++i)
+			{
+				std::size_t const node = leaf(random);
+				graph.setLocal(nodes[node], locals[node]);
+			}
+			graph.update(&context.jobs());
+		}
+		context.report((prefix + " partial update parallel").c_str(), timer.elapsedMs() / frameCount, "ms");
+	}
+}
+
+ENGINE_BENCHMARK(SceneGraph)
+{
+	// What the scene graph replaces: every node walks up to the root multiplying matrices, every frame
+	{
+		engine::SceneGraph graph;
+		std::vector<std::uint32_t> nodes;
+		std::vector<engine::Transform> locals;
+		buildTree(graph, nodes, locals);
+
+		std::vector<glm::mat4> world(nodeCount);
+		engine::Stopwatch timer;
+		for(int frame = 0; frame < 5; ++frame)
+		{
+			for(std::size_t i = 0; i < nodeCount; ++i)
+			{
+				glm::mat4 matrix = locals[i].matrix();
+				for(std::size_t parent = i; parent != 0;)
+				{
+					parent = (parent - 1) / childrenPerNode;
+					matrix = locals[parent].matrix() * matrix;
+				}
+				world[i] = matrix;
+			}
+		}
+		context.report("parent walk", timer.elapsedMs() / 5, "ms");
+	}
+
+	benchmarkStorage(context, engine::SceneGraph::Storage::Matrix4, "mat4");
+	benchmarkStorage(context, engine::SceneGraph::Storage::Affine3x4, "mat3x4");
+}
@@ -0,0 +1,261 @@
+#include "Serialization.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace engine
+{
+	namespace
+	{
+		char const snapshotMagic[4] = { 'S', 'N', 'A', 'P' };
+		std::uint32_t const snapshotVersion = 1;
+
+		// Magic, format version, schema version and chunk count
+		std::size_t const headerSize = 16;
+		// Id, element size and element count
+		std::size_t const chunkHeaderSize = 16;
+		std::size_t const chunkCountOffset = 12;
+
+		// A run of zeros shorter than this costs more to end a literal for than it saves
+		std::size_t const minimumZeroRun = 4;
+
+		template<typename T>
+		void store(unsigned char* target, const T& value)
+		{
+			std::memcpy(target, &value, sizeof(T));
+		}
+
+		template<typename T>
+		T fetch(const unsigned char* source)
+		{
+			T value;
+			std::memcpy(&value, source, sizeof(T));
+			return value;
+		}
+	}
+
+	SnapshotWriter::SnapshotWriter(std::uint32_t schemaVersion) :
+		m_schemaVersion(schemaVersion)
+	{
+		clear();
+	}
+
+	void SnapshotWriter::clear()
+	{
+		m_bytes.resize(headerSize);
+		std::memcpy(m_bytes.data(), snapshotMagic, sizeof(snapshotMagic));
+		store(m_bytes.data() + 4, snapshotVersion);
+		store(m_bytes.data() + 8, m_schemaVersion);
+		store(m_bytes.data() + chunkCountOffset, std::uint32_t(0));
+	}
+
+	void* SnapshotWriter::beginChunk(std::uint32_t id, std::size_t elementSize, std::size_t count)
+	{
+		std::size_t const offset = m_bytes.size();
+		m_bytes.resize(offset + chunkHeaderSize + elementSize * count);
+		store(m_bytes.data() + offset, id);
+		store(m_bytes.data() + offset + 4, static_cast<std::uint32_t>(elementSize));
+		store(m_bytes.data() + offset + 8, static_cast<std::uint64_t>(count));
+		store(m_bytes.data() + chunkCountOffset, fetch<std::uint32_t>(m_bytes.data() + chunkCountOffset) + 1);
+		return m_bytes.data() + offset + chunkHeaderSize;
+	}
+
+	bool SnapshotWriter::save(const std::string& path) const
+	{
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+		if(!file)
+			return false;
+
+		bool const ok = std::fwrite(m_bytes.data(), 1, m_bytes.size(), file) == m_bytes.size();
+		return std::fclose(file) == 0 && ok;
+	}
+
+	bool loadSnapshot(const std::string& path, std::vector<unsigned char>& bytes)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if(!file)
+			return false;
+
+		bool ok = std::fseek(file, 0, SEEK_END) == 0;
+		long const size = ok ? std::ftell(file) : -1;
+		ok = ok && size >= 0 && std::fseek(file, 0, SEEK_SET) == 0;
+
+		std::vector<unsigned char> loaded;
+		if(ok)
+		{
+			loaded.resize(static_cast<std::size_t>(size));
+			ok = size == 0 || std::fread(loaded.data(), 1, loaded.size(), file) == loaded.size();
+		}
+		std::fclose(file);
+		if(!ok)
+			return false;
+
+		bytes.swap(loaded);
+		return true;
+	}
+
+	SnapshotReader::SnapshotReader(const unsigned char* bytes, std::size_t size) :
+		m_bytes(bytes),
+		m_schemaVersion(0),
+		m_valid(false)
+	{
+		if(size < headerSize || !std::equal(snapshotMagic, snapshotMagic + 4, bytes) || fetch<std::uint32_t>(bytes + 4) != snapshotVersion)
+			return;
+		m_schemaVersion = fetch<std::uint32_t>(bytes + 8);
+
+		std::uint32_t const chunkCount = fetch<std::uint32_t>(bytes + chunkCountOffset);
+		std::size_t offset = headerSize;
+		for(std::uint32_t i = 0; i < chunkCount; ++i)
+		{
+			if(size - offset < chunkHeaderSize)
+				return;
+			Chunk chunk;
+			chunk.id = fetch<std::uint32_t>(bytes + offset);
+			chunk.elementSize = fetch<std::uint32_t>(bytes + offset + 4);
+			chunk.count = fetch<std::uint64_t>(bytes + offset + 8);
+			chunk.offset = offset + chunkHeaderSize;
+
+			// Checked by division so a corrupt count can't overflow the product
+			std::size_t const available = size - chunk.offset;
+			if(chunk.elementSize > 0 && chunk.count > available / chunk.elementSize)
+				return;
+			m_chunks.push_back(chunk);
+			offset = chunk.offset + static_cast<std::size_t>(chunk.count * chunk.elementSize);
+		}
+		m_valid = true;
+	}
+
+	SnapshotReader::SnapshotReader(const std::vector<unsigned char>& bytes) :
+		SnapshotReader(bytes.data(), bytes.size())
+	{
+	}
+
+	const SnapshotReader::Chunk* SnapshotReader::find(std::uint32_t id) const
+	{
+		if(!m_valid)
+			return nullptr;
+		for(const Chunk& chunk : m_chunks)
+		{
+			if(chunk.id == id)
+				return &chunk;
+		}
+		return nullptr;
+	}
+
+	void writeVarint(std::vector<unsigned char>& stream, std::uint64_t value)
+	{
+		while(value >= 0x80)
+		{
+			stream.push_back(static_cast<unsigned char>(value | 0x80));
+			value >>= 7;
+		}
+		stream.push_back(static_cast<unsigned char>(value));
+	}
+
+	void writeSigned(std::vector<unsigned char>& stream, std::int64_t value)
+	{
+		writeVarint(stream, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+	}
+
+	std::uint64_t readVarint(const std::vector<unsigned char>& stream, std::uint64_t& offset)
+	{
+		std::uint64_t value = 0;
+		for(int shift = 0; offset < stream.size() && shift < 64; shift += 7)
+		{
+			unsigned char const byte = stream[static_cast<std::size_t>(offset++)];
+			value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+			if((byte & 0x80) == 0)
+				break;
+		}
+		return value;
+	}
+
+	std::int64_t readSigned(const std::vector<unsigned char>& stream, std::uint64_t& offset)
+	{
+		std::uint64_t const value = readVarint(stream, offset);
+		return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+	}
+
+	void encodeDelta(const std::vector<unsigned char>& baseline, const std::vector<unsigned char>& current, std::vector<unsigned char>& delta)
+	{
+		// XOR a word at a time, bytes past the end of the baseline are XORed with zero
+		std::size_t const size = current.size();
+		std::size_t const common = std::min(size, baseline.size());
+		std::vector<unsigned char> difference(size);
+		std::size_t i = 0;
+		for(; i + sizeof(std::uint64_t) <= common; i += sizeof(std::uint64_t))
+			store(difference.data() + i, fetch<std::uint64_t>(current.data() + i) ^ fetch<std::uint64_t>(baseline.data() + i));
+		for(; i < common; ++i)
+			difference[i] = current[i] ^ baseline[i];
+		if(size > common)
+			std::memcpy(difference.data() + common, current.data() + common, size - common);
+
+		// Header, then pairs of a zero run length and a literal run length followed by its bytes
+		delta.clear();
+		writeVarint(delta, baseline.size());
+		writeVarint(delta, size);
+		const unsigned char* bytes = difference.data();
+		i = 0;
+		while(i < size)
+		{
+			std::size_t const zeroStart = i;
+			while(i + sizeof(std::uint64_t) <= size && fetch<std::uint64_t>(bytes + i) == 0)
+				i += sizeof(std::uint64_t);
+			while(i < size && bytes[i] == 0)
+				++i;
+			writeVarint(delta, i - zeroStart);
+
+			// The literal ends at the first run of minimumZeroRun zeros
+			std::size_t const literalStart = i;
+			std::size_t zeros = 0;
+			for(; i < size && zeros < minimumZeroRun; ++i)
+				zeros = bytes[i] == 0 ? zeros + 1 : 0;
+			if(zeros == minimumZeroRun)
+				i -= zeros;
+			writeVarint(delta, i - literalStart);
+			delta.insert(delta.end(), bytes + literalStart, bytes + i);
+		}
+	}
+
+	bool decodeDelta(const std::vector<unsigned char>& baseline, const std::vector<unsigned char>& delta, std::vector<unsigned char>& current)
+	{
+		std::uint64_t offset = 0;
+		std::uint64_t const baselineSize = readVarint(delta, offset);
+		std::uint64_t const size = readVarint(delta, offset);
+		if(baselineSize != baseline.size())
+			return false;
+
+		// The runs must cover exactly size bytes and end with the delta before the output is sized from it
+		std::uint64_t const runs = offset;
+		std::uint64_t covered = 0;
+		while(covered < size)
+		{
+			if(offset >= delta.size())
+				return false;
+			std::uint64_t const zeros = readVarint(delta, offset);
+			std::uint64_t const literal = readVarint(delta, offset);
+			if(zeros > size - covered || literal > size - covered - zeros || literal > delta.size() - offset)
+				return false;
+			covered += zeros + literal;
+			offset += literal;
+		}
+		if(offset != delta.size())
+			return false;
+
+		// Start from the baseline, then flip the bytes that differ
+		std::vector<unsigned char> decoded(static_cast<std::size_t>(size), 0);
+		std::memcpy(decoded.data(), baseline.data(), std::min(decoded.size(), baseline.size()));
+		offset = runs;
+		std::uint64_t i = 0;
+		while(i < size)
+		{
+			i += readVarint(delta, offset);
+			std::uint64_t const literal = readVarint(delta, offset);
+			for(std::uint64_t end = i + literal; i < end; ++i, ++offset)
+				decoded[static_cast<std::size_t>(i)] ^= delta[static_cast<std::size_t>(offset)];
+		}
+
+		current.swap(decoded);
+		return true;
+	}
+}
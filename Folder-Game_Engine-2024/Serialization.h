@@ -0,0 +1,200 @@
+#pragma once
+
+#include <glm.hpp>
+#include <gtc/packing.hpp>
+#include <gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace engine
+{
+	// World state as a list of chunks, each an array of one component: an id, the size of an element, the element
+	// count and the elements' bytes. Trivially copyable arrays, glm types and engine components alike, are copied
+	// with one memcpy, padding included: padding bytes are whatever was in memory and make deltas larger. Other arrays
+	// go through a quantizer which converts every element to a smaller trivially copyable one, see the quantizers
+	// below.
+	//
+	// The header carries the format version and a schema version chosen by the game, readers skip chunks they don't
+	// know and report the ones that are missing, so old snapshots can be migrated. Values are stored in the byte
+	// order of the machine, every platform the engine targets is little endian.
+	class SnapshotWriter
+	{
+	public:
+		explicit SnapshotWriter(std::uint32_t schemaVersion = 0);
+
+		// Starts a new snapshot, keeping the buffer's memory
+		void clear();
+
+		template<typename T>
+		void writeArray(std::uint32_t id, const T* values, std::size_t count)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "writeArray copies the bytes of T");
+			void* data = beginChunk(id, sizeof(T), count);
+			if(count > 0)
+				std::memcpy(data, values, count * sizeof(T));
+		}
+
+		template<typename T>
+		void writeArray(std::uint32_t id, const std::vector<T>& values)
+		{
+			writeArray(id, values.data(), values.size());
+		}
+
+		template<typename Quantizer>
+		void writeQuantized(std::uint32_t id, const typename Quantizer::Value* values, std::size_t count, const Quantizer& quantizer)
+		{
+			typedef typename Quantizer::Encoded Encoded;
+			static_assert(std::is_trivially_copyable<Encoded>::value, "Quantized elements are stored as bytes");
+			unsigned char* data = static_cast<unsigned char*>(beginChunk(id, sizeof(Encoded), count));
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				Encoded const encoded = quantizer.quantize(values[i]);
+				std::memcpy(data + i * sizeof(Encoded), &encoded, sizeof(Encoded));
+			}
+		}
+
+		template<typename Quantizer>
+		void writeQuantized(std::uint32_t id, const std::vector<typename Quantizer::Value>& values, const Quantizer& quantizer)
+		{
+			writeQuantized(id, values.data(), values.size(), quantizer);
+		}
+
+		const std::vector<unsigned char>& bytes() const { return m_bytes; }
+
+		bool save(const std::string& path) const;
+
+	private:
+		// Appends a chunk header and returns where its elementSize * count bytes go
+		void* beginChunk(std::uint32_t id, std::size_t elementSize, std::size_t count);
+
+		std::vector<unsigned char> m_bytes;
+		std::uint32_t m_schemaVersion;
+	};
+
+	// Reads a snapshot written by SnapshotWriter. The bytes are not copied and must outlive the reader.
+	class SnapshotReader
+	{
+	public:
+		SnapshotReader(const unsigned char* bytes, std::size_t size);
+		explicit SnapshotReader(const std::vector<unsigned char>& bytes);
+
+		// False if the bytes are not a snapshot of this format version or are truncated
+		bool valid() const { return m_valid; }
+		std::uint32_t schemaVersion() const { return m_schemaVersion; }
+
+		bool hasChunk(std::uint32_t id) const { return find(id) != nullptr; }
+
+		// False, leaving values untouched, if the chunk is missing or its elements have another size
+		template<typename T>
+		bool readArray(std::uint32_t id, std::vector<T>& values) const
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "readArray copies the bytes of T");
+			const Chunk* chunk = find(id);
+			if(!chunk || chunk->elementSize != sizeof(T))
+				return false;
+			values.resize(static_cast<std::size_t>(chunk->count));
+			if(chunk->count > 0)
+				std::memcpy(values.data(), m_bytes + chunk->offset, values.size() * sizeof(T));
+			return true;
+		}
+
+		template<typename Quantizer>
+		bool readQuantized(std::uint32_t id, std::vector<typename Quantizer::Value>& values, const Quantizer& quantizer) const
+		{
+			typedef typename Quantizer::Encoded Encoded;
+			const Chunk* chunk = find(id);
+			if(!chunk || chunk->elementSize != sizeof(Encoded))
+				return false;
+			values.resize(static_cast<std::size_t>(chunk->count));
+			const unsigned char* data = m_bytes + chunk->offset;
+			for(std::size_t i = 0; i < values.size(); ++i)
+			{
+				Encoded encoded;
+				std::memcpy(&encoded, data + i * sizeof(Encoded), sizeof(Encoded));
+				values[i] = quantizer.dequantize(encoded);
+			}
+			return true;
+		}
+
+	private:
+		struct Chunk
+		{
+			std::uint32_t id;
+			std::uint32_t elementSize;
+			std::uint64_t count;
+			std::size_t offset;
+		};
+
+		const Chunk* find(std::uint32_t id) const;
+
+		const unsigned char* m_bytes;
+		std::vector<Chunk> m_chunks;
+		std::uint32_t m_schemaVersion;
+		bool m_valid;
+	};
+
+	bool loadSnapshot(const std::string& path, std::vector<unsigned char>& bytes);
+
+	// Quantizers convert a Value to a smaller trivially copyable Encoded and back, writeQuantized and readQuantized
+	// accept any type with the same members.
+
+	// glm::packHalf: 11 significant bits, for values of any magnitude that tolerate a relative error of 1/2048
+	struct HalfQuantizer
+	{
+		typedef glm::vec3 Value;
+		typedef glm::u16vec3 Encoded;
+
+		Encoded quantize(const Value& value) const { return glm::packHalf(value); }
+		Value dequantize(const Encoded& encoded) const { return glm::unpackHalf(encoded); }
+	};
+
+	// 16 bits per axis over the box [min, max], values outside are clamped. A 1 km world gets 1.5 cm steps.
+	struct RangeQuantizer
+	{
+		typedef glm::vec3 Value;
+		typedef glm::u16vec3 Encoded;
+
+		glm::vec3 min;
+		glm::vec3 max;
+
+		RangeQuantizer(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
+
+		Encoded quantize(const Value& value) const { return glm::packUnorm<std::uint16_t>((value - min) / (max - min)); }
+		Value dequantize(const Encoded& encoded) const { return min + glm::unpackUnorm<float>(encoded) * (max - min); }
+	};
+
+	// Unit quaternions as 16-bit signed normalized components, renormalized on the way back
+	struct QuaternionQuantizer
+	{
+		typedef glm::quat Value;
+		typedef glm::i16vec4 Encoded;
+
+		Encoded quantize(const Value& value) const { return glm::packSnorm<std::int16_t>(glm::vec4(value.x, value.y, value.z, value.w)); }
+
+		Value dequantize(const Encoded& encoded) const
+		{
+			glm::vec4 const v = glm::unpackSnorm<float>(encoded);
+			return glm::normalize(glm::quat(v.w, v.x, v.y, v.z));
+		}
+	};
+
+	// LEB128 variable length integers: 7 bits per byte, small values take one byte. Signed values are zigzag
+	// encoded so small negative ones are short too. Reads stop at the end of the stream.
+	void writeVarint(std::vector<unsigned char>& stream, std::uint64_t value);
+	void writeSigned(std::vector<unsigned char>& stream, std::int64_t value);
+	std::uint64_t readVarint(const std::vector<unsigned char>& stream, std::uint64_t& offset);
+	std::int64_t readSigned(const std::vector<unsigned char>& stream, std::uint64_t& offset);
+
+	// Delta compression against a baseline both ends already have, such as the last snapshot a client acknowledged.
+	// The current bytes are XORed with the baseline, so unchanged bytes become zero, and runs of zero bytes are
+	// stored as their length. Snapshots with the same chunk layout line up byte for byte; when an array grows or
+	// shrinks the chunks after it shift and compress poorly, append entities or send a full snapshot then.
+	void encodeDelta(const std::vector<unsigned char>& baseline, const std::vector<unsigned char>& current, std::vector<unsigned char>& delta);
+	// False if delta is malformed or was not made against this baseline's size
+	bool decodeDelta(const std::vector<unsigned char>& baseline, const std::vector<unsigned char>& delta, std::vector<unsigned char>& current);
+}
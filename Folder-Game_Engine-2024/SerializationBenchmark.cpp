@@ -0,0 +1,186 @@
+#include "Benchmark.h"
+#include "SceneGraph.h"
+#include "Serialization.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	std::size_t const entityCount = 100000;
+	std::uint32_t const schemaVersion = 3;
+
+	enum ChunkId : std::uint32_t
+	{
+		Transforms,
+		Velocities,
+		Health,
+		Positions,
+		Rotations,
+		Scales
+	};
+
+	struct World
+	{
+		std::vector<engine::Transform> transforms;
+		std::vector<glm::vec3> velocities;
+		std::vector<std::uint32_t> health;
+	};
+
+	// About a tenth of the entities move in a tick, the rest of a typical world sleeps
+	void step(World& world, std::mt19937& random)
+	{
+		std::uniform_int_distribution<std::size_t> pick(0, entityCount - 1);
+		for(std::size_t i = 0; i < entityCount / 10; ++i)
+		{
+			std::size_t const entity = pick(random);
+			world.transforms[entity].position += world.velocities[entity] * (1.0f / 60.0f);
+		}
+	}
+
+	void writeRaw(const World& world, engine::SnapshotWriter& writer)
+	{
+		writer.clear();
+		writer.writeArray(Transforms, world.transforms);
+		writer.writeArray(Velocities, world.velocities);
+		writer.writeArray(Health, world.health);
+	}
+
+	bool readRaw(const std::vector<unsigned char>& bytes, World& world)
+	{
+		engine::SnapshotReader const reader(bytes);
+		return reader.valid() && reader.schemaVersion() == schemaVersion
+			&& reader.readArray(Transforms, world.transforms)
+			&& reader.readArray(Velocities, world.velocities)
+			&& reader.readArray(Health, world.health);
+	}
+
+	// Transforms split into one array per field so each gets its own quantizer
+	void writeQuantized(const World& world, engine::SnapshotWriter& writer, std::vector<glm::vec3>& positions, std::vector<glm::quat>& rotations, std::vector<glm::vec3>& scales)
+	{
+		for(std::size_t i = 0; i < entityCount; ++i)
+		{
+			positions[i] = world.transforms[i].position;
+			rotations[i] = world.transforms[i].rotation;
+			scales[i] = world.transforms[i].scale;
+		}
+		writer.clear();
+		writer.writeQuantized(Positions, positions, engine::RangeQuantizer(glm::vec3(-1024.0f), glm::vec3(1024.0f)));
+		writer.writeQuantized(Rotations, rotations, engine::QuaternionQuantizer());
+		writer.writeQuantized(Scales, scales, engine::HalfQuantizer());
+		writer.writeQuantized(Velocities, world.velocities, engine::HalfQuantizer());
+		writer.writeArray(Health, world.health);
+	}
+
+	bool equal(const World& a, const World& b)
+	{
+		if(a.transforms.size() != b.transforms.size() || a.velocities != b.velocities || a.health != b.health)
+			return false;
+		for(std::size_t i = 0; i < a.transforms.size(); ++i)
+		{
+			if(a.transforms[i].position != b.transforms[i].position || a.transforms[i].rotation != b.transforms[i].rotation || a.transforms[i].scale != b.transforms[i].scale)
+				return false;
+		}
+		return true;
+	}
+}
+
+ENGINE_BENCHMARK(Serialization)
+{
+	std::mt19937 random(40);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	World world;
+	world.transforms.resize(entityCount);
+	world.velocities.resize(entityCount);
+	world.health.resize(entityCount);
+	for(std::size_t i = 0; i < entityCount; ++i)
+	{
+		world.transforms[i].position = glm::vec3(unit(random), unit(random), unit(random)) * 1000.0f;
+		world.transforms[i].rotation = glm::normalize(glm::quat(unit(random), unit(random), unit(random), unit(random)));
+		world.transforms[i].scale = glm::vec3(1.0f + unit(random) * 0.5f);
+		world.velocities[i] = glm::vec3(unit(random), 0.0f, unit(random)) * 5.0f;
+		world.health[i] = 100 + static_cast<std::uint32_t>(i % 50);
+	}
+
+	// Full snapshot to memory, then to a file and back
+	engine::SnapshotWriter writer(schemaVersion);
+	writeRaw(world, writer);
+	engine::Stopwatch timer;
+	writeRaw(world, writer);
+	context.report("write", timer.elapsedMs(), "ms");
+	context.report("size", writer.bytes().size() / 1024.0, "KiB");
+
+	std::string const path = "serialization_benchmark.snapshot";
+	timer.restart();
+	bool const saved = writer.save(path);
+	context.report("save to file", timer.elapsedMs(), "ms");
+
+	std::vector<unsigned char> bytes;
+	World loaded;
+	timer.restart();
+	bool const read = engine::loadSnapshot(path, bytes) && readRaw(bytes, loaded);
+	context.report("load from file", timer.elapsedMs(), "ms");
+	std::remove(path.c_str());
+	context.report("round trip", saved && read && equal(world, loaded) ? 1.0 : 0.0, "ok");
+
+	// Quantized through gtc/packing
+	std::vector<glm::vec3> positions(entityCount);
+	std::vector<glm::quat> rotations(entityCount);
+	std::vector<glm::vec3> scales(entityCount);
+	engine::SnapshotWriter quantized(schemaVersion);
+	timer.restart();
+	writeQuantized(world, quantized, positions, rotations, scales);
+	context.report("write quantized", timer.elapsedMs(), "ms");
+	context.report("quantized size", quantized.bytes().size() / 1024.0, "KiB");
+
+	engine::SnapshotReader const reader(quantized.bytes());
+	std::vector<glm::vec3> readPositions;
+	std::vector<glm::quat> readRotations;
+	timer.restart();
+	bool const dequantized = reader.readQuantized(Positions, readPositions, engine::RangeQuantizer(glm::vec3(-1024.0f), glm::vec3(1024.0f)))
+		&& reader.readQuantized(Rotations, readRotations, engine::QuaternionQuantizer());
+	context.report("read quantized", timer.elapsedMs(), "ms");
+	float positionError = 0.0f;
+	float rotationError = 0.0f;
+	for(std::size_t i = 0; dequantized && i < entityCount; ++i)
+	{
+		positionError = glm::max(positionError, glm::length(readPositions[i] - positions[i]));
+		rotationError = glm::max(rotationError, 1.0f - glm::abs(glm::dot(readRotations[i], rotations[i])));
+	}
+	context.report("max position error", positionError * 1000.0f, "mm");
+	context.report("max rotation error", glm::degrees(2.0f * glm::acos(1.0f - rotationError)), "deg");
+
+	// Delta against the previous tick's snapshot
+	std::vector<unsigned char> const baseline = writer.bytes();
+	step(world, random);
+	writeRaw(world, writer);
+	std::vector<unsigned char> delta;
+	timer.restart();
+	engine::encodeDelta(baseline, writer.bytes(), delta);
+	context.report("encode delta", timer.elapsedMs(), "ms");
+	context.report("delta size", delta.size() / 1024.0, "KiB");
+
+	std::vector<unsigned char> decoded;
+	timer.restart();
+	bool const applied = engine::decodeDelta(baseline, delta, decoded);
+	context.report("decode delta", timer.elapsedMs(), "ms");
+	context.report("delta matches", applied && decoded == writer.bytes() ? 1.0 : 0.0, "ok");
+
+	// Cut short, or with a size its runs don't cover, a delta is refused before the output is sized
+	std::vector<unsigned char> corrupt(delta.begin(), delta.begin() + delta.size() / 2);
+	bool refused = !engine::decodeDelta(baseline, corrupt, decoded);
+	corrupt.clear();
+	engine::writeVarint(corrupt, baseline.size());
+	engine::writeVarint(corrupt, 1ull << 40);
+	engine::writeVarint(corrupt, 0);
+	engine::writeVarint(corrupt, 1);
+	corrupt.push_back(1);
+	refused = refused && !engine::decodeDelta(baseline, corrupt, decoded) && decoded == writer.bytes();
+	context.report("corrupt delta refused", refused ? 1.0 : 0.0, "ok");
+
+	std::vector<unsigned char> const quantizedBaseline = quantized.bytes();
+	writeQuantized(world, quantized, positions, rotations, scales);
+	engine::encodeDelta(quantizedBaseline, quantized.bytes(), delta);
+	context.report("quantized delta size", delta.size() / 1024.0, "KiB");
+}
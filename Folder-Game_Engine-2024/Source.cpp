@@ -0,0 +1,175 @@
+#include "Benchmark.h"
+#include "GlRenderBackend.h"
+#include "Input.h"
+#include "JobSystem.h"
+#include "MeshAssets.h"
+#include "RenderThread.h"
+#include "Replay.h"
+#include "Stats.h"
+
+#include <GLFW/glfw3.h>
+#include <gtc/matrix_transform.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	enum Action : std::uint32_t
+	{
+		Quit
+	};
+
+	// The main thread owns the window and polls its events, the simulation runs on its own thread and the
+	// render thread owns the GL context. Each tick publishes frame.ms and jobs.queued next to the backend's render.*
+	// stats and ends the stats frame, the percentiles over the last frames are printed on exit.
+	int runWindow(const char* recordPath)
+	{
+		if(!glfwInit())
+			return 1;
+
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		GLFWwindow* window = glfwCreateWindow(1280, 720, "Folder-Game_Engine-2024", nullptr, nullptr);
+		if(!window)
+		{
+			glfwTerminate();
+			return 1;
+		}
+
+		engine::InputQueue input;
+		input.attach(window);
+		engine::StatsRegistry stats;
+		engine::JobSystem jobs;
+		engine::GlRenderBackend backend(window, &jobs, &stats);
+		engine::Replay replay;
+		std::atomic<bool> quit(false);
+		{
+			engine::RenderThread renderThread(backend, 2);
+			std::thread simulation([&]()
+			{
+				engine::ActionMap actions;
+				actions.bindButton(Quit, GLFW_KEY_ESCAPE);
+				engine::StatGauge const frameMs = stats.gauge("frame.ms");
+				engine::StatGauge const queuedJobs = stats.gauge("jobs.queued");
+				engine::Stopwatch frameTimer;
+				for(std::uint64_t tick = 0; !quit.load(); ++tick)
+				{
+					if(recordPath)
+					{
+						replay.beginTick(input.now());
+						if(tick == 0)
+							replay.seedRandom(static_cast<std::uint32_t>(input.now()));
+						engine::consumeInput(input, actions, replay);
+					}
+					else
+						engine::consumeInput(input, actions, nullptr, tick);
+					if(actions.pressed(Quit))
+						glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+					engine::FramePacket& packet = renderThread.acquire();
+					packet.projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+					renderThread.publish();
+
+					frameMs.set(frameTimer.elapsedMs());
+					frameTimer.restart();
+					queuedJobs.set(static_cast<double>(jobs.queuedJobs()));
+					stats.endFrame();
+				}
+			});
+
+			while(!glfwWindowShouldClose(window))
+				glfwWaitEventsTimeout(0.005);
+
+			quit.store(true);
+			simulation.join();
+			renderThread.stop();
+		}
+
+		std::vector<engine::StatSummary> summaries;
+		stats.summarize(summaries);
+		for(const engine::StatSummary& summary : summaries)
+			std::printf("%-24s p50 %10.3f  p95 %10.3f  p99 %10.3f  max %10.3f\n", summary.name, summary.p50, summary.p95, summary.p99, summary.max);
+
+		if(recordPath && !replay.save(recordPath))
+			std::printf("Failed to write replay %s\n", recordPath);
+
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return 0;
+	}
+
+	// Plays a recorded session without a window, as fast as the simulation goes
+	int runReplay(const char* path)
+	{
+		engine::Replay replay;
+		if(!replay.load(path))
+		{
+			std::printf("Failed to read replay %s\n", path);
+			return 1;
+		}
+
+		engine::ActionMap actions;
+		actions.bindButton(Quit, GLFW_KEY_ESCAPE);
+		engine::ReplayPlayer player(replay);
+		engine::Stopwatch timer;
+		std::uint64_t events = 0;
+		while(player.playTick(actions))
+			events += player.events().size();
+		double const elapsed = timer.elapsedMs();
+
+		std::printf("%llu ticks, %llu events, %zu bytes, %.3f ms (%.0f ticks/s)\n", static_cast<unsigned long long>(replay.tickCount()),
+			static_cast<unsigned long long>(events), replay.encodedBytes(), elapsed, elapsed > 0.0 ? replay.tickCount() * 1000.0 / elapsed : 0.0);
+		return 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if(argc >= 2 && std::strcmp(argv[1], "--bench") == 0)
+	{
+		engine::JobSystem jobs;
+		std::string const filter = argc >= 3 ? argv[2] : "";
+		if(engine::runBenchmarks(filter, jobs) == 0)
+			std::printf("No benchmark matches \"%s\"\n", filter.c_str());
+		return 0;
+	}
+
+	if(argc >= 3 && std::strcmp(argv[1], "--optimize-meshes") == 0)
+	{
+		engine::JobSystem jobs;
+		std::vector<engine::MeshOptimizeResult> const results = engine::optimizeMeshDirectory(argv[2], &jobs);
+		int failed = 0;
+		for(const engine::MeshOptimizeResult& result : results)
+		{
+			if(!result.ok)
+			{
+				std::printf("%s: failed\n", result.source.c_str());
+				++failed;
+				continue;
+			}
+			std::printf("%s: %zu triangles, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, overfetch %.2f -> %.2f\n", result.output.c_str(), result.triangles,
+				result.before.acmr, result.after.acmr, result.before.atvr, result.after.atvr, result.fetchBefore, result.fetchAfter);
+		}
+		std::printf("%zu meshes, %d failed\n", results.size(), failed);
+		return failed == 0 ? 0 : 1;
+	}
+
+	if(argc >= 3 && std::strcmp(argv[1], "--record") == 0)
+		return runWindow(argv[2]);
+
+	if(argc >= 3 && std::strcmp(argv[1], "--replay") == 0)
+		return runReplay(argv[2]);
+
+	if(argc >= 2)
+	{
+		std::printf("Usage: %s [--record session.replay | --replay session.replay | --bench [filter] | --optimize-meshes directory]\n", argv[0]);
+		return 1;
+	}
+	return runWindow(nullptr);
+}
@@ -0,0 +1,309 @@
+#include "SpatialHashGrid.h"
+#include "JobSystem.h"
+
+#include <gtc/bitfield.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+namespace engine
+{
+	namespace
+	{
+		std::uint32_t const emptySlot = 0xFFFFFFFFu;
+		std::size_t const pointGrain = 4096;
+		std::size_t const queryGrain = 64;
+
+		std::uint64_t mortonKey(const glm::ivec3& cell)
+		{
+			// Bias into 21 unsigned bits per axis so the interleaved key fits in 63 bits
+			std::uint32_t const bias = 1u << 20;
+			std::uint32_t const mask = (1u << 21) - 1;
+			return glm::bitfieldInterleave(
+				(static_cast<std::uint32_t>(cell.x) + bias) & mask,
+				(static_cast<std::uint32_t>(cell.y) + bias) & mask,
+				(static_cast<std::uint32_t>(cell.z) + bias) & mask);
+		}
+
+		std::uint64_t hashKey(std::uint64_t key)
+		{
+			std::uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+			return hash ^ (hash >> 32);
+		}
+	}
+
+	SpatialHashGrid::SpatialHashGrid(float cellSize) :
+		m_cellSize(cellSize),
+		m_inverseCellSize(1.0f / cellSize),
+		m_minCell(0),
+		m_maxCell(-1),
+		m_tableMask(0)
+	{
+	}
+
+	glm::ivec3 SpatialHashGrid::cellOf(const glm::vec3& position) const
+	{
+		return glm::ivec3(glm::floor(position * m_inverseCellSize));
+	}
+
+	void SpatialHashGrid::build(const glm::vec3* positions, std::size_t count, JobSystem* jobs)
+	{
+		m_entries.resize(count);
+		parallelFor(jobs, count, pointGrain, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t i = begin; i < end; ++i)
+			{
+				m_entries[i].key = mortonKey(cellOf(positions[i]));
+				m_entries[i].index = static_cast<std::uint32_t>(i);
+			}
+		});
+
+		// Ties are broken by index so the layout doesn't depend on the number of workers
+		parallelSort(jobs, m_entries, [](const Entry& a, const Entry& b)
+		{
+			return a.key < b.key || (a.key == b.key && a.index < b.index);
+		});
+
+		m_sortedPositions.resize(count);
+		m_sortedIndices.resize(count);
+		parallelFor(jobs, count, pointGrain, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t i = begin; i < end; ++i)
+			{
+				m_sortedIndices[i] = m_entries[i].index;
+				m_sortedPositions[i] = positions[m_entries[i].index];
+			}
+		});
+
+		m_cellKeys.clear();
+		m_cellCoords.clear();
+		m_cellStart.clear();
+		m_minCell = glm::ivec3(std::numeric_limits<int>::max());
+		m_maxCell = glm::ivec3(std::numeric_limits<int>::min());
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			if(i > 0 && m_entries[i].key == m_entries[i - 1].key)
+				continue;
+
+			glm::ivec3 const cell = cellOf(m_sortedPositions[i]);
+			m_cellKeys.push_back(m_entries[i].key);
+			m_cellCoords.push_back(cell);
+			m_cellStart.push_back(static_cast<std::uint32_t>(i));
+			m_minCell = glm::min(m_minCell, cell);
+			m_maxCell = glm::max(m_maxCell, cell);
+		}
+		m_cellStart.push_back(static_cast<std::uint32_t>(count));
+		if(count == 0)
+		{
+			m_minCell = glm::ivec3(0);
+			m_maxCell = glm::ivec3(-1);
+		}
+
+		// Load factor of at most one half keeps the probe sequences short
+		std::size_t capacity = 16;
+		while(capacity < m_cellKeys.size() * 2)
+			capacity *= 2;
+		m_table.assign(capacity, emptySlot);
+		m_tableMask = capacity - 1;
+		for(std::size_t cell = 0; cell < m_cellKeys.size(); ++cell)
+		{
+			std::uint64_t slot = hashKey(m_cellKeys[cell]) & m_tableMask;
+			while(m_table[slot] != emptySlot)
+				slot = (slot + 1) & m_tableMask;
+			m_table[slot] = static_cast<std::uint32_t>(cell);
+		}
+	}
+
+	std::uint32_t SpatialHashGrid::findCell(const glm::ivec3& cell) const
+	{
+		std::uint64_t const key = mortonKey(cell);
+		for(std::uint64_t slot = hashKey(key) & m_tableMask;; slot = (slot + 1) & m_tableMask)
+		{
+			std::uint32_t const found = m_table[slot];
+			if(found == emptySlot || m_cellKeys[found] == key)
+				return found;
+		}
+	}
+
+	std::size_t SpatialHashGrid::queryRadius(const glm::vec3& center, float radius, std::vector<std::uint32_t>& out) const
+	{
+		glm::ivec3 const lo = glm::max(cellOf(center - radius), m_minCell);
+		glm::ivec3 const hi = glm::min(cellOf(center + radius), m_maxCell);
+		if(glm::any(glm::greaterThan(lo, hi)))
+			return 0;
+
+		std::size_t const before = out.size();
+		float const radius2 = radius * radius;
+		auto scanCell = [&](std::uint32_t cell)
+		{
+			for(std::uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+			{
+				glm::vec3 const delta = m_sortedPositions[i] - center;
+				if(glm::dot(delta, delta) <= radius2)
+					out.push_back(m_sortedIndices[i]);
+			}
+		};
+
+		glm::dvec3 const extent = glm::dvec3(hi - lo) + 1.0;
+		if(extent.x * extent.y * extent.z > static_cast<double>(m_cellKeys.size()))
+		{
+			// Large radius: walking the occupied cells is cheaper than probing mostly empty ones
+			for(std::size_t cell = 0; cell < m_cellCoords.size(); ++cell)
+			{
+				glm::ivec3 const coord = m_cellCoords[cell];
+				if(glm::all(glm::greaterThanEqual(coord, lo)) && glm::all(glm::lessThanEqual(coord, hi)))
+					scanCell(static_cast<std::uint32_t>(cell));
+			}
+		}
+		else
+		{
+			for(int z = lo.z; z <= hi.z; ++z)
+			for(int y = lo.y; y <= hi.y; ++y)
+			for(int x = lo.x; x <= hi.x; ++x)
+			{
+				std::uint32_t const cell = findCell(glm::ivec3(x, y, z));
+				if(cell != emptySlot)
+					scanCell(cell);
+			}
+		}
+		return out.size() - before;
+	}
+
+	namespace
+	{
+		template<typename Candidate>
+		bool closer(const Candidate& a, const Candidate& b)
+		{
+			return a.distance2 < b.distance2 || (a.distance2 == b.distance2 && a.index < b.index);
+		}
+	}
+
+	void SpatialHashGrid::gatherCell(std::uint32_t cell, const glm::vec3& center, std::size_t k, std::vector<Candidate>& heap) const
+	{
+		for(std::uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+		{
+			glm::vec3 const delta = m_sortedPositions[i] - center;
+			Candidate const candidate = { glm::dot(delta, delta), m_sortedIndices[i] };
+			if(heap.size() < k)
+			{
+				heap.push_back(candidate);
+				std::push_heap(heap.begin(), heap.end(), closer<Candidate>);
+			}
+			else if(closer(candidate, heap.front()))
+			{
+				std::pop_heap(heap.begin(), heap.end(), closer<Candidate>);
+				heap.back() = candidate;
+				std::push_heap(heap.begin(), heap.end(), closer<Candidate>);
+			}
+		}
+	}
+
+	std::size_t SpatialHashGrid::queryNearest(const glm::vec3& center, std::size_t k, std::vector<std::uint32_t>& out) const
+	{
+		if(k == 0 || m_cellKeys.empty())
+			return 0;
+
+		std::vector<Candidate> heap;
+		heap.reserve(std::min(k, pointCount()));
+
+		glm::ivec3 const origin = cellOf(center);
+		glm::vec3 const cellMin = glm::vec3(origin) * m_cellSize;
+		glm::vec3 const faceDistance = glm::min(center - cellMin, cellMin + m_cellSize - center);
+		float const innerDistance = glm::max(0.0f, glm::min(faceDistance.x, glm::min(faceDistance.y, faceDistance.z)));
+
+		// Walk shells of cells at growing Chebyshev distance until no unvisited cell can hold a closer point
+		for(int shell = 0;; ++shell)
+		{
+			double const side = 2.0 * shell + 1.0;
+			if(side * side * side > 8.0 * static_cast<double>(m_cellKeys.size()))
+			{
+				// The shells have become mostly empty, finish with the occupied cells directly
+				heap.clear();
+				for(std::size_t cell = 0; cell < m_cellKeys.size(); ++cell)
+					gatherCell(static_cast<std::uint32_t>(cell), center, k, heap);
+				break;
+			}
+
+			int const zLo = std::max(origin.z - shell, m_minCell.z), zHi = std::min(origin.z + shell, m_maxCell.z);
+			int const yLo = std::max(origin.y - shell, m_minCell.y), yHi = std::min(origin.y + shell, m_maxCell.y);
+			int const xLo = std::max(origin.x - shell, m_minCell.x), xHi = std::min(origin.x + shell, m_maxCell.x);
+			for(int z = zLo; z <= zHi; ++z)
+			for(int y = yLo; y <= yHi; ++y)
+			{
+				bool const face = std::abs(z - origin.z) == shell || std::abs(y - origin.y) == shell;
+				int const step = face ? 1 : 2 * shell;
+				for(int x = face ? xLo : origin.x - shell; x <= xHi; x += step)
+				{
+					if(x < xLo)
+						continue;
+					std::uint32_t const cell = findCell(glm::ivec3(x, y, z));
+					if(cell != emptySlot)
+						gatherCell(cell, center, k, heap);
+				}
+			}
+
+			if(heap.size() == k)
+			{
+				float const reach = shell * m_cellSize + innerDistance;
+				if(reach * reach >= heap.front().distance2)
+					break;
+			}
+
+			glm::ivec3 const covered = glm::ivec3(shell);
+			if(glm::all(glm::lessThanEqual(origin - covered, m_minCell)) && glm::all(glm::greaterThanEqual(origin + covered, m_maxCell)))
+				break;
+		}
+
+		std::sort_heap(heap.begin(), heap.end(), closer<Candidate>);
+		for(const Candidate& candidate : heap)
+			out.push_back(candidate.index);
+		return heap.size();
+	}
+
+	template<typename QueryFunction>
+	void SpatialHashGrid::runBatch(std::size_t count, SpatialQueryResults& results, JobSystem* jobs, QueryFunction query) const
+	{
+		// Each chunk of queries writes to its own buffers which are then stitched together in order
+		std::size_t const chunkCount = (count + queryGrain - 1) / queryGrain;
+		std::vector<std::vector<std::uint32_t> > chunkHits(chunkCount);
+		std::vector<std::uint32_t> counts(count);
+		parallelFor(jobs, chunkCount, 1, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t chunk = begin; chunk < end; ++chunk)
+			{
+				std::size_t const last = std::min(count, (chunk + 1) * queryGrain);
+				for(std::size_t q = chunk * queryGrain; q < last; ++q)
+					counts[q] = static_cast<std::uint32_t>(query(q, chunkHits[chunk]));
+			}
+		});
+
+		results.offsets.resize(count + 1);
+		results.offsets[0] = 0;
+		for(std::size_t q = 0; q < count; ++q)
+			results.offsets[q + 1] = results.offsets[q] + counts[q];
+
+		results.indices.resize(results.offsets[count]);
+		parallelFor(jobs, chunkCount, 1, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t chunk = begin; chunk < end; ++chunk)
+				std::copy(chunkHits[chunk].begin(), chunkHits[chunk].end(), results.indices.begin() + results.offsets[chunk * queryGrain]);
+		});
+	}
+
+	void SpatialHashGrid::queryRadiusBatch(const glm::vec3* centers, const float* radii, std::size_t count, SpatialQueryResults& results, JobSystem* jobs) const
+	{
+		runBatch(count, results, jobs, [&](std::size_t q, std::vector<std::uint32_t>& out)
+		{
+			return queryRadius(centers[q], radii[q], out);
+		});
+	}
+
+	void SpatialHashGrid::queryNearestBatch(const glm::vec3* centers, std::size_t count, std::size_t k, SpatialQueryResults& results, JobSystem* jobs) const
+	{
+		runBatch(count, results, jobs, [&](std::size_t q, std::vector<std::uint32_t>& out)
+		{
+			return queryNearest(centers[q], k, out);
+		});
+	}
+}
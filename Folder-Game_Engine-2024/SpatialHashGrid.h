@@ -0,0 +1,91 @@
+#pragma once
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	// Results of a batched query in compressed rows: the hits of query i are
+	// indices[offsets[i]] to indices[offsets[i + 1]].
+	struct SpatialQueryResults
+	{
+		std::vector<std::uint32_t> offsets;
+		std::vector<std::uint32_t> indices;
+
+		std::size_t queryCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+		std::size_t hitCount(std::size_t query) const { return offsets[query + 1] - offsets[query]; }
+		const std::uint32_t* hits(std::size_t query) const { return indices.data() + offsets[query]; }
+	};
+
+	// Uniform grid over points, rebuilt from scratch every frame.
+	// Points are sorted by the Morton code of their cell so that neighboring cells are close in memory,
+	// and occupied cells are found through an open addressing table keyed by the same code.
+	// Cell coordinates are limited to +/-2^20 cells around the origin.
+	class SpatialHashGrid
+	{
+	public:
+		explicit SpatialHashGrid(float cellSize);
+
+		float cellSize() const { return m_cellSize; }
+		std::size_t pointCount() const { return m_sortedIndices.size(); }
+		std::size_t cellCount() const { return m_cellKeys.size(); }
+
+		// Points are copied, the indices returned by queries refer to the positions array.
+		void build(const glm::vec3* positions, std::size_t count, JobSystem* jobs = nullptr);
+
+		// Appends the indices of the points within radius of center, returns how many were appended.
+		std::size_t queryRadius(const glm::vec3& center, float radius, std::vector<std::uint32_t>& out) const;
+
+		// Appends the indices of the k points closest to center, nearest first.
+		std::size_t queryNearest(const glm::vec3& center, std::size_t k, std::vector<std::uint32_t>& out) const;
+
+		void queryRadiusBatch(const glm::vec3* centers, const float* radii, std::size_t count, SpatialQueryResults& results, JobSystem* jobs = nullptr) const;
+		void queryNearestBatch(const glm::vec3* centers, std::size_t count, std::size_t k, SpatialQueryResults& results, JobSystem* jobs = nullptr) const;
+
+		glm::ivec3 cellOf(const glm::vec3& position) const;
+
+	private:
+		struct Candidate
+		{
+			float distance2;
+			std::uint32_t index;
+		};
+
+		struct Entry
+		{
+			std::uint64_t key;
+			std::uint32_t index;
+		};
+
+		std::uint32_t findCell(const glm::ivec3& cell) const;
+		void gatherCell(std::uint32_t cell, const glm::vec3& center, std::size_t k, std::vector<Candidate>& heap) const;
+
+		template<typename QueryFunction>
+		void runBatch(std::size_t count, SpatialQueryResults& results, JobSystem* jobs, QueryFunction query) const;
+
+		float m_cellSize;
+		float m_inverseCellSize;
+
+		// Sorted by cell Morton code
+		std::vector<glm::vec3> m_sortedPositions;
+		std::vector<std::uint32_t> m_sortedIndices;
+
+		// One entry per occupied cell, points of cell i are [m_cellStart[i], m_cellStart[i + 1])
+		std::vector<std::uint64_t> m_cellKeys;
+		std::vector<glm::ivec3> m_cellCoords;
+		std::vector<std::uint32_t> m_cellStart;
+		glm::ivec3 m_minCell;
+		glm::ivec3 m_maxCell;
+
+		std::vector<std::uint32_t> m_table;
+		std::uint64_t m_tableMask;
+
+		// Build scratch, kept to avoid reallocating every frame
+		std::vector<Entry> m_entries;
+	};
+}
@@ -0,0 +1,135 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "SpatialHashGrid.h"
+
+#include <gtx/hash.hpp>
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	std::size_t const pointCount = 100000;
+	std::size_t const queryCount = 20000;
+	float const worldSize = 500.0f;
+	float const cellSize = 4.0f;
+	float const queryRadius = 6.0f;
+	std::size_t const nearestCount = 8;
+	int const repeats = 5;
+
+	std::vector<glm::vec3> randomPoints(std::size_t count, unsigned seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> coordinate(-0.5f * worldSize, 0.5f * worldSize);
+		std::vector<glm::vec3> points(count);
+		for(glm::vec3& point : points)
+			point = glm::vec3(coordinate(random), coordinate(random) * 0.1f, coordinate(random));
+		return points;
+	}
+
+	// The straightforward grid the Morton grid replaces, kept as the reference point
+	class MapGrid
+	{
+	public:
+		void build(const std::vector<glm::vec3>& points)
+		{
+			m_positions = points;
+			m_cells.clear();
+			for(std::size_t i = 0; i < points.size(); ++i)
+				m_cells[cellOf(points[i])].push_back(static_cast<std::uint32_t>(i));
+		}
+
+		std::size_t queryRadius(const glm::vec3& center, float radius, std::vector<std::uint32_t>& out) const
+		{
+			std::size_t const before = out.size();
+			glm::ivec3 const lo = cellOf(center - radius);
+			glm::ivec3 const hi = cellOf(center + radius);
+			for(int z = lo.z; z <= hi.z; ++z)
+			for(int y = lo.y; y <= hi.y; ++y)
+			for(int x = lo.x; x <= hi.x; ++x)
+			{
+				auto const found = m_cells.find(glm::ivec3(x, y, z));
+				if(found == m_cells.end())
+					continue;
+				for(std::uint32_t index : found->second)
+				{
+					glm::vec3 const delta = m_positions[index] - center;
+					if(glm::dot(delta, delta) <= radius * radius)
+						out.push_back(index);
+				}
+			}
+			return out.size() - before;
+		}
+
+	private:
+		static glm::ivec3 cellOf(const glm::vec3& position)
+		{
+			return glm::ivec3(glm::floor(position / cellSize));
+		}
+
+		std::vector<glm::vec3> m_positions;
+		std::unordered_map<glm::ivec3, std::vector<std::uint32_t> > m_cells;
+	};
+}
+
+ENGINE_BENCHMARK(SpatialHashGrid)
+{
+	std::vector<glm::vec3> const points = randomPoints(pointCount, 1);
+	std::vector<glm::vec3> const centers = randomPoints(queryCount, 2);
+	std::vector<float> const radii(queryCount, queryRadius);
+
+	MapGrid mapGrid;
+	engine::SpatialHashGrid grid(cellSize);
+	std::vector<std::uint32_t> hits;
+	engine::SpatialQueryResults results;
+
+	engine::Stopwatch timer;
+	for(int i = 0; i < repeats; ++i)
+		mapGrid.build(points);
+	context.report("unordered_map build", timer.elapsedMs() / repeats, "ms");
+
+	timer.restart();
+	for(int i = 0; i < repeats; ++i)
+		grid.build(points.data(), points.size());
+	context.report("morton build", timer.elapsedMs() / repeats, "ms");
+
+	timer.restart();
+	for(int i = 0; i < repeats; ++i)
+		grid.build(points.data(), points.size(), &context.jobs());
+	context.report("morton build parallel", timer.elapsedMs() / repeats, "ms");
+
+	timer.restart();
+	std::size_t mapHits = 0;
+	for(const glm::vec3& center : centers)
+	{
+		hits.clear();
+		mapHits += mapGrid.queryRadius(center, queryRadius, hits);
+	}
+	context.report("unordered_map radius queries", timer.elapsedMs(), "ms");
+
+	timer.restart();
+	std::size_t gridHits = 0;
+	for(const glm::vec3& center : centers)
+	{
+		hits.clear();
+		gridHits += grid.queryRadius(center, queryRadius, hits);
+	}
+	context.report("morton radius queries", timer.elapsedMs(), "ms");
+
+	timer.restart();
+	grid.queryRadiusBatch(centers.data(), radii.data(), centers.size(), results, &context.jobs());
+	context.report("morton radius batch parallel", timer.elapsedMs(), "ms");
+
+	timer.restart();
+	grid.queryNearestBatch(centers.data(), centers.size(), nearestCount, results);
+	context.report("morton nearest batch", timer.elapsedMs(), "ms");
+
+	timer.restart();
+	grid.queryNearestBatch(centers.data(), centers.size(), nearestCount, results, &context.jobs());
+	context.report("morton nearest batch parallel", timer.elapsedMs(), "ms");
+
+	context.report("hits per radius query", static_cast<double>(gridHits) / queryCount, "");
+	if(mapHits != gridHits)
+		context.report("MISMATCH unordered_map hits", static_cast<double>(mapHits), "");
+}
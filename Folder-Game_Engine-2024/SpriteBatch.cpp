@@ -0,0 +1,129 @@
+#include "SpriteBatch.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace engine
+{
+	namespace
+	{
+		std::size_t const prefetchDistance = 16;
+
+		std::uint32_t unorm16(float value)
+		{
+			return static_cast<std::uint32_t>(glm::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+		}
+	}
+
+	SpriteBatch::SpriteBatch(std::size_t maxSprites) :
+		m_maxSprites(maxSprites)
+	{
+		m_sprites.reserve(maxSprites);
+	}
+
+	void SpriteBatch::clear()
+	{
+		m_sprites.clear();
+		m_ranges.clear();
+		// The order refers to the sprites just dropped, nothing is written until the next sort
+		m_order.clear();
+		m_keys.clear();
+	}
+
+	void SpriteBatch::sort()
+	{
+		std::size_t const count = m_sprites.size();
+		m_keys.resize(count);
+		m_order.resize(count);
+		m_scratchKeys.resize(count);
+		m_scratchOrder.resize(count);
+
+		// Biased so negative layers sort first
+		std::size_t histograms[4][256] = {};
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			std::uint32_t const key = static_cast<std::uint32_t>(m_sprites[i].layer + 32768) << 16 | m_sprites[i].page;
+			m_keys[i] = key;
+			m_order[i] = static_cast<std::uint32_t>(i);
+			for(int pass = 0; pass < 4; ++pass)
+				++histograms[pass][key >> (pass * 8) & 0xFF];
+		}
+
+		// Least significant byte first, each pass is stable. Bytes that are the same in every key are skipped,
+		// usually all but one or two.
+		for(int pass = 0; pass < 4; ++pass)
+		{
+			std::size_t* histogram = histograms[pass];
+			if(count == 0 || histogram[m_keys[0] >> (pass * 8) & 0xFF] == count)
+				continue;
+			std::size_t offset = 0;
+			for(int bucket = 0; bucket < 256; ++bucket)
+			{
+				std::size_t const size = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += size;
+			}
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				std::size_t const target = histogram[m_keys[i] >> (pass * 8) & 0xFF]++;
+				m_scratchKeys[target] = m_keys[i];
+				m_scratchOrder[target] = m_order[i];
+			}
+			m_keys.swap(m_scratchKeys);
+			m_order.swap(m_scratchOrder);
+		}
+
+		m_ranges.clear();
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			std::uint32_t const page = m_keys[i] & 0xFFFF;
+			if(m_ranges.empty() || m_ranges.back().page != page)
+			{
+				SpriteRange const range = { page, static_cast<std::uint32_t>(i), 0 };
+				m_ranges.push_back(range);
+			}
+			++m_ranges.back().count;
+		}
+	}
+
+	void SpriteBatch::writeVertices(SpriteVertex* vertices, std::size_t first, std::size_t count, JobSystem* jobs) const
+	{
+		count = std::min(count, m_order.size() - std::min(first, m_order.size()));
+		parallelFor(jobs, count, 4096, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t i = begin; i < end; ++i)
+			{
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+				// The sprites are read in sorted order, scattered over the whole array
+				if(first + i + prefetchDistance < m_order.size())
+					_mm_prefetch(reinterpret_cast<const char*>(&m_sprites[m_order[first + i + prefetchDistance]]), _MM_HINT_T0);
+#endif
+				const Sprite& sprite = m_sprites[m_order[first + i]];
+				glm::vec2 const low = -sprite.pivot * sprite.size;
+				glm::vec2 const high = low + sprite.size;
+				glm::vec2 corners[4] = { low, glm::vec2(low.x, high.y), high, glm::vec2(high.x, low.y) };
+				if(sprite.rotation != 0.0f)
+				{
+					float const c = glm::cos(sprite.rotation);
+					float const s = glm::sin(sprite.rotation);
+					for(glm::vec2& corner : corners)
+						corner = glm::vec2(c * corner.x - s * corner.y, s * corner.x + c * corner.y);
+				}
+
+				std::uint32_t const u0 = unorm16(sprite.uv.x);
+				std::uint32_t const v0 = unorm16(sprite.uv.y) << 16;
+				std::uint32_t const u1 = unorm16(sprite.uv.z);
+				std::uint32_t const v1 = unorm16(sprite.uv.w) << 16;
+				std::uint32_t const uvs[4] = { u0 | v0, u0 | v1, u1 | v1, u1 | v0 };
+
+				SpriteVertex* out = vertices + i * 4;
+				for(int corner = 0; corner < 4; ++corner)
+				{
+					out[corner].position = sprite.position + corners[corner];
+					out[corner].uv = uvs[corner];
+					out[corner].color = sprite.color;
+				}
+			}
+		});
+	}
+}
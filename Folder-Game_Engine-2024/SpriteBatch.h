@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glm.hpp>
+#include <ext/matrix_clip_space.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	struct Sprite
+	{
+		glm::vec2 position;
+		glm::vec2 size;
+		glm::vec2 pivot;      // Point of the sprite at position that it rotates around, 0 to 1 across its size
+		float rotation;       // Radians, clockwise on a y down screen
+		glm::vec4 uv;         // Min and max texture coordinates, from an AtlasRegion for instance
+		std::uint32_t color;  // glm::packUnorm4x8 of the RGBA tint
+		std::uint16_t page;   // Texture the sprite is drawn from
+		std::int16_t layer;   // Lower layers are drawn first
+
+		Sprite() : position(0.0f), size(1.0f), pivot(0.5f), rotation(0.0f), uv(0.0f, 0.0f, 1.0f, 1.0f), color(0xFFFFFFFFu), page(0), layer(0) {}
+	};
+
+	// 16 bytes, the texture coordinates as two normalized unsigned shorts and the color as four normalized bytes
+	struct SpriteVertex
+	{
+		glm::vec2 position;
+		std::uint32_t uv;
+		std::uint32_t color;
+	};
+
+	// Consecutive sprites of the same page, drawn with one call
+	struct SpriteRange
+	{
+		std::uint32_t page;
+		std::uint32_t first;
+		std::uint32_t count;
+	};
+
+	// Pixel coordinates with the origin at the top-left corner and y down
+	inline glm::mat4 spriteProjection(float width, float height)
+	{
+		return glm::ortho(0.0f, width, height, 0.0f, -1.0f, 1.0f);
+	}
+
+	// Collects the sprites of a frame and orders them for drawing: by layer, then by page inside a layer, and in
+	// the order they were added among sprites of the same layer and page. Overlapping translucent sprites from
+	// different pages that have to be drawn in a given order go on different layers.
+	class SpriteBatch
+	{
+	public:
+		explicit SpriteBatch(std::size_t maxSprites = 262144);
+
+		std::size_t maxSprites() const { return m_maxSprites; }
+		std::size_t spriteCount() const { return m_sprites.size(); }
+
+		void clear();
+		// False once the batch is full
+		bool add(const Sprite& sprite)
+		{
+			if(m_sprites.size() >= m_maxSprites)
+				return false;
+			m_sprites.push_back(sprite);
+			return true;
+		}
+
+		// Radix sort on the layer and page, then the ranges of the same page
+		void sort();
+		const std::vector<SpriteRange>& ranges() const { return m_ranges; }
+
+		// Four vertices per sprite from the first sorted sprite on, top-left, bottom-left, bottom-right and top-right,
+		// drawn with the index pattern 0, 1, 2, 0, 2, 3. vertices holds count * 4. Only sprites sorted since the
+		// last clear are written.
+		void writeVertices(SpriteVertex* vertices, std::size_t first, std::size_t count, JobSystem* jobs = nullptr) const;
+
+	private:
+		std::size_t m_maxSprites;
+		std::vector<Sprite> m_sprites;
+		std::vector<std::uint32_t> m_order;
+		std::vector<std::uint32_t> m_keys;
+		std::vector<std::uint32_t> m_scratchOrder;
+		std::vector<std::uint32_t> m_scratchKeys;
+		std::vector<SpriteRange> m_ranges;
+	};
+}
@@ -0,0 +1,144 @@
+#include "Benchmark.h"
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	std::size_t const spriteCount = 200000;
+	int const frameCount = 30;
+	int const pageCount = 8;
+	int const layerCount = 4;
+	unsigned const rectangleCount = 4000;
+
+	// Every pixel of every page claimed at most once
+	bool regionsDisjoint(const std::vector<engine::AtlasRegion>& regions, unsigned pageSize, std::size_t pages)
+	{
+		std::vector<unsigned char> claimed(pages * pageSize * pageSize, 0);
+		for(const engine::AtlasRegion& region : regions)
+		{
+			if(region.position.x + region.size.x > pageSize || region.position.y + region.size.y > pageSize)
+				return false;
+			for(unsigned y = region.position.y; y < region.position.y + region.size.y; ++y)
+			{
+				for(unsigned x = region.position.x; x < region.position.x + region.size.x; ++x)
+				{
+					unsigned char& pixel = claimed[(region.page * pageSize + y) * pageSize + x];
+					if(pixel != 0)
+						return false;
+					pixel = 1;
+				}
+			}
+		}
+		return true;
+	}
+}
+
+ENGINE_BENCHMARK(Sprite)
+{
+	// Atlas: glyph and icon sized rectangles packed at runtime
+	std::mt19937 random(47);
+	std::uniform_int_distribution<unsigned> side(8, 64);
+	engine::TextureAtlas atlas(1024, 16);
+	std::vector<engine::AtlasRegion> regions;
+	engine::Stopwatch timer;
+	for(unsigned i = 0; i < rectangleCount; ++i)
+	{
+		engine::AtlasRegion region;
+		if(atlas.allocate(side(random), side(random), region))
+			regions.push_back(region);
+	}
+	double const packMs = timer.elapsedMs();
+	double occupancy = 0.0;
+	for(std::uint32_t page = 0; page + 1 < atlas.pageCount(); ++page)
+		occupancy += atlas.occupancy(page);
+	context.report("rectangles packed per ms", regions.size() / packMs, "");
+	context.report("atlas pages", static_cast<double>(atlas.pageCount()), "");
+	context.report("full page occupancy", atlas.pageCount() > 1 ? occupancy / (atlas.pageCount() - 1) * 100.0 : 0.0, "%");
+	context.report("regions disjoint", regions.size() == rectangleCount && regionsDisjoint(regions, atlas.pageSize(), atlas.pageCount()) ? 1.0 : 0.0, "ok");
+
+	// Sprites spread over the pages and layers in random order, a quarter of them rotated
+	std::vector<engine::Sprite> sprites(spriteCount);
+	std::uniform_real_distribution<float> x(0.0f, 1920.0f);
+	std::uniform_real_distribution<float> y(0.0f, 1080.0f);
+	std::uniform_int_distribution<int> page(0, pageCount - 1);
+	std::uniform_int_distribution<int> layer(0, layerCount - 1);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for(engine::Sprite& sprite : sprites)
+	{
+		sprite.position = glm::vec2(x(random), y(random));
+		sprite.size = glm::vec2(8.0f + 24.0f * unit(random));
+		sprite.rotation = unit(random) < 0.25f ? unit(random) * 6.28f : 0.0f;
+		sprite.uv = regions[random() % regions.size()].uv;
+		sprite.page = static_cast<std::uint16_t>(page(random));
+		sprite.layer = static_cast<std::int16_t>(layer(random));
+		sprite.color = glm::packUnorm4x8(glm::vec4(unit(random), unit(random), unit(random), 1.0f));
+	}
+
+	engine::SpriteBatch batch(spriteCount);
+	std::vector<engine::SpriteVertex> vertices(spriteCount * 4);
+	double addMs = 0.0;
+	double sortMs = 0.0;
+	double writeMs = 0.0;
+	double serialWriteMs = 0.0;
+	for(int frame = 0; frame < frameCount; ++frame)
+	{
+		timer.restart();
+		batch.clear();
+		for(const engine::Sprite& sprite : sprites)
+			batch.add(sprite);
+		addMs += timer.elapsedMs();
+		timer.restart();
+		batch.sort();
+		sortMs += timer.elapsedMs();
+		timer.restart();
+		batch.writeVertices(vertices.data(), 0, batch.spriteCount(), nullptr);
+		serialWriteMs += timer.elapsedMs();
+		timer.restart();
+		batch.writeVertices(vertices.data(), 0, batch.spriteCount(), &context.jobs());
+		writeMs += timer.elapsedMs();
+	}
+	context.report("sprites", static_cast<double>(batch.spriteCount()), "");
+	context.report("add", addMs / frameCount, "ms");
+	context.report("sort", sortMs / frameCount, "ms");
+	context.report("write vertices single thread", serialWriteMs / frameCount, "ms");
+	context.report("write vertices", writeMs / frameCount, "ms");
+	context.report("frame cpu", (addMs + sortMs + writeMs) / frameCount, "ms");
+	context.report("draw calls", static_cast<double>(batch.ranges().size()), "");
+	context.report("vertex bytes", vertices.size() * sizeof(engine::SpriteVertex) / (1024.0 * 1024.0), "MB");
+
+	// Tag every sprite with its index in the color, the vertices then show the order the batch drew them in:
+	// by layer, then page, then the order they were added
+	for(std::size_t i = 0; i < spriteCount; ++i)
+		sprites[i].color = static_cast<std::uint32_t>(i);
+	batch.clear();
+	for(const engine::Sprite& sprite : sprites)
+		batch.add(sprite);
+	batch.sort();
+	batch.writeVertices(vertices.data(), 0, batch.spriteCount(), &context.jobs());
+	bool ordered = true;
+	for(std::size_t i = 1; i < spriteCount; ++i)
+	{
+		const engine::Sprite& previous = sprites[vertices[(i - 1) * 4].color];
+		const engine::Sprite& current = sprites[vertices[i * 4].color];
+		bool const sameKey = previous.layer == current.layer && previous.page == current.page;
+		ordered = ordered && (sameKey ? vertices[(i - 1) * 4].color < vertices[i * 4].color : previous.layer < current.layer || (previous.layer == current.layer && previous.page < current.page));
+	}
+	std::size_t covered = 0;
+	for(const engine::SpriteRange& range : batch.ranges())
+	{
+		ordered = ordered && range.first == covered && sprites[vertices[range.first * 4].color].page == range.page;
+		covered += range.count;
+	}
+	context.report("draw order", ordered && covered == spriteCount ? 1.0 : 0.0, "ok");
+
+	// Cleared and refilled with fewer sprites but not sorted again, the old order must not be written
+	batch.clear();
+	batch.add(sprites[0]);
+	vertices[0].color = ~0u;
+	batch.writeVertices(vertices.data(), 0, spriteCount, &context.jobs());
+	context.report("stale order ignored after clear", vertices[0].color == ~0u ? 1.0 : 0.0, "ok");
+}
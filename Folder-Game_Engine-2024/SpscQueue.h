@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace engine
+{
+	// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+	// Each side keeps a cached copy of the other side's index so it only touches the shared cache line when it
+	// looks full or empty.
+	template<typename T>
+	class SpscQueue
+	{
+	public:
+		// capacity is rounded up to a power of two
+		explicit SpscQueue(std::size_t capacity) :
+			m_head(0),
+			m_cachedTail(0),
+			m_tail(0),
+			m_cachedHead(0)
+		{
+			std::size_t size = 2;
+			while(size < capacity)
+				size *= 2;
+			m_buffer.resize(size);
+			m_mask = size - 1;
+		}
+
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+		std::size_t capacity() const { return m_buffer.size(); }
+
+		// Producer side. Returns false when the queue is full.
+		bool push(const T& value)
+		{
+			std::size_t const tail = m_tail.load(std::memory_order_relaxed);
+			if(tail - m_cachedHead == m_buffer.size())
+			{
+				m_cachedHead = m_head.load(std::memory_order_acquire);
+				if(tail - m_cachedHead == m_buffer.size())
+					return false;
+			}
+			m_buffer[tail & m_mask] = value;
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer side. Returns false when the queue is empty.
+		bool pop(T& value)
+		{
+			std::size_t const head = m_head.load(std::memory_order_relaxed);
+			if(head == m_cachedTail)
+			{
+				m_cachedTail = m_tail.load(std::memory_order_acquire);
+				if(head == m_cachedTail)
+					return false;
+			}
+			value = m_buffer[head & m_mask];
+			m_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+	private:
+		static std::size_t const cacheLine = 64;
+
+		std::vector<T> m_buffer;
+		std::size_t m_mask;
+
+		// Consumer
+		char m_padding0[cacheLine];
+		std::atomic<std::size_t> m_head;
+		std::size_t m_cachedTail;
+
+		// Producer
+		char m_padding1[cacheLine];
+		std::atomic<std::size_t> m_tail;
+		std::size_t m_cachedHead;
+		char m_padding2[cacheLine];
+	};
+}
@@ -0,0 +1,342 @@
+#include "Stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace engine
+{
+	namespace
+	{
+		int const lowestExponent = 127 - 20;
+		int const octaves = 60;
+		int const subBuckets = 16;
+
+		const char* kindName(StatKind kind)
+		{
+			switch(kind)
+			{
+			case StatKind::Counter:
+				return "counter";
+			case StatKind::Gauge:
+				return "gauge";
+			default:
+				return "sample";
+			}
+		}
+
+		// Nearest rank, values holds count elements and is reordered
+		double percentile(std::vector<double>& values, double fraction)
+		{
+			std::size_t const rank = static_cast<std::size_t>(std::ceil(fraction * values.size()));
+			std::vector<double>::iterator nth = values.begin() + (rank > 0 ? rank - 1 : 0);
+			std::nth_element(values.begin(), nth, values.end());
+			return *nth;
+		}
+
+		void appendNumber(std::string& out, double value)
+		{
+			char text[32];
+			std::snprintf(text, sizeof(text), "%.6g", value);
+			out += text;
+		}
+	}
+
+	unsigned statBucket(double value)
+	{
+		if(!(value > 0.0))
+			return 0;
+		float const single = static_cast<float>(value);
+		std::uint32_t bits = 0;
+		std::memcpy(&bits, &single, sizeof(bits));
+		int const exponent = static_cast<int>(bits >> 23 & 0xFF);
+		if(exponent < lowestExponent)
+			return 0;
+		if(exponent >= lowestExponent + octaves)
+			return statBucketCount - 1;
+		return static_cast<unsigned>((exponent - lowestExponent) * subBuckets) + (bits >> 19 & (subBuckets - 1)) + 1;
+	}
+
+	double statBucketValue(unsigned bucket)
+	{
+		if(bucket == 0)
+			return 0.0;
+		if(bucket >= statBucketCount - 1)
+			return std::ldexp(1.0, octaves + lowestExponent - 127);
+		// The middle of the bucket
+		std::uint32_t const exponent = static_cast<std::uint32_t>((bucket - 1) / subBuckets + lowestExponent);
+		std::uint32_t const bits = exponent << 23 | ((bucket - 1) % subBuckets) << 19 | 1u << 18;
+		float value = 0.0f;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	StatsRegistry::StatsRegistry(unsigned windowFrames, unsigned capacity) :
+		m_windowFrames(std::max(windowFrames, 1u)),
+		m_capacity(1),
+		m_frame(0)
+	{
+		while(m_capacity < capacity)
+			m_capacity <<= 1;
+		m_slots.reset(new StatSlot[m_capacity]);
+		for(std::size_t i = 0; i < m_capacity; ++i)
+			m_slots[i].state.store(0, std::memory_order_relaxed);
+	}
+
+	StatSlot* StatsRegistry::slot(const char* name, StatKind kind)
+	{
+		std::size_t const length = std::min<std::size_t>(std::strlen(name), sizeof(StatSlot::name) - 1);
+		std::uint64_t hash = 14695981039346656037ull;
+		for(std::size_t i = 0; i < length; ++i)
+			hash = (hash ^ static_cast<unsigned char>(name[i])) * 1099511628211ull;
+
+		for(std::size_t probe = 0; probe < m_capacity; ++probe)
+		{
+			StatSlot& slot = m_slots[(hash + probe) & (m_capacity - 1)];
+			int state = slot.state.load(std::memory_order_acquire);
+			if(state == 0 && slot.state.compare_exchange_strong(state, 1, std::memory_order_acquire))
+			{
+				std::memcpy(slot.name, name, length);
+				slot.name[length] = '\0';
+				slot.kind = kind;
+				slot.counter.store(0, std::memory_order_relaxed);
+				slot.gauge.store(0, std::memory_order_relaxed);
+				if(kind == StatKind::Sample)
+				{
+					slot.buckets.reset(new std::atomic<std::uint32_t>[statBucketCount]);
+					for(unsigned bucket = 0; bucket < statBucketCount; ++bucket)
+						slot.buckets[bucket].store(0, std::memory_order_relaxed);
+					slot.windowBuckets.assign(statBucketCount, 0);
+				}
+				slot.newest = 0;
+				slot.last = 0.0;
+				slot.state.store(2, std::memory_order_release);
+				return &slot;
+			}
+			// Another thread is filling in the slot, it's only a few stores from done
+			while(state == 1)
+			{
+				std::this_thread::yield();
+				state = slot.state.load(std::memory_order_acquire);
+			}
+			if(std::strncmp(slot.name, name, length) == 0 && slot.name[length] == '\0')
+				return slot.kind == kind ? &slot : nullptr;
+		}
+		return nullptr;
+	}
+
+	void StatsRegistry::endFrame()
+	{
+		++m_frame;
+		for(std::size_t i = 0; i < m_capacity; ++i)
+		{
+			StatSlot& slot = m_slots[i];
+			if(slot.state.load(std::memory_order_acquire) != 2)
+				continue;
+
+			if(slot.kind == StatKind::Sample)
+			{
+				// The oldest frame's samples leave the window as the new frame's enter it
+				if(slot.frameBuckets.size() < m_windowFrames)
+				{
+					slot.frameBuckets.emplace_back();
+					slot.newest = slot.frameBuckets.size() - 1;
+				}
+				else
+				{
+					slot.newest = (slot.newest + 1) % m_windowFrames;
+					for(const std::pair<std::uint16_t, std::uint32_t>& oldest : slot.frameBuckets[slot.newest])
+						slot.windowBuckets[oldest.first] -= oldest.second;
+					slot.frameBuckets[slot.newest].clear();
+				}
+
+				std::vector<std::pair<std::uint16_t, std::uint32_t> >& frame = slot.frameBuckets[slot.newest];
+				double sum = 0.0;
+				std::uint64_t count = 0;
+				for(unsigned bucket = 0; bucket < statBucketCount; ++bucket)
+				{
+					if(slot.buckets[bucket].load(std::memory_order_relaxed) == 0)
+						continue;
+					std::uint32_t const samples = slot.buckets[bucket].exchange(0, std::memory_order_relaxed);
+					frame.push_back(std::make_pair(static_cast<std::uint16_t>(bucket), samples));
+					slot.windowBuckets[bucket] += samples;
+					sum += statBucketValue(bucket) * samples;
+					count += samples;
+				}
+				slot.last = count > 0 ? sum / count : 0.0;
+				continue;
+			}
+
+			if(slot.kind == StatKind::Counter)
+				slot.last = static_cast<double>(slot.counter.exchange(0, std::memory_order_relaxed));
+			else
+			{
+				std::uint64_t const bits = slot.gauge.load(std::memory_order_relaxed);
+				std::memcpy(&slot.last, &bits, sizeof(bits));
+			}
+			if(slot.values.size() < m_windowFrames)
+			{
+				slot.values.push_back(slot.last);
+				slot.newest = slot.values.size() - 1;
+			}
+			else
+			{
+				slot.newest = (slot.newest + 1) % m_windowFrames;
+				slot.values[slot.newest] = slot.last;
+			}
+		}
+	}
+
+	void StatsRegistry::summarize(std::vector<StatSummary>& summaries) const
+	{
+		summaries.clear();
+		for(std::size_t i = 0; i < m_capacity; ++i)
+		{
+			const StatSlot& slot = m_slots[i];
+			if(slot.state.load(std::memory_order_acquire) != 2)
+				continue;
+
+			StatSummary summary;
+			summary.name = slot.name;
+			summary.kind = slot.kind;
+			summary.last = slot.last;
+			summary.mean = summary.p50 = summary.p95 = summary.p99 = summary.max = 0.0;
+			summary.count = 0;
+			if(slot.kind == StatKind::Sample)
+			{
+				double sum = 0.0;
+				for(unsigned bucket = 0; bucket < statBucketCount; ++bucket)
+				{
+					std::uint32_t const samples = slot.windowBuckets[bucket];
+					if(samples == 0)
+						continue;
+					sum += statBucketValue(bucket) * samples;
+					summary.count += samples;
+					summary.max = statBucketValue(bucket);
+				}
+				if(summary.count > 0)
+				{
+					summary.mean = sum / summary.count;
+					double* const targets[3] = { &summary.p50, &summary.p95, &summary.p99 };
+					double const fractions[3] = { 0.5, 0.95, 0.99 };
+					std::uint64_t seen = 0;
+					int next = 0;
+					for(unsigned bucket = 0; bucket < statBucketCount && next < 3; ++bucket)
+					{
+						seen += slot.windowBuckets[bucket];
+						while(next < 3 && seen >= static_cast<std::uint64_t>(std::ceil(fractions[next] * summary.count)))
+							*targets[next++] = statBucketValue(bucket);
+					}
+				}
+			}
+			else if(!slot.values.empty())
+			{
+				m_scratch.assign(slot.values.begin(), slot.values.end());
+				double sum = 0.0;
+				for(double value : m_scratch)
+					sum += value;
+				summary.count = m_scratch.size();
+				summary.mean = sum / m_scratch.size();
+				summary.max = *std::max_element(m_scratch.begin(), m_scratch.end());
+				summary.p50 = percentile(m_scratch, 0.5);
+				summary.p95 = percentile(m_scratch, 0.95);
+				summary.p99 = percentile(m_scratch, 0.99);
+			}
+			summaries.push_back(summary);
+		}
+		std::sort(summaries.begin(), summaries.end(), [](const StatSummary& a, const StatSummary& b) { return std::strcmp(a.name, b.name) < 0; });
+	}
+
+	void StatsRegistry::writeCsvHeader(std::string& out)
+	{
+		out += "frame,name,kind,last,mean,p50,p95,p99,max,count\n";
+	}
+
+	void StatsRegistry::writeCsv(std::string& out) const
+	{
+		summarize(m_summaries);
+		for(const StatSummary& summary : m_summaries)
+		{
+			appendNumber(out, static_cast<double>(m_frame));
+			out += ',';
+			out += summary.name;
+			out += ',';
+			out += kindName(summary.kind);
+			double const values[6] = { summary.last, summary.mean, summary.p50, summary.p95, summary.p99, summary.max };
+			for(double value : values)
+			{
+				out += ',';
+				appendNumber(out, value);
+			}
+			out += ',';
+			appendNumber(out, static_cast<double>(summary.count));
+			out += '\n';
+		}
+	}
+
+	void StatsRegistry::writeJson(std::string& out) const
+	{
+		summarize(m_summaries);
+		out += "{\"frame\":";
+		appendNumber(out, static_cast<double>(m_frame));
+		out += ",\"stats\":{";
+		for(std::size_t i = 0; i < m_summaries.size(); ++i)
+		{
+			const StatSummary& summary = m_summaries[i];
+			if(i > 0)
+				out += ',';
+			out += '"';
+			for(const char* c = summary.name; *c; ++c)
+			{
+				if(*c == '"' || *c == '\\')
+					out += '\\';
+				out += *c;
+			}
+			out += "\":{\"kind\":\"";
+			out += kindName(summary.kind);
+			char const* const labels[6] = { "\",\"last\":", ",\"mean\":", ",\"p50\":", ",\"p95\":", ",\"p99\":", ",\"max\":" };
+			double const values[6] = { summary.last, summary.mean, summary.p50, summary.p95, summary.p99, summary.max };
+			for(int value = 0; value < 6; ++value)
+			{
+				out += labels[value];
+				appendNumber(out, values[value]);
+			}
+			out += ",\"count\":";
+			appendNumber(out, static_cast<double>(summary.count));
+			out += '}';
+		}
+		out += "}}\n";
+	}
+
+	StatsDump::StatsDump(const std::string& path, Format format, unsigned everyFrames) :
+		m_file(std::fopen(path.c_str(), "wb")),
+		m_format(format),
+		m_everyFrames(std::max(everyFrames, 1u))
+	{
+		if(m_file && m_format == Format::Csv)
+		{
+			StatsRegistry::writeCsvHeader(m_buffer);
+			std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+		}
+	}
+
+	StatsDump::~StatsDump()
+	{
+		if(m_file)
+			std::fclose(m_file);
+	}
+
+	void StatsDump::update(const StatsRegistry& stats)
+	{
+		if(!m_file || stats.frame() % m_everyFrames != 0)
+			return;
+		m_buffer.clear();
+		if(m_format == Format::Csv)
+			stats.writeCsv(m_buffer);
+		else
+			stats.writeJson(m_buffer);
+		std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+		// A CI run that crashes still leaves the rows before it
+		std::fflush(m_file);
+	}
+}
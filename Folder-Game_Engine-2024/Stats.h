@@ -0,0 +1,227 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace engine
+{
+	enum class StatKind
+	{
+		Counter,  // Summed over the frame and reset, draw calls or bytes uploaded
+		Gauge,    // Value at the end of the frame, frame time, queue depths or memory in use
+		Sample    // Distribution of values recorded during the frame, latencies of single requests
+	};
+
+	// Log-linear buckets of the samples: 16 per power of two from 2^-20 to 2^40, each at most 6.25% wide, then
+	// one below and one above
+	unsigned const statBucketCount = 60 * 16 + 2;
+
+	struct StatSlot
+	{
+		std::atomic<int> state;  // 0 free, 1 being registered, 2 ready
+		char name[48];
+		StatKind kind;
+		std::atomic<std::int64_t> counter;
+		std::atomic<std::uint64_t> gauge; // Bits of a double
+		std::unique_ptr<std::atomic<std::uint32_t>[]> buckets;
+
+		// Frames in the window, only touched by the thread ending frames
+		std::vector<double> values;
+		std::size_t newest;
+		double last;
+		std::vector<std::uint32_t> windowBuckets;
+		std::vector<std::vector<std::pair<std::uint16_t, std::uint32_t> > > frameBuckets;
+	};
+
+	unsigned statBucket(double value);
+	double statBucketValue(unsigned bucket);
+
+	// Handles to publish into a registered stat, copied freely and used from any thread. Publishing is one
+	// relaxed atomic operation. A default constructed handle, or one the registry had no room for, does nothing.
+	class StatCounter
+	{
+	public:
+		StatCounter() : m_slot(nullptr) {}
+		explicit StatCounter(StatSlot* slot) : m_slot(slot) {}
+
+		void add(std::int64_t value = 1) const
+		{
+			if(m_slot)
+				m_slot->counter.fetch_add(value, std::memory_order_relaxed);
+		}
+
+	private:
+		StatSlot* m_slot;
+	};
+
+	class StatGauge
+	{
+	public:
+		StatGauge() : m_slot(nullptr) {}
+		explicit StatGauge(StatSlot* slot) : m_slot(slot) {}
+
+		void set(double value) const
+		{
+			if(m_slot)
+				m_slot->gauge.store(bits(value), std::memory_order_relaxed);
+		}
+
+		// For gauges changed from several threads, allocations and frees for instance
+		void add(double delta) const
+		{
+			if(!m_slot)
+				return;
+			std::uint64_t current = m_slot->gauge.load(std::memory_order_relaxed);
+			while(!m_slot->gauge.compare_exchange_weak(current, bits(value(current) + delta), std::memory_order_relaxed))
+			{
+			}
+		}
+
+	private:
+		static std::uint64_t bits(double value)
+		{
+			std::uint64_t result = 0;
+			std::memcpy(&result, &value, sizeof(result));
+			return result;
+		}
+
+		static double value(std::uint64_t bits)
+		{
+			double result = 0.0;
+			std::memcpy(&result, &bits, sizeof(result));
+			return result;
+		}
+
+		StatSlot* m_slot;
+	};
+
+	class StatSample
+	{
+	public:
+		StatSample() : m_slot(nullptr) {}
+		explicit StatSample(StatSlot* slot) : m_slot(slot) {}
+
+		void record(double value) const
+		{
+			if(m_slot)
+				m_slot->buckets[statBucket(value)].fetch_add(1, std::memory_order_relaxed);
+		}
+
+	private:
+		StatSlot* m_slot;
+	};
+
+	// Over the frames in the window. Percentiles of counters and gauges are exact, those of samples are the
+	// middle of their bucket.
+	struct StatSummary
+	{
+		const char* name;
+		StatKind kind;
+		double last;   // Last frame's total or value, or the mean of its samples
+		double mean;
+		double p50;
+		double p95;
+		double p99;
+		double max;
+		std::uint64_t count; // Frames in the window, samples for samples
+	};
+
+	// Named counters, gauges and samples that any subsystem publishes into. Registering and publishing never
+	// lock: a stat claims a slot of a fixed open addressed table with a compare and swap, registering the same
+	// name again returns the same stat. endFrame, called by one thread, moves each frame's values into a
+	// rolling window of the last windowFrames frames.
+	class StatsRegistry
+	{
+	public:
+		explicit StatsRegistry(unsigned windowFrames = 240, unsigned capacity = 256);
+
+		StatsRegistry(const StatsRegistry&) = delete;
+		StatsRegistry& operator=(const StatsRegistry&) = delete;
+
+		// Names longer than 47 characters are cut. A name already registered as another kind gives a handle
+		// that does nothing.
+		StatCounter counter(const char* name) { return StatCounter(slot(name, StatKind::Counter)); }
+		StatGauge gauge(const char* name) { return StatGauge(slot(name, StatKind::Gauge)); }
+		StatSample sample(const char* name) { return StatSample(slot(name, StatKind::Sample)); }
+
+		void endFrame();
+		std::uint64_t frame() const { return m_frame; }
+
+		// Sorted by name. Call from the thread that ends frames.
+		void summarize(std::vector<StatSummary>& summaries) const;
+
+		// One row per stat: frame,name,kind,last,mean,p50,p95,p99,max,count
+		static void writeCsvHeader(std::string& out);
+		void writeCsv(std::string& out) const;
+		// One line, {"frame":...,"stats":{"name":{"kind":...,"last":...},...}}
+		void writeJson(std::string& out) const;
+
+	private:
+		StatSlot* slot(const char* name, StatKind kind);
+
+		unsigned m_windowFrames;
+		std::size_t m_capacity;
+		std::unique_ptr<StatSlot[]> m_slots;
+		std::uint64_t m_frame;
+		mutable std::vector<double> m_scratch;
+		mutable std::vector<StatSummary> m_summaries;
+	};
+
+	// What the GL renderers publish, under render.*: draw calls, triangles, and buffer and texture objects bound
+	// while drawing. Made without a registry, every handle does nothing.
+	struct RenderStatHandles
+	{
+		StatCounter drawCalls;
+		StatCounter triangles;
+		StatCounter bufferBinds;
+		StatCounter textureBinds;
+
+		RenderStatHandles() {}
+
+		explicit RenderStatHandles(StatsRegistry* stats)
+		{
+			if(!stats)
+				return;
+			drawCalls = stats->counter("render.draw_calls");
+			triangles = stats->counter("render.triangles");
+			bufferBinds = stats->counter("render.buffer_binds");
+			textureBinds = stats->counter("render.texture_binds");
+		}
+	};
+
+	// Appends the registry to a file every few frames, CSV rows or JSON lines, for tracking performance on
+	// headless CI runs
+	class StatsDump
+	{
+	public:
+		enum class Format
+		{
+			Csv,
+			Json
+		};
+
+		StatsDump(const std::string& path, Format format, unsigned everyFrames = 60);
+		~StatsDump();
+
+		StatsDump(const StatsDump&) = delete;
+		StatsDump& operator=(const StatsDump&) = delete;
+
+		bool open() const { return m_file != nullptr; }
+
+		// Call after endFrame, writes on every everyFrames-th frame
+		void update(const StatsRegistry& stats);
+
+	private:
+		std::FILE* m_file;
+		Format m_format;
+		unsigned m_everyFrames;
+		std::string m_buffer;
+	};
+}
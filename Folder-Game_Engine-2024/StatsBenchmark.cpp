@@ -0,0 +1,244 @@
+#include "Benchmark.h"
+#include "GlyphCache.h"
+#include "JobSystem.h"
+#include "SpriteBatch.h"
+#include "Stats.h"
+#include "StatsOverlay.h"
+#include "TextLayout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	std::size_t const publishCount = 1000000;
+	int const windowFrames = 240;
+	int const frameCount = 600;
+	int const sampleFrames = 20;
+	std::size_t const samplesPerFrame = 50000;
+	int const dumpEvery = 10;
+
+	// Solid boxes for glyphs, the overlay only needs their metrics
+	class BoxFont : public engine::GlyphRasterizer
+	{
+	public:
+		unsigned pixelSize() const override { return 32; }
+		float ascent() const override { return 26.0f; }
+		float lineHeight() const override { return 38.0f; }
+
+		bool rasterize(std::uint32_t codepoint, engine::GlyphBitmap& bitmap) const override
+		{
+			bitmap.metrics.advance = 18.0f;
+			if(codepoint == ' ')
+				return true;
+			if(codepoint < 33 || codepoint > 126)
+				return false;
+			bitmap.width = 14;
+			bitmap.height = 22;
+			bitmap.coverage.assign(bitmap.width * bitmap.height, 255);
+			bitmap.metrics.offset = glm::vec2(2.0f, -22.0f);
+			bitmap.metrics.size = glm::vec2(14.0f, 22.0f);
+			return true;
+		}
+	};
+
+	std::size_t countLines(const char* path)
+	{
+		std::FILE* file = std::fopen(path, "rb");
+		if(!file)
+			return 0;
+		std::size_t lines = 0;
+		for(int c = std::fgetc(file); c != EOF; c = std::fgetc(file))
+			lines += c == '\n' ? 1 : 0;
+		std::fclose(file);
+		return lines;
+	}
+
+	const engine::StatSummary* findStat(const std::vector<engine::StatSummary>& summaries, const char* name)
+	{
+		for(const engine::StatSummary& summary : summaries)
+		{
+			if(std::strcmp(summary.name, name) == 0)
+				return &summary;
+		}
+		return nullptr;
+	}
+
+	double relativeError(double estimate, double exact)
+	{
+		return exact != 0.0 ? std::abs(estimate - exact) / exact : 0.0;
+	}
+}
+
+ENGINE_BENCHMARK(Stats)
+{
+	engine::StatsRegistry stats(windowFrames);
+
+	// Publishing from every job at once into the same stats
+	engine::StatCounter const draws = stats.counter("render.draw_calls");
+	engine::StatGauge const allocated = stats.gauge("memory.allocated_bytes");
+	engine::StatSample const latency = stats.sample("streaming.request_ms");
+	engine::Stopwatch timer;
+	engine::parallelFor(&context.jobs(), publishCount, 4096, [&](std::size_t begin, std::size_t end)
+	{
+		for(std::size_t i = begin; i < end; ++i)
+		{
+			draws.add();
+			allocated.add(i % 2 ? 64.0 : -32.0);
+			latency.record(0.5 + static_cast<double>(i % 100));
+		}
+	});
+	double const publishMs = timer.elapsedMs();
+	stats.endFrame();
+	std::vector<engine::StatSummary> summaries;
+	stats.summarize(summaries);
+	bool counted = summaries.size() == 3;
+	for(const engine::StatSummary& summary : summaries)
+	{
+		if(summary.kind == engine::StatKind::Counter)
+			counted = counted && summary.last == static_cast<double>(publishCount);
+		else if(summary.kind == engine::StatKind::Gauge)
+			counted = counted && summary.last == static_cast<double>(publishCount / 2) * 32.0;
+		else
+			counted = counted && summary.count == publishCount;
+	}
+	// Registering a name again gives the same stat, as another kind a handle that does nothing
+	stats.counter("render.draw_calls").add(5);
+	stats.gauge("render.draw_calls").set(1.0);
+	stats.endFrame();
+	stats.summarize(summaries);
+	const engine::StatSummary* drawStat = findStat(summaries, "render.draw_calls");
+	counted = counted && summaries.size() == 3 && drawStat && drawStat->kind == engine::StatKind::Counter && drawStat->last == 5.0;
+	context.report("publish", publishMs / (publishCount * 3) * 1e6, "ns");
+	context.report("published values exact", counted ? 1.0 : 0.0, "ok");
+
+	// A frame loop's worth of stats: the frame time gauge against the exact percentiles of its window
+	std::mt19937 random(50);
+	std::lognormal_distribution<double> frameTime(std::log(16.0), 0.15);
+	std::vector<engine::StatCounter> counters;
+	std::vector<engine::StatGauge> gauges;
+	std::vector<engine::StatSample> samples;
+	char name[48];
+	for(int i = 0; i < 32; ++i)
+	{
+		std::snprintf(name, sizeof(name), "system%02d.counter", i);
+		counters.push_back(stats.counter(name));
+		std::snprintf(name, sizeof(name), "system%02d.gauge", i);
+		gauges.push_back(stats.gauge(name));
+	}
+	for(int i = 0; i < 8; ++i)
+	{
+		std::snprintf(name, sizeof(name), "system%02d.sample", i);
+		samples.push_back(stats.sample(name));
+	}
+	engine::StatGauge const frameMs = stats.gauge("frame.ms");
+	engine::StatGauge const queued = stats.gauge("jobs.queued");
+
+	std::vector<double> history;
+	double endFrameMs = 0.0;
+	for(int frame = 0; frame < frameCount; ++frame)
+	{
+		double const ms = frameTime(random);
+		history.push_back(ms);
+		frameMs.set(ms);
+		queued.set(static_cast<double>(context.jobs().queuedJobs()));
+		for(std::size_t i = 0; i < counters.size(); ++i)
+		{
+			counters[i].add(static_cast<std::int64_t>(i + frame));
+			gauges[i].set(static_cast<double>(i * frame));
+		}
+		for(const engine::StatSample& sample : samples)
+		{
+			for(int i = 0; i < 16; ++i)
+				sample.record(frameTime(random));
+		}
+		timer.restart();
+		stats.endFrame();
+		endFrameMs += timer.elapsedMs();
+	}
+	std::vector<double> window(history.end() - windowFrames, history.end());
+	std::sort(window.begin(), window.end());
+	stats.summarize(summaries);
+	const engine::StatSummary* frameStat = findStat(summaries, "frame.ms");
+	bool const exact = frameStat && frameStat->count == static_cast<std::uint64_t>(windowFrames) &&
+		frameStat->p50 == window[windowFrames / 2 - 1] && frameStat->p95 == window[windowFrames * 95 / 100 - 1] &&
+		frameStat->p99 == window[static_cast<std::size_t>(std::ceil(windowFrames * 0.99)) - 1] && frameStat->max == window.back();
+	context.report("stats", static_cast<double>(summaries.size()), "");
+	context.report("end frame", endFrameMs / frameCount * 1000.0, "us");
+	context.report("frame time percentiles exact", exact ? 1.0 : 0.0, "ok");
+
+	// Bucketed percentiles of many samples a frame against the exact ones
+	engine::StatsRegistry sampled(sampleFrames);
+	engine::StatSample const request = sampled.sample("request_ms");
+	std::exponential_distribution<double> requestTime(0.25);
+	std::vector<double> recorded;
+	for(int frame = 0; frame < sampleFrames; ++frame)
+	{
+		for(std::size_t i = 0; i < samplesPerFrame; ++i)
+		{
+			double const value = requestTime(random);
+			recorded.push_back(value);
+			request.record(value);
+		}
+		sampled.endFrame();
+	}
+	std::sort(recorded.begin(), recorded.end());
+	sampled.summarize(summaries);
+	double const errors[3] = {
+		relativeError(summaries[0].p50, recorded[recorded.size() / 2 - 1]),
+		relativeError(summaries[0].p95, recorded[recorded.size() * 95 / 100 - 1]),
+		relativeError(summaries[0].p99, recorded[recorded.size() * 99 / 100 - 1]) };
+	context.report("sample percentile error max", *std::max_element(errors, errors + 3) * 100.0, "%");
+
+	// Overlay of every stat, drawn each frame
+	BoxFont font;
+	engine::GlyphCache glyphs(font);
+	engine::TextLayoutCache layouts;
+	engine::StatsOverlay overlay(glyphs, layouts);
+	engine::SpriteBatch batch(65536);
+	double overlayMs = 0.0;
+	std::size_t sprites = 0;
+	for(int frame = 0; frame < 60; ++frame)
+	{
+		frameMs.set(frameTime(random));
+		stats.endFrame();
+		glyphs.nextFrame();
+		batch.clear();
+		timer.restart();
+		sprites = overlay.draw(batch, stats, glm::vec2(8.0f), 14.0f, 0xFFFFFFFFu, 0);
+		overlayMs += timer.elapsedMs();
+	}
+	context.report("overlay sprites", static_cast<double>(sprites), "");
+	context.report("overlay", overlayMs / 60, "ms");
+	context.report("overlay layout cache hit rate", 100.0 * layouts.hits() / (layouts.hits() + layouts.misses()), "%");
+
+	// Headless dumps every few frames, as a CI run would write them
+	char const* const csvPath = "stats_benchmark.csv";
+	char const* const jsonPath = "stats_benchmark.jsonl";
+	stats.summarize(summaries);
+	double dumpMs = 0.0;
+	{
+		engine::StatsDump csv(csvPath, engine::StatsDump::Format::Csv, dumpEvery);
+		engine::StatsDump json(jsonPath, engine::StatsDump::Format::Json, dumpEvery);
+		for(int frame = 0; frame < frameCount; ++frame)
+		{
+			frameMs.set(frameTime(random));
+			stats.endFrame();
+			timer.restart();
+			csv.update(stats);
+			json.update(stats);
+			dumpMs += timer.elapsedMs();
+		}
+	}
+	std::size_t const dumps = frameCount / dumpEvery;
+	bool const dumped = countLines(csvPath) == 1 + dumps * summaries.size() && countLines(jsonPath) == dumps;
+	context.report("dump csv and json", dumpMs / dumps * 1000.0, "us");
+	context.report("dump rows", dumped ? 1.0 : 0.0, "ok");
+	std::remove(csvPath);
+	std::remove(jsonPath);
+}
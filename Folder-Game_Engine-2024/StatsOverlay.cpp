@@ -0,0 +1,79 @@
+#include "StatsOverlay.h"
+#include "GlyphCache.h"
+#include "TextLayout.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace engine
+{
+	namespace
+	{
+		// Three significant digits or so, short enough for a fixed column
+		void formatValue(double value, char (&text)[16])
+		{
+			double const magnitude = std::fabs(value);
+			if(magnitude >= 1e9)
+				std::snprintf(text, sizeof(text), "%.2fG", value / 1e9);
+			else if(magnitude >= 1e6)
+				std::snprintf(text, sizeof(text), "%.2fM", value / 1e6);
+			else if(magnitude >= 1e4)
+				std::snprintf(text, sizeof(text), "%.1fk", value / 1e3);
+			else if(magnitude >= 100.0 || value == std::floor(value))
+				std::snprintf(text, sizeof(text), "%.0f", value);
+			else
+				std::snprintf(text, sizeof(text), "%.2f", value);
+		}
+
+		// Width of a number column in ems
+		float const columnWidth = 4.5f;
+	}
+
+	StatsOverlay::StatsOverlay(GlyphCache& glyphs, TextLayoutCache& layouts) :
+		m_glyphs(glyphs),
+		m_layouts(layouts)
+	{
+	}
+
+	std::size_t StatsOverlay::draw(SpriteBatch& batch, const StatsRegistry& stats, glm::vec2 position, float size, std::uint32_t color,
+		std::uint16_t firstPage, std::int16_t layer)
+	{
+		stats.summarize(m_summaries);
+		const GlyphRasterizer& rasterizer = m_glyphs.rasterizer();
+		float const scale = size / static_cast<float>(rasterizer.pixelSize());
+		float const rowHeight = rasterizer.lineHeight() * scale;
+
+		// The name column is as wide as the longest name
+		float nameWidth = 0.0f;
+		for(const StatSummary& summary : m_summaries)
+			nameWidth = glm::max(nameWidth, m_layouts.layout(m_glyphs, summary.name).size.x * scale);
+		nameWidth += size;
+
+		char const* const headers[5] = { "", "last", "p50", "p95", "p99" };
+		std::size_t added = 0;
+		glm::vec2 row = position;
+		for(std::size_t line = 0; line <= m_summaries.size(); ++line)
+		{
+			const StatSummary* summary = line > 0 ? &m_summaries[line - 1] : nullptr;
+			if(summary)
+				added += drawText(batch, m_glyphs, m_layouts.layout(m_glyphs, summary->name), row, size, color, firstPage, layer);
+			for(int column = 1; column < 5; ++column)
+			{
+				char text[16];
+				if(summary)
+				{
+					double const values[5] = { 0.0, summary->last, summary->p50, summary->p95, summary->p99 };
+					formatValue(values[column], text);
+				}
+				else
+					std::snprintf(text, sizeof(text), "%s", headers[column]);
+				// Numbers are right aligned
+				const TextLayout& layout = m_layouts.layout(m_glyphs, text);
+				float const right = row.x + nameWidth + columnWidth * size * column;
+				added += drawText(batch, m_glyphs, layout, glm::vec2(right - layout.size.x * scale, row.y), size, color, firstPage, layer);
+			}
+			row.y += rowHeight;
+		}
+		return added;
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Stats.h"
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	class GlyphCache;
+	class SpriteBatch;
+	class TextLayoutCache;
+
+	// Table of stats drawn as text sprites: name, last value, p50, p95 and p99, one stat per row from position
+	// down at size pixels per em. Every cell is laid out on its own, numbers that repeat from frame to frame hit
+	// the layout cache even when the rest of the row changed.
+	class StatsOverlay
+	{
+	public:
+		StatsOverlay(GlyphCache& glyphs, TextLayoutCache& layouts);
+
+		StatsOverlay(const StatsOverlay&) = delete;
+		StatsOverlay& operator=(const StatsOverlay&) = delete;
+
+		// Returns the sprites added, glyph pages map to sprite pages from firstPage on as in drawText
+		std::size_t draw(SpriteBatch& batch, const StatsRegistry& stats, glm::vec2 position, float size, std::uint32_t color,
+			std::uint16_t firstPage, std::int16_t layer = 32767);
+
+	private:
+		GlyphCache& m_glyphs;
+		TextLayoutCache& m_layouts;
+		std::vector<StatSummary> m_summaries;
+	};
+}
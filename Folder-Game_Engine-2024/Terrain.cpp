@@ -0,0 +1,427 @@
+#include "Terrain.h"
+#include "JobSystem.h"
+
+#include <gtc/noise.hpp>
+
+#include <algorithm>
+
+namespace engine
+{
+	namespace
+	{
+		std::int32_t floorDiv(std::int32_t value, std::int32_t divisor)
+		{
+			return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+		}
+
+		// Keys pack the level in the top 8 bits and 28 bits of each coordinate
+		std::int32_t unpackCoordinate(std::uint64_t bits)
+		{
+			return static_cast<std::int32_t>(static_cast<std::uint32_t>(bits & 0xFFFFFFFu) << 4) >> 4;
+		}
+
+		float bilinear(const float* heights, unsigned stride, unsigned cells, glm::vec2 local)
+		{
+			local = glm::clamp(local, glm::vec2(0.0f), glm::vec2(static_cast<float>(cells)));
+			glm::uvec2 const cell = glm::min(glm::uvec2(local), glm::uvec2(cells - 1));
+			glm::vec2 const t = local - glm::vec2(cell);
+			const float* row = heights + cell.y * stride + cell.x;
+			float const low = glm::mix(row[0], row[1], t.x);
+			float const high = glm::mix(row[stride], row[stride + 1], t.x);
+			return glm::mix(low, high, t.y);
+		}
+	}
+
+	NoiseHeightSource::NoiseHeightSource(float amplitude, float wavelength, unsigned octaves, const glm::vec2& offset) :
+		m_amplitude(amplitude),
+		m_frequency(1.0f / glm::max(wavelength, 1e-3f)),
+		m_octaves(glm::clamp(octaves, 1u, 16u)),
+		m_offset(offset)
+	{
+	}
+
+	void NoiseHeightSource::generate(const glm::vec2& origin, float spacing, unsigned resolution, float* heights) const
+	{
+		for(unsigned z = 0; z < resolution; ++z)
+		{
+			for(unsigned x = 0; x < resolution; ++x)
+				heights[z * resolution + x] = sample(origin.x + x * spacing, origin.y + z * spacing);
+		}
+	}
+
+	glm::vec2 NoiseHeightSource::heightRange() const
+	{
+		float const total = m_amplitude * (2.0f - 2.0f / static_cast<float>(1u << (m_octaves - 1)));
+		return glm::vec2(-total, total);
+	}
+
+	float NoiseHeightSource::sample(float x, float z) const
+	{
+		glm::vec2 point = (glm::vec2(x, z) + m_offset) * m_frequency;
+		float amplitude = m_amplitude;
+		float sum = 0.0f;
+		for(unsigned octave = 0; octave < m_octaves; ++octave)
+		{
+			sum += amplitude * glm::simplex(point);
+			point *= 2.0f;
+			amplitude *= 0.5f;
+		}
+		return sum;
+	}
+
+	TerrainGrid::TerrainGrid(unsigned resolution) :
+		m_resolution(resolution)
+	{
+		m_vertices.reserve(resolution * resolution);
+		for(unsigned z = 0; z < resolution; ++z)
+		{
+			for(unsigned x = 0; x < resolution; ++x)
+				m_vertices.push_back(glm::vec2(x, z));
+		}
+
+		// Every cell is split along the same diagonal, which collapses into the diagonals of the coarser grid when
+		// the odd vertices morph onto the even ones
+		unsigned const half = (resolution - 1) / 2;
+		m_indices.reserve((resolution - 1) * (resolution - 1) * 6);
+		for(unsigned quadrant = 0; quadrant < 4; ++quadrant)
+		{
+			unsigned const startX = (quadrant & 1) * half;
+			unsigned const startZ = (quadrant >> 1) * half;
+			for(unsigned z = startZ; z < startZ + half; ++z)
+			{
+				for(unsigned x = startX; x < startX + half; ++x)
+				{
+					std::uint16_t const a = static_cast<std::uint16_t>(z * resolution + x);
+					std::uint16_t const b = static_cast<std::uint16_t>(a + 1);
+					std::uint16_t const c = static_cast<std::uint16_t>(a + resolution);
+					std::uint16_t const d = static_cast<std::uint16_t>(c + 1);
+					// Counter-clockwise seen from above
+					std::uint16_t const cell[6] = { a, d, b, a, c, d };
+					m_indices.insert(m_indices.end(), cell, cell + 6);
+				}
+			}
+		}
+	}
+
+	Terrain::Terrain(const HeightSource& source, const TerrainSettings& settings, StatsRegistry* stats) :
+		m_source(source),
+		m_settings(settings),
+		m_gridCells(glm::clamp(1u << static_cast<unsigned>(glm::ceil(glm::log2(static_cast<float>(glm::max(settings.gridResolution, 3u) - 1)))), 4u, 128u)),
+		m_tileCells(0),
+		m_blocksPerTile(0),
+		m_spacing(0.0f),
+		m_heightRange(source.heightRange()),
+		m_grid(m_gridCells + 1),
+		m_frame(0),
+		m_tileSamples(0),
+		m_streamingJobs(nullptr)
+	{
+		if(stats)
+		{
+			m_tilesLoadedStat = stats->counter("terrain.tiles_loaded");
+			m_tilesPendingStat = stats->gauge("terrain.tiles_pending");
+			m_tilesMissingStat = stats->gauge("terrain.tiles_missing");
+		}
+
+		m_settings.gridResolution = m_gridCells + 1;
+		m_settings.lodCount = glm::clamp(m_settings.lodCount, 1u, 16u);
+		m_settings.leafSize = glm::max(m_settings.leafSize, 1e-3f);
+		// Below about two patch sizes neighbors could differ by more than one lod
+		m_settings.lodRange = glm::max(m_settings.lodRange, 2.0f * m_settings.leafSize);
+		m_settings.morphStart = glm::clamp(m_settings.morphStart, 0.0f, 0.95f);
+		m_settings.maxCachedTiles = glm::max(m_settings.maxCachedTiles, 1u);
+
+		m_blocksPerTile = glm::max((glm::max(m_settings.tileResolution, 2u) - 1 + m_gridCells - 1) / m_gridCells, 1u);
+		m_tileCells = m_blocksPerTile * m_gridCells;
+		m_settings.tileResolution = m_tileCells + 1;
+		m_spacing = m_settings.leafSize / m_gridCells;
+
+		float previous = 0.0f;
+		for(unsigned lod = 0; lod < m_settings.lodCount; ++lod)
+		{
+			float const range = m_settings.lodRange * static_cast<float>(1u << lod);
+			m_ranges.push_back(range);
+			m_morph.push_back(glm::vec2(previous + (range - previous) * m_settings.morphStart, range));
+			previous = range;
+		}
+
+		std::size_t const capacity = m_settings.maxCachedTiles;
+		m_tileSamples = static_cast<std::size_t>(m_tileCells + 1) * (m_tileCells + 1);
+		m_heights.resize(capacity * m_tileSamples);
+		m_blockBounds.resize(capacity * m_blocksPerTile * m_blocksPerTile);
+		m_tileLevel.resize(capacity, 0);
+		m_tileCoordinates.resize(capacity, glm::ivec2(0));
+		m_tileUsed.resize(capacity, 0);
+		m_tileSlots.reserve(capacity);
+	}
+
+	Terrain::~Terrain()
+	{
+		// The jobs write into the cache
+		finishStreaming();
+	}
+
+	void Terrain::finishStreaming()
+	{
+		if(!m_pending.empty())
+			m_streamingJobs->wait(m_streaming);
+	}
+
+	glm::vec2 Terrain::tileOrigin(std::uint32_t tile) const
+	{
+		return glm::vec2(m_tileCoordinates[tile]) * (vertexSpacing(m_tileLevel[tile]) * m_tileCells);
+	}
+
+	std::uint64_t Terrain::tileKey(unsigned level, std::int32_t x, std::int32_t z) const
+	{
+		return static_cast<std::uint64_t>(level) << 56 | (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x) & 0xFFFFFFFu) << 28) | (static_cast<std::uint32_t>(z) & 0xFFFFFFFu);
+	}
+
+	std::uint32_t Terrain::findTile(unsigned level, std::int32_t x, std::int32_t z) const
+	{
+		std::unordered_map<std::uint64_t, std::uint32_t>::const_iterator const found = m_tileSlots.find(tileKey(level, x, z));
+		return found != m_tileSlots.end() ? found->second : invalidTile;
+	}
+
+	float Terrain::sampleTile(std::uint32_t tile, float x, float z) const
+	{
+		glm::vec2 const local = (glm::vec2(x, z) - tileOrigin(tile)) / vertexSpacing(m_tileLevel[tile]);
+		return bilinear(tileHeights(tile), m_tileCells + 1, m_tileCells, local);
+	}
+
+	glm::ivec2 Terrain::tileOf(const TerrainPatch& patch) const
+	{
+		glm::ivec2 const node(glm::round(patch.origin / patch.size));
+		std::int32_t const blocks = static_cast<std::int32_t>(m_blocksPerTile);
+		return glm::ivec2(floorDiv(node.x, blocks), floorDiv(node.y, blocks));
+	}
+
+	Aabb Terrain::nodeBounds(std::int32_t x, std::int32_t z, unsigned lod) const
+	{
+		std::int32_t const blocks = static_cast<std::int32_t>(m_blocksPerTile);
+		std::int32_t const tileX = floorDiv(x, blocks);
+		std::int32_t const tileZ = floorDiv(z, blocks);
+		std::uint32_t const tile = findTile(lod, tileX, tileZ);
+		glm::vec2 const range = tile != invalidTile ? m_blockBounds[(tile * blocks + z - tileZ * blocks) * blocks + x - tileX * blocks] : m_heightRange;
+		float const size = patchSize(lod);
+		return Aabb(glm::vec3(x * size, range.x, z * size), glm::vec3((x + 1) * size, range.y, (z + 1) * size));
+	}
+
+	void Terrain::selectNode(std::int32_t x, std::int32_t z, unsigned lod, const glm::vec3& camera, const Frustum& frustum)
+	{
+		++m_stats.nodesVisited;
+		Aabb const bounds = nodeBounds(x, z, lod);
+		if(!intersectsSphere(bounds, camera, m_ranges[lod]) || classify(frustum, bounds) == Containment::Outside)
+			return;
+
+		float const size = patchSize(lod);
+		TerrainPatch patch;
+		patch.origin = glm::vec2(x, z) * size;
+		patch.size = size;
+		patch.lod = lod;
+		patch.quadrants = 0xF;
+		patch.tile = invalidTile;
+		if(lod > 0 && intersectsSphere(bounds, camera, m_ranges[lod - 1]))
+		{
+			// Children in range of the finer lod select themselves, this node draws the quadrants of the others
+			patch.quadrants = 0;
+			for(unsigned quadrant = 0; quadrant < 4; ++quadrant)
+			{
+				std::int32_t const childX = 2 * x + static_cast<std::int32_t>(quadrant & 1);
+				std::int32_t const childZ = 2 * z + static_cast<std::int32_t>(quadrant >> 1);
+				Aabb const child = nodeBounds(childX, childZ, lod - 1);
+				if(intersectsSphere(child, camera, m_ranges[lod - 1]))
+					selectNode(childX, childZ, lod - 1, camera, frustum);
+				else if(classify(frustum, child) != Containment::Outside)
+					patch.quadrants |= 1u << quadrant;
+			}
+		}
+		if(patch.quadrants != 0)
+			m_patches.push_back(patch);
+	}
+
+	void Terrain::update(const glm::vec3& camera, const Frustum& frustum, JobSystem* jobs)
+	{
+		++m_frame;
+		m_stats = TerrainStats();
+		m_patches.clear();
+		m_loaded.clear();
+		collectTiles();
+
+		unsigned const rootLod = m_settings.lodCount - 1;
+		float const rootSize = patchSize(rootLod);
+		float const distance = m_ranges[rootLod];
+		glm::ivec2 const low(glm::floor((glm::vec2(camera.x, camera.z) - distance) / rootSize));
+		glm::ivec2 const high(glm::floor((glm::vec2(camera.x, camera.z) + distance) / rootSize));
+		for(std::int32_t z = low.y; z <= high.y; ++z)
+		{
+			for(std::int32_t x = low.x; x <= high.x; ++x)
+				selectNode(x, z, rootLod, camera, frustum);
+		}
+
+		streamTiles(jobs);
+
+		m_tilesLoadedStat.add(static_cast<std::int64_t>(m_stats.tilesLoaded));
+		m_tilesPendingStat.set(static_cast<double>(m_stats.tilesPending));
+		m_tilesMissingStat.set(static_cast<double>(m_stats.tilesMissing));
+	}
+
+	void Terrain::collectTiles()
+	{
+		if(m_pending.empty() || !m_streaming.done())
+			return;
+		for(std::size_t i = 0; i < m_pending.size(); ++i)
+		{
+			m_tileSlots[m_pendingKeys[i]] = m_pending[i];
+			m_loaded.push_back(m_pending[i]);
+		}
+		m_stats.tilesLoaded += m_pending.size();
+		m_pending.clear();
+		m_pendingKeys.clear();
+	}
+
+	void Terrain::streamTiles(JobSystem* jobs)
+	{
+		m_missing.clear();
+		for(const TerrainPatch& patch : m_patches)
+		{
+			glm::ivec2 const tile = tileOf(patch);
+			std::uint32_t const slot = findTile(patch.lod, tile.x, tile.y);
+			if(slot != invalidTile)
+				m_tileUsed[slot] = m_frame;
+			else
+				m_missing.push_back(tileKey(patch.lod, tile.x, tile.y));
+		}
+		std::sort(m_missing.begin(), m_missing.end());
+		m_missing.erase(std::unique(m_missing.begin(), m_missing.end()), m_missing.end());
+
+		// The pending keys were taken in order from a sorted m_missing, so they are sorted too
+		for(std::uint32_t slot : m_pending)
+			m_tileUsed[slot] = m_frame;
+		m_missing.erase(std::remove_if(m_missing.begin(), m_missing.end(), [this](std::uint64_t key)
+		{
+			return std::binary_search(m_pendingKeys.begin(), m_pendingKeys.end(), key);
+		}), m_missing.end());
+
+		std::size_t loads = 0;
+		if(!m_missing.empty() && m_pending.empty())
+		{
+			// Free slots have never been used so they go first, then the least recently used
+			m_victims.clear();
+			for(std::uint32_t slot = 0; slot < m_tileUsed.size(); ++slot)
+			{
+				if(m_tileUsed[slot] < m_frame)
+					m_victims.push_back(slot);
+			}
+			loads = std::min(m_missing.size(), m_victims.size());
+			std::partial_sort(m_victims.begin(), m_victims.begin() + loads, m_victims.end(), [this](std::uint32_t a, std::uint32_t b)
+			{
+				return m_tileUsed[a] < m_tileUsed[b];
+			});
+
+			for(std::size_t i = 0; i < loads; ++i)
+			{
+				std::uint32_t const slot = m_victims[i];
+				if(m_tileUsed[slot] != 0)
+				{
+					m_tileSlots.erase(tileKey(m_tileLevel[slot], m_tileCoordinates[slot].x, m_tileCoordinates[slot].y));
+					++m_stats.tilesEvicted;
+				}
+				std::uint64_t const key = m_missing[i];
+				m_tileLevel[slot] = static_cast<std::uint32_t>(key >> 56);
+				m_tileCoordinates[slot] = glm::ivec2(unpackCoordinate(key >> 28), unpackCoordinate(key));
+				m_tileUsed[slot] = m_frame;
+				m_pending.push_back(slot);
+				m_pendingKeys.push_back(key);
+			}
+
+			if(jobs && jobs->workerCount() > 0)
+			{
+				// Neither height nor the patches see the slots until collectTiles, so the jobs can fill them meanwhile
+				m_streamingJobs = jobs;
+				for(std::uint32_t slot : m_pending)
+					jobs->run([this, slot]() { loadTile(slot); }, m_streaming);
+			}
+			else
+			{
+				parallelFor(jobs, m_pending.size(), 1, [this](std::size_t begin, std::size_t end)
+				{
+					for(std::size_t i = begin; i < end; ++i)
+						loadTile(m_pending[i]);
+				});
+				collectTiles();
+			}
+		}
+		m_stats.tilesPending = m_pending.size();
+		m_stats.tilesMissing = m_missing.size() - loads;
+
+		for(TerrainPatch& patch : m_patches)
+		{
+			glm::ivec2 const tile = tileOf(patch);
+			patch.tile = findTile(patch.lod, tile.x, tile.y);
+		}
+		m_patches.erase(std::remove_if(m_patches.begin(), m_patches.end(), [](const TerrainPatch& patch) { return patch.tile == invalidTile; }), m_patches.end());
+	}
+
+	void Terrain::loadTile(std::uint32_t tile)
+	{
+		float* heights = m_heights.data() + tile * m_tileSamples;
+		unsigned const stride = m_tileCells + 1;
+		m_source.generate(tileOrigin(tile), vertexSpacing(m_tileLevel[tile]), stride, heights);
+
+		glm::vec2* bounds = m_blockBounds.data() + tile * m_blocksPerTile * m_blocksPerTile;
+		for(unsigned blockZ = 0; blockZ < m_blocksPerTile; ++blockZ)
+		{
+			for(unsigned blockX = 0; blockX < m_blocksPerTile; ++blockX)
+			{
+				glm::vec2 range(heights[blockZ * m_gridCells * stride + blockX * m_gridCells]);
+				for(unsigned z = blockZ * m_gridCells; z <= (blockZ + 1) * m_gridCells; ++z)
+				{
+					const float* row = heights + z * stride;
+					for(unsigned x = blockX * m_gridCells; x <= (blockX + 1) * m_gridCells; ++x)
+						range = glm::vec2(glm::min(range.x, row[x]), glm::max(range.y, row[x]));
+				}
+				bounds[blockZ * m_blocksPerTile + blockX] = range;
+			}
+		}
+	}
+
+	float Terrain::height(float x, float z) const
+	{
+		for(unsigned level = 0; level < m_settings.lodCount; ++level)
+		{
+			float const tileSize = vertexSpacing(level) * m_tileCells;
+			std::uint32_t const tile = findTile(level, static_cast<std::int32_t>(glm::floor(x / tileSize)), static_cast<std::int32_t>(glm::floor(z / tileSize)));
+			if(tile != invalidTile)
+				return sampleTile(tile, x, z);
+		}
+		float result = 0.0f;
+		m_source.generate(glm::vec2(x, z), 1.0f, 1, &result);
+		return result;
+	}
+
+	void Terrain::heights(const glm::vec2* points, std::size_t count, float* results, JobSystem* jobs) const
+	{
+		parallelFor(jobs, count, 1024, [&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t i = begin; i < end; ++i)
+				results[i] = height(points[i].x, points[i].y);
+		});
+	}
+
+	void Terrain::patchVertices(const TerrainPatch& patch, const glm::vec3& camera, std::vector<glm::vec3>& positions) const
+	{
+		positions.clear();
+		float const spacing = vertexSpacing(patch.lod);
+		glm::vec2 const morph = m_morph[patch.lod];
+		for(const glm::vec2& vertex : m_grid.vertices())
+		{
+			glm::vec2 const flat = patch.origin + vertex * spacing;
+			float const distance = glm::distance(camera, glm::vec3(flat.x, sampleTile(patch.tile, flat.x, flat.y), flat.y));
+			float const k = glm::clamp((distance - morph.x) / (morph.y - morph.x), 0.0f, 1.0f);
+			// Odd vertices slide onto their even neighbor, where the coarser grid has its vertices
+			glm::vec2 const morphed = patch.origin + (vertex - glm::fract(vertex * 0.5f) * 2.0f * k) * spacing;
+			positions.push_back(glm::vec3(morphed.x, sampleTile(patch.tile, morphed.x, morphed.y), morphed.y));
+		}
+	}
+}
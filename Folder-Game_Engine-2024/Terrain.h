@@ -0,0 +1,214 @@
+#pragma once
+
+#include "Bounds.h"
+#include "JobSystem.h"
+#include "Stats.h"
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace engine
+{
+	std::uint32_t const invalidTile = 0xFFFFFFFFu;
+
+	// Fills height tiles on demand. Called from worker threads, so generate must be safe to run concurrently.
+	class HeightSource
+	{
+	public:
+		virtual ~HeightSource() {}
+
+		// resolution x resolution heights, row by row along x, the first at origin and spacing apart on x and z
+		virtual void generate(const glm::vec2& origin, float spacing, unsigned resolution, float* heights) const = 0;
+		// Lowest and highest height the source can return, bounds the terrain before its tiles are loaded
+		virtual glm::vec2 heightRange() const = 0;
+	};
+
+	// Fractal sum of glm::simplex octaves, each twice the frequency and half the amplitude of the previous one
+	class NoiseHeightSource : public HeightSource
+	{
+	public:
+		NoiseHeightSource(float amplitude = 300.0f, float wavelength = 2000.0f, unsigned octaves = 7, const glm::vec2& offset = glm::vec2(0.0f));
+
+		void generate(const glm::vec2& origin, float spacing, unsigned resolution, float* heights) const override;
+		glm::vec2 heightRange() const override;
+
+		float sample(float x, float z) const;
+
+	private:
+		float m_amplitude;
+		float m_frequency;
+		unsigned m_octaves;
+		glm::vec2 m_offset;
+	};
+
+	struct TerrainSettings
+	{
+		float leafSize;           // Side of a lod 0 patch in meters
+		unsigned gridResolution;  // Vertices along a patch side, a power of two plus one
+		unsigned tileResolution;  // Heights along a tile side, a multiple of the patch cells plus one
+		unsigned lodCount;        // Patch sizes double with every lod, the last is the size of the root nodes
+		float lodRange;           // Distance up to which lod 0 patches are used, doubles with every lod
+		float morphStart;         // Fraction of a lod's distance band after which it morphs into the next lod
+		unsigned maxCachedTiles;  // Height tiles kept in memory at most
+
+		TerrainSettings() : leafSize(32.0f), gridResolution(33), tileResolution(129), lodCount(8), lodRange(96.0f), morphStart(0.7f), maxCachedTiles(96) {}
+	};
+
+	// One patch-sized vertex grid shared by all the patches, which are placed, scaled and displaced in the vertex
+	// shader. The indices are ordered by quadrant so a patch drawing only some quadrants uses sub-ranges of the same
+	// index buffer.
+	class TerrainGrid
+	{
+	public:
+		explicit TerrainGrid(unsigned resolution);
+
+		unsigned resolution() const { return m_resolution; }
+		// Integer grid coordinates, 0 to resolution - 1
+		const std::vector<glm::vec2>& vertices() const { return m_vertices; }
+		const std::vector<std::uint16_t>& indices() const { return m_indices; }
+
+		// Quadrant bits are 1 for (-x, -z), 2 for (+x, -z), 4 for (-x, +z) and 8 for (+x, +z)
+		std::size_t quadrantOffset(unsigned quadrant) const { return m_indices.size() / 4 * quadrant; }
+		std::size_t quadrantCount() const { return m_indices.size() / 4; }
+
+	private:
+		unsigned m_resolution;
+		std::vector<glm::vec2> m_vertices;
+		std::vector<std::uint16_t> m_indices;
+	};
+
+	// A quadtree node drawn at its lod, or some of its quadrants when the others are drawn by finer children
+	struct TerrainPatch
+	{
+		glm::vec2 origin;
+		float size;
+		std::uint32_t lod;
+		std::uint32_t quadrants;
+		std::uint32_t tile; // Cache slot of the heights the patch reads, tiles of level lod have the same spacing as its vertices
+	};
+
+	struct TerrainStats
+	{
+		std::size_t nodesVisited;
+		std::size_t tilesLoaded;
+		std::size_t tilesEvicted;
+		std::size_t tilesPending; // Being generated by jobs at the end of the update, their patches are dropped until then
+		std::size_t tilesMissing; // Needed this update but neither resident nor pending, their patches are dropped
+
+		TerrainStats() : nodesVisited(0), tilesLoaded(0), tilesEvicted(0), tilesPending(0), tilesMissing(0) {}
+	};
+
+	// Chunked level of detail terrain after CDLOD (Strugar 2010). Every update walks a quadtree from root nodes around
+	// the camera and picks patches whose size grows with distance. Vertices morph into the next coarser grid over the
+	// last part of their lod's distance band, so neighbors of different lods meet without cracks or popping.
+	//
+	// Heights are streamed in square tiles from a HeightSource into a cache of fixed size, evicted least recently used.
+	// Patches of lod l read tiles of level l, sampled at the same spacing as their vertices, so the tiles needed stay
+	// about the same number at every level and memory is bounded no matter how far the view distance reaches.
+	//
+	// With a JobSystem that has workers, missing tiles are generated by jobs while the frame goes on and become
+	// resident in a later update. Only one batch of tiles is generated at a time, the tiles missing meanwhile are
+	// started once it is collected. Patches whose tile isn't resident yet are dropped.
+	//
+	// With a StatsRegistry every update publishes terrain.tiles_loaded, and the backlog as terrain.tiles_pending and
+	// terrain.tiles_missing.
+	class Terrain
+	{
+	public:
+		explicit Terrain(const HeightSource& source, const TerrainSettings& settings = TerrainSettings(), StatsRegistry* stats = nullptr);
+		~Terrain();
+
+		Terrain(const Terrain&) = delete;
+		Terrain& operator=(const Terrain&) = delete;
+
+		const TerrainSettings& settings() const { return m_settings; }
+		const TerrainGrid& grid() const { return m_grid; }
+
+		// Selects the patches for a camera, collects the tiles generated since the last update and starts generating
+		// the missing ones. Without jobs, or without workers to run them, tiles are generated before it returns.
+		void update(const glm::vec3& camera, const Frustum& frustum, JobSystem* jobs = nullptr);
+		// Waits for the tiles being generated and makes them resident, the next update draws them
+		void finishStreaming();
+		std::size_t pendingTiles() const { return m_pending.size(); }
+
+		const std::vector<TerrainPatch>& patches() const { return m_patches; }
+		const TerrainStats& stats() const { return m_stats; }
+
+		float patchSize(unsigned lod) const { return m_settings.leafSize * static_cast<float>(1u << lod); }
+		float vertexSpacing(unsigned lod) const { return m_spacing * static_cast<float>(1u << lod); }
+		// Distance band over which patches of lod morph into lod + 1, for the vertex shader
+		glm::vec2 morphRange(unsigned lod) const { return m_morph[lod]; }
+		float viewDistance() const { return m_ranges.back(); }
+
+		// Cache slots are stable until evicted. The slots made resident by the last update are listed so a renderer only
+		// uploads those, to the texture array layer of the same index for instance.
+		std::size_t tileCapacity() const { return m_tileLevel.size(); }
+		std::size_t residentTiles() const { return m_tileSlots.size(); }
+		std::size_t memoryBytes() const { return m_heights.size() * sizeof(float) + m_blockBounds.size() * sizeof(glm::vec2); }
+		const std::vector<std::uint32_t>& loadedTiles() const { return m_loaded; }
+		const float* tileHeights(std::uint32_t tile) const { return m_heights.data() + tile * m_tileSamples; }
+		glm::vec2 tileOrigin(std::uint32_t tile) const;
+		unsigned tileResolution() const { return m_tileCells + 1; }
+
+		// Bilinear height from the finest resident tile covering (x, z), from the source if none does. Safe to call
+		// from any number of threads between updates.
+		float height(float x, float z) const;
+		void heights(const glm::vec2* points, std::size_t count, float* results, JobSystem* jobs = nullptr) const;
+
+		// World positions of all of the patch's grid vertices after the morph, as the vertex shader places them
+		void patchVertices(const TerrainPatch& patch, const glm::vec3& camera, std::vector<glm::vec3>& positions) const;
+
+	private:
+		std::uint64_t tileKey(unsigned level, std::int32_t x, std::int32_t z) const;
+		std::uint32_t findTile(unsigned level, std::int32_t x, std::int32_t z) const;
+		glm::ivec2 tileOf(const TerrainPatch& patch) const;
+		float sampleTile(std::uint32_t tile, float x, float z) const;
+		Aabb nodeBounds(std::int32_t x, std::int32_t z, unsigned lod) const;
+		void selectNode(std::int32_t x, std::int32_t z, unsigned lod, const glm::vec3& camera, const Frustum& frustum);
+		void collectTiles();
+		void streamTiles(JobSystem* jobs);
+		void loadTile(std::uint32_t tile);
+
+		const HeightSource& m_source;
+		TerrainSettings m_settings;
+		unsigned m_gridCells;
+		unsigned m_tileCells;
+		unsigned m_blocksPerTile; // Nodes along a tile side at the tile's level
+		float m_spacing;          // Between the vertices of lod 0 patches and the heights of level 0 tiles
+		glm::vec2 m_heightRange;
+		std::vector<float> m_ranges;
+		std::vector<glm::vec2> m_morph;
+		TerrainGrid m_grid;
+
+		std::vector<TerrainPatch> m_patches;
+		TerrainStats m_stats;
+		std::uint64_t m_frame;
+		StatCounter m_tilesLoadedStat;
+		StatGauge m_tilesPendingStat;
+		StatGauge m_tilesMissingStat;
+
+		// Tile cache, the heights of slot i start at i * m_tileSamples
+		std::size_t m_tileSamples;
+		std::vector<float> m_heights;
+		std::vector<glm::vec2> m_blockBounds; // Lowest and highest height under each node of the tile's level
+		std::vector<std::uint32_t> m_tileLevel;
+		std::vector<glm::ivec2> m_tileCoordinates;
+		std::vector<std::uint64_t> m_tileUsed; // Last update that read the tile, 0 for a free slot
+		std::unordered_map<std::uint64_t, std::uint32_t> m_tileSlots;
+
+		// Slots being generated by jobs, only added to m_tileSlots once m_streaming is done
+		std::vector<std::uint32_t> m_pending;
+		std::vector<std::uint64_t> m_pendingKeys;
+		JobSystem* m_streamingJobs;
+		JobCounter m_streaming;
+
+		// Per update
+		std::vector<std::uint64_t> m_missing;
+		std::vector<std::uint32_t> m_loaded;
+		std::vector<std::uint32_t> m_victims;
+	};
+}
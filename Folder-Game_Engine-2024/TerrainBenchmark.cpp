@@ -0,0 +1,259 @@
+#include "Benchmark.h"
+#include "Stats.h"
+#include "Terrain.h"
+
+#include <gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	int const frameCount = 600;
+	float const flightSpeed = 20.0f; // Meters per frame, 1200 m/s at 60 Hz
+	float const altitude = 20.0f;
+	std::size_t const queryCount = 1000000;
+
+	glm::vec3 flightPosition(const engine::NoiseHeightSource& source, int frame)
+	{
+		float const t = static_cast<float>(frame);
+		glm::vec2 const flat(t * flightSpeed, 3000.0f * glm::sin(t * 0.004f));
+		return glm::vec3(flat.x, source.sample(flat.x, flat.y) + altitude, flat.y);
+	}
+
+	engine::Frustum flightFrustum(const engine::Terrain& terrain, const glm::vec3& camera, const glm::vec3& ahead)
+	{
+		glm::mat4 const view = glm::lookAt(camera, ahead, glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 const projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.5f, terrain.viewDistance());
+		return engine::Frustum::fromMatrix(projection * view);
+	}
+
+	// A quadrant of a patch, the unit the renderer draws
+	struct Square
+	{
+		std::size_t patch;
+		glm::vec2 min;
+		glm::vec2 max;
+	};
+
+	// Height of a patch's morphed surface along one of its grid lines, the one at coordinate line on axis
+	float lineHeight(const engine::Terrain& terrain, const engine::TerrainPatch& patch, const std::vector<glm::vec3>& positions, int axis, float line, float along)
+	{
+		int const other = 2 - axis;
+		int const resolution = static_cast<int>(terrain.grid().resolution());
+		int const index = static_cast<int>(glm::round((line - patch.origin[axis / 2]) / terrain.vertexSpacing(patch.lod)));
+		float result = 0.0f;
+		for(int i = 0; i + 1 < resolution; ++i)
+		{
+			const glm::vec3& a = axis == 0 ? positions[i * resolution + index] : positions[index * resolution + i];
+			const glm::vec3& b = axis == 0 ? positions[(i + 1) * resolution + index] : positions[index * resolution + i + 1];
+			if(along >= a[other] && along <= b[other])
+				return b[other] > a[other] ? glm::mix(a.y, b.y, (along - a[other]) / (b[other] - a[other])) : a.y;
+			result = b.y;
+		}
+		return result;
+	}
+
+	// Largest vertical gap between the border vertices of every drawn quadrant and the surface of the patch
+	// drawn across the border. Cracks show up as T-junctions that didn't finish morphing.
+	float seamGap(const engine::Terrain& terrain, const glm::vec3& camera, std::size_t& lodJumps)
+	{
+		const std::vector<engine::TerrainPatch>& patches = terrain.patches();
+		std::vector<std::vector<glm::vec3> > positions(patches.size());
+		std::vector<Square> squares;
+		for(std::size_t p = 0; p < patches.size(); ++p)
+		{
+			terrain.patchVertices(patches[p], camera, positions[p]);
+			float const half = patches[p].size * 0.5f;
+			for(unsigned quadrant = 0; quadrant < 4; ++quadrant)
+			{
+				if(patches[p].quadrants & (1u << quadrant))
+				{
+					Square square;
+					square.patch = p;
+					square.min = patches[p].origin + glm::vec2(quadrant & 1, quadrant >> 1) * half;
+					square.max = square.min + half;
+					squares.push_back(square);
+				}
+			}
+		}
+
+		int const resolution = static_cast<int>(terrain.grid().resolution());
+		float gap = 0.0f;
+		lodJumps = 0;
+		for(const Square& square : squares)
+		{
+			const engine::TerrainPatch& patch = patches[square.patch];
+			for(int axis = 0; axis <= 2; axis += 2)
+			{
+				int const other = 2 - axis;
+				for(int side = 0; side < 2; ++side)
+				{
+					float const line = side == 0 ? square.min[axis / 2] : square.max[axis / 2];
+					glm::vec2 outside = (square.min + square.max) * 0.5f;
+					outside[axis / 2] = line + (side == 0 ? -0.01f : 0.01f);
+					const Square* neighbor = nullptr;
+					for(const Square& candidate : squares)
+					{
+						if(outside.x >= candidate.min.x && outside.x < candidate.max.x && outside.y >= candidate.min.y && outside.y < candidate.max.y)
+							neighbor = &candidate;
+					}
+					if(!neighbor || neighbor->patch == square.patch)
+						continue;
+					const engine::TerrainPatch& across = patches[neighbor->patch];
+					lodJumps += glm::abs(static_cast<int>(across.lod) - static_cast<int>(patch.lod)) > 1 ? 1 : 0;
+
+					int const index = static_cast<int>(glm::round((line - patch.origin[axis / 2]) / terrain.vertexSpacing(patch.lod)));
+					for(int i = 0; i < resolution; ++i)
+					{
+						const glm::vec3& vertex = axis == 0 ? positions[square.patch][i * resolution + index] : positions[square.patch][index * resolution + i];
+						float const along = vertex[other];
+						float const overlapMin = glm::max(square.min[other / 2], neighbor->min[other / 2]);
+						float const overlapMax = glm::min(square.max[other / 2], neighbor->max[other / 2]);
+						if(along < overlapMin || along > overlapMax)
+							continue;
+						gap = glm::max(gap, glm::abs(vertex.y - lineHeight(terrain, across, positions[neighbor->patch], axis, line, along)));
+					}
+				}
+			}
+		}
+		return gap;
+	}
+}
+
+ENGINE_BENCHMARK(Terrain)
+{
+	engine::NoiseHeightSource const source;
+	engine::StatsRegistry stats;
+	engine::Terrain terrain(source, engine::TerrainSettings(), &stats);
+	context.report("view distance", terrain.viewDistance(), "m");
+	context.report("cache capacity", static_cast<double>(terrain.tileCapacity()), "tiles");
+	context.report("cache memory", terrain.memoryBytes() / (1024.0 * 1024.0), "MB");
+
+	// Tiles are generated on workers of their own, so updates never generate them on the calling thread even
+	// where the shared pool has no workers
+	engine::JobSystem streaming(std::max(2u, context.jobs().workerCount()));
+
+	engine::Stopwatch timer;
+	glm::vec3 camera = flightPosition(source, 0);
+	terrain.update(camera, flightFrustum(terrain, camera, flightPosition(source, 10)), &streaming);
+	context.report("first update", timer.elapsedMs(), "ms");
+	context.report("first update tiles pending", static_cast<double>(terrain.stats().tilesPending), "");
+	timer.restart();
+	terrain.finishStreaming();
+	context.report("first tiles generated", timer.elapsedMs(), "ms");
+
+	double totalMs = 0.0;
+	double maxMs = 0.0;
+	double patches = 0.0;
+	double triangles = 0.0;
+	double nodes = 0.0;
+	std::size_t loads = 0;
+	std::size_t maxLoads = 0;
+	std::size_t evictions = 0;
+	std::size_t missing = 0;
+	std::size_t pending = 0;
+	std::size_t maxPending = 0;
+	engine::Frustum frustum;
+	std::size_t const quadrantTriangles = terrain.grid().quadrantCount() / 3;
+	// Paced at 60 Hz like a frame loop, the tiles are generated in the time left between updates
+	std::chrono::steady_clock::time_point nextFrame = std::chrono::steady_clock::now();
+	for(int frame = 1; frame < frameCount; ++frame)
+	{
+		nextFrame += std::chrono::microseconds(16667);
+		std::this_thread::sleep_until(nextFrame);
+		camera = flightPosition(source, frame);
+		frustum = flightFrustum(terrain, camera, flightPosition(source, frame + 10));
+		timer.restart();
+		terrain.update(camera, frustum, &streaming);
+		double const elapsed = timer.elapsedMs();
+		totalMs += elapsed;
+		maxMs = std::max(maxMs, elapsed);
+		patches += static_cast<double>(terrain.patches().size());
+		nodes += static_cast<double>(terrain.stats().nodesVisited);
+		for(const engine::TerrainPatch& patch : terrain.patches())
+		{
+			for(unsigned quadrant = 0; quadrant < 4; ++quadrant)
+				triangles += (patch.quadrants >> quadrant & 1u) * quadrantTriangles;
+		}
+		loads += terrain.stats().tilesLoaded;
+		maxLoads = std::max(maxLoads, terrain.stats().tilesLoaded);
+		evictions += terrain.stats().tilesEvicted;
+		missing += terrain.stats().tilesMissing;
+		pending += terrain.stats().tilesPending;
+		maxPending = std::max(maxPending, terrain.stats().tilesPending);
+		stats.endFrame();
+	}
+	int const updates = frameCount - 1;
+	context.report("update", totalMs / updates, "ms");
+	context.report("update max", maxMs, "ms");
+	context.report("nodes visited", nodes / updates, "");
+	context.report("patches", patches / updates, "");
+	context.report("triangles", triangles / updates, "");
+	context.report("tiles loaded per update", static_cast<double>(loads) / updates, "");
+	context.report("tiles loaded max", static_cast<double>(maxLoads), "");
+	context.report("tiles evicted", static_cast<double>(evictions), "");
+	context.report("tiles missing", static_cast<double>(missing), "");
+	context.report("tiles pending per update", static_cast<double>(pending) / updates, "");
+	context.report("tiles pending max", static_cast<double>(maxPending), "");
+
+	// The registry's last frame is the last update's stats
+	std::vector<engine::StatSummary> summaries;
+	stats.summarize(summaries);
+	std::size_t published = 0;
+	for(const engine::StatSummary& summary : summaries)
+	{
+		std::string const name = summary.name;
+		published += (name == "terrain.tiles_loaded" && summary.last == static_cast<double>(terrain.stats().tilesLoaded))
+			+ (name == "terrain.tiles_pending" && summary.last == static_cast<double>(terrain.stats().tilesPending))
+			+ (name == "terrain.tiles_missing" && summary.last == static_cast<double>(terrain.stats().tilesMissing));
+	}
+	context.report("backlog published", published == 3 ? 1.0 : 0.0, "ok");
+
+	// Every tile of the last position resident, for the seams and the height queries
+	while(terrain.pendingTiles() > 0)
+	{
+		terrain.finishStreaming();
+		terrain.update(camera, frustum, &streaming);
+	}
+	context.report("resident tiles", static_cast<double>(terrain.residentTiles()), "");
+
+	std::vector<std::size_t> perLod(terrain.settings().lodCount, 0);
+	for(const engine::TerrainPatch& patch : terrain.patches())
+		++perLod[patch.lod];
+	for(unsigned lod = 0; lod < perLod.size(); ++lod)
+		context.report(("lod " + std::to_string(lod) + " patches").c_str(), static_cast<double>(perLod[lod]), "");
+
+	std::size_t lodJumps = 0;
+	context.report("max seam gap", seamGap(terrain, camera, lodJumps), "m");
+	context.report("neighbors more than one lod apart", static_cast<double>(lodJumps), "");
+
+	// Physics queries around the camera, all inside resident level 0 tiles
+	std::mt19937 random(45);
+	std::uniform_real_distribution<float> offset(-100.0f, 100.0f);
+	std::vector<glm::vec2> points(queryCount);
+	for(glm::vec2& point : points)
+		point = glm::vec2(camera.x, camera.z) + glm::vec2(offset(random), offset(random));
+	std::vector<float> heights(queryCount);
+	timer.restart();
+	terrain.heights(points.data(), points.size(), heights.data());
+	context.report("height queries per ms single thread", queryCount / timer.elapsedMs(), "");
+	timer.restart();
+	terrain.heights(points.data(), points.size(), heights.data(), &context.jobs());
+	context.report("height queries per ms", queryCount / timer.elapsedMs(), "");
+
+	double error = 0.0;
+	float maxError = 0.0f;
+	for(std::size_t i = 0; i < 10000; ++i)
+	{
+		float const difference = glm::abs(heights[i] - source.sample(points[i].x, points[i].y));
+		error += difference;
+		maxError = glm::max(maxError, difference);
+	}
+	context.report("bilinear error mean", error / 10000, "m");
+	context.report("bilinear error max", maxError, "m");
+}
@@ -0,0 +1,330 @@
+#include "Benchmark.h"
+#include "GlyphCache.h"
+#include "SpriteBatch.h"
+#include "TextLayout.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	int const frameCount = 30;
+	float const screenWidth = 1920.0f;
+	float const screenHeight = 1080.0f;
+	std::uint32_t const firstIdeograph = 0x4E00;
+	std::uint32_t const ideographCount = 4000;
+	std::uint32_t const ideographWindow = 160;
+	std::uint32_t const ideographScroll = 40;
+
+	// Stands in for a TrueType font: printable ASCII and a block of ideographs drawn as seven segment style bars
+	// picked by a hash of the codepoint, antialiased with 4x4 samples per pixel
+	class SegmentFont : public engine::GlyphRasterizer
+	{
+	public:
+		unsigned pixelSize() const override { return 48; }
+		float ascent() const override { return 38.0f; }
+		float lineHeight() const override { return 56.0f; }
+
+		bool rasterize(std::uint32_t codepoint, engine::GlyphBitmap& bitmap) const override
+		{
+			bool const ideograph = codepoint >= firstIdeograph && codepoint < firstIdeograph + ideographCount;
+			if(codepoint == ' ')
+			{
+				bitmap.metrics.advance = 14.0f;
+				return true;
+			}
+			if(!ideograph && (codepoint < 33 || codepoint > 126))
+				return false;
+
+			unsigned const width = ideograph ? 44 : 24;
+			unsigned const height = ideograph ? 44 : 36;
+			std::uint32_t const bits = (codepoint * 2654435761u) >> 7 | 1;
+			bitmap.width = width;
+			bitmap.height = height;
+			bitmap.coverage.assign(width * height, 0);
+			bitmap.metrics.offset = glm::vec2(2.0f, -static_cast<float>(height));
+			bitmap.metrics.size = glm::vec2(static_cast<float>(width), static_cast<float>(height));
+			bitmap.metrics.advance = static_cast<float>(width) + 4.0f;
+
+			// Three horizontal and four vertical bars, then a diagonal
+			float const thickness = 5.0f;
+			float const w = static_cast<float>(width);
+			float const h = static_cast<float>(height);
+			glm::vec4 const bars[7] = {
+				glm::vec4(0.0f, 0.0f, w, thickness), glm::vec4(0.0f, (h - thickness) * 0.5f, w, (h + thickness) * 0.5f), glm::vec4(0.0f, h - thickness, w, h),
+				glm::vec4(0.0f, 0.0f, thickness, h * 0.5f), glm::vec4(w - thickness, 0.0f, w, h * 0.5f),
+				glm::vec4(0.0f, h * 0.5f, thickness, h), glm::vec4(w - thickness, h * 0.5f, w, h) };
+			bool const diagonal = (bits & 0x80) != 0;
+			for(unsigned y = 0; y < height; ++y)
+			{
+				for(unsigned x = 0; x < width; ++x)
+				{
+					int samples = 0;
+					for(int s = 0; s < 16; ++s)
+					{
+						glm::vec2 const p(x + (s % 4 + 0.5f) * 0.25f, y + (s / 4 + 0.5f) * 0.25f);
+						bool inside = diagonal && glm::abs(p.x / w - p.y / h) * glm::min(w, h) < thickness * 0.5f;
+						for(int bar = 0; bar < 7 && !inside; ++bar)
+							inside = (bits >> bar & 1) != 0 && p.x >= bars[bar].x && p.y >= bars[bar].y && p.x < bars[bar].z && p.y < bars[bar].w;
+						samples += inside ? 1 : 0;
+					}
+					bitmap.coverage[y * width + x] = static_cast<std::uint8_t>(samples * 255 / 16);
+				}
+			}
+			return true;
+		}
+	};
+
+	std::string utf8(std::uint32_t codepoint)
+	{
+		std::string text;
+		if(codepoint < 0x80)
+			text += static_cast<char>(codepoint);
+		else if(codepoint < 0x800)
+		{
+			text += static_cast<char>(0xC0 | codepoint >> 6);
+			text += static_cast<char>(0x80 | (codepoint & 0x3F));
+		}
+		else
+		{
+			text += static_cast<char>(0xE0 | codepoint >> 12);
+			text += static_cast<char>(0x80 | (codepoint >> 6 & 0x3F));
+			text += static_cast<char>(0x80 | (codepoint & 0x3F));
+		}
+		return text;
+	}
+
+	// Random words of printable characters, about length bytes
+	std::string words(std::mt19937& random, std::size_t length)
+	{
+		std::uniform_int_distribution<int> character(33, 126);
+		std::uniform_int_distribution<int> wordLength(2, 9);
+		std::string text;
+		while(text.size() < length)
+		{
+			for(int i = wordLength(random); i > 0; --i)
+				text += static_cast<char>(character(random));
+			text += ' ';
+		}
+		return text;
+	}
+}
+
+ENGINE_BENCHMARK(Text)
+{
+	// Distance field accuracy against a disk, within the spread
+	{
+		unsigned const size = 64;
+		unsigned const spread = 6;
+		float const radius = 20.0f;
+		glm::vec2 const center(32.0f);
+		std::vector<std::uint8_t> coverage(size * size);
+		for(unsigned y = 0; y < size; ++y)
+		{
+			for(unsigned x = 0; x < size; ++x)
+			{
+				int samples = 0;
+				for(int s = 0; s < 16; ++s)
+					samples += glm::distance(glm::vec2(x + (s % 4 + 0.5f) * 0.25f, y + (s / 4 + 0.5f) * 0.25f), center) < radius ? 1 : 0;
+				coverage[y * size + x] = static_cast<std::uint8_t>(samples * 255 / 16);
+			}
+		}
+		std::vector<std::uint8_t> field;
+		engine::Stopwatch timer;
+		engine::generateDistanceField(coverage.data(), size, size, spread, field);
+		double const fieldMs = timer.elapsedMs();
+		unsigned const fieldSize = size + spread * 2;
+		double errorSum = 0.0;
+		double errorMax = 0.0;
+		std::size_t samples = 0;
+		for(unsigned y = 0; y < fieldSize; ++y)
+		{
+			for(unsigned x = 0; x < fieldSize; ++x)
+			{
+				float const exact = radius - glm::distance(glm::vec2(x + 0.5f, y + 0.5f) - glm::vec2(static_cast<float>(spread)), center);
+				if(glm::abs(exact) >= spread - 1.0f)
+					continue;
+				float const decoded = (field[y * fieldSize + x] - 128.0f) / 127.0f * spread;
+				errorSum += glm::abs(decoded - exact);
+				errorMax = glm::max<double>(errorMax, glm::abs(decoded - exact));
+				++samples;
+			}
+		}
+		context.report("distance field 76x76", fieldMs, "ms");
+		context.report("distance error mean", errorSum / samples, "px");
+		context.report("distance error max", errorMax, "px");
+	}
+
+	SegmentFont font;
+	std::mt19937 random(48);
+
+	// A screen of text in three sizes, the top lines rewritten every frame like counters on a HUD
+	std::vector<std::string> lines;
+	std::vector<float> sizes;
+	float const sizeCycle[3] = { 14.0f, 18.0f, 24.0f };
+	for(float y = 0.0f; y < screenHeight;)
+	{
+		float const size = sizeCycle[lines.size() % 3];
+		lines.push_back(words(random, static_cast<std::size_t>(screenWidth / (size * 0.55f))));
+		sizes.push_back(size);
+		y += size * font.lineHeight() / font.pixelSize();
+	}
+	std::size_t const dynamicLines = 6;
+
+	std::string all;
+	for(const std::string& line : lines)
+		all += line;
+	engine::Stopwatch timer;
+	{
+		engine::GlyphCache serial(font);
+		serial.prepare(all.c_str(), nullptr);
+		context.report("glyph generation single thread", timer.elapsedMs() / serial.stats().generated * 1000.0, "us");
+	}
+	engine::GlyphCache glyphs(font);
+	timer.restart();
+	glyphs.prepare(all.c_str(), &context.jobs());
+	double const prepareMs = timer.elapsedMs();
+	context.report("glyph generation", prepareMs / glyphs.stats().generated * 1000.0, "us");
+	context.report("glyphs", static_cast<double>(glyphs.stats().generated), "");
+
+	engine::TextLayoutCache layouts;
+	engine::SpriteBatch batch(65536);
+	std::vector<engine::SpriteVertex> vertices(batch.maxSprites() * 4);
+	double layoutMs = 0.0;
+	double batchMs = 0.0;
+	double frameMs = 0.0;
+	std::size_t sprites = 0;
+	char counter[64];
+	for(int frame = 0; frame < frameCount; ++frame)
+	{
+		engine::Stopwatch frameTimer;
+		glyphs.nextFrame();
+		batch.clear();
+		float y = 0.0f;
+		for(std::size_t line = 0; line < lines.size(); ++line)
+		{
+			const char* text = lines[line].c_str();
+			if(line < dynamicLines)
+			{
+				std::snprintf(counter, sizeof(counter), "frame %d  line %u  %.3f ms", frame, static_cast<unsigned>(line), frameMs / glm::max(frame, 1));
+				text = counter;
+			}
+			float const scale = sizes[line] / font.pixelSize();
+			timer.restart();
+			const engine::TextLayout& layout = layouts.layout(glyphs, text, screenWidth / scale);
+			layoutMs += timer.elapsedMs();
+			timer.restart();
+			engine::drawText(batch, glyphs, layout, glm::vec2(0.0f, y), sizes[line], 0xFFFFFFFFu, 0);
+			batchMs += timer.elapsedMs();
+			y += sizes[line] * font.lineHeight() / font.pixelSize();
+		}
+		batch.sort();
+		batch.writeVertices(vertices.data(), 0, batch.spriteCount(), &context.jobs());
+		frameMs += frameTimer.elapsedMs();
+		sprites = batch.spriteCount();
+	}
+	context.report("text lines", static_cast<double>(lines.size()), "");
+	context.report("glyph sprites", static_cast<double>(sprites), "");
+	context.report("layout", layoutMs / frameCount, "ms");
+	context.report("glyph sprites added", batchMs / frameCount, "ms");
+	context.report("frame cpu", frameMs / frameCount, "ms");
+	context.report("draw calls", static_cast<double>(batch.ranges().size()), "");
+	context.report("layout cache hit rate", 100.0 * layouts.hits() / (layouts.hits() + layouts.misses()), "%");
+	context.report("atlas pages", static_cast<double>(glyphs.pageCount()), "");
+
+	// Uncached: the same screen laid out from scratch every frame
+	timer.restart();
+	for(int frame = 0; frame < frameCount; ++frame)
+	{
+		batch.clear();
+		engine::TextLayout layout;
+		for(std::size_t line = 0; line < lines.size(); ++line)
+		{
+			float const scale = sizes[line] / font.pixelSize();
+			engine::layoutText(glyphs, lines[line].c_str(), screenWidth / scale, layout);
+			engine::drawText(batch, glyphs, layout, glm::vec2(0.0f), sizes[line], 0xFFFFFFFFu, 0);
+		}
+	}
+	context.report("layout and sprites uncached", timer.elapsedMs() / frameCount, "ms");
+
+	// Scrolling through a document of ideographs, more than the atlas holds: the working set drifts every frame,
+	// pages are recycled and every glyph drawn must still read its own distance field
+	engine::GlyphCache small(font, 6, 512, 8);
+	std::uniform_int_distribution<std::uint32_t> window(0, ideographWindow - 1);
+	bool intact = true;
+	std::size_t dropped = 0;
+	timer.restart();
+	for(int frame = 0; frame < frameCount; ++frame)
+	{
+		small.nextFrame();
+		batch.clear();
+		std::string text;
+		for(int i = 0; i < 200; ++i)
+			text += utf8(firstIdeograph + frame * ideographScroll + window(random));
+		small.prepare(text.c_str(), &context.jobs());
+		engine::TextLayout layout;
+		engine::layoutText(small, text.c_str(), 0.0f, layout);
+		dropped += layout.glyphs.size() < 200 ? 200 - layout.glyphs.size() : 0;
+		engine::drawText(batch, small, layout, glm::vec2(0.0f), 16.0f, 0xFFFFFFFFu, 0);
+		if(frame != frameCount - 1)
+			continue;
+
+		std::vector<std::uint8_t> field;
+		engine::GlyphBitmap bitmap;
+		for(const engine::PlacedGlyph& placed : layout.glyphs)
+		{
+			const engine::CachedGlyph* glyph = small.glyph(placed.codepoint);
+			font.rasterize(placed.codepoint, bitmap);
+			engine::generateDistanceField(bitmap.coverage.data(), bitmap.width, bitmap.height, small.spread(), field);
+			const std::uint8_t* pixels = small.pagePixels(glyph->region.page);
+			for(unsigned y = 0; y < glyph->region.size.y; ++y)
+			{
+				for(unsigned x = 0; x < glyph->region.size.x; ++x)
+					intact = intact && pixels[(glyph->region.position.y + y) * small.pageSize() + glyph->region.position.x + x] == field[y * glyph->region.size.x + x];
+			}
+		}
+	}
+	context.report("ideograph frame", timer.elapsedMs() / frameCount, "ms");
+	context.report("evicted pages", static_cast<double>(small.stats().evictedPages), "");
+	context.report("glyphs generated", static_cast<double>(small.stats().generated), "");
+	context.report("glyphs dropped", static_cast<double>(dropped + small.stats().overflows), "");
+	context.report("glyphs intact after eviction", intact ? 1.0 : 0.0, "ok");
+
+	// A cached layout drawn while the atlas was full gets its glyphs once there's room again
+	engine::GlyphCache tiny(font, 6, 128, 1);
+	engine::TextLayoutCache tinyLayouts;
+	std::string filler;
+	for(std::uint32_t i = 0; i < 8; ++i)
+		filler += utf8(firstIdeograph + i);
+	std::string const label = utf8(firstIdeograph + 100) + utf8(firstIdeograph + 101);
+	tiny.nextFrame();
+	tiny.prepare(filler.c_str());
+	bool const overflowed = !tinyLayouts.layout(tiny, label.c_str()).complete;
+	tiny.nextFrame();
+	const engine::TextLayout& relaid = tinyLayouts.layout(tiny, label.c_str());
+	context.report("overflowed layout laid out again", overflowed && relaid.complete && relaid.glyphs.size() == 2 ? 1.0 : 0.0, "ok");
+
+	// Glyphs filling the rest of an uploaded page and spilling onto a new one in the same frame: the upload has
+	// to send the dirty rectangle of the first page and all of the second, each read from inside its own pixels
+	engine::GlyphCache spill(font, 6, 128, 2);
+	spill.nextFrame();
+	spill.prepare((utf8(firstIdeograph) + utf8(firstIdeograph + 1)).c_str());
+	spill.markClean(0);
+	std::string more;
+	for(std::uint32_t i = 2; i < 6; ++i)
+		more += utf8(firstIdeograph + i);
+	spill.prepare(more.c_str());
+	std::size_t const uploadedPages = 1;
+	bool inBounds = spill.pageCount() == 2;
+	bool dirtyAndNew = inBounds;
+	for(std::uint32_t page = 0; inBounds && page < spill.pageCount(); ++page)
+	{
+		glm::uvec4 const rect = spill.uploadRect(page, uploadedPages);
+		inBounds = rect.x <= rect.z && rect.y <= rect.w && rect.z <= spill.pageSize() && rect.w <= spill.pageSize();
+		bool const whole = rect == glm::uvec4(0, 0, spill.pageSize(), spill.pageSize());
+		dirtyAndNew = dirtyAndNew && (page < uploadedPages ? rect.z > rect.x && rect.w > rect.y && !whole : whole);
+	}
+	context.report("dirty and new page uploaded in bounds", inBounds && dirtyAndNew ? 1.0 : 0.0, "ok");
+}
@@ -0,0 +1,167 @@
+#include "TextLayout.h"
+#include "GlyphCache.h"
+#include "SpriteBatch.h"
+
+#include <cstring>
+
+namespace engine
+{
+	namespace
+	{
+		// FNV-1a over the text, then the wrap width
+		std::uint64_t layoutKey(const char* text, std::size_t length, float maxWidth)
+		{
+			std::uint64_t hash = 14695981039346656037ull;
+			for(std::size_t i = 0; i < length; ++i)
+				hash = (hash ^ static_cast<unsigned char>(text[i])) * 1099511628211ull;
+			std::uint32_t width = 0;
+			std::memcpy(&width, &maxWidth, sizeof(width));
+			return (hash ^ width) * 1099511628211ull;
+		}
+	}
+
+	void layoutText(GlyphCache& glyphs, const char* text, float maxWidth, TextLayout& layout)
+	{
+		const GlyphRasterizer& rasterizer = glyphs.rasterizer();
+		float const lineHeight = rasterizer.lineHeight();
+		layout.glyphs.clear();
+		layout.size = glm::vec2(0.0f);
+		layout.complete = true;
+
+		glm::vec2 pen(0.0f, rasterizer.ascent());
+		std::size_t lineStart = 0;
+		// First glyph after the last space of the line and where it starts
+		std::size_t breakGlyph = 0;
+		float breakX = 0.0f;
+		std::uint32_t previous = 0;
+		while(std::uint32_t const codepoint = nextCodepoint(text))
+		{
+			if(codepoint == '\n')
+			{
+				layout.size.x = glm::max(layout.size.x, pen.x);
+				pen = glm::vec2(0.0f, pen.y + lineHeight);
+				lineStart = breakGlyph = layout.glyphs.size();
+				breakX = 0.0f;
+				previous = 0;
+				continue;
+			}
+
+			const CachedGlyph* glyph = glyphs.glyph(codepoint);
+			if(!glyph)
+			{
+				// Glyphs the font lacks are left out for good, the others are there once the atlas has room
+				layout.complete = layout.complete && !glyphs.overflowed(codepoint);
+				continue;
+			}
+			float const advance = glyph->metrics.advance;
+			bool const blank = glyph->region.size.x == 0;
+			if(previous != 0)
+				pen.x += rasterizer.kerning(previous, codepoint);
+			previous = codepoint;
+
+			if(maxWidth > 0.0f && !blank && pen.x + advance > maxWidth && breakGlyph > lineStart)
+			{
+				// The words after the last space move to the next line
+				layout.size.x = glm::max(layout.size.x, breakX);
+				pen.y += lineHeight;
+				for(std::size_t i = breakGlyph; i < layout.glyphs.size(); ++i)
+					layout.glyphs[i].pen = glm::vec2(layout.glyphs[i].pen.x - breakX, pen.y);
+				pen.x -= breakX;
+				lineStart = breakGlyph;
+				breakX = 0.0f;
+			}
+
+			if(blank)
+			{
+				pen.x += advance;
+				if(codepoint == ' ')
+				{
+					breakGlyph = layout.glyphs.size();
+					breakX = pen.x;
+				}
+				continue;
+			}
+			PlacedGlyph const placed = { codepoint, pen };
+			layout.glyphs.push_back(placed);
+			pen.x += advance;
+		}
+		layout.size.x = glm::max(layout.size.x, pen.x);
+		layout.size.y = pen.y - rasterizer.ascent() + lineHeight;
+	}
+
+	TextLayoutCache::TextLayoutCache(std::size_t maxEntries) :
+		m_maxEntries(glm::max<std::size_t>(maxEntries, 1)),
+		m_hits(0),
+		m_misses(0)
+	{
+	}
+
+	const TextLayout& TextLayoutCache::layout(GlyphCache& glyphs, const char* text, float maxWidth)
+	{
+		std::size_t const length = std::strlen(text);
+		std::uint64_t const key = layoutKey(text, length, maxWidth);
+		std::unordered_map<std::uint64_t, Entry>::iterator found = m_entries.find(key);
+		if(found != m_entries.end())
+		{
+			Entry& entry = found->second;
+			m_recency.splice(m_recency.begin(), m_recency, entry.recency);
+			bool const same = entry.maxWidth == maxWidth && entry.text.compare(0, std::string::npos, text, length) == 0;
+			if(same && entry.layout.complete)
+			{
+				++m_hits;
+				return entry.layout;
+			}
+			// Collision, the entry is reused for the new text, or the same text is laid out again with its glyphs
+			++m_misses;
+			entry.text.assign(text, length);
+			entry.maxWidth = maxWidth;
+			layoutText(glyphs, text, maxWidth, entry.layout);
+			return entry.layout;
+		}
+
+		++m_misses;
+		if(m_entries.size() >= m_maxEntries)
+		{
+			m_entries.erase(m_recency.back());
+			m_recency.pop_back();
+		}
+		m_recency.push_front(key);
+		Entry& entry = m_entries[key];
+		entry.text.assign(text, length);
+		entry.maxWidth = maxWidth;
+		entry.recency = m_recency.begin();
+		layoutText(glyphs, text, maxWidth, entry.layout);
+		return entry.layout;
+	}
+
+	void TextLayoutCache::clear()
+	{
+		m_entries.clear();
+		m_recency.clear();
+	}
+
+	std::size_t drawText(SpriteBatch& batch, GlyphCache& glyphs, const TextLayout& layout, glm::vec2 position, float size,
+		std::uint32_t color, std::uint16_t firstPage, std::int16_t layer)
+	{
+		float const scale = size / static_cast<float>(glyphs.rasterizer().pixelSize());
+		Sprite sprite;
+		sprite.pivot = glm::vec2(0.0f);
+		sprite.color = color;
+		sprite.layer = layer;
+		std::size_t added = 0;
+		for(const PlacedGlyph& placed : layout.glyphs)
+		{
+			const CachedGlyph* glyph = glyphs.glyph(placed.codepoint);
+			if(!glyph || glyph->region.size.x == 0)
+				continue;
+			sprite.position = position + (placed.pen + glyph->metrics.offset) * scale;
+			sprite.size = glyph->metrics.size * scale;
+			sprite.uv = glyph->region.uv;
+			sprite.page = static_cast<std::uint16_t>(firstPage + glyph->region.page);
+			if(!batch.add(sprite))
+				break;
+			++added;
+		}
+		return added;
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace engine
+{
+	class GlyphCache;
+	class SpriteBatch;
+
+	struct PlacedGlyph
+	{
+		std::uint32_t codepoint;
+		glm::vec2 pen; // On the baseline, pixels at the rasterizer's size from the top-left corner of the text
+	};
+
+	struct TextLayout
+	{
+		std::vector<PlacedGlyph> glyphs;
+		glm::vec2 size;
+		bool complete; // False when glyphs the atlas had no room for this frame were left out
+	};
+
+	// Lays out a UTF-8 string with the glyph advances and kerning, breaking lines at '\n' and at the last space
+	// before maxWidth when it isn't 0. Lengths are in pixels at the rasterizer's size.
+	void layoutText(GlyphCache& glyphs, const char* text, float maxWidth, TextLayout& layout);
+
+	// Layouts of recent strings keyed by a hash of their text and wrap width, so the same HUD labels and debug
+	// lines drawn every frame skip decoding and measuring. The least recently used layout is dropped past
+	// maxEntries. Texts are kept along with the layouts and compared on a hit, a hash collision only costs a miss.
+	// A layout that isn't complete is laid out again on its next use.
+	class TextLayoutCache
+	{
+	public:
+		explicit TextLayoutCache(std::size_t maxEntries = 1024);
+
+		TextLayoutCache(const TextLayoutCache&) = delete;
+		TextLayoutCache& operator=(const TextLayoutCache&) = delete;
+
+		// Valid until the next call
+		const TextLayout& layout(GlyphCache& glyphs, const char* text, float maxWidth = 0.0f);
+		void clear();
+
+		std::size_t size() const { return m_entries.size(); }
+		std::size_t hits() const { return m_hits; }
+		std::size_t misses() const { return m_misses; }
+
+	private:
+		struct Entry
+		{
+			std::string text;
+			float maxWidth;
+			TextLayout layout;
+			std::list<std::uint64_t>::iterator recency;
+		};
+
+		std::size_t m_maxEntries;
+		std::unordered_map<std::uint64_t, Entry> m_entries;
+		std::list<std::uint64_t> m_recency; // Most recently used first
+		std::size_t m_hits;
+		std::size_t m_misses;
+	};
+
+	// Adds one sprite per glyph of a layout with its top-left corner at position, scaled to size pixels per em.
+	// Glyph pages map to sprite pages from firstPage on, drawn with a distance field program. Returns the sprites
+	// added, fewer than the glyphs once the batch is full.
+	std::size_t drawText(SpriteBatch& batch, GlyphCache& glyphs, const TextLayout& layout, glm::vec2 position, float size,
+		std::uint32_t color, std::uint16_t firstPage, std::int16_t layer = 0);
+}
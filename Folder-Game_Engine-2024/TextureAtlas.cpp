@@ -0,0 +1,140 @@
+#include "TextureAtlas.h"
+
+#include <limits>
+
+namespace engine
+{
+	SkylinePacker::SkylinePacker(unsigned width, unsigned height, unsigned padding) :
+		m_width(width),
+		m_height(height),
+		m_padding(padding),
+		m_usedArea(0)
+	{
+		clear();
+	}
+
+	void SkylinePacker::clear()
+	{
+		// Padding is also kept after the last row and column, so the packed area is grown by it
+		Segment const floor = { 0, 0, m_width + m_padding };
+		m_skyline.assign(1, floor);
+		m_usedArea = 0;
+	}
+
+	bool SkylinePacker::fit(std::size_t segment, unsigned width, unsigned height, unsigned& y) const
+	{
+		if(m_skyline[segment].x + width > m_width + m_padding)
+			return false;
+		y = 0;
+		unsigned left = width;
+		for(std::size_t i = segment; left > 0; ++i)
+		{
+			y = glm::max(y, m_skyline[i].y);
+			if(y + height > m_height + m_padding)
+				return false;
+			left -= glm::min(left, m_skyline[i].width);
+		}
+		return true;
+	}
+
+	bool SkylinePacker::insert(unsigned width, unsigned height, glm::uvec2& position)
+	{
+		unsigned const paddedWidth = width + m_padding;
+		unsigned const paddedHeight = height + m_padding;
+		std::size_t best = m_skyline.size();
+		unsigned bestTop = std::numeric_limits<unsigned>::max();
+		unsigned bestWidth = std::numeric_limits<unsigned>::max();
+		unsigned bestY = 0;
+		for(std::size_t i = 0; i < m_skyline.size(); ++i)
+		{
+			unsigned y = 0;
+			if(!fit(i, paddedWidth, paddedHeight, y))
+				continue;
+			// Lowest top first, then the narrowest segment so wide ones stay free for wide rectangles
+			unsigned const top = y + paddedHeight;
+			if(top < bestTop || (top == bestTop && m_skyline[i].width < bestWidth))
+			{
+				best = i;
+				bestTop = top;
+				bestWidth = m_skyline[i].width;
+				bestY = y;
+			}
+		}
+		if(best == m_skyline.size())
+			return false;
+
+		position = glm::uvec2(m_skyline[best].x, bestY);
+		Segment const placed = { position.x, bestTop, paddedWidth };
+		m_skyline.insert(m_skyline.begin() + best, placed);
+
+		// Segments now under the rectangle are cut back or removed
+		unsigned const right = placed.x + placed.width;
+		std::size_t i = best + 1;
+		while(i < m_skyline.size() && m_skyline[i].x < right)
+		{
+			unsigned const overlap = right - m_skyline[i].x;
+			if(overlap >= m_skyline[i].width)
+			{
+				m_skyline.erase(m_skyline.begin() + i);
+				continue;
+			}
+			m_skyline[i].x += overlap;
+			m_skyline[i].width -= overlap;
+			break;
+		}
+
+		for(i = 0; i + 1 < m_skyline.size();)
+		{
+			if(m_skyline[i].y == m_skyline[i + 1].y)
+			{
+				m_skyline[i].width += m_skyline[i + 1].width;
+				m_skyline.erase(m_skyline.begin() + i + 1);
+			}
+			else
+				++i;
+		}
+
+		m_usedArea += static_cast<std::uint64_t>(width) * height;
+		return true;
+	}
+
+	TextureAtlas::TextureAtlas(unsigned pageSize, unsigned maxPages, unsigned padding) :
+		m_pageSize(glm::max(pageSize, 1u)),
+		m_maxPages(glm::max(maxPages, 1u)),
+		m_padding(padding)
+	{
+	}
+
+	bool TextureAtlas::allocate(unsigned width, unsigned height, AtlasRegion& region)
+	{
+		if(width > m_pageSize || height > m_pageSize)
+			return false;
+
+		std::size_t page = 0;
+		for(; page < m_pages.size(); ++page)
+		{
+			if(m_pages[page].insert(width, height, region.position))
+				break;
+		}
+		if(page == m_pages.size())
+		{
+			if(m_pages.size() >= m_maxPages)
+				return false;
+			m_pages.push_back(SkylinePacker(m_pageSize, m_pageSize, m_padding));
+			if(!m_pages.back().insert(width, height, region.position))
+				return false;
+		}
+
+		region.page = static_cast<std::uint32_t>(page);
+		region.size = glm::uvec2(width, height);
+		glm::vec2 const scale(1.0f / m_pageSize);
+		region.uv = glm::vec4(glm::vec2(region.position) * scale, glm::vec2(region.position + region.size) * scale);
+		return true;
+	}
+
+	void TextureAtlas::clearPage(std::uint32_t page)
+	{
+		if(page < m_pages.size())
+			m_pages[page].clear();
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+	// Skyline bottom-left rectangle packer (Jylanki 2010). The top edge of the packed area is kept as a list of
+	// horizontal segments and each rectangle goes where its top ends lowest. Fast enough to pack at runtime, but
+	// rectangles can't be freed one by one, only the whole packer cleared.
+	class SkylinePacker
+	{
+	public:
+		SkylinePacker(unsigned width, unsigned height, unsigned padding = 1);
+
+		// Position of the top-left corner, false if the rectangle doesn't fit anywhere. padding pixels are kept
+		// free on the right and bottom of every rectangle so filtering doesn't bleed into neighbors.
+		bool insert(unsigned width, unsigned height, glm::uvec2& position);
+		void clear();
+
+		unsigned width() const { return m_width; }
+		unsigned height() const { return m_height; }
+		// Area of the rectangles packed over the packer's area
+		float occupancy() const { return static_cast<float>(m_usedArea) / (static_cast<float>(m_width) * m_height); }
+
+	private:
+		struct Segment
+		{
+			unsigned x;
+			unsigned y;
+			unsigned width;
+		};
+
+		// Top of a rectangle of width placed at segment's x, false if it runs past the right or bottom edge
+		bool fit(std::size_t segment, unsigned width, unsigned height, unsigned& y) const;
+
+		unsigned m_width;
+		unsigned m_height;
+		unsigned m_padding;
+		std::uint64_t m_usedArea;
+		std::vector<Segment> m_skyline;
+	};
+
+	struct AtlasRegion
+	{
+		std::uint32_t page;
+		glm::uvec2 position; // In pixels
+		glm::uvec2 size;
+		glm::vec4 uv;        // Min and max texture coordinates, texel edges
+	};
+
+	// Pages of the same size filled by skyline packers, a page is added when a rectangle fits in none of them.
+	// Pages can be cleared to reuse their space, the regions in them are invalid afterwards.
+	class TextureAtlas
+	{
+	public:
+		TextureAtlas(unsigned pageSize = 1024, unsigned maxPages = 8, unsigned padding = 1);
+
+		// False if the rectangle is larger than a page or every page is full and none can be added
+		bool allocate(unsigned width, unsigned height, AtlasRegion& region);
+		void clearPage(std::uint32_t page);
+
+		unsigned pageSize() const { return m_pageSize; }
+		std::size_t pageCount() const { return m_pages.size(); }
+		unsigned maxPages() const { return m_maxPages; }
+		float occupancy(std::uint32_t page) const { return m_pages[page].occupancy(); }
+
+	private:
+		unsigned m_pageSize;
+		unsigned m_maxPages;
+		unsigned m_padding;
+		std::vector<SkylinePacker> m_pages;
+	};
+}
@@ -0,0 +1,210 @@
+#include "UdpSocket.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace engine
+{
+	namespace
+	{
+#ifdef _WIN32
+		typedef SOCKET NativeSocket;
+		NativeSocket const noSocket = INVALID_SOCKET;
+		typedef int AddressLength;
+
+		// Winsock is started with the first socket and stays up for the rest of the process
+		bool startNetworking()
+		{
+			static bool const started = []()
+			{
+				WSADATA data;
+				return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+			}();
+			return started;
+		}
+
+		void closeNative(NativeSocket handle) { closesocket(handle); }
+
+		bool setNonBlocking(NativeSocket handle)
+		{
+			u_long enable = 1;
+			return ioctlsocket(handle, FIONBIO, &enable) == 0;
+		}
+#else
+		typedef int NativeSocket;
+		NativeSocket const noSocket = -1;
+		typedef socklen_t AddressLength;
+
+		bool startNetworking() { return true; }
+
+		void closeNative(NativeSocket handle) { ::close(handle); }
+
+		bool setNonBlocking(NativeSocket handle)
+		{
+			int const flags = fcntl(handle, F_GETFL, 0);
+			return flags != -1 && fcntl(handle, F_SETFL, flags | O_NONBLOCK) == 0;
+		}
+#endif
+
+		// Room for a few ticks of packets from many peers before the OS drops any
+		int const receiveBufferSize = 4 << 20;
+
+		NativeSocket native(std::uintptr_t handle) { return static_cast<NativeSocket>(handle); }
+
+		sockaddr_in toNative(const NetAddress& address)
+		{
+			sockaddr_in result = {};
+			result.sin_family = AF_INET;
+			result.sin_addr.s_addr = htonl(address.ip);
+			result.sin_port = htons(address.port);
+			return result;
+		}
+	}
+
+	const std::size_t UdpSocket::maxPacketSize;
+
+	UdpSocket::UdpSocket() :
+		m_handle(static_cast<std::uintptr_t>(noSocket)),
+		m_random(1),
+		m_delayOrder(0),
+		m_packetsSent(0),
+		m_bytesSent(0),
+		m_packetsDropped(0)
+	{
+	}
+
+	UdpSocket::~UdpSocket()
+	{
+		close();
+	}
+
+	bool UdpSocket::open(std::uint16_t port, bool any)
+	{
+		close();
+		if(!startNetworking())
+			return false;
+
+		NativeSocket const handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if(handle == noSocket)
+			return false;
+
+		sockaddr_in address = toNative(NetAddress(any ? 0u : NetAddress::localhost(0).ip, port));
+		AddressLength length = sizeof(address);
+		setsockopt(handle, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&receiveBufferSize), sizeof(receiveBufferSize));
+		if(bind(handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+			|| getsockname(handle, reinterpret_cast<sockaddr*>(&address), &length) != 0
+			|| !setNonBlocking(handle))
+		{
+			closeNative(handle);
+			return false;
+		}
+
+		m_handle = static_cast<std::uintptr_t>(handle);
+		m_address = NetAddress(ntohl(address.sin_addr.s_addr), ntohs(address.sin_port));
+		return true;
+	}
+
+	void UdpSocket::close()
+	{
+		if(isOpen())
+			closeNative(native(m_handle));
+		m_handle = static_cast<std::uintptr_t>(noSocket);
+		m_delayed.clear();
+	}
+
+	bool UdpSocket::isOpen() const
+	{
+		return native(m_handle) != noSocket;
+	}
+
+	void UdpSocket::setConditions(const LinkConditions& conditions, std::uint32_t seed)
+	{
+		m_conditions = conditions;
+		m_random.seed(seed);
+	}
+
+	bool UdpSocket::later(const Delayed& a, const Delayed& b)
+	{
+		return a.time > b.time || (a.time == b.time && a.order > b.order);
+	}
+
+	bool UdpSocket::sendNow(const NetAddress& to, const void* data, std::size_t size)
+	{
+		sockaddr_in const address = toNative(to);
+		return sendto(native(m_handle), static_cast<const char*>(data), static_cast<int>(size), 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == static_cast<int>(size);
+	}
+
+	bool UdpSocket::send(const NetAddress& to, const void* data, std::size_t size, double now)
+	{
+		if(!isOpen() || size > maxPacketSize)
+			return false;
+		++m_packetsSent;
+		m_bytesSent += size;
+
+		// A lost packet still counts as sent, the sender can't tell
+		if(m_conditions.loss > 0.0f && std::uniform_real_distribution<float>(0.0f, 1.0f)(m_random) < m_conditions.loss)
+		{
+			++m_packetsDropped;
+			return true;
+		}
+		if(m_conditions.latency <= 0.0 && m_conditions.jitter <= 0.0)
+			return sendNow(to, data, size);
+
+		Delayed delayed;
+		delayed.time = now + m_conditions.latency + std::uniform_real_distribution<double>(0.0, m_conditions.jitter)(m_random);
+		delayed.order = m_delayOrder++;
+		delayed.to = to;
+		delayed.data.assign(static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + size);
+		m_delayed.push_back(std::move(delayed));
+		std::push_heap(m_delayed.begin(), m_delayed.end(), &UdpSocket::later);
+		return true;
+	}
+
+	void UdpSocket::update(double now)
+	{
+		while(!m_delayed.empty() && m_delayed.front().time <= now)
+		{
+			std::pop_heap(m_delayed.begin(), m_delayed.end(), &UdpSocket::later);
+			const Delayed& delayed = m_delayed.back();
+			sendNow(delayed.to, delayed.data.data(), delayed.data.size());
+			m_delayed.pop_back();
+		}
+	}
+
+	bool UdpSocket::receive(NetAddress& from, std::vector<unsigned char>& packet)
+	{
+		if(!isOpen())
+			return false;
+
+		unsigned char buffer[maxPacketSize];
+		sockaddr_in address = {};
+		AddressLength length = sizeof(address);
+		for(;;)
+		{
+			int const size = static_cast<int>(recvfrom(native(m_handle), reinterpret_cast<char*>(buffer), sizeof(buffer), 0, reinterpret_cast<sockaddr*>(&address), &length));
+			// Windows reports an ICMP port unreachable from an earlier send as an error on the next receive, skip it
+			if(size < 0)
+			{
+#ifdef _WIN32
+				if(WSAGetLastError() == WSAECONNRESET)
+					continue;
+#endif
+				return false;
+			}
+			from = NetAddress(ntohl(address.sin_addr.s_addr), ntohs(address.sin_port));
+			packet.assign(buffer, buffer + size);
+			return true;
+		}
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace engine
+{
+	// IPv4 address and port in host byte order
+	struct NetAddress
+	{
+		std::uint32_t ip;
+		std::uint16_t port;
+
+		NetAddress() : ip(0), port(0) {}
+		NetAddress(std::uint32_t ip, std::uint16_t port) : ip(ip), port(port) {}
+
+		static NetAddress localhost(std::uint16_t port) { return NetAddress(0x7F000001u, port); }
+
+		bool operator==(const NetAddress& other) const { return ip == other.ip && port == other.port; }
+		bool operator!=(const NetAddress& other) const { return !(*this == other); }
+	};
+
+	// Network conditions simulated on the sending side: every packet is dropped with probability loss, the others
+	// are held for latency plus a uniform jitter, which can reorder them. The defaults send immediately.
+	struct LinkConditions
+	{
+		double latency;  // Seconds
+		double jitter;   // Seconds
+		float loss;
+
+		LinkConditions() : latency(0.0), jitter(0.0), loss(0.0f) {}
+		LinkConditions(double latency, double jitter, float loss) : latency(latency), jitter(jitter), loss(loss) {}
+	};
+
+	// Non-blocking UDP socket. Times are in seconds on any clock that the caller uses consistently, they only
+	// matter for the simulated conditions.
+	class UdpSocket
+	{
+	public:
+		static const std::size_t maxPacketSize = 1400;
+
+		UdpSocket();
+		~UdpSocket();
+
+		UdpSocket(const UdpSocket&) = delete;
+		UdpSocket& operator=(const UdpSocket&) = delete;
+
+		// Port 0 picks a free one. Binds to the loopback interface only unless any is set.
+		bool open(std::uint16_t port, bool any = false);
+		void close();
+		bool isOpen() const;
+		NetAddress address() const { return m_address; }
+
+		void setConditions(const LinkConditions& conditions, std::uint32_t seed = 1);
+
+		// Packets larger than maxPacketSize are refused
+		bool send(const NetAddress& to, const void* data, std::size_t size, double now);
+		// Sends the delayed packets whose time has come
+		void update(double now);
+		// False when no packet is waiting
+		bool receive(NetAddress& from, std::vector<unsigned char>& packet);
+
+		std::uint64_t packetsSent() const { return m_packetsSent; }
+		std::uint64_t bytesSent() const { return m_bytesSent; }
+		std::uint64_t packetsDropped() const { return m_packetsDropped; }
+
+	private:
+		struct Delayed
+		{
+			double time;
+			std::uint64_t order;
+			NetAddress to;
+			std::vector<unsigned char> data;
+		};
+
+		// Heap order: the earliest time on top, then the earliest sent
+		static bool later(const Delayed& a, const Delayed& b);
+		bool sendNow(const NetAddress& to, const void* data, std::size_t size);
+
+		std::uintptr_t m_handle;
+		NetAddress m_address;
+		LinkConditions m_conditions;
+		std::mt19937 m_random;
+		std::vector<Delayed> m_delayed;
+		std::uint64_t m_delayOrder;
+		std::uint64_t m_packetsSent;
+		std::uint64_t m_bytesSent;
+		std::uint64_t m_packetsDropped;
+	};
+}
@@ -0,0 +1,222 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "VoxelWorld.h"
+
+#include <gtc/noise.hpp>
+#include <gtc/packing.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	int const chunksX = 12;
+	int const chunksY = 4;
+	int const chunksZ = 12;
+	int const editCount = 200;
+	float const carveRadius = 3.0f;
+
+	engine::Voxel const stone = 1;
+	engine::Voxel const dirt = 2;
+	engine::Voxel const grass = 3;
+	engine::Voxel const ore = 4;
+
+	// Rolling hills over stone with caves and a few ore pockets
+	engine::Voxel terrainVoxel(const glm::ivec3& p, float surface)
+	{
+		float const y = static_cast<float>(p.y);
+		if(y > surface)
+			return 0;
+		if(y > surface - 1.0f)
+			return grass;
+		if(y > surface - 4.0f)
+			return dirt;
+		glm::vec3 const q = glm::vec3(p) * 0.04f;
+		if(glm::simplex(q) > 0.55f)
+			return 0;
+		glm::uvec3 const cell(p / 4);
+		std::uint32_t hash = cell.x * 73856093u ^ cell.y * 19349663u ^ cell.z * 83492791u;
+		hash = (hash ^ (hash >> 13)) * 0x5bd1e995u;
+		return (hash ^ (hash >> 15)) % 64 == 0 ? ore : stone;
+	}
+
+	void fillChunk(engine::VoxelChunk& chunk, const glm::ivec3& coordinates, std::vector<engine::Voxel>& voxels)
+	{
+		int const size = engine::VoxelChunk::size;
+		glm::ivec3 const origin = coordinates * size;
+		float surfaces[engine::VoxelChunk::size * engine::VoxelChunk::size];
+		for(int z = 0; z < size; ++z)
+		{
+			for(int x = 0; x < size; ++x)
+			{
+				glm::vec2 const p(static_cast<float>(origin.x + x), static_cast<float>(origin.z + z));
+				surfaces[z * size + x] = 64.0f + 24.0f * glm::simplex(p * 0.006f) + 6.0f * glm::simplex(p * 0.03f);
+			}
+		}
+		for(int y = 0; y < size; ++y)
+		{
+			for(int z = 0; z < size; ++z)
+			{
+				for(int x = 0; x < size; ++x)
+					voxels[engine::VoxelChunk::index(x, y, z)] = terrainVoxel(origin + glm::ivec3(x, y, z), surfaces[z * size + x]);
+			}
+		}
+		chunk.encode(voxels.data());
+	}
+
+	// Visible faces counted one voxel at a time, the greedy quads must cover exactly as many
+	std::size_t countFaces(const engine::VoxelWorld& world, const glm::ivec3& coordinates)
+	{
+		int const size = engine::VoxelChunk::size;
+		std::size_t faces = 0;
+		for(int y = 0; y < size; ++y)
+		{
+			for(int z = 0; z < size; ++z)
+			{
+				for(int x = 0; x < size; ++x)
+				{
+					glm::ivec3 const p = coordinates * size + glm::ivec3(x, y, z);
+					if(world.get(p) == 0)
+						continue;
+					for(int axis = 0; axis < 3; ++axis)
+					{
+						glm::ivec3 step(0);
+						step[axis] = 1;
+						faces += (world.get(p + step) == 0 ? 1 : 0) + (world.get(p - step) == 0 ? 1 : 0);
+					}
+				}
+			}
+		}
+		return faces;
+	}
+
+	std::size_t meshArea(const engine::VoxelMesh& mesh)
+	{
+		std::size_t area = 0;
+		for(std::size_t i = 0; i < mesh.vertices.size(); i += 4)
+		{
+			glm::u8vec2 const extent = glm::unpackUint2x8(mesh.vertices[i].extent);
+			area += static_cast<std::size_t>(extent.x) * extent.y;
+		}
+		return area;
+	}
+}
+
+ENGINE_BENCHMARK(Voxel)
+{
+	engine::VoxelWorld world;
+	std::vector<glm::ivec3> coordinates;
+	std::vector<engine::VoxelChunk*> chunks;
+	for(int y = 0; y < chunksY; ++y)
+	{
+		for(int z = 0; z < chunksZ; ++z)
+		{
+			for(int x = 0; x < chunksX; ++x)
+			{
+				coordinates.push_back(glm::ivec3(x, y, z));
+				chunks.push_back(&world.chunk(coordinates.back()));
+			}
+		}
+	}
+
+	engine::Stopwatch timer;
+	engine::parallelFor(&context.jobs(), chunks.size(), 1, [&](std::size_t begin, std::size_t end)
+	{
+		std::vector<engine::Voxel> voxels(engine::VoxelChunk::volume);
+		for(std::size_t i = begin; i < end; ++i)
+			fillChunk(*chunks[i], coordinates[i], voxels);
+	});
+	context.report("chunks", static_cast<double>(world.chunkCount()), "");
+	context.report("generate", timer.elapsedMs(), "ms");
+	context.report("bytes per chunk uncompressed", static_cast<double>(engine::VoxelChunk::volume * sizeof(engine::Voxel)), "B");
+	context.report("bytes per chunk palette", static_cast<double>(world.voxelBytes()) / world.chunkCount(), "B");
+
+	timer.restart();
+	std::size_t meshed = world.remesh(nullptr);
+	double const serialMs = timer.elapsedMs();
+	context.report("chunks meshed per second single thread", meshed / serialMs * 1000.0, "/s");
+
+	// Every chunk dirty again
+	for(const glm::ivec3& c : coordinates)
+		world.chunk(c);
+	timer.restart();
+	meshed = world.remesh(&context.jobs());
+	double const parallelMs = timer.elapsedMs();
+	context.report("chunks meshed per second", meshed / parallelMs * 1000.0, "/s");
+
+	std::size_t quads = 0;
+	std::size_t area = 0;
+	for(const glm::ivec3& c : coordinates)
+	{
+		quads += world.mesh(c)->quadCount();
+		area += meshArea(*world.mesh(c));
+	}
+	context.report("quads", static_cast<double>(quads), "");
+	context.report("faces per quad", static_cast<double>(area) / quads, "");
+	context.report("mesh bytes per chunk", static_cast<double>(world.meshBytes()) / world.chunkCount(), "B");
+
+	bool covered = true;
+	for(int i = 0; i < 8; ++i)
+	{
+		const glm::ivec3& c = coordinates[(i * 131 + 17) % coordinates.size()];
+		covered = covered && meshArea(*world.mesh(c)) == countFaces(world, c);
+	}
+	context.report("quads cover every face", covered ? 1.0 : 0.0, "ok");
+
+	std::vector<engine::Voxel> before(engine::VoxelChunk::volume);
+	std::vector<engine::Voxel> after(engine::VoxelChunk::volume);
+	chunks[chunks.size() / 2 + 7]->decode(before.data());
+	std::size_t const live = world.voxelBytes();
+	timer.restart();
+	std::size_t const compressed = world.compressIdle();
+	context.report("compress", timer.elapsedMs(), "ms");
+	context.report("bytes per chunk at rest", static_cast<double>(world.voxelBytes()) / world.chunkCount(), "B");
+	context.report("at rest over palette", static_cast<double>(world.voxelBytes()) / live, "x");
+
+	// Incremental edits: carve spheres into the compressed world, only the touched chunks are expanded and remeshed
+	std::mt19937 random(46);
+	std::uniform_int_distribution<int> horizontal(4, chunksX * engine::VoxelChunk::size - 5);
+	std::uniform_int_distribution<int> vertical(40, 90);
+	int const r = static_cast<int>(carveRadius);
+	glm::ivec3 center(0);
+	double editMs = 0.0;
+	double remeshMs = 0.0;
+	std::size_t remeshed = 0;
+	for(int edit = 0; edit < editCount; ++edit)
+	{
+		center = glm::ivec3(horizontal(random), vertical(random), horizontal(random));
+		timer.restart();
+		for(int y = -r; y <= r; ++y)
+		{
+			for(int z = -r; z <= r; ++z)
+			{
+				for(int x = -r; x <= r; ++x)
+				{
+					if(x * x + y * y + z * z <= r * r)
+						world.set(center + glm::ivec3(x, y, z), 0);
+				}
+			}
+		}
+		editMs += timer.elapsedMs();
+		timer.restart();
+		remeshed += world.remesh(&context.jobs());
+		remeshMs += timer.elapsedMs();
+	}
+	context.report("chunks compressed", static_cast<double>(compressed), "");
+	context.report("sphere carve", editMs / editCount, "ms");
+	context.report("remesh after carve", remeshMs / editCount, "ms");
+	context.report("chunks remeshed per carve", static_cast<double>(remeshed) / editCount, "");
+
+	std::vector<unsigned char> bytes;
+	engine::VoxelChunk restored;
+	engine::VoxelChunk original;
+	original.encode(before.data());
+	original.compress(bytes);
+	restored.decompress(bytes);
+	restored.decode(after.data());
+	context.report("compressed round trip", before == after ? 1.0 : 0.0, "ok");
+
+	glm::ivec3 const carved = engine::VoxelWorld::chunkOf(center);
+	context.report("quads cover every face after edits", meshArea(*world.mesh(carved)) == countFaces(world, carved) ? 1.0 : 0.0, "ok");
+}
@@ -0,0 +1,517 @@
+#include "VoxelWorld.h"
+#include "JobSystem.h"
+#include "Serialization.h"
+
+#include <gtc/packing.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace engine
+{
+	namespace
+	{
+		int const padded = VoxelChunk::size + 2;
+
+		unsigned bitsFor(std::size_t paletteSize)
+		{
+			if(paletteSize <= 1)
+				return 0;
+			if(paletteSize <= 2)
+				return 1;
+			if(paletteSize <= 4)
+				return 2;
+			if(paletteSize <= 16)
+				return 4;
+			return paletteSize <= 256 ? 8 : 16;
+		}
+
+		std::size_t wordCount(unsigned bits)
+		{
+			return bits == 0 ? 0 : VoxelChunk::volume / (64 / bits);
+		}
+
+		// Palette size, the palette, then pairs of run length and palette index
+		bool decodeRuns(const std::vector<unsigned char>& bytes, Voxel* voxels)
+		{
+			std::uint64_t offset = 0;
+			std::uint64_t const paletteSize = readVarint(bytes, offset);
+			if(paletteSize == 0 || paletteSize > 65536)
+				return false;
+			std::vector<Voxel> palette(static_cast<std::size_t>(paletteSize));
+			for(Voxel& voxel : palette)
+				voxel = static_cast<Voxel>(readVarint(bytes, offset));
+
+			std::uint64_t filled = 0;
+			while(offset < bytes.size())
+			{
+				std::uint64_t const length = readVarint(bytes, offset);
+				std::uint64_t const entry = readVarint(bytes, offset);
+				if(length == 0 || filled + length > VoxelChunk::volume || entry >= paletteSize)
+					return false;
+				std::fill(voxels + filled, voxels + filled + length, palette[static_cast<std::size_t>(entry)]);
+				filled += length;
+			}
+			return filled == VoxelChunk::volume;
+		}
+
+		// Reads one voxel of a compressed chunk by walking its runs
+		Voxel compressedVoxel(const std::vector<unsigned char>& bytes, int index)
+		{
+			std::uint64_t offset = 0;
+			std::uint64_t const paletteSize = readVarint(bytes, offset);
+			std::vector<Voxel> palette(static_cast<std::size_t>(std::min<std::uint64_t>(paletteSize, 65536)));
+			for(Voxel& voxel : palette)
+				voxel = static_cast<Voxel>(readVarint(bytes, offset));
+			std::uint64_t end = 0;
+			while(offset < bytes.size())
+			{
+				end += readVarint(bytes, offset);
+				std::uint64_t const entry = readVarint(bytes, offset);
+				if(static_cast<std::uint64_t>(index) < end)
+					return entry < palette.size() ? palette[static_cast<std::size_t>(entry)] : 0;
+			}
+			return 0;
+		}
+	}
+
+	VoxelChunk::VoxelChunk() :
+		m_palette(1, 0),
+		m_bits(0)
+	{
+	}
+
+	void VoxelChunk::setIndex(int i, unsigned entry)
+	{
+		unsigned const perWord = 64 / m_bits;
+		unsigned const shift = i % perWord * m_bits;
+		std::uint64_t& word = m_words[i / perWord];
+		word = (word & ~(static_cast<std::uint64_t>((1u << m_bits) - 1) << shift)) | static_cast<std::uint64_t>(entry) << shift;
+	}
+
+	void VoxelChunk::resize(unsigned bits)
+	{
+		std::vector<std::uint64_t> words(wordCount(bits), 0);
+		unsigned const perWord = 64 / bits;
+		for(int i = 0; i < volume; ++i)
+			words[i / perWord] |= static_cast<std::uint64_t>(paletteIndex(i)) << (i % perWord * bits);
+		m_words.swap(words);
+		m_bits = bits;
+	}
+
+	void VoxelChunk::set(int x, int y, int z, Voxel voxel)
+	{
+		std::vector<Voxel>::const_iterator const found = std::find(m_palette.begin(), m_palette.end(), voxel);
+		unsigned const entry = static_cast<unsigned>(found - m_palette.begin());
+		if(found == m_palette.end())
+		{
+			// Entries no longer used stay until the chunk is encoded again
+			m_palette.push_back(voxel);
+			unsigned const bits = bitsFor(m_palette.size());
+			if(bits > m_bits)
+				resize(bits);
+		}
+		if(m_bits > 0)
+			setIndex(index(x, y, z), entry);
+	}
+
+	void VoxelChunk::fill(Voxel voxel)
+	{
+		m_palette.assign(1, voxel);
+		m_bits = 0;
+		std::vector<std::uint64_t>().swap(m_words);
+	}
+
+	void VoxelChunk::decode(Voxel* voxels) const
+	{
+		if(m_bits == 0)
+		{
+			std::fill(voxels, voxels + volume, m_palette[0]);
+			return;
+		}
+		unsigned const perWord = 64 / m_bits;
+		std::uint64_t const mask = (1u << m_bits) - 1;
+		for(std::size_t w = 0; w < m_words.size(); ++w)
+		{
+			std::uint64_t word = m_words[w];
+			for(unsigned i = 0; i < perWord; ++i, word >>= m_bits)
+				voxels[w * perWord + i] = m_palette[static_cast<std::size_t>(word & mask)];
+		}
+	}
+
+	void VoxelChunk::encode(const Voxel* voxels)
+	{
+		// Chunks hold a handful of types, a linear search that remembers the last hit beats a map
+		m_palette.assign(1, voxels[0]);
+		for(int i = 1; i < volume; ++i)
+		{
+			if(voxels[i] != voxels[i - 1] && std::find(m_palette.begin(), m_palette.end(), voxels[i]) == m_palette.end())
+				m_palette.push_back(voxels[i]);
+		}
+		m_bits = bitsFor(m_palette.size());
+		std::vector<std::uint64_t>(wordCount(m_bits), 0).swap(m_words);
+		if(m_bits == 0)
+			return;
+
+		unsigned entry = 0;
+		for(int i = 0; i < volume; ++i)
+		{
+			if(m_palette[entry] != voxels[i])
+				entry = static_cast<unsigned>(std::find(m_palette.begin(), m_palette.end(), voxels[i]) - m_palette.begin());
+			setIndex(i, entry);
+		}
+	}
+
+	void VoxelChunk::compress(std::vector<unsigned char>& bytes) const
+	{
+		// Runs first, so the palette written holds only the entries still used
+		std::vector<std::uint32_t> runs;
+		std::vector<bool> used(m_palette.size(), false);
+		unsigned current = paletteIndex(0);
+		std::uint32_t length = 0;
+		for(int i = 0; i < volume; ++i)
+		{
+			unsigned const entry = paletteIndex(i);
+			if(entry != current)
+			{
+				runs.push_back(length);
+				runs.push_back(current);
+				used[current] = true;
+				current = entry;
+				length = 0;
+			}
+			++length;
+		}
+		runs.push_back(length);
+		runs.push_back(current);
+		used[current] = true;
+
+		std::vector<std::uint32_t> remap(m_palette.size(), 0);
+		std::uint32_t usedCount = 0;
+		for(std::size_t entry = 0; entry < m_palette.size(); ++entry)
+		{
+			if(used[entry])
+				remap[entry] = usedCount++;
+		}
+
+		bytes.clear();
+		writeVarint(bytes, usedCount);
+		for(std::size_t entry = 0; entry < m_palette.size(); ++entry)
+		{
+			if(used[entry])
+				writeVarint(bytes, m_palette[entry]);
+		}
+		for(std::size_t i = 0; i < runs.size(); i += 2)
+		{
+			writeVarint(bytes, runs[i]);
+			writeVarint(bytes, remap[runs[i + 1]]);
+		}
+	}
+
+	bool VoxelChunk::decompress(const std::vector<unsigned char>& bytes)
+	{
+		std::vector<Voxel> voxels(volume);
+		if(!decodeRuns(bytes, voxels.data()))
+		{
+			fill(0);
+			return false;
+		}
+		encode(voxels.data());
+		return true;
+	}
+
+	void buildQuadIndices(std::size_t quadCount, std::vector<std::uint32_t>& indices)
+	{
+		indices.resize(quadCount * 6);
+		for(std::size_t quad = 0; quad < quadCount; ++quad)
+		{
+			std::uint32_t const base = static_cast<std::uint32_t>(quad * 4);
+			std::uint32_t* out = indices.data() + quad * 6;
+			out[0] = base;
+			out[1] = base + 1;
+			out[2] = base + 2;
+			out[3] = base;
+			out[4] = base + 2;
+			out[5] = base + 3;
+		}
+	}
+
+	void meshChunk(const Voxel* voxels, VoxelMesh& mesh)
+	{
+		int const size = VoxelChunk::size;
+		int const strides[3] = { 1, padded * padded, padded };
+		// Positive for a face of the voxel behind the slice looking along +axis, negative for one in front facing back
+		std::int32_t mask[VoxelChunk::size * VoxelChunk::size];
+		mesh.vertices.clear();
+
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			// u cross v points along +axis
+			int const u = (axis + 1) % 3;
+			int const v = (axis + 2) % 3;
+			int const stride = strides[axis];
+			for(int slice = 0; slice <= size; ++slice)
+			{
+				// Voxels at slice - 1 and slice along the axis, both inside the padded block
+				int const base = strides[0] + strides[1] + strides[2] + (slice - 1) * stride;
+				for(int j = 0; j < size; ++j)
+				{
+					const Voxel* behind = voxels + base + j * strides[v];
+					for(int i = 0; i < size; ++i)
+					{
+						Voxel const a = behind[i * strides[u]];
+						Voxel const b = behind[i * strides[u] + stride];
+						std::int32_t face = 0;
+						if(a != 0 && b == 0 && slice > 0)
+							face = a;
+						else if(b != 0 && a == 0 && slice < size)
+							face = -static_cast<std::int32_t>(b);
+						mask[j * size + i] = face;
+					}
+				}
+
+				for(int j = 0; j < size; ++j)
+				{
+					for(int i = 0; i < size; ++i)
+					{
+						std::int32_t const face = mask[j * size + i];
+						if(face == 0)
+							continue;
+						int width = 1;
+						while(i + width < size && mask[j * size + i + width] == face)
+							++width;
+						int height = 1;
+						for(; j + height < size; ++height)
+						{
+							const std::int32_t* row = mask + (j + height) * size + i;
+							if(std::count(row, row + width, face) != width)
+								break;
+						}
+						for(int h = 0; h < height; ++h)
+							std::fill(mask + (j + h) * size + i, mask + (j + h) * size + i + width, 0);
+
+						glm::ivec2 corners[4] = { glm::ivec2(i, j), glm::ivec2(i + width, j), glm::ivec2(i + width, j + height), glm::ivec2(i, j + height) };
+						if(face < 0)
+							std::swap(corners[1], corners[3]);
+						VoxelVertex vertex;
+						vertex.voxel = static_cast<Voxel>(face > 0 ? face : -face);
+						vertex.extent = glm::packUint2x8(glm::u8vec2(width, height));
+						for(const glm::ivec2& corner : corners)
+						{
+							glm::u8vec4 position;
+							position[axis] = static_cast<std::uint8_t>(slice);
+							position[u] = static_cast<std::uint8_t>(corner.x);
+							position[v] = static_cast<std::uint8_t>(corner.y);
+							position.w = static_cast<std::uint8_t>(axis * 2 + (face > 0 ? 0 : 1));
+							vertex.position = glm::packUint4x8(position);
+							mesh.vertices.push_back(vertex);
+						}
+						i += width - 1;
+					}
+				}
+			}
+		}
+	}
+
+	std::uint64_t VoxelWorld::key(const glm::ivec3& coordinates)
+	{
+		std::uint64_t const mask = (1u << 21) - 1;
+		return (static_cast<std::uint64_t>(coordinates.x) & mask) | (static_cast<std::uint64_t>(coordinates.y) & mask) << 21 | (static_cast<std::uint64_t>(coordinates.z) & mask) << 42;
+	}
+
+	VoxelWorld::Entry* VoxelWorld::find(const glm::ivec3& coordinates) const
+	{
+		std::unordered_map<std::uint64_t, std::size_t>::const_iterator const found = m_index.find(key(coordinates));
+		return found != m_index.end() ? m_chunks[found->second].get() : nullptr;
+	}
+
+	VoxelChunk& VoxelWorld::expand(Entry& entry)
+	{
+		if(!entry.chunk)
+		{
+			entry.chunk.reset(new VoxelChunk());
+			entry.chunk->decompress(entry.compressed);
+			std::vector<unsigned char>().swap(entry.compressed);
+		}
+		return *entry.chunk;
+	}
+
+	void VoxelWorld::markDirty(const glm::ivec3& coordinates)
+	{
+		std::unordered_map<std::uint64_t, std::size_t>::const_iterator const found = m_index.find(key(coordinates));
+		if(found != m_index.end() && !m_chunks[found->second]->dirty)
+		{
+			m_chunks[found->second]->dirty = true;
+			m_dirty.push_back(found->second);
+		}
+	}
+
+	VoxelChunk& VoxelWorld::chunk(const glm::ivec3& coordinates)
+	{
+		Entry* entry = find(coordinates);
+		if(!entry)
+		{
+			m_index[key(coordinates)] = m_chunks.size();
+			m_chunks.push_back(std::unique_ptr<Entry>(new Entry()));
+			entry = m_chunks.back().get();
+			entry->coordinates = coordinates;
+			entry->chunk.reset(new VoxelChunk());
+			entry->dirty = false;
+			entry->meshed = false;
+		}
+		markDirty(coordinates);
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			glm::ivec3 step(0);
+			step[axis] = 1;
+			markDirty(coordinates + step);
+			markDirty(coordinates - step);
+		}
+		return expand(*entry);
+	}
+
+	Voxel VoxelWorld::get(const glm::ivec3& voxel) const
+	{
+		const Entry* entry = find(chunkOf(voxel));
+		if(!entry)
+			return 0;
+		glm::ivec3 const local = voxel & (VoxelChunk::size - 1);
+		if(entry->chunk)
+			return entry->chunk->get(local.x, local.y, local.z);
+		return compressedVoxel(entry->compressed, VoxelChunk::index(local.x, local.y, local.z));
+	}
+
+	void VoxelWorld::set(const glm::ivec3& voxel, Voxel value)
+	{
+		glm::ivec3 const coordinates = chunkOf(voxel);
+		glm::ivec3 const local = voxel & (VoxelChunk::size - 1);
+		Entry* entry = find(coordinates);
+		if(!entry)
+		{
+			if(value == 0)
+				return;
+			chunk(coordinates);
+			entry = find(coordinates);
+		}
+		VoxelChunk& target = expand(*entry);
+		if(target.get(local.x, local.y, local.z) == value)
+			return;
+		target.set(local.x, local.y, local.z, value);
+
+		markDirty(coordinates);
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			glm::ivec3 step(0);
+			step[axis] = 1;
+			if(local[axis] == 0)
+				markDirty(coordinates - step);
+			else if(local[axis] == VoxelChunk::size - 1)
+				markDirty(coordinates + step);
+		}
+	}
+
+	void VoxelWorld::gather(const Entry& entry, Voxel* voxels, Voxel* scratch) const
+	{
+		int const size = VoxelChunk::size;
+		std::fill(voxels, voxels + padded * padded * padded, Voxel(0));
+		if(entry.chunk)
+			entry.chunk->decode(scratch);
+		else if(!decodeRuns(entry.compressed, scratch))
+			std::fill(scratch, scratch + VoxelChunk::volume, Voxel(0));
+		for(int y = 0; y < size; ++y)
+		{
+			for(int z = 0; z < size; ++z)
+				std::memcpy(voxels + 1 + padded * (z + 1 + padded * (y + 1)), scratch + VoxelChunk::index(0, y, z), size * sizeof(Voxel));
+		}
+
+		// One layer of each face neighbor, missing neighbors are empty
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			int const u = (axis + 1) % 3;
+			int const v = (axis + 2) % 3;
+			for(int side = -1; side <= 1; side += 2)
+			{
+				glm::ivec3 step(0);
+				step[axis] = side;
+				const Entry* neighbor = find(entry.coordinates + step);
+				if(!neighbor)
+					continue;
+				if(!neighbor->chunk && !decodeRuns(neighbor->compressed, scratch))
+					continue;
+				for(int j = 0; j < size; ++j)
+				{
+					for(int i = 0; i < size; ++i)
+					{
+						glm::ivec3 local;
+						local[axis] = side > 0 ? 0 : size - 1;
+						local[u] = i;
+						local[v] = j;
+						Voxel const value = neighbor->chunk ? neighbor->chunk->get(local.x, local.y, local.z) : scratch[VoxelChunk::index(local.x, local.y, local.z)];
+						glm::ivec3 target = local + 1;
+						target[axis] = side > 0 ? size + 1 : 0;
+						voxels[target.x + padded * (target.z + padded * target.y)] = value;
+					}
+				}
+			}
+		}
+	}
+
+	std::size_t VoxelWorld::remesh(JobSystem* jobs)
+	{
+		std::vector<std::size_t> dirty;
+		dirty.swap(m_dirty);
+		parallelFor(jobs, dirty.size(), 1, [&](std::size_t begin, std::size_t end)
+		{
+			std::vector<Voxel> voxels(padded * padded * padded);
+			std::vector<Voxel> scratch(VoxelChunk::volume);
+			for(std::size_t i = begin; i < end; ++i)
+			{
+				Entry& entry = *m_chunks[dirty[i]];
+				gather(entry, voxels.data(), scratch.data());
+				meshChunk(voxels.data(), entry.mesh);
+				entry.meshed = true;
+			}
+		});
+		for(std::size_t index : dirty)
+			m_chunks[index]->dirty = false;
+		return dirty.size();
+	}
+
+	const VoxelMesh* VoxelWorld::mesh(const glm::ivec3& coordinates) const
+	{
+		const Entry* entry = find(coordinates);
+		return entry && entry->meshed ? &entry->mesh : nullptr;
+	}
+
+	std::size_t VoxelWorld::compressIdle()
+	{
+		std::size_t count = 0;
+		for(const std::unique_ptr<Entry>& entry : m_chunks)
+		{
+			if(entry->chunk && !entry->dirty)
+			{
+				entry->chunk->compress(entry->compressed);
+				entry->compressed.shrink_to_fit();
+				entry->chunk.reset();
+				++count;
+			}
+		}
+		return count;
+	}
+
+	std::size_t VoxelWorld::voxelBytes() const
+	{
+		std::size_t bytes = 0;
+		for(const std::unique_ptr<Entry>& entry : m_chunks)
+			bytes += entry->chunk ? entry->chunk->memoryBytes() : entry->compressed.capacity();
+		return bytes;
+	}
+
+	std::size_t VoxelWorld::meshBytes() const
+	{
+		std::size_t bytes = 0;
+		for(const std::unique_ptr<Entry>& entry : m_chunks)
+			bytes += entry->mesh.vertices.capacity() * sizeof(VoxelVertex);
+		return bytes;
+	}
+}
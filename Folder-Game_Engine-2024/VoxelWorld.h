@@ -0,0 +1,141 @@
+#pragma once
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace engine
+{
+	class JobSystem;
+
+	// Voxel type, 0 is empty space
+	typedef std::uint16_t Voxel;
+
+	// 32^3 voxels stored as indices into a palette of the types present, bit-packed at 0, 1, 2, 4, 8 or 16 bits per
+	// voxel so no index straddles two words. A chunk of a single type has no index storage at all.
+	// Voxels are ordered x first, then z, then y, so horizontal layers are contiguous.
+	class VoxelChunk
+	{
+	public:
+		static const int size = 32;
+		static const int volume = size * size * size;
+
+		VoxelChunk();
+
+		static int index(int x, int y, int z) { return x + size * (z + size * y); }
+
+		Voxel get(int x, int y, int z) const { return m_palette[paletteIndex(index(x, y, z))]; }
+		void set(int x, int y, int z, Voxel voxel);
+		void fill(Voxel voxel);
+
+		// Expands to volume voxels in index order
+		void decode(Voxel* voxels) const;
+		// Replaces the content, the palette holds only the types present
+		void encode(const Voxel* voxels);
+
+		// Runs of the same palette entry as varints, for chunks at rest. Typical terrain takes a few hundred bytes.
+		void compress(std::vector<unsigned char>& bytes) const;
+		// False if bytes is malformed, the chunk is left empty then
+		bool decompress(const std::vector<unsigned char>& bytes);
+
+		std::size_t paletteSize() const { return m_palette.size(); }
+		unsigned bitsPerVoxel() const { return m_bits; }
+		std::size_t memoryBytes() const { return sizeof(*this) + m_palette.capacity() * sizeof(Voxel) + m_words.capacity() * sizeof(std::uint64_t); }
+
+	private:
+		unsigned paletteIndex(int i) const
+		{
+			if(m_bits == 0)
+				return 0;
+			unsigned const perWord = 64 / m_bits;
+			return static_cast<unsigned>(m_words[i / perWord] >> (i % perWord * m_bits)) & ((1u << m_bits) - 1);
+		}
+		void setIndex(int i, unsigned entry);
+		void resize(unsigned bits);
+
+		std::vector<Voxel> m_palette;
+		unsigned m_bits;
+		std::vector<std::uint64_t> m_words;
+	};
+
+	// Four corners per quad, counter-clockwise seen from outside, drawn with the index pattern of buildQuadIndices
+	struct VoxelVertex
+	{
+		std::uint32_t position; // glm::packUint4x8 of x, y, z in voxels from the chunk's corner, 0 to 32, and the face
+		Voxel voxel;
+		std::uint16_t extent;   // glm::packUint2x8 of the quad's size along its two axes, to repeat textures over it
+	};
+
+	// Faces 0 to 5 are +x, -x, +y, -y, +z, -z
+	struct VoxelMesh
+	{
+		std::vector<VoxelVertex> vertices;
+
+		std::size_t quadCount() const { return vertices.size() / 4; }
+	};
+
+	// 0, 1, 2, 0, 2, 3 for every quad, one index buffer shared by all the chunk meshes
+	void buildQuadIndices(std::size_t quadCount, std::vector<std::uint32_t>& indices);
+
+	// Greedy meshing (Lysenko 2012): the visible faces of each slice are merged into the largest rectangles of the
+	// same type. padded holds (size + 2)^3 voxels, the chunk and one layer of each face neighbor, x first then z then y.
+	void meshChunk(const Voxel* padded, VoxelMesh& mesh);
+
+	// Sparse grid of chunks. Edits mark their chunk dirty, and its neighbors when they touch the shared border, and
+	// remesh only meshes those, in parallel. Chunks that haven't changed since they were meshed can be run-length
+	// compressed, they are expanded again when edited.
+	class VoxelWorld
+	{
+	public:
+		VoxelWorld() {}
+
+		VoxelWorld(const VoxelWorld&) = delete;
+		VoxelWorld& operator=(const VoxelWorld&) = delete;
+
+		static glm::ivec3 chunkOf(const glm::ivec3& voxel) { return glm::ivec3(voxel.x >> 5, voxel.y >> 5, voxel.z >> 5); }
+
+		Voxel get(const glm::ivec3& voxel) const;
+		void set(const glm::ivec3& voxel, Voxel value);
+
+		// Creates the chunk if needed and marks it and its neighbors dirty, for filling it whole. Creating other
+		// chunks doesn't move it, so chunks can be created first and then filled from different threads.
+		VoxelChunk& chunk(const glm::ivec3& coordinates);
+		std::size_t chunkCount() const { return m_chunks.size(); }
+
+		// Meshes the dirty chunks across jobs, returns how many
+		std::size_t remesh(JobSystem* jobs = nullptr);
+		// Null for chunks never meshed
+		const VoxelMesh* mesh(const glm::ivec3& coordinates) const;
+
+		// Compresses the chunks that are not dirty, returns how many
+		std::size_t compressIdle();
+
+		std::size_t voxelBytes() const;
+		std::size_t meshBytes() const;
+
+	private:
+		struct Entry
+		{
+			glm::ivec3 coordinates;
+			std::unique_ptr<VoxelChunk> chunk; // Null while compressed
+			std::vector<unsigned char> compressed;
+			VoxelMesh mesh;
+			bool dirty;
+			bool meshed;
+		};
+
+		static std::uint64_t key(const glm::ivec3& coordinates);
+		Entry* find(const glm::ivec3& coordinates) const;
+		VoxelChunk& expand(Entry& entry);
+		void markDirty(const glm::ivec3& coordinates);
+		void gather(const Entry& entry, Voxel* padded, Voxel* scratch) const;
+
+		std::vector<std::unique_ptr<Entry> > m_chunks;
+		std::unordered_map<std::uint64_t, std::size_t> m_index;
+		std::vector<std::size_t> m_dirty;
+	};
+}
@@ -196,6 +196,11 @@
 #ifdef GLM_ENABLE_EXPERIMENTAL
 #include "./gtx/associated_min_max.hpp"
 #include "./gtx/bit.hpp"
+#include "./gtx/bounds_transform.hpp"
+#if GLM_LANG & GLM_LANG_CXX11_FLAG
+#	include "./gtx/buffer_layout.hpp"
+#endif
+#include "./gtx/bulk_packing.hpp"
 #include "./gtx/closest_point.hpp"
 #include "./gtx/color_encoding.hpp"
 #include "./gtx/color_space.hpp"
@@ -2206,6 +2206,14 @@ export namespace glm {
 		using glm::io::operator<<;
 		using glm::operator<<;
 		using glm::tdualquat;
+#       if GLM_LANG & GLM_LANG_CXX11_FLAG
+		using glm::buffer_layout_rule;
+		using glm::std140_layout;
+		using glm::std430_layout;
+		using glm::scalar_layout;
+		using glm::buffer_member;
+		using glm::buffer_layout;
+#       endif
 
 #       if !((GLM_COMPILER & GLM_COMPILER_CUDA) || (GLM_COMPILER & GLM_COMPILER_HIP))
 		using glm::to_string;
@@ -2522,7 +2530,10 @@ export namespace glm {
 		using glm::orthonormalize;
 		using glm::outerProduct;
 		using glm::packDouble2x32;
+		using glm::packF2x11_1x10Bulk;
+		using glm::packF3x9_E1x5Bulk;
 		using glm::packHalf2x16;
+		using glm::packHalfBulk;
 		using glm::packSnorm2x16;
 		using glm::packSnorm4x8;
 		using glm::packUnorm2x16;
@@ -2634,6 +2645,9 @@ export namespace glm {
 		using glm::tanh;
 		using glm::third;
 		using glm::three_over_two_pi;
+		using glm::transformBounds;
+		using glm::transformBoundsBulk;
+		using glm::transformMinMax;
 		using glm::translate;
 		using glm::transpose;
 		using glm::triangleNormal;
@@ -2650,7 +2664,10 @@ export namespace glm {
 		using glm::unProjectNO;
 		using glm::unProjectZO;
 		using glm::unpackDouble2x32;
+		using glm::unpackF2x11_1x10Bulk;
+		using glm::unpackF3x9_E1x5Bulk;
 		using glm::unpackHalf2x16;
+		using glm::unpackHalfBulk;
 		using glm::unpackSnorm2x16;
 		using glm::unpackSnorm4x8;
 		using glm::unpackUnorm2x16;
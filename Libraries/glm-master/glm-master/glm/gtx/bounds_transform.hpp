@@ -0,0 +1,62 @@
+/// @ref gtx_bounds_transform
+/// @file glm/gtx/bounds_transform.hpp
+///
+/// @see core (dependence)
+///
+/// @defgroup gtx_bounds_transform GLM_GTX_bounds_transform
+/// @ingroup gtx
+///
+/// Include <glm/gtx/bounds_transform.hpp> to use the features of this extension.
+///
+/// Transform axis aligned bounding boxes by affine matrices.
+///
+/// A box given by its center and extent (half size) is transformed as
+/// center' = M * center and extent' = abs(M3x3) * extent, which gives the same
+/// box as transforming its eight corners and taking their minimum and maximum.
+///
+/// The bulk function reads the boxes as structure of arrays and one matrix per
+/// box. When GLM is built with AVX intrinsics (GLM_FORCE_INTRINSICS or
+/// GLM_FORCE_AVX) eight boxes are transformed per iteration, four with SSE2,
+/// and the remaining boxes go through the scalar path.
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include <cstddef>
+
+#ifndef GLM_ENABLE_EXPERIMENTAL
+#	error "GLM: GLM_GTX_bounds_transform is an experimental extension and may change in the future. Use #define GLM_ENABLE_EXPERIMENTAL before including it, if you really want to use it."
+#elif GLM_MESSAGES == GLM_ENABLE && !defined(GLM_EXT_INCLUDED)
+#	pragma message("GLM: GLM_GTX_bounds_transform extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_bounds_transform
+	/// @{
+
+	/// Transform the box of center Center and half size Extent by the affine matrix M.
+	/// The last row of M is assumed to be (0, 0, 0, 1).
+	///
+	/// @see gtx_bounds_transform
+	template<typename T, qualifier Q>
+	GLM_FUNC_DISCARD_DECL void transformBounds(mat<4, 4, T, Q> const& M, vec<3, T, Q> const& Center, vec<3, T, Q> const& Extent, vec<3, T, Q>& OutCenter, vec<3, T, Q>& OutExtent);
+
+	/// Transform the box between Min and Max by the affine matrix M and return the box of the result in OutMin and OutMax.
+	///
+	/// @see gtx_bounds_transform
+	template<typename T, qualifier Q>
+	GLM_FUNC_DISCARD_DECL void transformMinMax(mat<4, 4, T, Q> const& M, vec<3, T, Q> const& Min, vec<3, T, Q> const& Max, vec<3, T, Q>& OutMin, vec<3, T, Q>& OutMax);
+
+	/// Transform Count boxes, box i by Transforms[i].
+	/// Center[0], Center[1] and Center[2] point to the x, y and z coordinates of the box centers, Extent to their half sizes.
+	/// The world space boxes are written to OutMin and OutMax, which are structures of arrays laid out the same way.
+	///
+	/// @see gtx_bounds_transform
+	GLM_FUNC_DISCARD_DECL void transformBoundsBulk(mat4 const* Transforms, float const* const Center[3], float const* const Extent[3], float* const OutMin[3], float* const OutMax[3], std::size_t Count);
+
+	/// @}
+}//namespace glm
+
+#include "bounds_transform.inl"
@@ -0,0 +1,147 @@
+/// @ref gtx_bounds_transform
+
+namespace glm{
+namespace detail
+{
+	GLM_FUNC_QUALIFIER void transformBoundsBulkScalar(mat4 const* Transforms, float const* const Center[3], float const* const Extent[3], float* const OutMin[3], float* const OutMax[3], std::size_t Begin, std::size_t End)
+	{
+		for(std::size_t i = Begin; i < End; ++i)
+		{
+			vec3 WorldCenter, WorldExtent;
+			transformBounds(Transforms[i], vec3(Center[0][i], Center[1][i], Center[2][i]), vec3(Extent[0][i], Extent[1][i], Extent[2][i]), WorldCenter, WorldExtent);
+			for(length_t c = 0; c < 3; ++c)
+			{
+				OutMin[c][i] = WorldCenter[c] - WorldExtent[c];
+				OutMax[c][i] = WorldCenter[c] + WorldExtent[c];
+			}
+		}
+	}
+
+#	if GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_SSE2_BIT)
+
+	// Reads column Column of four matrices as registers of their x, y and z components
+	GLM_FUNC_QUALIFIER void loadColumn4(mat4 const* Transforms, length_t Column, __m128& x, __m128& y, __m128& z)
+	{
+		__m128 const r0 = _mm_loadu_ps(&Transforms[0][Column].x);
+		__m128 const r1 = _mm_loadu_ps(&Transforms[1][Column].x);
+		__m128 const r2 = _mm_loadu_ps(&Transforms[2][Column].x);
+		__m128 const r3 = _mm_loadu_ps(&Transforms[3][Column].x);
+
+		__m128 const t0 = _mm_unpacklo_ps(r0, r1);
+		__m128 const t1 = _mm_unpackhi_ps(r0, r1);
+		__m128 const t2 = _mm_unpacklo_ps(r2, r3);
+		__m128 const t3 = _mm_unpackhi_ps(r2, r3);
+		x = _mm_movelh_ps(t0, t2);
+		y = _mm_movehl_ps(t2, t0);
+		z = _mm_movelh_ps(t1, t3);
+	}
+
+	GLM_FUNC_QUALIFIER void transformBounds4(mat4 const* Transforms, float const* const Center[3], float const* const Extent[3], float* const OutMin[3], float* const OutMax[3], std::size_t i)
+	{
+		__m128 m[4][3];
+		for(length_t Column = 0; Column < 4; ++Column)
+			loadColumn4(Transforms + i, Column, m[Column][0], m[Column][1], m[Column][2]);
+
+		__m128 const SignMask = _mm_set1_ps(-0.0f);
+		__m128 const cx = _mm_loadu_ps(Center[0] + i);
+		__m128 const cy = _mm_loadu_ps(Center[1] + i);
+		__m128 const cz = _mm_loadu_ps(Center[2] + i);
+		__m128 const ex = _mm_loadu_ps(Extent[0] + i);
+		__m128 const ey = _mm_loadu_ps(Extent[1] + i);
+		__m128 const ez = _mm_loadu_ps(Extent[2] + i);
+
+		for(length_t Row = 0; Row < 3; ++Row)
+		{
+			__m128 const WorldCenter = _mm_add_ps(_mm_add_ps(m[3][Row], _mm_mul_ps(m[0][Row], cx)), _mm_add_ps(_mm_mul_ps(m[1][Row], cy), _mm_mul_ps(m[2][Row], cz)));
+			__m128 const WorldExtent = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_andnot_ps(SignMask, m[0][Row]), ex),
+				_mm_mul_ps(_mm_andnot_ps(SignMask, m[1][Row]), ey)),
+				_mm_mul_ps(_mm_andnot_ps(SignMask, m[2][Row]), ez));
+			_mm_storeu_ps(OutMin[Row] + i, _mm_sub_ps(WorldCenter, WorldExtent));
+			_mm_storeu_ps(OutMax[Row] + i, _mm_add_ps(WorldCenter, WorldExtent));
+		}
+	}
+
+#	endif//GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_SSE2_BIT)
+
+#	if GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_AVX_BIT)
+
+	// Reads column Column of eight matrices as registers of their x, y and z components. Matrices 0 to 3 go to the low
+	// lanes and 4 to 7 to the high lanes, so the in-lane transpose keeps them in order.
+	GLM_FUNC_QUALIFIER void loadColumn8(mat4 const* Transforms, length_t Column, __m256& x, __m256& y, __m256& z)
+	{
+		__m256 const r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&Transforms[0][Column].x)), _mm_loadu_ps(&Transforms[4][Column].x), 1);
+		__m256 const r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&Transforms[1][Column].x)), _mm_loadu_ps(&Transforms[5][Column].x), 1);
+		__m256 const r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&Transforms[2][Column].x)), _mm_loadu_ps(&Transforms[6][Column].x), 1);
+		__m256 const r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&Transforms[3][Column].x)), _mm_loadu_ps(&Transforms[7][Column].x), 1);
+
+		__m256 const t0 = _mm256_unpacklo_ps(r0, r1);
+		__m256 const t1 = _mm256_unpackhi_ps(r0, r1);
+		__m256 const t2 = _mm256_unpacklo_ps(r2, r3);
+		__m256 const t3 = _mm256_unpackhi_ps(r2, r3);
+		x = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+		y = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+		z = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	}
+
+	GLM_FUNC_QUALIFIER void transformBounds8(mat4 const* Transforms, float const* const Center[3], float const* const Extent[3], float* const OutMin[3], float* const OutMax[3], std::size_t i)
+	{
+		__m256 m[4][3];
+		for(length_t Column = 0; Column < 4; ++Column)
+			loadColumn8(Transforms + i, Column, m[Column][0], m[Column][1], m[Column][2]);
+
+		__m256 const SignMask = _mm256_set1_ps(-0.0f);
+		__m256 const cx = _mm256_loadu_ps(Center[0] + i);
+		__m256 const cy = _mm256_loadu_ps(Center[1] + i);
+		__m256 const cz = _mm256_loadu_ps(Center[2] + i);
+		__m256 const ex = _mm256_loadu_ps(Extent[0] + i);
+		__m256 const ey = _mm256_loadu_ps(Extent[1] + i);
+		__m256 const ez = _mm256_loadu_ps(Extent[2] + i);
+
+		for(length_t Row = 0; Row < 3; ++Row)
+		{
+			__m256 const WorldCenter = _mm256_add_ps(_mm256_add_ps(m[3][Row], _mm256_mul_ps(m[0][Row], cx)), _mm256_add_ps(_mm256_mul_ps(m[1][Row], cy), _mm256_mul_ps(m[2][Row], cz)));
+			__m256 const WorldExtent = _mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(_mm256_andnot_ps(SignMask, m[0][Row]), ex),
+				_mm256_mul_ps(_mm256_andnot_ps(SignMask, m[1][Row]), ey)),
+				_mm256_mul_ps(_mm256_andnot_ps(SignMask, m[2][Row]), ez));
+			_mm256_storeu_ps(OutMin[Row] + i, _mm256_sub_ps(WorldCenter, WorldExtent));
+			_mm256_storeu_ps(OutMax[Row] + i, _mm256_add_ps(WorldCenter, WorldExtent));
+		}
+	}
+
+#	endif//GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_AVX_BIT)
+}//namespace detail
+
+	template<typename T, qualifier Q>
+	GLM_FUNC_QUALIFIER void transformBounds(mat<4, 4, T, Q> const& M, vec<3, T, Q> const& Center, vec<3, T, Q> const& Extent, vec<3, T, Q>& OutCenter, vec<3, T, Q>& OutExtent)
+	{
+		vec<3, T, Q> const WorldCenter = vec<3, T, Q>(M[3]) + vec<3, T, Q>(M[0]) * Center.x + vec<3, T, Q>(M[1]) * Center.y + vec<3, T, Q>(M[2]) * Center.z;
+		vec<3, T, Q> const WorldExtent = abs(vec<3, T, Q>(M[0])) * Extent.x + abs(vec<3, T, Q>(M[1])) * Extent.y + abs(vec<3, T, Q>(M[2])) * Extent.z;
+		OutCenter = WorldCenter;
+		OutExtent = WorldExtent;
+	}
+
+	template<typename T, qualifier Q>
+	GLM_FUNC_QUALIFIER void transformMinMax(mat<4, 4, T, Q> const& M, vec<3, T, Q> const& Min, vec<3, T, Q> const& Max, vec<3, T, Q>& OutMin, vec<3, T, Q>& OutMax)
+	{
+		vec<3, T, Q> Center, Extent;
+		transformBounds(M, (Min + Max) * static_cast<T>(0.5), (Max - Min) * static_cast<T>(0.5), Center, Extent);
+		OutMin = Center - Extent;
+		OutMax = Center + Extent;
+	}
+
+	GLM_FUNC_QUALIFIER void transformBoundsBulk(mat4 const* Transforms, float const* const Center[3], float const* const Extent[3], float* const OutMin[3], float* const OutMax[3], std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_AVX_BIT)
+			for(; i + 8 <= Count; i += 8)
+				detail::transformBounds8(Transforms, Center, Extent, OutMin, OutMax, i);
+#		endif
+#		if GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_SSE2_BIT)
+			for(; i + 4 <= Count; i += 4)
+				detail::transformBounds4(Transforms, Center, Extent, OutMin, OutMax, i);
+#		endif
+		detail::transformBoundsBulkScalar(Transforms, Center, Extent, OutMin, OutMax, i, Count);
+	}
+}//namespace glm
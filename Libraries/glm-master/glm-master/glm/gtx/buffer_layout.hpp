@@ -0,0 +1,110 @@
+/// @ref gtx_buffer_layout
+/// @file glm/gtx/buffer_layout.hpp
+///
+/// @see core (dependence)
+/// @see gtc_type_aligned (dependence)
+///
+/// @defgroup gtx_buffer_layout GLM_GTX_buffer_layout
+/// @ingroup gtx
+///
+/// Include <glm/gtx/buffer_layout.hpp> to use the features of this extension.
+///
+/// Compile-time offsets of GLSL interface blocks following the std140,
+/// std430 or scalar (GL_EXT_scalar_block_layout) rules.
+///
+/// A block is described as the list of its member types, in declaration order:
+/// @code
+/// typedef glm::buffer_layout<glm::std140_layout, glm::vec3, float, glm::mat3> block;
+/// static_assert(block::offset(1) == 12 && block::offset(2) == 16 && block::size() == 64, "");
+/// static_assert(block::matches(offsetof(S, a), offsetof(S, b), offsetof(S, c)), "S can be copied as is");
+/// @endcode
+///
+/// Vectors and matrices of any qualifier are accepted, including the
+/// gtc_type_aligned ones, and buffer_member::zero_copy tells whether the C++
+/// representation of a member already has the block's strides. When a C++
+/// struct doesn't match, buffer_layout::write copies the members one by one
+/// to their block offsets, padding matrix columns and array elements.
+///
+/// Requires C++11.
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include <cstddef>
+
+#ifndef GLM_ENABLE_EXPERIMENTAL
+#	error "GLM: GLM_GTX_buffer_layout is an experimental extension and may change in the future. Use #define GLM_ENABLE_EXPERIMENTAL before including it, if you really want to use it."
+#elif !(GLM_LANG & GLM_LANG_CXX11_FLAG)
+#	error "GLM: GLM_GTX_buffer_layout requires C++11 constexpr and variadic templates."
+#elif GLM_MESSAGES == GLM_ENABLE && !defined(GLM_EXT_INCLUDED)
+#	pragma message("GLM: GLM_GTX_buffer_layout extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_buffer_layout
+	/// @{
+
+	/// Packing rules of a GLSL interface block.
+	enum buffer_layout_rule
+	{
+		std140_layout,	///< Uniform blocks: arrays, matrix columns and structs are aligned to 16 bytes
+		std430_layout,	///< Shader storage blocks: like std140 without rounding arrays and structs to 16 bytes
+		scalar_layout	///< GL_EXT_scalar_block_layout: every member aligned to its component size
+	};
+
+	/// Base alignment and size of a member type under a layout rule.
+	///
+	/// Specialized for float, double, int, uint, vec, mat and arrays of those,
+	/// which all provide alignment(), size(), data_size(), zero_copy(), write()
+	/// and read(). data_size() leaves out the padding of array elements and
+	/// matrix columns.
+	/// A nested buffer_layout with the same rule can be a member too, for its
+	/// offsets only: it has no write() or read().
+	///
+	/// GLSL bool is four bytes and has no C++ counterpart, use uint instead.
+	///
+	/// @see gtx_buffer_layout
+	template<buffer_layout_rule Rule, typename T>
+	struct buffer_member;
+
+	/// Layout of a block whose members have the types Members, in declaration order.
+	///
+	/// @see gtx_buffer_layout
+	template<buffer_layout_rule Rule, typename... Members>
+	struct buffer_layout
+	{
+		/// Number of members.
+		GLM_FUNC_DECL static constexpr std::size_t count();
+
+		/// Byte offset of the member Index from the start of the block.
+		GLM_FUNC_DECL static constexpr std::size_t offset(std::size_t Index);
+
+		/// Base alignment of the block when it is nested in another block.
+		GLM_FUNC_DECL static constexpr std::size_t alignment();
+
+		/// Size of the block, rounded up to its alignment.
+		GLM_FUNC_DECL static constexpr std::size_t size();
+
+		/// Bytes holding member data, size() - data_size() is spent on padding.
+		GLM_FUNC_DECL static constexpr std::size_t data_size();
+
+		/// True when the Offsets of the members of a C++ struct, usually given with
+		/// offsetof, are the block offsets. The struct can then be copied as is if its
+		/// members are zero_copy and its size is size().
+		template<typename... Offsets>
+		GLM_FUNC_DECL static constexpr bool matches(Offsets... CppOffsets);
+
+		/// Copy Values to their block offsets in Dst, which must hold size() bytes.
+		/// Padding bytes are left untouched.
+		GLM_FUNC_DISCARD_DECL static void write(void* Dst, Members const&... Values);
+
+		/// Read Values from a block stored in Src.
+		GLM_FUNC_DISCARD_DECL static void read(void const* Src, Members&... Values);
+	};
+
+	/// @}
+}//namespace glm
+
+#include "buffer_layout.inl"
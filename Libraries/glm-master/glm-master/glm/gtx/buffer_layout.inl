@@ -0,0 +1,299 @@
+/// @ref gtx_buffer_layout
+
+#include <cstring>
+
+namespace glm{
+namespace detail
+{
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_round_up(std::size_t Value, std::size_t Alignment)
+	{
+		return (Value + Alignment - 1) / Alignment * Alignment;
+	}
+
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_max(std::size_t A, std::size_t B)
+	{
+		return A < B ? B : A;
+	}
+
+	template<typename T>
+	struct buffer_scalar
+	{
+		GLM_FUNC_QUALIFIER static constexpr std::size_t alignment(){return sizeof(T);}
+		GLM_FUNC_QUALIFIER static constexpr std::size_t size(){return sizeof(T);}
+		GLM_FUNC_QUALIFIER static constexpr std::size_t data_size(){return sizeof(T);}
+		GLM_FUNC_QUALIFIER static constexpr bool zero_copy(){return true;}
+
+		GLM_FUNC_QUALIFIER static void write(void* Dst, T const& Value)
+		{
+			std::memcpy(Dst, &Value, sizeof(T));
+		}
+
+		GLM_FUNC_QUALIFIER static void read(void const* Src, T& Value)
+		{
+			std::memcpy(&Value, Src, sizeof(T));
+		}
+	};
+
+	// Stride of array elements and matrix columns
+	template<buffer_layout_rule Rule, typename T>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_array_stride()
+	{
+		return Rule == std140_layout
+			? buffer_round_up(buffer_round_up(buffer_member<Rule, T>::size(), buffer_member<Rule, T>::alignment()), 16)
+			: buffer_round_up(buffer_member<Rule, T>::size(), buffer_member<Rule, T>::alignment());
+	}
+
+	template<buffer_layout_rule Rule, typename T>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_array_alignment()
+	{
+		return Rule == std140_layout
+			? buffer_round_up(buffer_member<Rule, T>::alignment(), 16)
+			: buffer_member<Rule, T>::alignment();
+	}
+
+	// Offset of the member Index of a block whose previous members end at End. Past the last member,
+	// it's where the last member ends.
+	template<buffer_layout_rule Rule>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_offset(std::size_t, std::size_t End)
+	{
+		return End;
+	}
+
+	template<buffer_layout_rule Rule, typename T, typename... Rest>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_offset(std::size_t Index, std::size_t End)
+	{
+		return Index == 0
+			? buffer_round_up(End, buffer_member<Rule, T>::alignment())
+			: buffer_offset<Rule, Rest...>(Index - 1, buffer_round_up(End, buffer_member<Rule, T>::alignment()) + buffer_member<Rule, T>::size());
+	}
+
+	template<buffer_layout_rule Rule>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_max_alignment()
+	{
+		return 1;
+	}
+
+	template<buffer_layout_rule Rule, typename T, typename... Rest>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_max_alignment()
+	{
+		return buffer_max(buffer_member<Rule, T>::alignment(), buffer_max_alignment<Rule, Rest...>());
+	}
+
+	template<buffer_layout_rule Rule>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_data_size()
+	{
+		return 0;
+	}
+
+	template<buffer_layout_rule Rule, typename T, typename... Rest>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_data_size()
+	{
+		return buffer_member<Rule, T>::data_size() + buffer_data_size<Rule, Rest...>();
+	}
+
+	template<typename Layout>
+	GLM_FUNC_QUALIFIER constexpr bool buffer_matches(std::size_t Index)
+	{
+		return Index == Layout::count();
+	}
+
+	template<typename Layout, typename... Offsets>
+	GLM_FUNC_QUALIFIER constexpr bool buffer_matches(std::size_t Index, std::size_t Offset, Offsets... Rest)
+	{
+		return Index < Layout::count() && Layout::offset(Index) == Offset && buffer_matches<Layout>(Index + 1, Rest...);
+	}
+
+	template<buffer_layout_rule Rule>
+	GLM_FUNC_QUALIFIER void buffer_write(unsigned char*, std::size_t)
+	{}
+
+	template<buffer_layout_rule Rule, typename T, typename... Rest>
+	GLM_FUNC_QUALIFIER void buffer_write(unsigned char* Dst, std::size_t End, T const& Value, Rest const&... Values)
+	{
+		std::size_t const Offset = buffer_round_up(End, buffer_member<Rule, T>::alignment());
+		buffer_member<Rule, T>::write(Dst + Offset, Value);
+		buffer_write<Rule>(Dst, Offset + buffer_member<Rule, T>::size(), Values...);
+	}
+
+	template<buffer_layout_rule Rule>
+	GLM_FUNC_QUALIFIER void buffer_read(unsigned char const*, std::size_t)
+	{}
+
+	template<buffer_layout_rule Rule, typename T, typename... Rest>
+	GLM_FUNC_QUALIFIER void buffer_read(unsigned char const* Src, std::size_t End, T& Value, Rest&... Values)
+	{
+		std::size_t const Offset = buffer_round_up(End, buffer_member<Rule, T>::alignment());
+		buffer_member<Rule, T>::read(Src + Offset, Value);
+		buffer_read<Rule>(Src, Offset + buffer_member<Rule, T>::size(), Values...);
+	}
+}//namespace detail
+
+	template<buffer_layout_rule Rule>
+	struct buffer_member<Rule, float> : public detail::buffer_scalar<float>
+	{};
+
+	template<buffer_layout_rule Rule>
+	struct buffer_member<Rule, double> : public detail::buffer_scalar<double>
+	{};
+
+	template<buffer_layout_rule Rule>
+	struct buffer_member<Rule, int> : public detail::buffer_scalar<int>
+	{};
+
+	template<buffer_layout_rule Rule>
+	struct buffer_member<Rule, unsigned int> : public detail::buffer_scalar<unsigned int>
+	{};
+
+	template<buffer_layout_rule Rule, length_t L, typename T, qualifier Q>
+	struct buffer_member<Rule, vec<L, T, Q> >
+	{
+		// A vec3 is aligned like a vec4 but only its three components are part of the block
+		GLM_FUNC_QUALIFIER static constexpr std::size_t alignment()
+		{
+			return Rule == scalar_layout
+				? buffer_member<Rule, T>::alignment()
+				: static_cast<std::size_t>(L == 3 ? 4 : L) * buffer_member<Rule, T>::alignment();
+		}
+
+		GLM_FUNC_QUALIFIER static constexpr std::size_t size(){return static_cast<std::size_t>(L) * buffer_member<Rule, T>::size();}
+		GLM_FUNC_QUALIFIER static constexpr std::size_t data_size(){return size();}
+		GLM_FUNC_QUALIFIER static constexpr bool zero_copy(){return true;}
+
+		GLM_FUNC_QUALIFIER static void write(void* Dst, vec<L, T, Q> const& Value)
+		{
+			std::memcpy(Dst, &Value[0], size());
+		}
+
+		GLM_FUNC_QUALIFIER static void read(void const* Src, vec<L, T, Q>& Value)
+		{
+			std::memcpy(&Value[0], Src, size());
+		}
+	};
+
+	template<buffer_layout_rule Rule, typename T, std::size_t N>
+	struct buffer_member<Rule, T[N]>
+	{
+		GLM_FUNC_QUALIFIER static constexpr std::size_t stride(){return detail::buffer_array_stride<Rule, T>();}
+		GLM_FUNC_QUALIFIER static constexpr std::size_t alignment(){return detail::buffer_array_alignment<Rule, T>();}
+		GLM_FUNC_QUALIFIER static constexpr std::size_t size(){return N * stride();}
+		GLM_FUNC_QUALIFIER static constexpr std::size_t data_size(){return N * buffer_member<Rule, T>::data_size();}
+		GLM_FUNC_QUALIFIER static constexpr bool zero_copy(){return buffer_member<Rule, T>::zero_copy() && sizeof(T) == stride();}
+
+		GLM_FUNC_QUALIFIER static void write(void* Dst, T const (&Value)[N])
+		{
+			GLM_IF_CONSTEXPR(zero_copy())
+				std::memcpy(Dst, Value, size());
+			else
+			{
+				for(std::size_t i = 0; i < N; ++i)
+					buffer_member<Rule, T>::write(static_cast<unsigned char*>(Dst) + i * stride(), Value[i]);
+			}
+		}
+
+		GLM_FUNC_QUALIFIER static void read(void const* Src, T (&Value)[N])
+		{
+			GLM_IF_CONSTEXPR(zero_copy())
+				std::memcpy(Value, Src, size());
+			else
+			{
+				for(std::size_t i = 0; i < N; ++i)
+					buffer_member<Rule, T>::read(static_cast<unsigned char const*>(Src) + i * stride(), Value[i]);
+			}
+		}
+	};
+
+	// Matrices are stored as arrays of column vectors
+	template<buffer_layout_rule Rule, length_t C, length_t R, typename T, qualifier Q>
+	struct buffer_member<Rule, mat<C, R, T, Q> >
+	{
+		typedef vec<R, T, Q> column;
+
+		GLM_FUNC_QUALIFIER static constexpr std::size_t stride(){return detail::buffer_array_stride<Rule, column>();}
+		GLM_FUNC_QUALIFIER static constexpr std::size_t alignment(){return detail::buffer_array_alignment<Rule, column>();}
+		GLM_FUNC_QUALIFIER static constexpr std::size_t size(){return static_cast<std::size_t>(C) * stride();}
+		GLM_FUNC_QUALIFIER static constexpr std::size_t data_size(){return static_cast<std::size_t>(C) * buffer_member<Rule, column>::data_size();}
+		GLM_FUNC_QUALIFIER static constexpr bool zero_copy(){return sizeof(column) == stride();}
+
+		GLM_FUNC_QUALIFIER static void write(void* Dst, mat<C, R, T, Q> const& Value)
+		{
+			GLM_IF_CONSTEXPR(zero_copy())
+				std::memcpy(Dst, &Value[0], size());
+			else
+			{
+				for(length_t i = 0; i < C; ++i)
+					buffer_member<Rule, column>::write(static_cast<unsigned char*>(Dst) + static_cast<std::size_t>(i) * stride(), Value[i]);
+			}
+		}
+
+		GLM_FUNC_QUALIFIER static void read(void const* Src, mat<C, R, T, Q>& Value)
+		{
+			GLM_IF_CONSTEXPR(zero_copy())
+				std::memcpy(&Value[0], Src, size());
+			else
+			{
+				for(length_t i = 0; i < C; ++i)
+					buffer_member<Rule, column>::read(static_cast<unsigned char const*>(Src) + static_cast<std::size_t>(i) * stride(), Value[i]);
+			}
+		}
+	};
+
+	template<buffer_layout_rule Rule, typename... Members>
+	struct buffer_member<Rule, buffer_layout<Rule, Members...> >
+	{
+		GLM_FUNC_QUALIFIER static constexpr std::size_t alignment(){return buffer_layout<Rule, Members...>::alignment();}
+		GLM_FUNC_QUALIFIER static constexpr std::size_t size(){return buffer_layout<Rule, Members...>::size();}
+		GLM_FUNC_QUALIFIER static constexpr std::size_t data_size(){return buffer_layout<Rule, Members...>::data_size();}
+		GLM_FUNC_QUALIFIER static constexpr bool zero_copy(){return false;}
+	};
+
+	template<buffer_layout_rule Rule, typename... Members>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_layout<Rule, Members...>::count()
+	{
+		return sizeof...(Members);
+	}
+
+	template<buffer_layout_rule Rule, typename... Members>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_layout<Rule, Members...>::offset(std::size_t Index)
+	{
+		return detail::buffer_offset<Rule, Members...>(Index, 0);
+	}
+
+	template<buffer_layout_rule Rule, typename... Members>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_layout<Rule, Members...>::alignment()
+	{
+		return Rule == std140_layout
+			? detail::buffer_round_up(detail::buffer_max_alignment<Rule, Members...>(), 16)
+			: detail::buffer_max_alignment<Rule, Members...>();
+	}
+
+	template<buffer_layout_rule Rule, typename... Members>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_layout<Rule, Members...>::size()
+	{
+		return detail::buffer_round_up(offset(count()), alignment());
+	}
+
+	template<buffer_layout_rule Rule, typename... Members>
+	GLM_FUNC_QUALIFIER constexpr std::size_t buffer_layout<Rule, Members...>::data_size()
+	{
+		return detail::buffer_data_size<Rule, Members...>();
+	}
+
+	template<buffer_layout_rule Rule, typename... Members>
+	template<typename... Offsets>
+	GLM_FUNC_QUALIFIER constexpr bool buffer_layout<Rule, Members...>::matches(Offsets... CppOffsets)
+	{
+		return sizeof...(Offsets) == sizeof...(Members) && detail::buffer_matches<buffer_layout<Rule, Members...> >(0, CppOffsets...);
+	}
+
+	template<buffer_layout_rule Rule, typename... Members>
+	GLM_FUNC_QUALIFIER void buffer_layout<Rule, Members...>::write(void* Dst, Members const&... Values)
+	{
+		detail::buffer_write<Rule>(static_cast<unsigned char*>(Dst), 0, Values...);
+	}
+
+	template<buffer_layout_rule Rule, typename... Members>
+	GLM_FUNC_QUALIFIER void buffer_layout<Rule, Members...>::read(void const* Src, Members&... Values)
+	{
+		detail::buffer_read<Rule>(static_cast<unsigned char const*>(Src), 0, Values...);
+	}
+}//namespace glm
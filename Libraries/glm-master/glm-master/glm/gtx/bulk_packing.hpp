@@ -0,0 +1,91 @@
+/// @ref gtx_bulk_packing
+/// @file glm/gtx/bulk_packing.hpp
+///
+/// @see core (dependence)
+/// @see gtc_packing (dependence)
+///
+/// @defgroup gtx_bulk_packing GLM_GTX_bulk_packing
+/// @ingroup gtx
+///
+/// Include <glm/gtx/bulk_packing.hpp> to use the features of this extension.
+///
+/// Convert large buffers to and from half, shared exponent (RGB9E5) and
+/// packed float (R11G11B10) formats.
+///
+/// The conversions produce the same bits as the gtc_packing functions applied
+/// element by element, except packF3x9_E1x5Bulk: it picks the shared exponent
+/// from the exponent bits rather than log2, see its documentation.
+///
+/// When GLM is built with AVX2 intrinsics (GLM_FORCE_INTRINSICS or
+/// GLM_FORCE_AVX2), eight elements are converted per iteration and the
+/// remaining elements go through the scalar path.
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include "../gtc/packing.hpp"
+#include <cstddef>
+
+#ifndef GLM_ENABLE_EXPERIMENTAL
+#	error "GLM: GLM_GTX_bulk_packing is an experimental extension and may change in the future. Use #define GLM_ENABLE_EXPERIMENTAL before including it, if you really want to use it."
+#elif GLM_MESSAGES == GLM_ENABLE && !defined(GLM_EXT_INCLUDED)
+#	pragma message("GLM: GLM_GTX_bulk_packing extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_bulk_packing
+	/// @{
+
+	/// Convert Count floating-point values to 16-bit floating-point values.
+	/// Out[i] is equal to packHalf1x16(In[i]).
+	///
+	/// @see gtx_bulk_packing
+	/// @see uint16 packHalf1x16(float v)
+	GLM_FUNC_DISCARD_DECL void packHalfBulk(float const* In, uint16* Out, std::size_t Count);
+
+	/// Convert Count 16-bit floating-point values to 32-bit floating-point values.
+	/// Out[i] is equal to unpackHalf1x16(In[i]).
+	///
+	/// With F16C, signaling NaN inputs are returned as quiet NaN.
+	///
+	/// @see gtx_bulk_packing
+	/// @see float unpackHalf1x16(uint16 v)
+	GLM_FUNC_DISCARD_DECL void unpackHalfBulk(uint16 const* In, float* Out, std::size_t Count);
+
+	/// Convert Count colors to the shared exponent RGB9E5 format.
+	///
+	/// The shared exponent is computed from the exponent bits of the largest component
+	/// instead of log2, so inputs just below a power of two may use a smaller exponent
+	/// than packF3x9_E1x5. Mantissas are rounded half up like packF3x9_E1x5.
+	///
+	/// @see gtx_bulk_packing
+	/// @see uint32 packF3x9_E1x5(vec3 const& v)
+	GLM_FUNC_DISCARD_DECL void packF3x9_E1x5Bulk(vec3 const* In, uint32* Out, std::size_t Count);
+
+	/// Convert Count RGB9E5 values to colors.
+	/// Out[i] is equal to unpackF3x9_E1x5(In[i]).
+	///
+	/// @see gtx_bulk_packing
+	/// @see vec3 unpackF3x9_E1x5(uint32 p)
+	GLM_FUNC_DISCARD_DECL void unpackF3x9_E1x5Bulk(uint32 const* In, vec3* Out, std::size_t Count);
+
+	/// Convert Count vectors to the packed float R11G11B10 format.
+	/// Out[i] is equal to packF2x11_1x10(In[i]).
+	///
+	/// @see gtx_bulk_packing
+	/// @see uint32 packF2x11_1x10(vec3 const& v)
+	GLM_FUNC_DISCARD_DECL void packF2x11_1x10Bulk(vec3 const* In, uint32* Out, std::size_t Count);
+
+	/// Convert Count packed float R11G11B10 values to vectors.
+	/// Out[i] is equal to unpackF2x11_1x10(In[i]).
+	///
+	/// @see gtx_bulk_packing
+	/// @see vec3 unpackF2x11_1x10(uint32 p)
+	GLM_FUNC_DISCARD_DECL void unpackF2x11_1x10Bulk(uint32 const* In, vec3* Out, std::size_t Count);
+
+	/// @}
+}//namespace glm
+
+#include "bulk_packing.inl"
@@ -0,0 +1,328 @@
+/// @ref gtx_bulk_packing
+
+#include <cstring>
+
+namespace glm{
+namespace detail
+{
+	GLM_FUNC_QUALIFIER uint32 packF3x9_E1x5Exponent(vec3 const& v)
+	{
+		// Same as packF3x9_E1x5 except floor(log2(MaxColor)) is read from the exponent bits
+		float const SharedExpMax = 32768.f;
+		vec3 const Color = clamp(v, 0.0f, SharedExpMax);
+		float const MaxColor = max(Color.x, max(Color.y, Color.z));
+
+		uint32 MaxBits = 0;
+		memcpy(&MaxBits, &MaxColor, sizeof(MaxBits));
+		int const ExpSharedP = max(-16, static_cast<int>((MaxBits >> 23) & 0xff) - 127) + 16;
+
+		uint32 const ScaleBitsP = static_cast<uint32>(151 - ExpSharedP) << 23;
+		float ScaleP = 0.f;
+		memcpy(&ScaleP, &ScaleBitsP, sizeof(ScaleP));
+		float const MaxShared = floor(MaxColor * ScaleP + 0.5f);
+		int const ExpShared = MaxShared >= 512.f ? ExpSharedP + 1 : ExpSharedP;
+
+		uint32 const ScaleBits = static_cast<uint32>(151 - ExpShared) << 23;
+		float Scale = 0.f;
+		memcpy(&Scale, &ScaleBits, sizeof(Scale));
+		uvec3 const ColorComp(floor(Color * Scale + 0.5f));
+
+		return ColorComp.x | (ColorComp.y << 9) | (ColorComp.z << 18) | (static_cast<uint32>(ExpShared) << 27);
+	}
+
+	GLM_FUNC_QUALIFIER void packHalfBulkScalar(float const* In, uint16* Out, std::size_t Count)
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Out[i] = packHalf1x16(In[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackHalfBulkScalar(uint16 const* In, float* Out, std::size_t Count)
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Out[i] = unpackHalf1x16(In[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void packF3x9_E1x5BulkScalar(vec3 const* In, uint32* Out, std::size_t Count)
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Out[i] = packF3x9_E1x5Exponent(In[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackF3x9_E1x5BulkScalar(uint32 const* In, vec3* Out, std::size_t Count)
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Out[i] = unpackF3x9_E1x5(In[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void packF2x11_1x10BulkScalar(vec3 const* In, uint32* Out, std::size_t Count)
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Out[i] = packF2x11_1x10(In[i]);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackF2x11_1x10BulkScalar(uint32 const* In, vec3* Out, std::size_t Count)
+	{
+		for(std::size_t i = 0; i < Count; ++i)
+			Out[i] = unpackF2x11_1x10(In[i]);
+	}
+
+#	if GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_AVX2_BIT)
+
+	// Reads eight vec3 as three registers of x, y and z components
+	GLM_FUNC_QUALIFIER void loadVec3x8(vec3 const* In, __m256& x, __m256& y, __m256& z)
+	{
+		__m256i const Stride = _mm256_set1_epi32(static_cast<int>(sizeof(vec3) / sizeof(float)));
+		__m256i const Index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), Stride);
+		float const* Base = &In[0].x;
+		x = _mm256_i32gather_ps(Base + 0, Index, 4);
+		y = _mm256_i32gather_ps(Base + 1, Index, 4);
+		z = _mm256_i32gather_ps(Base + 2, Index, 4);
+	}
+
+	GLM_FUNC_QUALIFIER void storeVec3x8(vec3* Out, __m256 x, __m256 y, __m256 z)
+	{
+		float X[8], Y[8], Z[8];
+		_mm256_storeu_ps(X, x);
+		_mm256_storeu_ps(Y, y);
+		_mm256_storeu_ps(Z, z);
+		for(int i = 0; i < 8; ++i)
+			Out[i] = vec3(X[i], Y[i], Z[i]);
+	}
+
+	// Integer transcription of detail::toFloat16 so that ties round up like the scalar path.
+	// F16C vcvtps2ph rounds ties to even and can't be used here.
+	GLM_FUNC_QUALIFIER void packHalf8(float const* In, uint16* Out)
+	{
+		__m256i const i = _mm256_castps_si256(_mm256_loadu_ps(In));
+		__m256i const s = _mm256_and_si256(_mm256_srli_epi32(i, 16), _mm256_set1_epi32(0x00008000));
+		__m256i const e = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(i, 23), _mm256_set1_epi32(0x000000ff)), _mm256_set1_epi32(127 - 15));
+		__m256i const m = _mm256_and_si256(i, _mm256_set1_epi32(0x007fffff));
+		__m256i const One = _mm256_set1_epi32(1);
+
+		// Denormalized half, rounding may carry into the exponent
+		__m256i const Denorm = _mm256_srlv_epi32(_mm256_or_si256(m, _mm256_set1_epi32(0x00800000)), _mm256_sub_epi32(One, e));
+		__m256i const DenormHalf = _mm256_add_epi32(_mm256_srli_epi32(Denorm, 13), _mm256_and_si256(_mm256_srli_epi32(Denorm, 12), One));
+
+		// Normalized half, rounding may carry into the exponent and overflow to infinity
+		__m256i const NormHalf = _mm256_min_epi32(
+			_mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(e, 10), _mm256_srli_epi32(m, 13)), _mm256_and_si256(_mm256_srli_epi32(m, 12), One)),
+			_mm256_set1_epi32(0x7c00));
+
+		// Infinity and NaN, NaN keeps at least one significand bit
+		__m256i const NanBits = _mm256_srli_epi32(m, 13);
+		__m256i const NanZero = _mm256_and_si256(_mm256_cmpeq_epi32(NanBits, _mm256_setzero_si256()), One);
+		__m256i const InfNan = _mm256_blendv_epi8(
+			_mm256_or_si256(_mm256_set1_epi32(0x7c00), _mm256_or_si256(NanBits, NanZero)),
+			_mm256_set1_epi32(0x7c00),
+			_mm256_cmpeq_epi32(m, _mm256_setzero_si256()));
+
+		__m256i const IsDenorm = _mm256_cmpgt_epi32(One, e);
+		__m256i const IsZero = _mm256_cmpgt_epi32(_mm256_set1_epi32(-10), e);
+		__m256i const IsInfNan = _mm256_cmpeq_epi32(e, _mm256_set1_epi32(0xff - (127 - 15)));
+
+		__m256i Result = _mm256_blendv_epi8(NormHalf, DenormHalf, IsDenorm);
+		Result = _mm256_andnot_si256(IsZero, Result);
+		Result = _mm256_blendv_epi8(Result, InfNan, IsInfNan);
+		Result = _mm256_or_si256(Result, s);
+
+		__m256i const Packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(Result, Result), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(Out), _mm256_castsi256_si128(Packed));
+	}
+
+	GLM_FUNC_QUALIFIER void unpackHalf8(uint16 const* In, float* Out)
+	{
+		__m128i const h = _mm_loadu_si128(reinterpret_cast<__m128i const*>(In));
+#		if defined(__F16C__) || (GLM_COMPILER & GLM_COMPILER_VC)
+			_mm256_storeu_ps(Out, _mm256_cvtph_ps(h));
+#		else
+			__m256i const i = _mm256_cvtepu16_epi32(h);
+			__m256i const s = _mm256_slli_epi32(_mm256_and_si256(i, _mm256_set1_epi32(0x8000)), 16);
+			__m256i const e = _mm256_and_si256(_mm256_srli_epi32(i, 10), _mm256_set1_epi32(0x1f));
+			__m256i const m = _mm256_and_si256(i, _mm256_set1_epi32(0x3ff));
+
+			__m256i const Norm = _mm256_or_si256(_mm256_slli_epi32(_mm256_add_epi32(e, _mm256_set1_epi32(127 - 15)), 23), _mm256_slli_epi32(m, 13));
+			__m256i const InfNan = _mm256_or_si256(_mm256_set1_epi32(0x7f800000), _mm256_slli_epi32(m, 13));
+			// Denormalized halfs are exactly m * 2^-24
+			__m256i const Denorm = _mm256_castps_si256(_mm256_mul_ps(_mm256_cvtepi32_ps(m), _mm256_set1_ps(5.9604644775390625e-8f)));
+
+			__m256i Result = _mm256_blendv_epi8(Norm, Denorm, _mm256_cmpeq_epi32(e, _mm256_setzero_si256()));
+			Result = _mm256_blendv_epi8(Result, InfNan, _mm256_cmpeq_epi32(e, _mm256_set1_epi32(0x1f)));
+			_mm256_storeu_ps(Out, _mm256_castsi256_ps(_mm256_or_si256(Result, s)));
+#		endif
+	}
+
+	GLM_FUNC_QUALIFIER __m256i packF3x9_E1x5Scale(__m256i ExpShared)
+	{
+		return _mm256_slli_epi32(_mm256_sub_epi32(_mm256_set1_epi32(151), ExpShared), 23);
+	}
+
+	GLM_FUNC_QUALIFIER void packF3x9_E1x58(vec3 const* In, uint32* Out)
+	{
+		__m256 x, y, z;
+		loadVec3x8(In, x, y, z);
+
+		__m256 const Zero = _mm256_setzero_ps();
+		__m256 const SharedExpMax = _mm256_set1_ps(32768.f);
+		__m256 const Half = _mm256_set1_ps(0.5f);
+		x = _mm256_min_ps(_mm256_max_ps(x, Zero), SharedExpMax);
+		y = _mm256_min_ps(_mm256_max_ps(y, Zero), SharedExpMax);
+		z = _mm256_min_ps(_mm256_max_ps(z, Zero), SharedExpMax);
+		__m256 const MaxColor = _mm256_max_ps(x, _mm256_max_ps(y, z));
+
+		__m256i const MaxExp = _mm256_and_si256(_mm256_srli_epi32(_mm256_castps_si256(MaxColor), 23), _mm256_set1_epi32(0xff));
+		__m256i const ExpSharedP = _mm256_add_epi32(_mm256_max_epi32(_mm256_sub_epi32(MaxExp, _mm256_set1_epi32(127)), _mm256_set1_epi32(-16)), _mm256_set1_epi32(16));
+
+		__m256 const MaxShared = _mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(MaxColor, _mm256_castsi256_ps(packF3x9_E1x5Scale(ExpSharedP))), Half));
+		__m256i const Overflow = _mm256_castps_si256(_mm256_cmp_ps(MaxShared, _mm256_set1_ps(512.f), _CMP_GE_OQ));
+		__m256i const ExpShared = _mm256_sub_epi32(ExpSharedP, Overflow);
+		__m256 const Scale = _mm256_castsi256_ps(packF3x9_E1x5Scale(ExpShared));
+
+		__m256i const r = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(x, Scale), Half)));
+		__m256i const g = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(y, Scale), Half)));
+		__m256i const b = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(z, Scale), Half)));
+
+		__m256i Result = _mm256_or_si256(r, _mm256_slli_epi32(g, 9));
+		Result = _mm256_or_si256(Result, _mm256_slli_epi32(b, 18));
+		Result = _mm256_or_si256(Result, _mm256_slli_epi32(ExpShared, 27));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(Out), Result);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackF3x9_E1x58(uint32 const* In, vec3* Out)
+	{
+		__m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(In));
+		__m256i const Mask = _mm256_set1_epi32(0x1ff);
+		__m256i const Exp = _mm256_srli_epi32(v, 27);
+		__m256 const Scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(Exp, _mm256_set1_epi32(127 - 15 - 9)), 23));
+
+		storeVec3x8(Out,
+			_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(v, Mask)), Scale),
+			_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(v, 9), Mask)), Scale),
+			_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(v, 18), Mask)), Scale));
+	}
+
+	// Transcription of detail::floatTo11bit (Shift == 17) and detail::floatTo10bit (Shift == 18)
+	GLM_FUNC_QUALIFIER __m256i floatToPacked8(__m256 v, int Shift)
+	{
+		__m128i const Count = _mm_cvtsi32_si128(Shift);
+		__m256i const Mantissa = _mm256_set1_epi32(0x7fffff >> Shift);
+		__m256i const Exponent = _mm256_set1_epi32((0x1f << 23) >> Shift);
+		__m256i const Inf = Exponent;
+		__m256i const Nan = _mm256_or_si256(Exponent, Mantissa);
+
+		__m256i const f = _mm256_castps_si256(v);
+		__m256i const Biased = _mm256_sub_epi32(_mm256_and_si256(f, _mm256_set1_epi32(0x7f800000)), _mm256_set1_epi32(0x38000000));
+		__m256i Result = _mm256_or_si256(
+			_mm256_and_si256(_mm256_srl_epi32(Biased, Count), Exponent),
+			_mm256_and_si256(_mm256_srl_epi32(f, Count), Mantissa));
+
+		__m256i const IsInf = _mm256_cmpeq_epi32(_mm256_and_si256(f, _mm256_set1_epi32(0x7fffffff)), _mm256_set1_epi32(0x7f800000));
+		__m256i const IsNan = _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+		__m256i const IsZero = _mm256_castps_si256(_mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_EQ_OQ));
+		Result = _mm256_blendv_epi8(Result, Inf, IsInf);
+		Result = _mm256_blendv_epi8(Result, Nan, IsNan);
+		return _mm256_andnot_si256(IsZero, Result);
+	}
+
+	// Transcription of detail::packed11bitToFloat (Shift == 17) and detail::packed10bitToFloat (Shift == 18),
+	// the special values are compared against the unmasked input like the scalar functions
+	GLM_FUNC_QUALIFIER __m256 packedToFloat8(__m256i p, int Shift)
+	{
+		__m128i const Count = _mm_cvtsi32_si128(Shift);
+		__m256i const Mantissa = _mm256_set1_epi32(0x7fffff >> Shift);
+		__m256i const Exponent = _mm256_set1_epi32((0x1f << 23) >> Shift);
+		__m256i const Nan = _mm256_or_si256(Exponent, Mantissa);
+
+		__m256i const Bits = _mm256_or_si256(
+			_mm256_and_si256(_mm256_add_epi32(_mm256_sll_epi32(_mm256_and_si256(p, Exponent), Count), _mm256_set1_epi32(0x38000000)), _mm256_set1_epi32(0x7f800000)),
+			_mm256_sll_epi32(_mm256_and_si256(p, Mantissa), Count));
+
+		__m256i const IsSpecial = _mm256_or_si256(_mm256_cmpeq_epi32(p, Exponent), _mm256_cmpeq_epi32(p, Nan));
+		__m256i const IsZero = _mm256_cmpeq_epi32(p, _mm256_setzero_si256());
+		__m256 const Result = _mm256_blendv_ps(_mm256_castsi256_ps(Bits), _mm256_set1_ps(-1.0f), _mm256_castsi256_ps(IsSpecial));
+		return _mm256_andnot_ps(_mm256_castsi256_ps(IsZero), Result);
+	}
+
+	GLM_FUNC_QUALIFIER void packF2x11_1x108(vec3 const* In, uint32* Out)
+	{
+		__m256 x, y, z;
+		loadVec3x8(In, x, y, z);
+
+		__m256i Result = floatToPacked8(x, 17);
+		Result = _mm256_or_si256(Result, _mm256_slli_epi32(floatToPacked8(y, 17), 11));
+		Result = _mm256_or_si256(Result, _mm256_slli_epi32(floatToPacked8(z, 18), 22));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(Out), Result);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackF2x11_1x108(uint32 const* In, vec3* Out)
+	{
+		__m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(In));
+
+		storeVec3x8(Out,
+			packedToFloat8(v, 17),
+			packedToFloat8(_mm256_srli_epi32(v, 11), 17),
+			packedToFloat8(_mm256_srli_epi32(v, 22), 18));
+	}
+
+#	endif//GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_AVX2_BIT)
+}//namespace detail
+
+	GLM_FUNC_QUALIFIER void packHalfBulk(float const* In, uint16* Out, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_AVX2_BIT)
+			for(; i + 8 <= Count; i += 8)
+				detail::packHalf8(In + i, Out + i);
+#		endif
+		detail::packHalfBulkScalar(In + i, Out + i, Count - i);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackHalfBulk(uint16 const* In, float* Out, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_AVX2_BIT)
+			for(; i + 8 <= Count; i += 8)
+				detail::unpackHalf8(In + i, Out + i);
+#		endif
+		detail::unpackHalfBulkScalar(In + i, Out + i, Count - i);
+	}
+
+	GLM_FUNC_QUALIFIER void packF3x9_E1x5Bulk(vec3 const* In, uint32* Out, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_AVX2_BIT)
+			for(; i + 8 <= Count; i += 8)
+				detail::packF3x9_E1x58(In + i, Out + i);
+#		endif
+		detail::packF3x9_E1x5BulkScalar(In + i, Out + i, Count - i);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackF3x9_E1x5Bulk(uint32 const* In, vec3* Out, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_AVX2_BIT)
+			for(; i + 8 <= Count; i += 8)
+				detail::unpackF3x9_E1x58(In + i, Out + i);
+#		endif
+		detail::unpackF3x9_E1x5BulkScalar(In + i, Out + i, Count - i);
+	}
+
+	GLM_FUNC_QUALIFIER void packF2x11_1x10Bulk(vec3 const* In, uint32* Out, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_AVX2_BIT)
+			for(; i + 8 <= Count; i += 8)
+				detail::packF2x11_1x108(In + i, Out + i);
+#		endif
+		detail::packF2x11_1x10BulkScalar(In + i, Out + i, Count - i);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackF2x11_1x10Bulk(uint32 const* In, vec3* Out, std::size_t Count)
+	{
+		std::size_t i = 0;
+#		if GLM_CONFIG_SIMD == GLM_ENABLE && (GLM_ARCH & GLM_ARCH_AVX2_BIT)
+			for(; i + 8 <= Count; i += 8)
+				detail::unpackF2x11_1x108(In + i, Out + i);
+#		endif
+		detail::unpackF2x11_1x10BulkScalar(In + i, Out + i, Count - i);
+	}
+}//namespace glm
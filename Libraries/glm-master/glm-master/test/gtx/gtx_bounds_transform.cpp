@@ -0,0 +1,142 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/bounds_transform.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/scalar_relational.hpp>
+#include <glm/ext/vector_relational.hpp>
+#include <vector>
+
+static glm::uint32 hashBits(glm::uint32 i)
+{
+	i ^= i >> 16;
+	i *= 0x7feb352dU;
+	i ^= i >> 15;
+	i *= 0x846ca68bU;
+	i ^= i >> 16;
+	return i;
+}
+
+// Uniform in [-1, 1)
+static float hashFloat(glm::uint32 i)
+{
+	return static_cast<float>(hashBits(i) >> 8) / 8388608.f - 1.f;
+}
+
+static glm::mat4 makeTransform(glm::uint32 Seed)
+{
+	glm::vec3 const Axis(hashFloat(Seed * 8 + 0), hashFloat(Seed * 8 + 1), hashFloat(Seed * 8 + 2) + 2.f);
+	glm::mat4 M = glm::translate(glm::mat4(1.f), glm::vec3(hashFloat(Seed * 8 + 3), hashFloat(Seed * 8 + 4), hashFloat(Seed * 8 + 5)) * 100.f);
+	M = glm::rotate(M, hashFloat(Seed * 8 + 6) * 3.f, glm::normalize(Axis));
+	return glm::scale(M, glm::vec3(1.5f, -0.5f, 2.f) + hashFloat(Seed * 8 + 7));
+}
+
+// Reference: the box of the eight transformed corners
+static void transformCorners(glm::mat4 const& M, glm::vec3 const& Min, glm::vec3 const& Max, glm::vec3& OutMin, glm::vec3& OutMax)
+{
+	OutMin = glm::vec3(1e30f);
+	OutMax = glm::vec3(-1e30f);
+	for(int Corner = 0; Corner < 8; ++Corner)
+	{
+		glm::vec3 const Local((Corner & 1) ? Max.x : Min.x, (Corner & 2) ? Max.y : Min.y, (Corner & 4) ? Max.z : Min.z);
+		glm::vec3 const World(M * glm::vec4(Local, 1.f));
+		OutMin = glm::min(OutMin, World);
+		OutMax = glm::max(OutMax, World);
+	}
+}
+
+static int test_transformMinMax()
+{
+	int Error = 0;
+
+	for(glm::uint32 i = 0; i < 256; ++i)
+	{
+		glm::mat4 const M = makeTransform(i);
+		glm::vec3 const Center(hashFloat(i * 3 + 1000), hashFloat(i * 3 + 1001), hashFloat(i * 3 + 1002));
+		glm::vec3 const Extent = glm::abs(glm::vec3(hashFloat(i * 3 + 2000), hashFloat(i * 3 + 2001), hashFloat(i * 3 + 2002))) * 4.f;
+
+		glm::vec3 ExpectedMin, ExpectedMax;
+		transformCorners(M, Center - Extent, Center + Extent, ExpectedMin, ExpectedMax);
+
+		glm::vec3 Min, Max;
+		glm::transformMinMax(M, Center - Extent, Center + Extent, Min, Max);
+		Error += glm::all(glm::equal(Min, ExpectedMin, 0.001f)) ? 0 : 1;
+		Error += glm::all(glm::equal(Max, ExpectedMax, 0.001f)) ? 0 : 1;
+
+		glm::vec3 WorldCenter, WorldExtent;
+		glm::transformBounds(M, Center, Extent, WorldCenter, WorldExtent);
+		Error += glm::all(glm::equal(WorldCenter, (ExpectedMin + ExpectedMax) * 0.5f, 0.001f)) ? 0 : 1;
+		Error += glm::all(glm::equal(WorldExtent, (ExpectedMax - ExpectedMin) * 0.5f, 0.001f)) ? 0 : 1;
+	}
+
+	// The outputs may alias the inputs
+	{
+		glm::mat4 const M = glm::translate(glm::mat4(1.f), glm::vec3(1.f, 2.f, 3.f));
+		glm::vec3 Min(-1.f), Max(1.f);
+		glm::transformMinMax(M, Min, Max, Min, Max);
+		Error += glm::all(glm::equal(Min, glm::vec3(0.f, 1.f, 2.f), 0.0001f)) ? 0 : 1;
+		Error += glm::all(glm::equal(Max, glm::vec3(2.f, 3.f, 4.f), 0.0001f)) ? 0 : 1;
+	}
+
+	return Error;
+}
+
+static int test_transformBoundsBulk()
+{
+	int Error = 0;
+
+	// Counts that leave a remainder for the scalar path after the SIMD iterations
+	for(std::size_t Count = 0; Count < 40; Count += 3)
+	{
+		std::vector<glm::mat4> Transforms;
+		std::vector<float> Center[3], Extent[3], Min[3], Max[3];
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			glm::uint32 const Seed = static_cast<glm::uint32>(Count * 64 + i);
+			Transforms.push_back(makeTransform(Seed));
+			for(int c = 0; c < 3; ++c)
+			{
+				Center[c].push_back(hashFloat(Seed * 6 + static_cast<glm::uint32>(c)) * 10.f);
+				Extent[c].push_back(glm::abs(hashFloat(Seed * 6 + 3 + static_cast<glm::uint32>(c))) * 5.f);
+			}
+		}
+		for(int c = 0; c < 3; ++c)
+		{
+			// One more element than Count to catch writes past the end
+			Min[c].assign(Count + 1, 42.f);
+			Max[c].assign(Count + 1, 42.f);
+		}
+
+		float const* const CenterPtr[3] = { Center[0].data(), Center[1].data(), Center[2].data() };
+		float const* const ExtentPtr[3] = { Extent[0].data(), Extent[1].data(), Extent[2].data() };
+		float* const MinPtr[3] = { Min[0].data(), Min[1].data(), Min[2].data() };
+		float* const MaxPtr[3] = { Max[0].data(), Max[1].data(), Max[2].data() };
+		glm::transformBoundsBulk(Transforms.data(), CenterPtr, ExtentPtr, MinPtr, MaxPtr, Count);
+
+		for(std::size_t i = 0; i < Count; ++i)
+		{
+			glm::vec3 const LocalCenter(Center[0][i], Center[1][i], Center[2][i]);
+			glm::vec3 const LocalExtent(Extent[0][i], Extent[1][i], Extent[2][i]);
+			glm::vec3 ExpectedMin, ExpectedMax;
+			transformCorners(Transforms[i], LocalCenter - LocalExtent, LocalCenter + LocalExtent, ExpectedMin, ExpectedMax);
+
+			Error += glm::all(glm::equal(glm::vec3(Min[0][i], Min[1][i], Min[2][i]), ExpectedMin, 0.001f)) ? 0 : 1;
+			Error += glm::all(glm::equal(glm::vec3(Max[0][i], Max[1][i], Max[2][i]), ExpectedMax, 0.001f)) ? 0 : 1;
+		}
+		for(int c = 0; c < 3; ++c)
+		{
+			Error += glm::equal(Min[c][Count], 42.f, 0.f) ? 0 : 1;
+			Error += glm::equal(Max[c][Count], 42.f, 0.f) ? 0 : 1;
+		}
+	}
+
+	return Error;
+}
+
+int main()
+{
+	int Error = 0;
+
+	Error += test_transformMinMax();
+	Error += test_transformBoundsBulk();
+
+	return Error;
+}
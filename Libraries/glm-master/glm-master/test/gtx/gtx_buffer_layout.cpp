@@ -0,0 +1,223 @@
+#define GLM_FORCE_ALIGNED_GENTYPES
+#include <glm/detail/setup.hpp>
+
+#if GLM_LANG & GLM_LANG_CXX11_FLAG
+
+#if GLM_COMPILER & GLM_COMPILER_CLANG
+#	pragma clang diagnostic push
+#	pragma clang diagnostic ignored "-Wfloat-equal"
+#endif
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/buffer_layout.hpp>
+#include <glm/ext/vector_relational.hpp>
+#include <glm/ext/matrix_relational.hpp>
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+#	include <glm/gtc/type_aligned.hpp>
+#endif
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// The example block of the std140 and std430 sections of the OpenGL specification, with bvec2 e
+// replaced by uvec2:
+//
+//	struct S { int d; uvec2 e; };
+//	struct T { uvec3 j; vec2 k; float l[2]; vec2 m; mat3 n[2]; };
+//	uniform Example { float a; vec2 b; vec3 c; S f; float g; float h[2]; mat2x3 i; T o[2]; };
+template<glm::buffer_layout_rule Rule>
+struct spec_example
+{
+	typedef glm::buffer_layout<Rule, int, glm::uvec2> S;
+	typedef glm::buffer_layout<Rule, glm::uvec3, glm::vec2, float[2], glm::vec2, glm::mat3[2]> T;
+	typedef glm::buffer_layout<Rule, float, glm::vec2, glm::vec3, S, float, float[2], glm::mat2x3, T[2]> block;
+};
+
+typedef spec_example<glm::std140_layout> std140_example;
+static_assert(std140_example::block::offset(0) == 0, "a");
+static_assert(std140_example::block::offset(1) == 8, "b");
+static_assert(std140_example::block::offset(2) == 16, "c");
+static_assert(std140_example::block::offset(3) == 32, "f");
+static_assert(std140_example::S::offset(1) == 8, "f.e");
+static_assert(std140_example::block::offset(4) == 48, "g");
+static_assert(std140_example::block::offset(5) == 64, "h");
+static_assert(std140_example::block::offset(6) == 96, "i");
+static_assert(std140_example::block::offset(7) == 128, "o");
+static_assert(std140_example::T::offset(1) == 16, "o[0].k");
+static_assert(std140_example::T::offset(2) == 32, "o[0].l");
+static_assert(std140_example::T::offset(3) == 64, "o[0].m");
+static_assert(std140_example::T::offset(4) == 80, "o[0].n");
+static_assert(std140_example::T::size() == 176, "o[1] starts at 304");
+static_assert(std140_example::block::size() == 480, "Example");
+
+typedef spec_example<glm::std430_layout> std430_example;
+static_assert(std430_example::block::offset(3) == 32, "f");
+static_assert(std430_example::block::offset(4) == 48, "g");
+static_assert(std430_example::block::offset(5) == 52, "h");
+static_assert(std430_example::block::offset(6) == 64, "i");
+static_assert(std430_example::block::offset(7) == 96, "o");
+static_assert(std430_example::T::offset(2) == 24, "o[0].l");
+static_assert(std430_example::T::offset(3) == 32, "o[0].m");
+static_assert(std430_example::T::offset(4) == 48, "o[0].n");
+static_assert(std430_example::T::size() == 144, "o[1] starts at 240");
+static_assert(std430_example::block::size() == 384, "Example");
+
+// Tightly packed alternative: a float after a vec3, and a vec3 after a float
+typedef glm::buffer_layout<glm::scalar_layout, float, glm::vec3, float, glm::mat3> scalar_block;
+static_assert(scalar_block::offset(1) == 4 && scalar_block::offset(2) == 16 && scalar_block::offset(3) == 20, "scalar offsets");
+static_assert(scalar_block::size() == scalar_block::data_size(), "no padding in scalar layout");
+typedef glm::buffer_layout<glm::std140_layout, float, glm::vec3, float, glm::mat3> std140_block;
+static_assert(std140_block::offset(1) == 16 && std140_block::offset(2) == 28 && std140_block::offset(3) == 32, "std140 offsets");
+static_assert(std140_block::size() - std140_block::data_size() == 24, "std140 padding");
+
+static_assert(!glm::buffer_member<glm::std140_layout, glm::mat3>::zero_copy(), "mat3 columns are padded to 16 bytes");
+static_assert(glm::buffer_member<glm::scalar_layout, glm::mat3>::zero_copy(), "mat3 columns are packed");
+static_assert(!glm::buffer_member<glm::std140_layout, float[4]>::zero_copy(), "std140 array stride is 16");
+static_assert(glm::buffer_member<glm::std430_layout, float[4]>::zero_copy(), "std430 array stride is 4");
+static_assert(glm::buffer_member<glm::std140_layout, glm::mat4>::zero_copy(), "mat4 columns are vec4");
+
+struct packed_block
+{
+	float a;
+	glm::vec3 b;
+	float c;
+	glm::mat3 d;
+};
+
+static_assert(!std140_block::matches(offsetof(packed_block, a), offsetof(packed_block, b), offsetof(packed_block, c), offsetof(packed_block, d)), "vec3 after float");
+static_assert(!std140_block::matches(0u, 16u, 28u), "too few offsets");
+static_assert(!std140_block::matches(0u, 16u, 28u, 32u, 80u), "too many offsets");
+
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+	struct aligned_block
+	{
+		glm::aligned_vec4 a;
+		glm::vec3 b;
+		float c;
+		glm::aligned_vec2 d;
+		glm::vec2 g;
+		glm::aligned_mat3 e;
+		glm::aligned_mat4 f;
+	};
+
+	typedef glm::buffer_layout<glm::std140_layout, glm::aligned_vec4, glm::vec3, float, glm::aligned_vec2, glm::vec2, glm::aligned_mat3, glm::aligned_mat4> aligned_std140;
+	static_assert(aligned_std140::matches(
+		offsetof(aligned_block, a), offsetof(aligned_block, b), offsetof(aligned_block, c),
+		offsetof(aligned_block, d), offsetof(aligned_block, g), offsetof(aligned_block, e), offsetof(aligned_block, f)), "aligned_block follows std140");
+	static_assert(sizeof(aligned_block) == aligned_std140::size(), "aligned_block size");
+	static_assert(glm::buffer_member<glm::std140_layout, glm::aligned_mat3>::zero_copy(), "aligned_vec3 columns are 16 bytes");
+	static_assert(glm::buffer_member<glm::std140_layout, glm::aligned_vec3[2]>::zero_copy(), "aligned_vec3 array stride is 16");
+#endif
+
+static int test_write()
+{
+	int Error = 0;
+
+	float const A = 1.0f;
+	glm::vec3 const B(2.0f, 3.0f, 4.0f);
+	float const C = 5.0f;
+	glm::mat3 const D(6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f);
+
+	std::vector<unsigned char> Buffer(std140_block::size(), 0xFF);
+	std140_block::write(&Buffer[0], A, B, C, D);
+
+	float Floats[std140_block::size() / sizeof(float)];
+	std::memcpy(Floats, &Buffer[0], sizeof(Floats));
+	Error += Floats[0] == 1.0f ? 0 : 1;
+	Error += Floats[4] == 2.0f && Floats[5] == 3.0f && Floats[6] == 4.0f ? 0 : 1;
+	Error += Floats[7] == 5.0f ? 0 : 1;
+	Error += Floats[8] == 6.0f && Floats[12] == 9.0f && Floats[16] == 12.0f && Floats[18] == 14.0f ? 0 : 1;
+
+	// Padding is left alone
+	unsigned char Padding[4];
+	std::memcpy(Padding, &Buffer[4], sizeof(Padding));
+	Error += Padding[0] == 0xFF && Padding[3] == 0xFF ? 0 : 1;
+
+	float ReadA = 0.0f;
+	glm::vec3 ReadB(0.0f);
+	float ReadC = 0.0f;
+	glm::mat3 ReadD(0.0f);
+	std140_block::read(&Buffer[0], ReadA, ReadB, ReadC, ReadD);
+	Error += ReadA == A ? 0 : 1;
+	Error += glm::all(glm::equal(ReadB, B, 0.0f)) ? 0 : 1;
+	Error += ReadC == C ? 0 : 1;
+	Error += glm::all(glm::equal(ReadD, D, 0.0f)) ? 0 : 1;
+
+	return Error;
+}
+
+static int test_write_array()
+{
+	int Error = 0;
+
+	typedef glm::buffer_layout<glm::std140_layout, float[3], glm::ivec2> block;
+	static_assert(block::offset(1) == 48 && block::size() == 64, "float array stride is 16");
+
+	float const Values[3] = {1.0f, 2.0f, 3.0f};
+	std::vector<unsigned char> Buffer(block::size(), 0);
+	block::write(&Buffer[0], Values, glm::ivec2(-1, 7));
+
+	float Read[3] = {0.0f, 0.0f, 0.0f};
+	glm::ivec2 ReadI(0);
+	block::read(&Buffer[0], Read, ReadI);
+	Error += Read[0] == 1.0f && Read[1] == 2.0f && Read[2] == 3.0f ? 0 : 1;
+	Error += ReadI == glm::ivec2(-1, 7) ? 0 : 1;
+
+	float Second = 0.0f;
+	std::memcpy(&Second, &Buffer[16], sizeof(Second));
+	Error += Second == 2.0f ? 0 : 1;
+
+	return Error;
+}
+
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+static int test_zero_copy()
+{
+	int Error = 0;
+
+	aligned_block Block;
+	Block.a = glm::aligned_vec4(1.0f, 2.0f, 3.0f, 4.0f);
+	Block.b = glm::vec3(5.0f, 6.0f, 7.0f);
+	Block.c = 8.0f;
+	Block.d = glm::aligned_vec2(9.0f, 10.0f);
+	Block.g = glm::vec2(11.0f, 12.0f);
+	Block.e = glm::aligned_mat3(2.0f);
+	Block.f = glm::aligned_mat4(3.0f);
+
+	// Copying the struct as is or writing it member by member gives the same block
+	std::vector<unsigned char> Copied(aligned_std140::size(), 0);
+	std::vector<unsigned char> Written(aligned_std140::size(), 0);
+	std::memcpy(&Copied[0], &Block, sizeof(Block));
+	aligned_std140::write(&Written[0], Block.a, Block.b, Block.c, Block.d, Block.g, Block.e, Block.f);
+
+	Error += std::memcmp(&Copied[0], &Written[0], Copied.size()) == 0 ? 0 : 1;
+
+	return Error;
+}
+#endif
+
+int main()
+{
+	int Error = 0;
+
+	Error += test_write();
+	Error += test_write_array();
+#	if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+		Error += test_zero_copy();
+#	endif
+
+	return Error;
+}
+
+#if GLM_COMPILER & GLM_COMPILER_CLANG
+#	pragma clang diagnostic pop
+#endif
+
+#else
+
+int main()
+{
+	return 0;
+}
+
+#endif//GLM_LANG & GLM_LANG_CXX11_FLAG
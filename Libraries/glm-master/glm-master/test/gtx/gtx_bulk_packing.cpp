@@ -0,0 +1,210 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/bulk_packing.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/ext/scalar_relational.hpp>
+#include <cstring>
+#include <vector>
+
+static glm::uint32 hashBits(glm::uint32 i)
+{
+	i ^= i >> 16;
+	i *= 0x7feb352dU;
+	i ^= i >> 15;
+	i *= 0x846ca68bU;
+	i ^= i >> 16;
+	return i;
+}
+
+static float floatFromBits(glm::uint32 Bits)
+{
+	float Result = 0.f;
+	std::memcpy(&Result, &Bits, sizeof(Result));
+	return Result;
+}
+
+static glm::uint32 bitsFromFloat(float Value)
+{
+	glm::uint32 Result = 0;
+	std::memcpy(&Result, &Value, sizeof(Result));
+	return Result;
+}
+
+static int test_packHalfBulk()
+{
+	int Error = 0;
+
+	std::vector<float> In;
+	In.push_back(0.0f);
+	In.push_back(-0.0f);
+	In.push_back(1.0f);
+	In.push_back(-2.5f);
+	In.push_back(65504.f);
+	In.push_back(65520.f); // Rounds to infinity
+	In.push_back(1.00048828125f); // Tie between two halfs
+	In.push_back(6.1035156e-05f); // Smallest normalized half
+	In.push_back(2.9802322e-08f); // Half of the smallest denormalized half
+	In.push_back(floatFromBits(0x7f800000));
+	In.push_back(floatFromBits(0xff800000));
+	In.push_back(floatFromBits(0x7fc00000));
+	In.push_back(floatFromBits(0x7f800001));
+	for(glm::uint32 i = 0; i < 4099; ++i)
+		In.push_back(floatFromBits(hashBits(i)));
+	for(glm::uint32 i = 0; i < 4099; ++i)
+		In.push_back(static_cast<float>(i) * 0.37f - 700.f);
+
+	std::vector<glm::uint16> Out(In.size());
+	glm::packHalfBulk(&In[0], &Out[0], In.size());
+
+	for(std::size_t i = 0; i < In.size(); ++i)
+		Error += Out[i] == glm::packHalf1x16(In[i]) ? 0 : 1;
+
+	return Error;
+}
+
+static int test_unpackHalfBulk()
+{
+	int Error = 0;
+
+	std::vector<glm::uint16> In(65536);
+	for(std::size_t i = 0; i < In.size(); ++i)
+		In[i] = static_cast<glm::uint16>(i);
+
+	std::vector<float> Out(In.size());
+	glm::unpackHalfBulk(&In[0], &Out[0], In.size());
+
+	for(std::size_t i = 0; i < In.size(); ++i)
+	{
+		float const Expected = glm::unpackHalf1x16(In[i]);
+		if(Expected != Expected)
+			Error += Out[i] != Out[i] ? 0 : 1;
+		else
+			Error += bitsFromFloat(Out[i]) == bitsFromFloat(Expected) ? 0 : 1;
+	}
+
+	return Error;
+}
+
+static int test_packF2x11_1x10Bulk()
+{
+	int Error = 0;
+
+	std::vector<glm::vec3> In;
+	In.push_back(glm::vec3(0.0f, -0.0f, 1.0f));
+	In.push_back(glm::vec3(floatFromBits(0x7f800000), floatFromBits(0x7fc00000), floatFromBits(0x7f800000)));
+	In.push_back(glm::vec3(65024.f, 0.5f, floatFromBits(0x7fc00000)));
+	for(glm::uint32 i = 0; i < 2051; ++i)
+		In.push_back(glm::vec3(floatFromBits(hashBits(i * 3 + 0)), floatFromBits(hashBits(i * 3 + 1)), floatFromBits(hashBits(i * 3 + 2))));
+	for(glm::uint32 i = 0; i < 2051; ++i)
+		In.push_back(glm::vec3(static_cast<float>(i) * 0.25f, static_cast<float>(i) * 0.01f, static_cast<float>(i) * 3.f));
+
+	std::vector<glm::uint32> Out(In.size());
+	glm::packF2x11_1x10Bulk(&In[0], &Out[0], In.size());
+
+	for(std::size_t i = 0; i < In.size(); ++i)
+		Error += Out[i] == glm::packF2x11_1x10(In[i]) ? 0 : 1;
+
+	return Error;
+}
+
+static int test_unpackF2x11_1x10Bulk()
+{
+	int Error = 0;
+
+	std::vector<glm::uint32> In;
+	In.push_back(0);
+	In.push_back(0x7ff);
+	In.push_back(0x7c0);
+	In.push_back(0x3ff << 22);
+	for(glm::uint32 i = 0; i < 4099; ++i)
+		In.push_back(hashBits(i));
+
+	std::vector<glm::vec3> Out(In.size(), glm::vec3(0.0f));
+	glm::unpackF2x11_1x10Bulk(&In[0], &Out[0], In.size());
+
+	for(std::size_t i = 0; i < In.size(); ++i)
+	{
+		glm::vec3 const Expected = glm::unpackF2x11_1x10(In[i]);
+		for(glm::length_t c = 0; c < 3; ++c)
+			Error += bitsFromFloat(Out[i][c]) == bitsFromFloat(Expected[c]) ? 0 : 1;
+	}
+
+	return Error;
+}
+
+static int test_packF3x9_E1x5Bulk()
+{
+	int Error = 0;
+
+	std::vector<glm::vec3> In;
+	In.push_back(glm::vec3(0.0f));
+	In.push_back(glm::vec3(1.0f, 0.5f, 0.25f));
+	In.push_back(glm::vec3(-1.0f, 2.0f, 40000.0f));
+	In.push_back(glm::vec3(511.75f, 0.0f, 0.0f)); // Mantissa rounding bumps the shared exponent
+	In.push_back(glm::vec3(1e-9f, 0.0f, 0.0f));
+	for(glm::uint32 i = 0; i < 4099; ++i)
+	{
+		float const Scale = static_cast<float>(1 << (hashBits(i) % 24)) / 256.f;
+		In.push_back(glm::vec3(
+			static_cast<float>(hashBits(i * 3 + 0) & 0xffff) / 65535.f,
+			static_cast<float>(hashBits(i * 3 + 1) & 0xffff) / 65535.f,
+			static_cast<float>(hashBits(i * 3 + 2) & 0xffff) / 65535.f) * Scale);
+	}
+
+	std::vector<glm::uint32> Out(In.size());
+	glm::packF3x9_E1x5Bulk(&In[0], &Out[0], In.size());
+
+	std::vector<glm::uint32> Scalar(In.size());
+	glm::detail::packF3x9_E1x5BulkScalar(&In[0], &Scalar[0], In.size());
+
+	for(std::size_t i = 0; i < In.size(); ++i)
+	{
+		Error += Out[i] == Scalar[i] ? 0 : 1;
+
+		// Identical to packF3x9_E1x5 or an encoding of the same precision or better
+		glm::vec3 const Color = glm::clamp(In[i], 0.0f, 32768.f);
+		glm::vec3 const Bulk = glm::unpackF3x9_E1x5(Out[i]);
+		glm::vec3 const Reference = glm::unpackF3x9_E1x5(glm::packF3x9_E1x5(In[i]));
+		for(glm::length_t c = 0; c < 3; ++c)
+			Error += glm::abs(Bulk[c] - Color[c]) <= glm::abs(Reference[c] - Color[c]) ? 0 : 1;
+	}
+
+	Error += Out[1] == glm::packF3x9_E1x5(In[1]) ? 0 : 1;
+	Error += Out[3] == glm::packF3x9_E1x5(In[3]) ? 0 : 1;
+
+	return Error;
+}
+
+static int test_unpackF3x9_E1x5Bulk()
+{
+	int Error = 0;
+
+	std::vector<glm::uint32> In;
+	for(glm::uint32 i = 0; i < 4099; ++i)
+		In.push_back(hashBits(i));
+
+	std::vector<glm::vec3> Out(In.size(), glm::vec3(0.0f));
+	glm::unpackF3x9_E1x5Bulk(&In[0], &Out[0], In.size());
+
+	for(std::size_t i = 0; i < In.size(); ++i)
+	{
+		glm::vec3 const Expected = glm::unpackF3x9_E1x5(In[i]);
+		for(glm::length_t c = 0; c < 3; ++c)
+			Error += bitsFromFloat(Out[i][c]) == bitsFromFloat(Expected[c]) ? 0 : 1;
+	}
+
+	return Error;
+}
+
+int main()
+{
+	int Error = 0;
+
+	Error += test_packHalfBulk();
+	Error += test_unpackHalfBulk();
+	Error += test_packF2x11_1x10Bulk();
+	Error += test_unpackF2x11_1x10Bulk();
+	Error += test_packF3x9_E1x5Bulk();
+	Error += test_unpackF3x9_E1x5Bulk();
+
+	return Error;
+}
@@ -0,0 +1,99 @@
+#define GLM_FORCE_INLINE
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/bounds_transform.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/vector_relational.hpp>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+static int toMicroseconds(std::chrono::high_resolution_clock::time_point t1, std::chrono::high_resolution_clock::time_point t2)
+{
+	return static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+}
+
+// Recomputes the world space boxes of Samples moving objects three ways: transforming the eight corners with
+// mat4 * vec4, the center and extent with the abs matrix, and the same in bulk on structure of arrays
+static int comp_bounds_transform(std::size_t Samples)
+{
+	int Error = 0;
+
+	std::vector<glm::mat4> Transforms(Samples);
+	std::vector<glm::vec3> LocalMin(Samples), LocalMax(Samples);
+	std::vector<float> Center[3], Extent[3], Min[3], Max[3];
+	for(std::size_t i = 0; i < Samples; ++i)
+	{
+		float const t = static_cast<float>(i);
+		Transforms[i] = glm::rotate(glm::translate(glm::mat4(1.f), glm::vec3(t, t * 0.5f, -t)), t * 0.01f, glm::normalize(glm::vec3(1.f, 2.f, 3.f)));
+		LocalMin[i] = glm::vec3(-1.f, -2.f, -0.5f) * (1.f + static_cast<float>(i % 7));
+		LocalMax[i] = glm::vec3(1.f, 0.5f, 2.f) * (1.f + static_cast<float>(i % 5));
+		for(glm::length_t c = 0; c < 3; ++c)
+		{
+			Center[c].push_back((LocalMin[i][c] + LocalMax[i][c]) * 0.5f);
+			Extent[c].push_back((LocalMax[i][c] - LocalMin[i][c]) * 0.5f);
+		}
+	}
+	for(int c = 0; c < 3; ++c)
+	{
+		Min[c].resize(Samples);
+		Max[c].resize(Samples);
+	}
+
+	std::vector<glm::vec3> CornerMin(Samples), CornerMax(Samples);
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	for(std::size_t i = 0; i < Samples; ++i)
+	{
+		glm::vec3 BoxMin(1e30f), BoxMax(-1e30f);
+		for(int Corner = 0; Corner < 8; ++Corner)
+		{
+			glm::vec4 const Local((Corner & 1) ? LocalMax[i].x : LocalMin[i].x, (Corner & 2) ? LocalMax[i].y : LocalMin[i].y, (Corner & 4) ? LocalMax[i].z : LocalMin[i].z, 1.f);
+			glm::vec3 const World(Transforms[i] * Local);
+			BoxMin = glm::min(BoxMin, World);
+			BoxMax = glm::max(BoxMax, World);
+		}
+		CornerMin[i] = BoxMin;
+		CornerMax[i] = BoxMax;
+	}
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- 8 corners: %d us\n", toMicroseconds(t1, t2));
+
+	std::vector<glm::vec3> ScalarMin(Samples), ScalarMax(Samples);
+	t1 = std::chrono::high_resolution_clock::now();
+	for(std::size_t i = 0; i < Samples; ++i)
+		glm::transformMinMax(Transforms[i], LocalMin[i], LocalMax[i], ScalarMin[i], ScalarMax[i]);
+	t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- transformMinMax: %d us\n", toMicroseconds(t1, t2));
+
+	float const* const CenterPtr[3] = { &Center[0][0], &Center[1][0], &Center[2][0] };
+	float const* const ExtentPtr[3] = { &Extent[0][0], &Extent[1][0], &Extent[2][0] };
+	float* const MinPtr[3] = { &Min[0][0], &Min[1][0], &Min[2][0] };
+	float* const MaxPtr[3] = { &Max[0][0], &Max[1][0], &Max[2][0] };
+	t1 = std::chrono::high_resolution_clock::now();
+	glm::transformBoundsBulk(&Transforms[0], CenterPtr, ExtentPtr, MinPtr, MaxPtr, Samples);
+	t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- transformBoundsBulk: %d us\n", toMicroseconds(t1, t2));
+
+	for(std::size_t i = 0; i < Samples; ++i)
+	{
+		// Tolerance relative to the translations, which reach Samples
+		float const Epsilon = 1e-5f * static_cast<float>(Samples);
+		Error += glm::all(glm::equal(ScalarMin[i], CornerMin[i], Epsilon)) ? 0 : 1;
+		Error += glm::all(glm::equal(ScalarMax[i], CornerMax[i], Epsilon)) ? 0 : 1;
+		Error += glm::all(glm::equal(glm::vec3(Min[0][i], Min[1][i], Min[2][i]), CornerMin[i], Epsilon)) ? 0 : 1;
+		Error += glm::all(glm::equal(glm::vec3(Max[0][i], Max[1][i], Max[2][i]), CornerMax[i], Epsilon)) ? 0 : 1;
+	}
+
+	return Error;
+}
+
+int main()
+{
+	std::size_t const Samples = 100000;
+
+	int Error = 0;
+
+	std::printf("world space bounds of %d movers:\n", static_cast<int>(Samples));
+	Error += comp_bounds_transform(Samples);
+
+	return Error;
+}
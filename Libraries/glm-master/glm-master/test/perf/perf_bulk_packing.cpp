@@ -0,0 +1,157 @@
+#define GLM_FORCE_INLINE
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/bulk_packing.hpp>
+#include <glm/gtc/packing.hpp>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+static double toThroughput(std::size_t Samples, std::chrono::high_resolution_clock::time_point t1, std::chrono::high_resolution_clock::time_point t2)
+{
+	double const Seconds = std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count();
+	return Seconds > 0.0 ? static_cast<double>(Samples) / Seconds / 1000000.0 : 0.0;
+}
+
+static int comp_half(std::size_t Samples)
+{
+	int Error = 0;
+
+	std::vector<float> In(Samples);
+	for(std::size_t i = 0; i < Samples; ++i)
+		In[i] = static_cast<float>(i) * 0.01f - 100.f;
+
+	std::vector<glm::uint16> Scalar(Samples);
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	for(std::size_t i = 0; i < Samples; ++i)
+		Scalar[i] = glm::packHalf1x16(In[i]);
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- packHalf1x16: %.1f M/s\n", toThroughput(Samples, t1, t2));
+
+	std::vector<glm::uint16> Bulk(Samples);
+	t1 = std::chrono::high_resolution_clock::now();
+	glm::packHalfBulk(&In[0], &Bulk[0], Samples);
+	t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- packHalfBulk: %.1f M/s\n", toThroughput(Samples, t1, t2));
+
+	std::vector<float> Unpacked(Samples);
+	t1 = std::chrono::high_resolution_clock::now();
+	for(std::size_t i = 0; i < Samples; ++i)
+		Unpacked[i] = glm::unpackHalf1x16(Bulk[i]);
+	t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- unpackHalf1x16: %.1f M/s\n", toThroughput(Samples, t1, t2));
+
+	std::vector<float> UnpackedBulk(Samples);
+	t1 = std::chrono::high_resolution_clock::now();
+	glm::unpackHalfBulk(&Bulk[0], &UnpackedBulk[0], Samples);
+	t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- unpackHalfBulk: %.1f M/s\n", toThroughput(Samples, t1, t2));
+
+	for(std::size_t i = 0; i < Samples; ++i)
+	{
+		Error += Scalar[i] == Bulk[i] ? 0 : 1;
+		Error += Unpacked[i] == UnpackedBulk[i] ? 0 : 1;
+	}
+
+	return Error;
+}
+
+static int comp_F3x9_E1x5(std::size_t Samples)
+{
+	int Error = 0;
+
+	std::vector<glm::vec3> In(Samples, glm::vec3(0.0f));
+	for(std::size_t i = 0; i < Samples; ++i)
+		In[i] = glm::vec3(0.001f, 0.01f, 0.1f) * static_cast<float>(i % 4096);
+
+	std::vector<glm::uint32> Scalar(Samples);
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	for(std::size_t i = 0; i < Samples; ++i)
+		Scalar[i] = glm::packF3x9_E1x5(In[i]);
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- packF3x9_E1x5: %.1f M/s\n", toThroughput(Samples, t1, t2));
+
+	std::vector<glm::uint32> Bulk(Samples);
+	t1 = std::chrono::high_resolution_clock::now();
+	glm::packF3x9_E1x5Bulk(&In[0], &Bulk[0], Samples);
+	t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- packF3x9_E1x5Bulk: %.1f M/s\n", toThroughput(Samples, t1, t2));
+
+	std::vector<glm::vec3> Unpacked(Samples, glm::vec3(0.0f));
+	t1 = std::chrono::high_resolution_clock::now();
+	for(std::size_t i = 0; i < Samples; ++i)
+		Unpacked[i] = glm::unpackF3x9_E1x5(Bulk[i]);
+	t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- unpackF3x9_E1x5: %.1f M/s\n", toThroughput(Samples, t1, t2));
+
+	std::vector<glm::vec3> UnpackedBulk(Samples, glm::vec3(0.0f));
+	t1 = std::chrono::high_resolution_clock::now();
+	glm::unpackF3x9_E1x5Bulk(&Bulk[0], &UnpackedBulk[0], Samples);
+	t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- unpackF3x9_E1x5Bulk: %.1f M/s\n", toThroughput(Samples, t1, t2));
+
+	for(std::size_t i = 0; i < Samples; ++i)
+		Error += glm::all(glm::equal(Unpacked[i], UnpackedBulk[i])) ? 0 : 1;
+
+	return Error;
+}
+
+static int comp_F2x11_1x10(std::size_t Samples)
+{
+	int Error = 0;
+
+	std::vector<glm::vec3> In(Samples, glm::vec3(0.0f));
+	for(std::size_t i = 0; i < Samples; ++i)
+		In[i] = glm::vec3(0.001f, 0.01f, 0.1f) * static_cast<float>(i % 4096);
+
+	std::vector<glm::uint32> Scalar(Samples);
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	for(std::size_t i = 0; i < Samples; ++i)
+		Scalar[i] = glm::packF2x11_1x10(In[i]);
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- packF2x11_1x10: %.1f M/s\n", toThroughput(Samples, t1, t2));
+
+	std::vector<glm::uint32> Bulk(Samples);
+	t1 = std::chrono::high_resolution_clock::now();
+	glm::packF2x11_1x10Bulk(&In[0], &Bulk[0], Samples);
+	t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- packF2x11_1x10Bulk: %.1f M/s\n", toThroughput(Samples, t1, t2));
+
+	std::vector<glm::vec3> Unpacked(Samples, glm::vec3(0.0f));
+	t1 = std::chrono::high_resolution_clock::now();
+	for(std::size_t i = 0; i < Samples; ++i)
+		Unpacked[i] = glm::unpackF2x11_1x10(Bulk[i]);
+	t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- unpackF2x11_1x10: %.1f M/s\n", toThroughput(Samples, t1, t2));
+
+	std::vector<glm::vec3> UnpackedBulk(Samples, glm::vec3(0.0f));
+	t1 = std::chrono::high_resolution_clock::now();
+	glm::unpackF2x11_1x10Bulk(&Bulk[0], &UnpackedBulk[0], Samples);
+	t2 = std::chrono::high_resolution_clock::now();
+	std::printf("- unpackF2x11_1x10Bulk: %.1f M/s\n", toThroughput(Samples, t1, t2));
+
+	for(std::size_t i = 0; i < Samples; ++i)
+	{
+		Error += Scalar[i] == Bulk[i] ? 0 : 1;
+		Error += glm::all(glm::equal(Unpacked[i], UnpackedBulk[i])) ? 0 : 1;
+	}
+
+	return Error;
+}
+
+int main()
+{
+	std::size_t const Samples = 1 << 20;
+
+	int Error = 0;
+
+	std::printf("float <-> half:\n");
+	Error += comp_half(Samples);
+
+	std::printf("vec3 <-> RGB9E5:\n");
+	Error += comp_F3x9_E1x5(Samples);
+
+	std::printf("vec3 <-> R11G11B10:\n");
+	Error += comp_F2x11_1x10(Samples);
+
+	return Error;
+}